@@ -8,12 +8,27 @@
 #define NUM_FEATURES 3
 #define FEATURE_SIZE 64
 
-// Defines a struct for the format of a pairing message
+#define BOUND_KEY_SIZE 16
+
+// Runtime snapshots (TEST_BUILD getSnapshot/setSnapshot) start with these
+// two bytes, followed by the role's state and then the platform's state
+#define SNAPSHOT_VERSION 4
+#define SNAPSHOT_ROLE_CAR 'C'
+#define SNAPSHOT_ROLE_FOB 'F'
+#define SNAPSHOT_MAX_SIZE 192
+
+// What snapshotPlatform returns when its state does not fit
+#define SNAPSHOT_NO_ROOM 0xFFFFFFFFu
+
+// Defines a struct for the format of a pairing message. bound_key keys the
+// fob's distance-bounding responses; unlike the password it is never sent
+// when unlocking
 typedef struct
 {
   uint8_t car_id[8];
   uint8_t password[8];
   uint8_t pin[8];
+  uint8_t bound_key[BOUND_KEY_SIZE];
 } PAIR_PACKET;
 
 // Defines a struct for the format of start message
@@ -0,0 +1,26 @@
+#ifndef ED25519_H
+#define ED25519_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define ED25519_SIG_SIZE 64
+#define ED25519_KEY_SIZE 32
+
+/**
+ * @brief Verify an Ed25519 (RFC 8032) signature
+ *
+ * Checks [S]B = R + [k]A, as tools/ed25519.py does. Not constant time:
+ * everything it handles is public.
+ *
+ * @param sig the 64-byte signature R || S
+ * @param msg the signed message
+ * @param len length of msg
+ * @param pub the signer's 32-byte public key
+ * @return true if the signature is valid
+ */
+bool ed25519_verify(const uint8_t *sig, const uint8_t *msg, size_t len,
+                    const uint8_t *pub);
+
+#endif // ED25519_H
@@ -0,0 +1,51 @@
+#ifndef HEX_CODEC_H
+#define HEX_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Convert bytes to a NUL-terminated lowercase hex string
+ *
+ * @param bytes pointer to the data to encode
+ * @param len number of bytes to encode
+ * @param hex destination; must hold at least len * 2 + 1 characters
+ */
+void bytesToHex(const uint8_t *bytes, size_t len, char *hex);
+
+/**
+ * @brief Convert a NUL-terminated hex string to bytes
+ *
+ * @param hex the string to decode (upper or lower case)
+ * @param bytes destination for the decoded data
+ * @param maxLen size of the destination buffer
+ * @return Number of bytes written, or -1 on error
+ */
+int hexToBytes(const char *hex, uint8_t *bytes, size_t maxLen);
+
+/**
+ * @brief Convert exactly hexLen hex characters to bytes
+ *
+ * Fails, without a partial result being meaningful, if hexLen is odd, if
+ * the result would not fit in maxLen bytes, or if any character is not a
+ * hex digit.
+ *
+ * @return Number of bytes written, or -1 on error
+ */
+int hexToBytesN(const char *hex, size_t hexLen, uint8_t *bytes, size_t maxLen);
+
+/**
+ * @brief Portable table-driven implementations
+ *
+ * bytesToHex and hexToBytesN use these, except on x86 where bulk data goes
+ * through SSSE3 or AVX2 when the CPU has it. Exposed for benchmarking.
+ */
+void bytesToHexScalar(const uint8_t *bytes, size_t len, char *hex);
+int hexToBytesScalar(const char *hex, size_t hexLen, uint8_t *bytes, size_t maxLen);
+
+/**
+ * @brief Name of the implementation in use: "avx2", "ssse3" or "scalar"
+ */
+const char *hexCodecImpl(void);
+
+#endif // HEX_CODEC_H
@@ -15,6 +15,7 @@
 #ifndef BOARD_LINK_H
 #define BOARD_LINK_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "uart.h"
@@ -26,31 +27,86 @@
 #define PAIR_MAGIC 0x55
 #define UNLOCK_MAGIC 0x56
 #define START_MAGIC 0x57
+#define PAIR_ACK_MAGIC 0x58
+#define BOUND_MAGIC 0x59
+
+// Distance-bounding challenges and responses are bare bytes of BOUND_BITS,
+// which never look like the magic that starts a frame
+#define BOUND_BITS 0x3F
+#define BOUND_NONCE_SIZE 8
+#define BOUND_MAX_ROUNDS 64
+
+// Board link addresses. The car is always CAR_ADDR; each fob has its own
+// address (see boardLinkAddress). Address 0 is never assigned.
+#define CAR_ADDR 0x01
+#define BROADCAST_ADDR 0xFF
 
 /**
  * @brief Structure for message between boards
  *
+ * On the wire a message is framed as
+ *   [magic] [dst] [src] [message_len] [buffer...] [crc8]
+ * so several boards can share one link. src is filled in on send.
  */
 typedef struct
 {
   uint8_t magic;
+  uint8_t dst;
+  uint8_t src;
   uint8_t message_len;
   uint8_t *buffer;
 } MESSAGE_PACKET;
 
+/**
+ * @brief What a BOUND frame carries: the rounds that follow, and the car's
+ * fresh nonce for bound_keystream
+ */
+typedef struct
+{
+  uint8_t rounds;
+  uint8_t nonce[BOUND_NONCE_SIZE];
+} BOUND_PACKET;
+
+/**
+ * @brief Set up the board link
+ *
+ * @param address this board's address
+ * @param shared true if the link is a shared medium on which every board,
+ * including the sender, hears every byte (multi-drop bus or x86 hub)
+ */
+void board_link_init(uint8_t address, bool shared);
+
+/**
+ * @brief Check whether a message may be waiting on the board link
+ *
+ * Never blocks. Bytes that cannot start a frame, such as bare
+ * distance-bounding bytes between other boards, are dropped.
+ *
+ * @return true if a message (or the start of one) has been received
+ */
+bool board_message_avail(void);
+
 /**
  * @brief Send a message between boards
  *
+ * On a shared link the message is retransmitted after a random backoff if
+ * it collides with another board's transmission.
+ *
  * @param message pointer to message to send
- * @return uint32_t the number of bytes sent
+ * @return uint32_t the number of bytes sent - 0 if it could not be sent
  */
 uint32_t send_board_message(MESSAGE_PACKET *message);
 
 /**
  * @brief Receive a message between boards
  *
+ * Frames that fail their CRC, are not addressed to this board (or to
+ * BROADCAST_ADDR), or are this board's own echo are discarded; message->magic
+ * is then 0. Blocks until a byte arrives; within a frame, gives up once the
+ * link has been quiet for a while, and picks up again at the next magic byte.
+ *
  * @param message pointer to message where data will be received
- * @return uint32_t the number of bytes received
+ * @return uint32_t the number of bytes received - 0 for error
  */
 uint32_t receive_board_message(MESSAGE_PACKET *message);
 
@@ -63,4 +119,59 @@ uint32_t receive_board_message(MESSAGE_PACKET *message);
  */
 uint32_t receive_board_message_by_type(MESSAGE_PACKET *message, uint8_t type);
 
+/**
+ * @brief Time one distance-bounding round: send a challenge byte and wait
+ * for the response byte
+ *
+ * The round trip is timed with cycleCount(), from just before the challenge
+ * is written to just after the response is read. On a shared link the
+ * challenge's own echo is skipped, and frames from other boards that come
+ * in between are kept for receive_board_message.
+ *
+ * @param challenge the challenge, within BOUND_BITS
+ * @param response where the response byte is stored
+ * @param timeout_us give up after this many microseconds
+ * @return uint32_t the round trip in cycleCount() ticks - 0 on timeout
+ */
+uint32_t bound_challenge(uint8_t challenge, uint8_t *response, uint32_t timeout_us);
+
+/**
+ * @brief Answer one distance-bounding round: wait for a challenge byte and
+ * send back bound_response for it at once
+ *
+ * Frames that come before the challenge are kept for receive_board_message.
+ *
+ * @param key0 the round's key from the first register, within BOUND_BITS
+ * @param key1 the round's key from the second register, within BOUND_BITS
+ * @param timeout_us give up after this many microseconds
+ * @return true if a challenge was answered
+ */
+bool bound_respond(uint8_t key0, uint8_t key1, uint32_t timeout_us);
+
+/**
+ * @brief The right response to a distance-bounding challenge
+ *
+ * Each challenge bit picks the same bit of key1 if set, of key0 if clear,
+ * so a response gives away exactly half of the round's key bits: a relay
+ * that asks the fob ahead of the car gets the other half only by guessing.
+ *
+ * @return uint8_t the response, within BOUND_BITS
+ */
+uint8_t bound_response(uint8_t challenge, uint8_t key0, uint8_t key1);
+
+/**
+ * @brief The two key registers for one distance-bounding check
+ *
+ * Register r is HMAC-SHA-512(key, nonce || r) cut to BOUND_BITS per round,
+ * and round i is answered with bound_response(challenge, stream[0][i],
+ * stream[1][i]). Only the car and its paired fobs hold the key, so a relay
+ * cannot answer for the fob, and the nonce makes every check's registers
+ * new.
+ *
+ * @param key the BOUND_KEY_SIZE-byte key from pairing
+ * @param nonce the BOUND_NONCE_SIZE-byte nonce from the BOUND frame
+ * @param stream where the two registers of BOUND_MAX_ROUNDS keys are stored
+ */
+void bound_keystream(const uint8_t *key, const uint8_t *nonce, uint8_t stream[2][BOUND_MAX_ROUNDS]);
+
 #endif
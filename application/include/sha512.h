@@ -0,0 +1,28 @@
+#ifndef SHA512_H
+#define SHA512_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SHA512_SIZE 64
+#define SHA512_BLOCK_SIZE 128
+
+typedef struct
+{
+  uint64_t state[8];
+  uint8_t block[SHA512_BLOCK_SIZE];
+  uint32_t used;
+  uint32_t total;
+} sha512_ctx;
+
+void sha512_init(sha512_ctx *ctx);
+void sha512_update(sha512_ctx *ctx, const uint8_t *data, size_t len);
+void sha512_final(sha512_ctx *ctx, uint8_t digest[SHA512_SIZE]);
+
+/**
+ * @brief HMAC-SHA-512 (RFC 2104) of msg under key
+ */
+void hmac_sha512(const uint8_t *key, size_t key_len, const uint8_t *msg, size_t len,
+                 uint8_t mac[SHA512_SIZE]);
+
+#endif // SHA512_H
@@ -16,63 +16,126 @@
 #include <stdint.h>
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 #include "secrets.h"
 #include "messages.h"
 #include "dataFormats.h"
 #include "uart.h"
 #include "platform.h"
+#include "hexCodec.h"
+#include "arm_stream_stats.h"
 
 /*** Macros ***/
-#define MAX_CMD_LEN 64
+#define MAX_CMD_LEN 256
+
+// A host command is taken only once the host transmit queue has room for a
+// full reply (see sendOK): while the host is slow to read, the board link is
+// still served instead of waiting in uart_write
+#define HOST_REPLY_ROOM 512
+
+// Fobs that have sent a good password and may now send START
+#define MAX_SESSIONS 8
+
+// Distance bounding: single-byte rounds timed after a good password, and
+// how long to wait for each response. BOUND_MAX_US, the limit on the
+// held round's round trip, comes from the build (scons bound_us=); 0 turns
+// bounding off
+#define BOUND_ROUNDS 16
+#define BOUND_TIMEOUT_US 50000
+#ifndef BOUND_MAX_US
+#   define BOUND_MAX_US 300
+#endif
+
+// The round held to BOUND_MAX_US, counting up from the fastest: the slowest
+// but one, so that one round slowed by noise is ridden out while a relay
+// must still answer every other round in time
+#define BOUND_HELD_ROUND (BOUND_ROUNDS - 2)
 
 /*** Function definitions ***/
 // Core functions - unlockCar and startCar
-void unlockCar(void);
-void startCar(void);
+void processBoardMessage(void);
+void unlockCar(MESSAGE_PACKET *message);
+void startCar(MESSAGE_PACKET *message);
 
 // Helper functions - sending ack messages
-void sendAckSuccess(void);
-void sendAckFailure(void);
+void sendAckSuccess(uint8_t dst);
+void sendAckFailure(uint8_t dst);
+
+// Helper functions - per-fob unlock sessions
+bool openSession(uint8_t addr);
+bool closeSession(uint8_t addr);
+
+// Helper functions - distance bounding
+bool boundDistance(uint8_t addr);
 
 // Command processing
 void processHostCommand(const char *cmd);
 void sendOK(const char *value);
 void sendError(const char *reason);
 
+// Test helpers - runtime state capture
+uint32_t saveSnapshot(uint8_t *blob, uint32_t max);
+bool loadSnapshot(const uint8_t *blob, uint32_t len);
+
 // Declare password
 const uint8_t pass[] = PASSWORD;
+static const uint8_t boundKey[BOUND_KEY_SIZE] = BOUND_KEY;
 const uint8_t car_id[] = CAR_ID;
 
 // State variables
 static bool carLocked = true;
 static uint32_t unlockCount = 0;
 
+// Addresses of fobs between UNLOCK and START (0 = free slot)
+static uint8_t sessions[MAX_SESSIONS];
+static uint8_t nextSession = 0;
+
+// Distance bounding threshold, and what the checks since boot found
+static uint32_t boundMaxUs = BOUND_MAX_US;
+static uint32_t boundChecks = 0;
+static uint32_t boundRejected = 0;
+static float32_t boundMin, boundMedian, boundHeld, boundMax, boundVar;   // last check, in us
+static uint32_t boundWrong = 0;                                          // last check's wrong rounds
+static uint32_t boundState = 1;
+static uint32_t boundNonce = 0;
+
 /**
  * @brief Main function for the car example
  *
  * Initializes the RF module and waits for a successful unlock attempt.
- * If successful prints out the unlock flag.
+ * If successful prints out the unlock flag. Several fobs may be unlocking
+ * at once on a shared board link; each is tracked by its address.
  */
 int main(int argc, char **argv)
 {
   initHardware_car(argc, argv);
+  board_link_init(CAR_ADDR, boardLinkShared());
 
   // Reset state on startup
   carLocked = true;
   unlockCount = 0;
+  memset(sessions, 0, sizeof(sessions));
+  nextSession = 0;
+  boundMaxUs = BOUND_MAX_US;
+  boundChecks = 0;
+  boundRejected = 0;
+  boundMin = boundMedian = boundHeld = boundMax = boundVar = 0.0f;
+  boundWrong = 0;
+  boundState = 1;
+  boundNonce = 0;
 
   // Signal ready to host
   uart_write(HOST_UART, (uint8_t *)"OK: started\n", 12);
 
   // Buffer for host commands
   char cmdBuffer[MAX_CMD_LEN];
-  uint8_t cmdIndex = 0;
+  uint16_t cmdIndex = 0;
 
   while (true)
   {
     // Check for host commands (non-blocking)
-    if (uart_avail(HOST_UART))
+    if (uart_avail(HOST_UART) && uart_tx_free(HOST_UART) >= HOST_REPLY_ROOM)
     {
       uint8_t c = (uint8_t)uart_readb(HOST_UART);
 
@@ -92,7 +155,7 @@ int main(int argc, char **argv)
     }
 
     // Check for board messages (non-blocking)
-    if (uart_avail(BOARD_UART)) unlockCar();
+    if (board_message_avail()) processBoardMessage();
   }
 }
 
@@ -118,6 +181,88 @@ void processHostCommand(const char *cmd)
     return;
   }
 
+  // Test command: bound [threshold_us] (report, or change, the distance
+  // bounding threshold; 0 turns bounding off)
+  if (strncmp(cmd, "bound", 5) == 0 && (cmd[5] == '\0' || cmd[5] == ' '))
+  {
+    char buf[48];
+
+    if (cmd[5] == ' ')
+    {
+      char *end;
+      unsigned long us = strtoul(cmd + 6, &end, 10);
+      if (end == cmd + 6 || *end != '\0' || us > 1000000)
+      {
+        sendError("invalid threshold");
+        return;
+      }
+      boundMaxUs = (uint32_t)us;
+    }
+    snprintf(buf, sizeof(buf), "threshold=%lu,rounds=%d", (unsigned long)boundMaxUs, BOUND_ROUNDS);
+    sendOK(buf);
+    return;
+  }
+
+  // Test command: boundStats (distance bounding checks since boot, with the
+  // round trips of the last one in microseconds and how many of its rounds
+  // were answered wrongly or not at all)
+  if (strcmp(cmd, "boundStats") == 0)
+  {
+    char buf[160];
+    if (boundChecks == 0)
+    {
+      snprintf(buf, sizeof(buf), "n=0,rejected=0");
+    }
+    else
+    {
+      snprintf(buf, sizeof(buf), "n=%lu,rejected=%lu,min=%lu,median=%lu,held=%lu,max=%lu,var=%lu,wrong=%lu",
+               (unsigned long)boundChecks, (unsigned long)boundRejected,
+               (unsigned long)boundMin, (unsigned long)boundMedian, (unsigned long)boundHeld,
+               (unsigned long)boundMax, (unsigned long)boundVar, (unsigned long)boundWrong);
+    }
+    sendOK(buf);
+    return;
+  }
+
+  // Test command: boundStatsReset (start the distance bounding counts over)
+  if (strcmp(cmd, "boundStatsReset") == 0)
+  {
+    boundChecks = 0;
+    boundRejected = 0;
+    sendOK(NULL);
+    return;
+  }
+
+  // Test command: getSnapshot
+  if (strcmp(cmd, "getSnapshot") == 0)
+  {
+    uint8_t blob[SNAPSHOT_MAX_SIZE];
+    char hex[SNAPSHOT_MAX_SIZE * 2 + 1];
+    uint32_t len = saveSnapshot(blob, sizeof(blob));
+    if (len == 0)
+    {
+      sendError("snapshot too large");
+      return;
+    }
+    bytesToHex(blob, len, hex);
+    sendOK(hex);
+    return;
+  }
+
+  // Test command: setSnapshot <hex>
+  if (strncmp(cmd, "setSnapshot ", 12) == 0)
+  {
+    uint8_t blob[SNAPSHOT_MAX_SIZE];
+    int len = hexToBytes(cmd + 12, blob, sizeof(blob));
+    if (len < 0 || !loadSnapshot(blob, len))
+    {
+      sendError("invalid snapshot");
+      return;
+    }
+    sendOK(NULL);
+    return;
+  }
+
   // Test command: restart (software reset)
   if (strcmp(cmd, "restart") == 0)
   {
@@ -132,17 +277,110 @@ void processHostCommand(const char *cmd)
   {
     carLocked = true;
     unlockCount = 0;
+    memset(sessions, 0, sizeof(sessions));
     // For car, factory reset just resets runtime state
     // A full factory reset would also clear EEPROM, but car has no persistent state
     sendOK(NULL);
     return;
   }
+
+  // Platform-specific test commands (e.g. clock profiles, x86 link impairment)
+  if (processPlatformCommand(cmd))
+  {
+    return;
+  }
 #endif
 
   // Unknown command
   sendError("unknown command");
 }
 
+#ifdef TEST_BUILD
+// Snapshot bytes before the platform state
+#define CAR_SNAPSHOT_LEN (7 + MAX_SESSIONS + 1 + 3 * 4)
+
+static uint32_t putU32(uint8_t *dest, uint32_t value)
+{
+  for (int i = 0; i < 4; i++)
+  {
+    dest[i] = (uint8_t)(value >> (8 * i));
+  }
+  return 4;
+}
+
+static uint32_t getU32(const uint8_t *src)
+{
+  uint32_t value = 0;
+  for (int i = 0; i < 4; i++)
+  {
+    value |= (uint32_t)src[i] << (8 * i);
+  }
+  return value;
+}
+
+/**
+ * @brief Serialize the car's runtime state
+ *
+ * Layout: [version] [role] [carLocked] [unlockCount (4, LE)]
+ * [sessions (MAX_SESSIONS)] [nextSession] [boundMaxUs (4, LE)]
+ * [boundState (4, LE)] [boundNonce (4, LE)] [platform state]
+ *
+ * @return the number of bytes written to blob, or 0 if the platform state
+ * does not fit
+ */
+uint32_t saveSnapshot(uint8_t *blob, uint32_t max)
+{
+  uint32_t len = 0;
+
+  blob[len++] = SNAPSHOT_VERSION;
+  blob[len++] = SNAPSHOT_ROLE_CAR;
+  blob[len++] = carLocked;
+  len += putU32(&blob[len], unlockCount);
+  memcpy(&blob[len], sessions, MAX_SESSIONS);
+  len += MAX_SESSIONS;
+  blob[len++] = nextSession;
+  len += putU32(&blob[len], boundMaxUs);
+  len += putU32(&blob[len], boundState);
+  len += putU32(&blob[len], boundNonce);
+
+  uint32_t platform = snapshotPlatform(&blob[len], max - len);
+  return (platform == SNAPSHOT_NO_ROOM) ? 0 : len + platform;
+}
+
+/**
+ * @brief Replace the car's runtime state with a snapshot from saveSnapshot
+ *
+ * @return true if the snapshot was valid and has been applied
+ */
+bool loadSnapshot(const uint8_t *blob, uint32_t len)
+{
+  if (len < CAR_SNAPSHOT_LEN || blob[0] != SNAPSHOT_VERSION || blob[1] != SNAPSHOT_ROLE_CAR ||
+      blob[7 + MAX_SESSIONS] >= MAX_SESSIONS)
+  {
+    return false;
+  }
+
+  if (!restorePlatform(&blob[CAR_SNAPSHOT_LEN], len - CAR_SNAPSHOT_LEN))
+  {
+    return false;
+  }
+
+  const uint8_t *p = &blob[2];
+  carLocked = (*p++ != 0);
+  unlockCount = getU32(p);
+  p += 4;
+  memcpy(sessions, p, MAX_SESSIONS);
+  p += MAX_SESSIONS;
+  nextSession = *p++;
+  boundMaxUs = getU32(p);
+  boundState = getU32(&p[4]);
+  boundNonce = getU32(&p[8]);
+  setLED(carLocked ? RED : GREEN);
+
+  return true;
+}
+#endif
+
 /**
  * @brief Send OK response to host
  */
@@ -150,7 +388,7 @@ void sendOK(const char *value)
 {
   if (value)
   {
-    char buf[128];
+    char buf[512];
     snprintf(buf, sizeof(buf), "OK: %s\n", value);
     uart_write(HOST_UART, (uint8_t *)buf, strlen(buf));
   }
@@ -171,42 +409,83 @@ void sendError(const char *reason)
 }
 
 /**
- * @brief Function that handles unlocking of car
- *
- * Receives unlock message, validates password, waits for start message,
- * then sends unlock flag and feature flags to host.
- *
- * Message format sent to host on success:
- *   OK: <unlock_flag_64_bytes>
- *   OK: 1,<feature1_flag_64_bytes>   (if feature 1 enabled)
- *   OK: 2,<feature2_flag_64_bytes>   (if feature 2 enabled)
- *   OK: 3,<feature3_flag_64_bytes>   (if feature 3 enabled)
- *   OK: done
+ * @brief Receive one message from the board link and act on it
  */
-void unlockCar(void)
+void processBoardMessage(void)
 {
   MESSAGE_PACKET message;
   uint8_t buffer[256];
   message.buffer = buffer;
 
-  // Receive unlock message
-  receive_board_message_by_type(&message, UNLOCK_MAGIC);
+  if (receive_board_message(&message) == 0)
+  {
+    return;
+  }
 
+  switch (message.magic)
+  {
+  case UNLOCK_MAGIC:
+    unlockCar(&message);
+    break;
+  case START_MAGIC:
+    startCar(&message);
+    break;
+  default:
+    break;
+  }
+}
+
+/**
+ * @brief Function that handles an unlock message from a fob
+ *
+ * Validates the password and, if it matches, opens a session so that the
+ * same fob may follow up with a start message.
+ */
+void unlockCar(MESSAGE_PACKET *message)
+{
   // Validate password
-  if (memcmp(message.buffer, pass, sizeof(pass)) != 0)
+  if (message->message_len < sizeof(pass) ||
+      memcmp(message->buffer, pass, sizeof(pass)) != 0)
   {
     sendError("bad password");
-    sendAckFailure();
+    sendAckFailure(message->src);
     return;
   }
 
-  // Password matches - send success ACK
-  sendAckSuccess();
+  // A relayed fob answers the timed rounds too slowly
+  if (boundMaxUs != 0 && !boundDistance(message->src))
+  {
+    sendError("distance bound failed");
+    sendAckFailure(message->src);
+    return;
+  }
 
-  // Wait for start message with feature data
-  receive_board_message_by_type(&message, START_MAGIC);
+  // Password matches - send success ACK and wait for this fob's start
+  openSession(message->src);
+  sendAckSuccess(message->src);
+}
 
-  FEATURE_DATA *feature_info = (FEATURE_DATA *)buffer;
+/**
+ * @brief Function that handles a start message from an unlocked fob
+ *
+ * Checks the car ID, then sends unlock flag and feature flags to host.
+ *
+ * Message format sent to host on success:
+ *   OK: <unlock_flag_64_bytes>
+ *   OK: 1,<feature1_flag_64_bytes>   (if feature 1 enabled)
+ *   OK: 2,<feature2_flag_64_bytes>   (if feature 2 enabled)
+ *   OK: 3,<feature3_flag_64_bytes>   (if feature 3 enabled)
+ *   OK: done
+ */
+void startCar(MESSAGE_PACKET *message)
+{
+  // Only a fob that has just sent the password may start the car
+  if (!closeSession(message->src) || message->message_len < sizeof(FEATURE_DATA))
+  {
+    return;
+  }
+
+  FEATURE_DATA *feature_info = (FEATURE_DATA *)message->buffer;
 
   // Verify car ID matches
   if (memcmp(car_id, feature_info->car_id, sizeof(car_id)) != 0)
@@ -224,7 +503,7 @@ void unlockCar(void)
   memset(flag_buffer, 0, sizeof(flag_buffer));
 
   // Send feature flags
-  for (int i = 0; i < feature_info->num_active; i++)
+  for (int i = 0; i < feature_info->num_active && i < NUM_FEATURES; i++)
   {
     uint8_t featureNum = feature_info->features[i];
     if (featureNum >= 1 && featureNum <= NUM_FEATURES)
@@ -246,10 +525,150 @@ void unlockCar(void)
   setLED(GREEN);
 }
 
+/**
+ * @brief Remember that a fob has sent a good password
+ *
+ * If every slot is in use, the oldest session is dropped.
+ *
+ * @return true if the session was opened
+ */
+bool openSession(uint8_t addr)
+{
+  for (int i = 0; i < MAX_SESSIONS; i++)
+  {
+    if (sessions[i] == addr)
+    {
+      return true;
+    }
+  }
+
+  for (int i = 0; i < MAX_SESSIONS; i++)
+  {
+    if (sessions[i] == 0)
+    {
+      sessions[i] = addr;
+      return true;
+    }
+  }
+
+  sessions[nextSession] = addr;
+  nextSession = (nextSession + 1) % MAX_SESSIONS;
+  return true;
+}
+
+/**
+ * @brief Forget a fob's session
+ *
+ * @return true if the fob had a session
+ */
+bool closeSession(uint8_t addr)
+{
+  for (int i = 0; i < MAX_SESSIONS; i++)
+  {
+    if (sessions[i] == addr)
+    {
+      sessions[i] = 0;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Check that a fob is as close as its answers are fast
+ *
+ * Tells the fob to expect BOUND_ROUNDS rounds under a fresh nonce, then
+ * sends each one a random challenge byte and times its response, which the
+ * challenge picks from the two key registers of bound_keystream: it cannot
+ * be sent before the challenge arrives, nor by anything without the
+ * pairing's bound key, and a relay that asks the fob ahead of the car
+ * learns only half of each round's keys. Such a relay still answers the
+ * rounds it guesses right at once, so it is one of the slowest rounds
+ * (BOUND_HELD_ROUND), not the fastest, that is held to the threshold.
+ * Every round is sent even after one fails, so that the fob takes exactly
+ * BOUND_ROUNDS bytes as challenges.
+ *
+ * @return true if every response was right and all but the slowest were
+ * in time
+ */
+bool boundDistance(uint8_t addr)
+{
+  MESSAGE_PACKET message;
+  BOUND_PACKET bound;
+  uint8_t stream[2][BOUND_MAX_ROUNDS];
+
+  // The count keeps nonces apart within a boot, the cycle count across boots
+  boundNonce++;
+  uint32_t stamp = cycleCount();
+  bound.rounds = BOUND_ROUNDS;
+  memcpy(&bound.nonce[0], &boundNonce, sizeof(boundNonce));
+  memcpy(&bound.nonce[4], &stamp, sizeof(stamp));
+  bound_keystream(boundKey, bound.nonce, stream);
+
+  message.magic = BOUND_MAGIC;
+  message.dst = addr;
+  message.buffer = (uint8_t *)&bound;
+  message.message_len = sizeof(bound);
+  if (send_board_message(&message) == 0)
+  {
+    return false;
+  }
+
+  // clockHz() is 0 on x86, whose cycle counter counts nanoseconds
+  uint32_t hz = clockHz() ? clockHz() : 1000000000u;
+  float32_t usPerCycle = 1000000.0f / (float32_t)hz;
+  float32_t rtt[BOUND_ROUNDS];
+  boundWrong = 0;
+
+  boundState ^= cycleCount();
+  for (int i = 0; i < BOUND_ROUNDS; i++)
+  {
+    boundState = boundState * 1103515245u + 12345u;
+    uint8_t challenge = (uint8_t)(boundState >> 16) & BOUND_BITS;
+    uint8_t response = 0;
+    uint32_t cycles = bound_challenge(challenge, &response, BOUND_TIMEOUT_US);
+
+    rtt[i] = cycles ? (float32_t)cycles * usPerCycle : (float32_t)BOUND_TIMEOUT_US;
+    if (cycles == 0 || response != bound_response(challenge, stream[0][i], stream[1][i]))
+    {
+      boundWrong++;
+    }
+  }
+
+  arm_stream_stats_instance_f32 stats;
+  arm_stream_stats_init_f32(&stats, 1.0f);
+  arm_stream_stats_f32(&stats, rtt, BOUND_ROUNDS);
+  arm_stream_stats_var_f32(&stats, &boundVar);
+  boundMin = stats.min;
+
+  // Median: sort the round trips (insertion sort; there are only a few)
+  for (int i = 1; i < BOUND_ROUNDS; i++)
+  {
+    float32_t v = rtt[i];
+    int j = i;
+    for (; j > 0 && rtt[j - 1] > v; j--)
+    {
+      rtt[j] = rtt[j - 1];
+    }
+    rtt[j] = v;
+  }
+  boundMedian = (rtt[BOUND_ROUNDS / 2 - 1] + rtt[BOUND_ROUNDS / 2]) / 2.0f;
+  boundHeld = rtt[BOUND_HELD_ROUND];
+  boundMax = rtt[BOUND_ROUNDS - 1];
+
+  boundChecks++;
+  if (boundWrong != 0 || boundHeld > (float32_t)boundMaxUs)
+  {
+    boundRejected++;
+    return false;
+  }
+  return true;
+}
+
 /**
  * @brief Function to send successful ACK message
  */
-void sendAckSuccess(void)
+void sendAckSuccess(uint8_t dst)
 {
   // Create packet for successful ack and send
   MESSAGE_PACKET message;
@@ -257,6 +676,7 @@ void sendAckSuccess(void)
   uint8_t buffer[1];
   message.buffer = buffer;
   message.magic = ACK_MAGIC;
+  message.dst = dst;
   buffer[0] = ACK_SUCCESS;
   message.message_len = 1;
 
@@ -266,7 +686,7 @@ void sendAckSuccess(void)
 /**
  * @brief Function to send unsuccessful ACK message
  */
-void sendAckFailure(void)
+void sendAckFailure(uint8_t dst)
 {
   // Create packet for unsuccessful ack and send
   MESSAGE_PACKET message;
@@ -274,6 +694,7 @@ void sendAckFailure(void)
   uint8_t buffer[1];
   message.buffer = buffer;
   message.magic = ACK_MAGIC;
+  message.dst = dst;
   buffer[0] = ACK_FAIL;
   message.message_len = 1;
 
@@ -0,0 +1,581 @@
+/**
+ * @file ed25519.c
+ * @brief Ed25519 signature verification for signed feature packages
+ *
+ * Field elements are eight 32-bit limbs, kept below 2^256 and only fully
+ * reduced mod p = 2^255 - 19 when encoded: a multiplication is 64 32x32->64
+ * multiply-accumulates (UMLAL on the M4) and a fold of the high half by 38.
+ *
+ * [S]B - [k]A is computed in one pass of 4-bit windows (Straus), sharing 252
+ * doublings between the two scalars. The multiples of B are a table in
+ * flash, generated by "tools/ed25519.py --c-table"; those of -A are built
+ * per call. Nothing here is secret, so nothing is constant time.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "ed25519.h"
+#include "sha512.h"
+
+/*** Structure definitions ***/
+typedef uint32_t fe[8];
+
+// Extended coordinates: x = X/Z, y = Y/Z, xy = T/Z
+typedef struct
+{
+  fe x, y, z, t;
+} ge;
+
+// A point ready to be added: (Y+X, Y-X, 2Z, 2dT)
+typedef struct
+{
+  fe ypx, ymx, z2, t2d;
+} ge_cached;
+
+// An affine point ready to be added (Z = 1): (y+x, y-x, 2dxy)
+typedef struct
+{
+  fe ypx, ymx, t2d;
+} ge_precomp;
+
+/*** Global variables ***/
+static const fe feD = {0x135978a3, 0x75eb4dca, 0x4141d8ab, 0x00700a4d,
+                       0x7779e898, 0x8cc74079, 0x2b6ffe73, 0x52036cee};
+static const fe feD2 = {0x26b2f159, 0xebd69b94, 0x8283b156, 0x00e0149a,
+                        0xeef3d130, 0x198e80f2, 0x56dffce7, 0x2406d9dc};
+static const fe feSqrtM1 = {0x4a0ea0b0, 0xc4ee1b27, 0xad2fe478, 0x2f431806,
+                            0x3dfbd7a7, 0x2b4d0099, 0x4fc1df0b, 0x2b832480};
+static const fe feP = {0xffffffed, 0xffffffff, 0xffffffff, 0xffffffff,
+                       0xffffffff, 0xffffffff, 0xffffffff, 0x7fffffff};
+
+// Group order L, little endian
+static const uint8_t orderL[32] = {
+  0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58, 0xd6, 0x9c, 0xf7, 0xa2, 0xde, 0xf9, 0xde, 0x14,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10,
+};
+
+// j * B for j = 0..15
+static const ge_precomp baseTable[16] = {
+  {{0x00000001, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000},
+   {0x00000001, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000},
+   {0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000}},
+  {{0xf58c3b85, 0x2fbc93c6, 0xfb8c0e19, 0xcf932dc6, 0x643d42c2, 0x270b4898, 0x33d4ba65, 0x07cf9d3a},
+   {0xd740913e, 0x9d103905, 0xd140beb3, 0xfd399f05, 0x688f8a09, 0xa5c18434, 0x98f81267, 0x44fd2f92},
+   {0x877aaa68, 0xabc91205, 0xccaac49e, 0x26d9e823, 0xdd43598c, 0x5a1b7dcb, 0x9f0c65a8, 0x6f117b68}},
+  {{0x933c71d7, 0x9224e7fc, 0x7a0ff5b5, 0x9f469d96, 0xe1d60702, 0x5aa69a65, 0xa87d2e2e, 0x590c063f},
+   {0x42b4d5a8, 0x8a99a560, 0x4e60acf6, 0x8f2b810c, 0xb16e37aa, 0xe09e236b, 0x69c92555, 0x6bb595a6},
+   {0xa59b7a5f, 0x43faa8b3, 0x5d9acf78, 0x36c16bdd, 0x0b3d6a31, 0x500fa084, 0x3ea50b73, 0x701af5b1}},
+  {{0x4cee9730, 0xaf25b0a8, 0xe8864b8a, 0x025a8430, 0x9f016732, 0xc11b5002, 0x9a80f8f4, 0x7a164e1b},
+   {0xa4fcd265, 0x56611fe8, 0xe5c1ba7d, 0x3bd353fd, 0x214bd6bd, 0x8131f31a, 0x555bda62, 0x2ab91587},
+   {0x0dd0d889, 0x14ae933f, 0x1c35da62, 0x58942322, 0x8cf2db4c, 0xd170e545, 0x12b9b4c6, 0x5a2826af}},
+  {{0x8efc099f, 0x287351b9, 0x7dfd2538, 0x6765c6f4, 0xfb0a9265, 0xca348d3d, 0x21e58727, 0x680e9103},
+   {0x056818bf, 0x95fe050a, 0x5660faa9, 0x327e8971, 0x06a05073, 0xc3e8e3cd, 0x7445a49a, 0x27933f4c},
+   {0xc476ff09, 0x5a13fbe9, 0x7b5cc172, 0x6e9e3945, 0x102b4494, 0x5ddbdcf9, 0x63553e2b, 0x7f9d0cbf}},
+  {{0x08a5bb33, 0xa212bc44, 0xc75eed02, 0x8d5048c3, 0x5abfec44, 0xdd1beb0c, 0x46e206eb, 0x2945ccf1},
+   {0xa447d6ba, 0x7f9182c3, 0x4b2729b7, 0xd50014d1, 0xb864a087, 0xe33cf11c, 0xeb1b55f3, 0x154a7e73},
+   {0x812a8285, 0xbcbbdbf1, 0xd0bdd1fc, 0x270e0807, 0x1bbda72d, 0xb41b670b, 0x6b3bb69a, 0x43aabe69}},
+  {{0x77157131, 0x3a0ceeeb, 0x00c8af88, 0x9b271589, 0xda59a736, 0x8065b668, 0xa2cc38bd, 0x51e57bb6},
+   {0x7b7d8ca4, 0x499806b6, 0x27d22739, 0x575be284, 0x204553b9, 0xbb085ce7, 0xae417884, 0x38b64c41},
+   {0x02ea4b71, 0x85ac3267, 0x41a1bb01, 0xbe70e003, 0x083bc144, 0x53e4a24b, 0x9f0d61e3, 0x10b8e91a}},
+  {{0x944ea3bf, 0x6b1a5cd0, 0xb39dc0d2, 0x7470353a, 0x28542e49, 0x71b25282, 0x283c927e, 0x461bea69},
+   {0xaa3221b1, 0xba6f2c9a, 0x3bba23a7, 0x6ca02153, 0x92192c3a, 0x9dea764f, 0x2e5317e0, 0x1d6edd5d},
+   {0x01b8b3a2, 0xf1836dc8, 0x053ea49a, 0xb3035f47, 0x5877adf3, 0x529c41ba, 0x6a0f90a7, 0x7a9fbb1c}},
+  {{0x04dd3e8f, 0x59b75966, 0xe288702c, 0x6cb30377, 0x5ed9c323, 0xb1339c66, 0x61bce52f, 0x0915e760},
+   {0xf39234d9, 0xe2a75ded, 0xe1b558f9, 0x963d7680, 0x6e3c23fb, 0x2c2741ac, 0x320e01c3, 0x3a9024a1},
+   {0xc9a2911a, 0xe7c1f5d9, 0x8bcca7d7, 0xb8a37178, 0x0eb62a32, 0x63641219, 0x2ecc4e95, 0x26907c5c}},
+  {{0xa6a8632f, 0x9b2e678a, 0x51bc46c5, 0xa6509e6f, 0xc686f5b5, 0xceb233c9, 0x8add7f59, 0x34b9ed33},
+   {0x039d8064, 0xf36e217e, 0xf520419b, 0x98a081b6, 0xe75eb044, 0x96cbc608, 0xfadc9c8f, 0x49c05a51},
+   {0x9045af1b, 0x06b4e8bf, 0xa719d22f, 0xe2ff83e8, 0x93d4cf16, 0xaaf6fc29, 0x1b008b06, 0x73c17202}},
+  {{0xb360748e, 0xff1d93d2, 0x1617e057, 0x45f534d4, 0x9b554646, 0x0d550363, 0xaae591ed, 0x43ac7628},
+   {0x227081dd, 0x75f3558e, 0x65a9f02f, 0x04f81836, 0xf5dc3958, 0x84739745, 0x4950b702, 0x0353832c},
+   {0x03d0f8d8, 0xd03d2ae4, 0xd3f06340, 0x1d0c1ccb, 0x6731b509, 0xff169f0f, 0x70bf4ce7, 0x0ec62af4}},
+  {{0x8a802ade, 0x2fbf0084, 0x02302e27, 0xe5d9fecf, 0x17703406, 0x113e8471, 0x546d8faf, 0x4275aae2},
+   {0x49864348, 0x315f5b02, 0x77088381, 0x3ed6b369, 0x6a8deb95, 0xa3a07555, 0x29d5c77f, 0x18ab5980},
+   {0xfd6089e9, 0xd82b2cc5, 0x3282e4a4, 0x031eb4a1, 0xb51a8622, 0x44311199, 0xb53df948, 0x3dc65522}},
+  {{0xa71e7539, 0xe2358042, 0xd834d1a9, 0x88de3dd7, 0x701a6f93, 0x45ecdd2e, 0x8d3cdd58, 0x078aafde},
+   {0xb53d54b9, 0x856f8375, 0xccb25b24, 0x23b2bf90, 0x56d5dbdd, 0x884dfb6e, 0x8a6022ed, 0x7956ece2},
+   {0x7f944553, 0xeea594d8, 0xa24e180b, 0xf66cda23, 0xf4976461, 0xffcb589a, 0x1c83d0c6, 0x37c6a515}},
+  {{0xa2007f6d, 0xbf70c222, 0xb5bcdedb, 0xbf84b39a, 0xfb07ba07, 0x537a0e12, 0xc346f241, 0x234fd7ee},
+   {0x327fbf93, 0x506f013b, 0x9b776f6b, 0xaefcebc9, 0xaaad5968, 0x9d12b232, 0x176024a7, 0x0267882d},
+   {0x732ea378, 0x5360a119, 0xdf8dd471, 0x2437e6b1, 0x91a7e533, 0xa2ef37f8, 0xaa097863, 0x497ba6fd}},
+  {{0x3f213df2, 0x26f870ec, 0x57efa987, 0x80277fc0, 0x2881bdd5, 0x1a474c04, 0x464d1630, 0x6eaf60b2},
+   {0xd4171280, 0xdfdb8a44, 0xdb7ca331, 0xce69b20f, 0x6eec47a9, 0x112e56f1, 0x5b3c80d2, 0x2df0ea2c},
+   {0x7a1e1b82, 0x96a1c587, 0xa2a9bf54, 0xf02397ed, 0x3ecb1baa, 0x9c1fdf70, 0xd8ba9c93, 0x24bf7e3c}},
+  {{0x13cfeaa0, 0x24cecc03, 0x189c246d, 0x8648c28d, 0xc1f2d4d0, 0x2dbdbdfa, 0xf12de72b, 0x61e22917},
+   {0x468ccf0b, 0x040bcd86, 0x2a9910d6, 0xd3829ba4, 0x07b25192, 0x75083008, 0x18d05ebf, 0x43b5cd42},
+   {0x9bd0b516, 0x5d9a762f, 0x373fdeee, 0xeb38af4e, 0x93d64270, 0x032e5a7d, 0x0ae4d842, 0x511d6121}}
+};
+
+/*** Field arithmetic mod 2^255 - 19 ***/
+
+/**
+ * @brief Add c * 2^256 to r, which is c * 38 mod p
+ */
+static void feFold(fe r, uint64_t c)
+{
+  while (c)
+  {
+    c *= 38;
+    for (int i = 0; i < 8; i++)
+    {
+      c += r[i];
+      r[i] = (uint32_t)c;
+      c >>= 32;
+    }
+  }
+}
+
+static void feAdd(fe r, const fe a, const fe b)
+{
+  uint64_t c = 0;
+  for (int i = 0; i < 8; i++)
+  {
+    c += (uint64_t)a[i] + b[i];
+    r[i] = (uint32_t)c;
+    c >>= 32;
+  }
+  feFold(r, c);
+}
+
+static void feSub(fe r, const fe a, const fe b)
+{
+  int64_t c = 0;
+  for (int i = 0; i < 8; i++)
+  {
+    c += (int64_t)a[i] - b[i];
+    r[i] = (uint32_t)c;
+    c >>= 32;
+  }
+  // Each borrow out took 2^256, so give back 38
+  while (c < 0)
+  {
+    c = -38;
+    for (int i = 0; i < 8; i++)
+    {
+      c += r[i];
+      r[i] = (uint32_t)c;
+      c >>= 32;
+    }
+  }
+}
+
+static void feMul(fe r, const fe a, const fe b)
+{
+  uint32_t t[16] = {0};
+  for (int i = 0; i < 8; i++)
+  {
+    uint64_t c = 0;
+    for (int j = 0; j < 8; j++)
+    {
+      c += (uint64_t)a[i] * b[j] + t[i + j];
+      t[i + j] = (uint32_t)c;
+      c >>= 32;
+    }
+    t[i + 8] = (uint32_t)c;
+  }
+
+  uint64_t c = 0;
+  for (int i = 0; i < 8; i++)
+  {
+    c += (uint64_t)t[i + 8] * 38 + t[i];
+    r[i] = (uint32_t)c;
+    c >>= 32;
+  }
+  feFold(r, c);
+}
+
+static void feSq(fe r, const fe a)
+{
+  feMul(r, a, a);
+}
+
+static void feCopy(fe r, const fe a)
+{
+  memcpy(r, a, sizeof(fe));
+}
+
+static void feSet(fe r, uint32_t v)
+{
+  memset(r, 0, sizeof(fe));
+  r[0] = v;
+}
+
+/**
+ * @brief Reduce a below p: it is below 2^256 < 3p, so two tries suffice
+ */
+static void feReduce(fe a)
+{
+  for (int k = 0; k < 2; k++)
+  {
+    fe t;
+    int64_t c = 0;
+    for (int i = 0; i < 8; i++)
+    {
+      c += (int64_t)a[i] - feP[i];
+      t[i] = (uint32_t)c;
+      c >>= 32;
+    }
+    if (c == 0)
+    {
+      feCopy(a, t);
+    }
+  }
+}
+
+static void fePack(uint8_t out[32], const fe a)
+{
+  fe t;
+  feCopy(t, a);
+  feReduce(t);
+  for (int i = 0; i < 8; i++)
+  {
+    out[4 * i] = (uint8_t)t[i];
+    out[4 * i + 1] = (uint8_t)(t[i] >> 8);
+    out[4 * i + 2] = (uint8_t)(t[i] >> 16);
+    out[4 * i + 3] = (uint8_t)(t[i] >> 24);
+  }
+}
+
+static bool feEqual(const fe a, const fe b)
+{
+  uint8_t pa[32], pb[32];
+  fePack(pa, a);
+  fePack(pb, b);
+  return memcmp(pa, pb, 32) == 0;
+}
+
+static bool feIsZero(const fe a)
+{
+  static const fe zero = {0};
+  return feEqual(a, zero);
+}
+
+static uint8_t feParity(const fe a)
+{
+  uint8_t p[32];
+  fePack(p, a);
+  return p[0] & 1;
+}
+
+/**
+ * @brief r = a^(p - 2) = 1/a
+ */
+static void feInvert(fe r, const fe a)
+{
+  fe c;
+  feCopy(c, a);
+  for (int i = 253; i >= 0; i--)
+  {
+    feSq(c, c);
+    if (i != 2 && i != 4)
+    {
+      feMul(c, c, a);
+    }
+  }
+  feCopy(r, c);
+}
+
+/**
+ * @brief r = a^((p - 5) / 8), for square roots
+ */
+static void fePow22523(fe r, const fe a)
+{
+  fe c;
+  feCopy(c, a);
+  for (int i = 250; i >= 0; i--)
+  {
+    feSq(c, c);
+    if (i != 1)
+    {
+      feMul(c, c, a);
+    }
+  }
+  feCopy(r, c);
+}
+
+/*** Group arithmetic ***/
+
+static void geIdentity(ge *r)
+{
+  feSet(r->x, 0);
+  feSet(r->y, 1);
+  feSet(r->z, 1);
+  feSet(r->t, 0);
+}
+
+static void geToCached(ge_cached *r, const ge *p)
+{
+  feAdd(r->ypx, p->y, p->x);
+  feSub(r->ymx, p->y, p->x);
+  feAdd(r->z2, p->z, p->z);
+  feMul(r->t2d, p->t, feD2);
+}
+
+/**
+ * @brief The last step of every addition and doubling formula
+ */
+static void geFinish(ge *r, const fe e, const fe f, const fe g, const fe h)
+{
+  feMul(r->x, e, f);
+  feMul(r->y, g, h);
+  feMul(r->z, f, g);
+  feMul(r->t, e, h);
+}
+
+static void geAddCached(ge *r, const ge *p, const ge_cached *q)
+{
+  fe a, b, c, d, e, f, g, h;
+  feSub(a, p->y, p->x);
+  feMul(a, a, q->ymx);
+  feAdd(b, p->y, p->x);
+  feMul(b, b, q->ypx);
+  feMul(c, p->t, q->t2d);
+  feMul(d, p->z, q->z2);
+  feSub(e, b, a);
+  feSub(f, d, c);
+  feAdd(g, d, c);
+  feAdd(h, b, a);
+  geFinish(r, e, f, g, h);
+}
+
+static void geAddPrecomp(ge *r, const ge *p, const ge_precomp *q)
+{
+  fe a, b, c, d, e, f, g, h;
+  feSub(a, p->y, p->x);
+  feMul(a, a, q->ymx);
+  feAdd(b, p->y, p->x);
+  feMul(b, b, q->ypx);
+  feMul(c, p->t, q->t2d);
+  feAdd(d, p->z, p->z);
+  feSub(e, b, a);
+  feSub(f, d, c);
+  feAdd(g, d, c);
+  feAdd(h, b, a);
+  geFinish(r, e, f, g, h);
+}
+
+static void geDouble(ge *r, const ge *p)
+{
+  fe a, b, c, e, f, g, h;
+  feSq(a, p->x);
+  feSq(b, p->y);
+  feSq(c, p->z);
+  feAdd(c, c, c);
+  feAdd(h, a, b);
+  feAdd(e, p->x, p->y);
+  feSq(e, e);
+  feSub(e, h, e);
+  feSub(g, a, b);
+  feAdd(f, c, g);
+  geFinish(r, e, f, g, h);
+}
+
+/**
+ * @brief Decode a point and negate it
+ * @return false if s is not the encoding of a point
+ */
+static bool geDecodeNeg(ge *r, const uint8_t s[32])
+{
+  fe u, v, v3, x2, chk;
+
+  for (int i = 0; i < 8; i++)
+  {
+    r->y[i] = (uint32_t)s[4 * i] | (uint32_t)s[4 * i + 1] << 8 |
+              (uint32_t)s[4 * i + 2] << 16 | (uint32_t)s[4 * i + 3] << 24;
+  }
+  r->y[7] &= 0x7fffffff;
+  uint8_t sign = s[31] >> 7;
+
+  // Reject non-canonical y
+  fe y;
+  feCopy(y, r->y);
+  feReduce(y);
+  if (memcmp(y, r->y, sizeof(fe)) != 0)
+  {
+    return false;
+  }
+  feSet(r->z, 1);
+
+  // x = u v^3 (u v^7)^((p - 5) / 8) with u = y^2 - 1, v = d y^2 + 1
+  feSq(u, r->y);
+  feMul(v, u, feD);
+  feSub(u, u, r->z);
+  feAdd(v, v, r->z);
+  feSq(v3, v);
+  feMul(v3, v3, v);
+  feSq(x2, v3);
+  feMul(x2, x2, v);
+  feMul(x2, x2, u);
+  fePow22523(x2, x2);
+  feMul(x2, x2, v3);
+  feMul(r->x, x2, u);
+
+  feSq(chk, r->x);
+  feMul(chk, chk, v);
+  if (!feEqual(chk, u))
+  {
+    feMul(r->x, r->x, feSqrtM1);
+    feSq(chk, r->x);
+    feMul(chk, chk, v);
+    if (!feEqual(chk, u))
+    {
+      return false;
+    }
+  }
+
+  if (feIsZero(r->x) && sign)
+  {
+    return false;
+  }
+  // Negated: keep x whose parity differs from the sign bit
+  if (feParity(r->x) == sign)
+  {
+    static const fe zero = {0};
+    feSub(r->x, zero, r->x);
+  }
+  feMul(r->t, r->x, r->y);
+  return true;
+}
+
+static void geEncode(uint8_t out[32], const ge *p)
+{
+  fe zi, x, y;
+  feInvert(zi, p->z);
+  feMul(x, p->x, zi);
+  feMul(y, p->y, zi);
+  fePack(out, y);
+  out[31] ^= feParity(x) << 7;
+}
+
+/*** Scalars mod L ***/
+
+/**
+ * @brief Reduce a 512-bit little-endian number mod L (TweetNaCl's modL)
+ */
+static void scReduce(uint8_t r[32], const uint8_t h[64])
+{
+  int64_t x[64];
+  int64_t carry;
+  int i, j;
+
+  for (i = 0; i < 64; i++)
+  {
+    x[i] = h[i];
+  }
+  for (i = 63; i >= 32; i--)
+  {
+    carry = 0;
+    for (j = i - 32; j < i - 12; j++)
+    {
+      x[j] += carry - 16 * x[i] * orderL[j - (i - 32)];
+      carry = (x[j] + 128) >> 8;
+      x[j] -= carry * 256;
+    }
+    x[j] += carry;
+    x[i] = 0;
+  }
+  carry = 0;
+  for (j = 0; j < 32; j++)
+  {
+    x[j] += carry - (x[31] >> 4) * orderL[j];
+    carry = x[j] >> 8;
+    x[j] &= 255;
+  }
+  for (j = 0; j < 32; j++)
+  {
+    x[j] -= carry * orderL[j];
+  }
+  for (i = 0; i < 32; i++)
+  {
+    x[i + 1] += x[i] >> 8;
+    r[i] = (uint8_t)(x[i] & 255);
+  }
+}
+
+static bool scIsCanonical(const uint8_t s[32])
+{
+  for (int i = 31; i >= 0; i--)
+  {
+    if (s[i] != orderL[i])
+    {
+      return s[i] < orderL[i];
+    }
+  }
+  return false;
+}
+
+static uint8_t nibble(const uint8_t s[32], int i)
+{
+  return (s[i / 2] >> (4 * (i & 1))) & 15;
+}
+
+/*** Verification ***/
+
+bool ed25519_verify(const uint8_t *sig, const uint8_t *msg, size_t len,
+                    const uint8_t *pub)
+{
+  const uint8_t *s = sig + 32;
+  if (!scIsCanonical(s))
+  {
+    return false;
+  }
+
+  ge negA;
+  if (!geDecodeNeg(&negA, pub))
+  {
+    return false;
+  }
+
+  // k = SHA-512(R || A || M) mod L
+  uint8_t h[64], k[32];
+  sha512_ctx ctx;
+  sha512_init(&ctx);
+  sha512_update(&ctx, sig, 32);
+  sha512_update(&ctx, pub, 32);
+  sha512_update(&ctx, msg, len);
+  sha512_final(&ctx, h);
+  scReduce(k, h);
+
+  // j * -A for j = 0..15
+  ge_cached tableA[16];
+  ge acc;
+  geIdentity(&acc);
+  geToCached(&tableA[0], &acc);
+  geToCached(&tableA[1], &negA);
+  acc = negA;
+  for (int j = 2; j < 16; j++)
+  {
+    geAddCached(&acc, &acc, &tableA[1]);
+    geToCached(&tableA[j], &acc);
+  }
+
+  // [S]B + [k](-A), four bits of each scalar per step
+  ge r;
+  geIdentity(&r);
+  for (int i = 63; i >= 0; i--)
+  {
+    if (i != 63)
+    {
+      geDouble(&r, &r);
+      geDouble(&r, &r);
+      geDouble(&r, &r);
+      geDouble(&r, &r);
+    }
+    uint8_t ki = nibble(k, i);
+    uint8_t si = nibble(s, i);
+    if (ki)
+    {
+      geAddCached(&r, &r, &tableA[ki]);
+    }
+    if (si)
+    {
+      geAddPrecomp(&r, &r, &baseTable[si]);
+    }
+  }
+
+  uint8_t check[32];
+  geEncode(check, &r);
+  return memcmp(check, sig, 32) == 0;
+}
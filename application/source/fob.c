@@ -14,6 +14,8 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
@@ -22,45 +24,88 @@
 #include "dataFormats.h"
 #include "uart.h"
 #include "platform.h"
+#include "hexCodec.h"
+#include "ed25519.h"
+#include "arm_stream_stats.h"
 
 /*** Macros ***/
-#define MAX_CMD_LEN 256
+#define MAX_CMD_LEN 512
+
+// Host commands wait until their reply would fit in the transmit queue
+#define HOST_REPLY_ROOM 512
+
+// Batch pairing: fobs acknowledged per command, broadcasts per command, and
+// how long to wait after the last acknowledgement before broadcasting again
+#define PAIR_BATCH_MAX 32
+#define PAIR_BATCH_TRIES 3
+#define PAIR_ACK_WINDOW_US 300000
+
+// Longest a feature package's signature check may take; enable also writes
+// flash, and the host tools give the whole command a second
+#define VERIFY_BUDGET_US 100000
+
+// Longest to wait for each distance-bounding challenge from the car
+#define BOUND_TIMEOUT_US 100000
+
+// Longest to wait for the car's next frame after an unlock request; on a
+// shared link the car may be bounding other fobs' distance first
+#define ACK_TIMEOUT_US 2000000
 
 /*** Structure definitions ***/
-// Defines a struct for the format of an enable message
+// Defines a struct for the format of an enable message: the signature, by
+// the key in secrets/feature_key.json, covers everything before it
 typedef struct {
   uint8_t car_id[8];
   uint8_t feature;
+  uint8_t sig[ED25519_SIG_SIZE];
 } ENABLE_PACKET;
 
+/*** Global variables ***/
+static const uint8_t featurePubKey[ED25519_KEY_SIZE] = FEATURE_PUBKEY;
+
 /*** Function definitions ***/
 // Core functions - all functionality supported by fob
 void pairFob(FLASH_DATA *fob_state_ram, const char *pin);
+void pairBatch(FLASH_DATA *fob_state_ram, const char *args);
 void unlockCar(FLASH_DATA *fob_state_ram);
 void enableFeature(FLASH_DATA *fob_state_ram, const uint8_t *data, size_t len);
 void startCar(FLASH_DATA *fob_state_ram);
 void attemptUnlock(FLASH_DATA *fob_state_ram);
 
 // Helper functions
-uint8_t receiveAck(void);
+uint8_t receiveAck(const FLASH_DATA *fob_state_ram);
+void answerBound(const FLASH_DATA *fob_state_ram, const BOUND_PACKET *bound);
+bool checkPairPin(const FLASH_DATA *fob_state_ram, const char *pin);
+bool broadcastPairing(FLASH_DATA *fob_state_ram);
+void sendPairAck(uint8_t dst);
+void receivePairing(FLASH_DATA *fob_state_ram);
 void processHostCommand(FLASH_DATA *fob_state_ram, const char *cmd);
 void sendOK(const char *value);
 void sendError(const char *reason);
-void bytesToHex(const uint8_t *bytes, size_t len, char *hex);
-int hexToBytes(const char *hex, uint8_t *bytes, size_t maxLen);
+uint32_t saveSnapshot(const FLASH_DATA *fob_state_ram, uint8_t *blob, uint32_t max);
+bool loadSnapshot(FLASH_DATA *fob_state_ram, const uint8_t *blob, uint32_t len);
+
+// Round trip from sending UNLOCK to the car's ACK, in microseconds
+static arm_stream_stats_instance_f32 unlockLatency;
+
+// Time to check a feature package's signature, in microseconds
+static arm_stream_stats_instance_f32 verifyLatency;
 
 /**
  * @brief Main function for the fob example
  *
- * Listens for host commands and button presses. If unpaired, also listens
- * for pairing messages on the board UART.
+ * Listens for host commands, button presses and pairing messages on the
+ * board UART.
  */
 int main(int argc, char **argv)
 {
   initHardware_fob(argc, argv);
+  board_link_init(boardLinkAddress(), boardLinkShared());
 
   FLASH_DATA fob_state_ram;
   loadFobState(&fob_state_ram);
+  arm_stream_stats_init_f32(&unlockLatency, 1.0f);
+  arm_stream_stats_init_f32(&verifyLatency, 1.0f);
 
 // If paired fob, initialize the system information on first boot
 #if PAIRED == 1
@@ -69,6 +114,7 @@ int main(int argc, char **argv)
     strcpy((char *)(fob_state_ram.pair_info.password), PASSWORD);
     strcpy((char *)(fob_state_ram.pair_info.pin), PAIR_PIN);
     strcpy((char *)(fob_state_ram.pair_info.car_id), CAR_ID);
+    memcpy(fob_state_ram.pair_info.bound_key, (const uint8_t[])BOUND_KEY, BOUND_KEY_SIZE);
     strcpy((char *)(fob_state_ram.feature_info.car_id), CAR_ID);
     fob_state_ram.paired = FLASH_PAIRED;
 
@@ -90,15 +136,11 @@ int main(int argc, char **argv)
   char cmdBuffer[MAX_CMD_LEN];
   uint16_t cmdIndex = 0;
 
-  // Buffer for board UART (pairing messages when unpaired)
-  uint8_t boardBuffer[64];
-  uint16_t boardIndex = 0;
-
   // Infinite loop for polling UART and button
   while (true)
   {
     // Non-blocking UART polling for host commands (always active)
-    if (uart_avail(HOST_UART))
+    if (uart_avail(HOST_UART) && uart_tx_free(HOST_UART) >= HOST_REPLY_ROOM)
     {
       uint8_t c = (uint8_t)uart_readb(HOST_UART);
 
@@ -117,47 +159,20 @@ int main(int argc, char **argv)
       }
     }
 
-    if (fob_state_ram.paired == FLASH_PAIRED)
+    // Paired fob: check for button press
+    if (fob_state_ram.paired == FLASH_PAIRED && buttonPressed())
     {
-      // Paired fob: check for button press
-      if (buttonPressed())
-      {
-        attemptUnlock(&fob_state_ram);
-      }
+      attemptUnlock(&fob_state_ram);
     }
-    else
-    {
-      // Unpaired fob: listen for pairing message on board UART
-      if (uart_avail(BOARD_UART))
-      {
-        uint8_t c = (uint8_t)uart_readb(BOARD_UART);
 
-        if (c == '\n' || c == '\r')
-        {
-          // Check if this is a valid pairing packet
-          // Format: [PAIR_MAGIC] [len] [PAIR_PACKET data...]
-          // len should equal boardIndex (the bytes we received, excluding magic and len itself)
-          if (boardIndex >= 2 &&
-              boardBuffer[0] == PAIR_MAGIC &&
-              boardBuffer[1] == (boardIndex - 2) &&
-              (boardIndex - 2) == sizeof(PAIR_PACKET))
-          {
-            // Valid pairing packet - extract and apply
-            memcpy(&fob_state_ram.pair_info, &boardBuffer[2], sizeof(PAIR_PACKET));
-            fob_state_ram.paired = FLASH_PAIRED;
-            strcpy((char *)fob_state_ram.feature_info.car_id,
-                   (char *)fob_state_ram.pair_info.car_id);
-            saveFobState(&fob_state_ram);
-
-            uart_write(HOST_UART, (uint8_t *)"OK: paired\n", 11);
-          }
-          boardIndex = 0;
-        }
-        else if (boardIndex < sizeof(boardBuffer) - 1)
-        {
-          boardBuffer[boardIndex++] = c;
-        }
-      }
+    // Listen for pairing messages on the board UART (a paired fob answers
+    // repeats of its own pairing, for a batch pairer that missed its ACK).
+    // Bytes that start no frame, such as other fobs' bounding rounds, are
+    // dropped here without waiting, and frames for other boards are not
+    // taken
+    if (board_message_avail())
+    {
+      receivePairing(&fob_state_ram);
     }
   }
 }
@@ -170,7 +185,7 @@ void processHostCommand(FLASH_DATA *fob_state_ram, const char *cmd)
   // Standard command: enable <hex_data>
   if (strncmp(cmd, "enable ", 7) == 0)
   {
-    uint8_t data[32];
+    uint8_t data[sizeof(ENABLE_PACKET) + 8];
     int len = hexToBytes(cmd + 7, data, sizeof(data));
     if (len < 0)
     {
@@ -181,6 +196,13 @@ void processHostCommand(FLASH_DATA *fob_state_ram, const char *cmd)
     return;
   }
 
+  // Standard command: pairBatch <pin> <count>
+  if (strncmp(cmd, "pairBatch ", 10) == 0)
+  {
+    pairBatch(fob_state_ram, cmd + 10);
+    return;
+  }
+
   // Standard command: pair <pin>
   if (strncmp(cmd, "pair ", 5) == 0)
   {
@@ -228,6 +250,36 @@ void processHostCommand(FLASH_DATA *fob_state_ram, const char *cmd)
     return;
   }
 
+  // Test command: getSnapshot
+  if (strcmp(cmd, "getSnapshot") == 0)
+  {
+    uint8_t blob[SNAPSHOT_MAX_SIZE];
+    char hex[SNAPSHOT_MAX_SIZE * 2 + 1];
+    uint32_t len = saveSnapshot(fob_state_ram, blob, sizeof(blob));
+    if (len == 0)
+    {
+      sendError("snapshot too large");
+      return;
+    }
+    bytesToHex(blob, len, hex);
+    sendOK(hex);
+    return;
+  }
+
+  // Test command: setSnapshot <hex>
+  if (strncmp(cmd, "setSnapshot ", 12) == 0)
+  {
+    uint8_t blob[SNAPSHOT_MAX_SIZE];
+    int len = hexToBytes(cmd + 12, blob, sizeof(blob));
+    if (len < 0 || !loadSnapshot(fob_state_ram, blob, len))
+    {
+      sendError("invalid snapshot");
+      return;
+    }
+    sendOK(NULL);
+    return;
+  }
+
   // Test command: restart (software reset)
   if (strcmp(cmd, "restart") == 0)
   {
@@ -236,6 +288,60 @@ void processHostCommand(FLASH_DATA *fob_state_ram, const char *cmd)
     return;
   }
 
+  // Test command: unlockStats (unlock latency since boot, in microseconds)
+  if (strcmp(cmd, "unlockStats") == 0)
+  {
+    char buf[96];
+    float32_t std = 0.0f;
+    arm_stream_stats_std_f32(&unlockLatency, &std);
+    if (unlockLatency.count == 0)
+    {
+      snprintf(buf, sizeof(buf), "n=0");
+    }
+    else
+    {
+      snprintf(buf, sizeof(buf), "n=%lu,mean=%lu,std=%lu,min=%lu,max=%lu",
+               (unsigned long)unlockLatency.count, (unsigned long)unlockLatency.mean,
+               (unsigned long)std, (unsigned long)unlockLatency.min,
+               (unsigned long)unlockLatency.max);
+    }
+    sendOK(buf);
+    return;
+  }
+
+  // Test command: unlockStatsReset (start the unlock latency statistics over)
+  if (strcmp(cmd, "unlockStatsReset") == 0)
+  {
+    arm_stream_stats_init_f32(&unlockLatency, 1.0f);
+    sendOK(NULL);
+    return;
+  }
+
+  // Test command: verifyStats (package signature checks since boot, in
+  // microseconds, with the slowest in core cycles and the budget)
+  if (strcmp(cmd, "verifyStats") == 0)
+  {
+    char buf[128];
+    float32_t std = 0.0f;
+    arm_stream_stats_std_f32(&verifyLatency, &std);
+    if (verifyLatency.count == 0)
+    {
+      snprintf(buf, sizeof(buf), "n=0,budget=%lu", (unsigned long)VERIFY_BUDGET_US);
+    }
+    else
+    {
+      // clockHz() is 0 on x86, which has no fixed core clock
+      uint64_t cycles = (uint64_t)verifyLatency.max * (clockHz() / 1000000);
+      snprintf(buf, sizeof(buf), "n=%lu,mean=%lu,std=%lu,min=%lu,max=%lu,cycles=%lu,budget=%lu",
+               (unsigned long)verifyLatency.count, (unsigned long)verifyLatency.mean,
+               (unsigned long)std, (unsigned long)verifyLatency.min,
+               (unsigned long)verifyLatency.max, (unsigned long)cycles,
+               (unsigned long)VERIFY_BUDGET_US);
+    }
+    sendOK(buf);
+    return;
+  }
+
   // Test command: reset (factory reset)
   if (strcmp(cmd, "reset") == 0)
   {
@@ -248,12 +354,69 @@ void processHostCommand(FLASH_DATA *fob_state_ram, const char *cmd)
     // A restart would be needed to re-enter the pairing wait state.
     return;
   }
+
+  // Platform-specific test commands (e.g. clock profiles, x86 link impairment)
+  if (processPlatformCommand(cmd))
+  {
+    return;
+  }
 #endif
 
   // Unknown command
   sendError("unknown command");
 }
 
+#ifdef TEST_BUILD
+/**
+ * @brief Serialize the fob's runtime state
+ *
+ * Layout: [version] [role] [FLASH_DATA] [platform state]
+ *
+ * @return the number of bytes written to blob, or 0 if the platform state
+ * does not fit
+ */
+uint32_t saveSnapshot(const FLASH_DATA *fob_state_ram, uint8_t *blob, uint32_t max)
+{
+  uint32_t len = 0;
+
+  blob[len++] = SNAPSHOT_VERSION;
+  blob[len++] = SNAPSHOT_ROLE_FOB;
+  memcpy(&blob[len], fob_state_ram, sizeof(FLASH_DATA));
+  len += sizeof(FLASH_DATA);
+
+  uint32_t platform = snapshotPlatform(&blob[len], max - len);
+  return (platform == SNAPSHOT_NO_ROOM) ? 0 : len + platform;
+}
+
+/**
+ * @brief Replace the fob's runtime state with a snapshot from saveSnapshot
+ *
+ * The fob state is also written back to flash, so that RAM and flash agree
+ * just as they do after any other state change.
+ *
+ * @return true if the snapshot was valid and has been applied
+ */
+bool loadSnapshot(FLASH_DATA *fob_state_ram, const uint8_t *blob, uint32_t len)
+{
+  const uint32_t fixed = 2 + sizeof(FLASH_DATA);
+
+  if (len < fixed || blob[0] != SNAPSHOT_VERSION || blob[1] != SNAPSHOT_ROLE_FOB)
+  {
+    return false;
+  }
+
+  if (!restorePlatform(&blob[fixed], len - fixed))
+  {
+    return false;
+  }
+
+  memcpy(fob_state_ram, &blob[2], sizeof(FLASH_DATA));
+  saveFobState(fob_state_ram);
+
+  return true;
+}
+#endif
+
 /**
  * @brief Send OK response to host
  */
@@ -276,108 +439,223 @@ void sendOK(const char *value)
  */
 void sendError(const char *reason)
 {
-  char buf[128];
+  char buf[512];
   snprintf(buf, sizeof(buf), "ERROR: %s\n", reason);
   uart_write(HOST_UART, (uint8_t *)buf, strlen(buf));
 }
 
 /**
- * @brief Convert bytes to hex string
+ * @brief Check that this fob may pair others with the given PIN, reporting
+ * the reason to the host if not
  */
-void bytesToHex(const uint8_t *bytes, size_t len, char *hex)
+bool checkPairPin(const FLASH_DATA *fob_state_ram, const char *pin)
 {
-  const char hexChars[] = "0123456789abcdef";
-  for (size_t i = 0; i < len; i++)
+  // Only paired fobs can initiate pairing
+  if (fob_state_ram->paired != FLASH_PAIRED)
   {
-    hex[i * 2] = hexChars[(bytes[i] >> 4) & 0x0F];
-    hex[i * 2 + 1] = hexChars[bytes[i] & 0x0F];
+    sendError("not paired");
+    return false;
   }
-  hex[len * 2] = '\0';
-}
 
-/**
- * @brief Convert hex string to bytes
- * @return Number of bytes written, or -1 on error
- */
-int hexToBytes(const char *hex, uint8_t *bytes, size_t maxLen)
-{
-  size_t hexLen = strlen(hex);
-  if (hexLen % 2 != 0)
-    return -1;
-
-  size_t byteLen = hexLen / 2;
-  if (byteLen > maxLen)
-    return -1;
-
-  for (size_t i = 0; i < byteLen; i++)
+  // Verify PIN length (expect 6 digits)
+  if (strlen(pin) != 6)
   {
-    uint8_t hi, lo;
-
-    if (hex[i * 2] >= '0' && hex[i * 2] <= '9')
-      hi = hex[i * 2] - '0';
-    else if (hex[i * 2] >= 'a' && hex[i * 2] <= 'f')
-      hi = hex[i * 2] - 'a' + 10;
-    else if (hex[i * 2] >= 'A' && hex[i * 2] <= 'F')
-      hi = hex[i * 2] - 'A' + 10;
-    else
-      return -1;
-
-    if (hex[i * 2 + 1] >= '0' && hex[i * 2 + 1] <= '9')
-      lo = hex[i * 2 + 1] - '0';
-    else if (hex[i * 2 + 1] >= 'a' && hex[i * 2 + 1] <= 'f')
-      lo = hex[i * 2 + 1] - 'a' + 10;
-    else if (hex[i * 2 + 1] >= 'A' && hex[i * 2 + 1] <= 'F')
-      lo = hex[i * 2 + 1] - 'A' + 10;
-    else
-      return -1;
+    sendError("invalid pin length");
+    return false;
+  }
 
-    bytes[i] = (hi << 4) | lo;
+  // Verify PIN matches
+  if (strncmp(pin, (char *)fob_state_ram->pair_info.pin, 6) != 0)
+  {
+    sendError("wrong pin");
+    return false;
   }
 
-  return (int)byteLen;
+  return true;
+}
+
+/**
+ * @brief Broadcast this fob's PAIR_PACKET, since new fobs' addresses are
+ * not known
+ *
+ * @return true if the message went out
+ */
+bool broadcastPairing(FLASH_DATA *fob_state_ram)
+{
+  // Pair the new key by sending a PAIR_PACKET structure
+  // with required information to unlock door
+  MESSAGE_PACKET message;
+  message.message_len = sizeof(PAIR_PACKET);
+  message.magic = PAIR_MAGIC;
+  message.dst = BROADCAST_ADDR;
+  message.buffer = (uint8_t *)&fob_state_ram->pair_info;
+  return send_board_message(&message) != 0;
 }
 
 /**
  * @brief Function that carries out pairing of the fob (paired fob side only)
  *
  * This is called on a paired fob to initiate pairing with an unpaired fob.
- * Sends: [PAIR_MAGIC] [len] [PAIR_PACKET data] [\n]
  *
  * @param fob_state_ram pointer to the current fob state in ram
  * @param pin the PIN string from the command
  */
 void pairFob(FLASH_DATA *fob_state_ram, const char *pin)
 {
-  // Only paired fobs can initiate pairing
-  if (fob_state_ram->paired != FLASH_PAIRED)
+  if (!checkPairPin(fob_state_ram, pin))
   {
-    sendError("not paired");
     return;
   }
 
-  // Verify PIN length (expect 6 digits)
-  if (strlen(pin) != 6)
+  if (!broadcastPairing(fob_state_ram))
   {
-    sendError("invalid pin length");
+    sendError("link busy");
     return;
   }
 
-  // Verify PIN matches
-  if (strncmp(pin, (char *)fob_state_ram->pair_info.pin, 6) != 0)
+  sendOK(NULL);
+}
+
+/**
+ * @brief Pair many unpaired fobs at once (paired fob side only)
+ *
+ * Broadcasts the PAIR_PACKET and collects a PAIR_ACK from each fob that
+ * takes it on, until count distinct fobs have answered. If fewer answer
+ * within PAIR_ACK_WINDOW_US of the last one, the broadcast is repeated, up
+ * to PAIR_BATCH_TRIES times; fobs that are already paired with it answer
+ * the repeat again, so a lost ACK is recovered too.
+ *
+ * Reports "OK: n=<fobs>,tries=<broadcasts>,us=<elapsed>,addrs=<hex>:<hex>..."
+ *
+ * @param fob_state_ram pointer to the current fob state in ram
+ * @param args "<pin> <count>" from the command
+ */
+void pairBatch(FLASH_DATA *fob_state_ram, const char *args)
+{
+  char pin[8] = { 0 };
+  const char *space = strchr(args, ' ');
+  int count = space ? atoi(space + 1) : 0;
+
+  if (space == NULL || space - args >= (int)sizeof(pin) || count < 1 || count > PAIR_BATCH_MAX)
+  {
+    sendError("usage: pairBatch <pin> <count>");
+    return;
+  }
+  memcpy(pin, args, space - args);
+  if (!checkPairPin(fob_state_ram, pin))
   {
-    sendError("wrong pin");
     return;
   }
 
-  // Pair the new key by sending a PAIR_PACKET structure
-  // with required information to unlock door
+  uint8_t acked[PAIR_BATCH_MAX];
+  int n = 0;
+  int tries = 0;
+  uint32_t start = timeUs();
+
+  MESSAGE_PACKET reply;
+  uint8_t buffer[255];
+  reply.buffer = buffer;
+
+  while (n < count && tries < PAIR_BATCH_TRIES)
+  {
+    tries++;
+    if (!broadcastPairing(fob_state_ram))
+    {
+      continue;
+    }
+
+    uint32_t last = timeUs();
+    while (n < count && timeUs() - last < PAIR_ACK_WINDOW_US)
+    {
+      if (!board_message_avail() || receive_board_message(&reply) != 1 ||
+          reply.magic != PAIR_ACK_MAGIC || reply.buffer[0] != ACK_SUCCESS)
+      {
+        continue;
+      }
+
+      int i = 0;
+      while (i < n && acked[i] != reply.src)
+      {
+        i++;
+      }
+      if (i == n)
+      {
+        acked[n++] = reply.src;
+        last = timeUs();
+      }
+    }
+  }
+
+  char buf[64 + 3 * PAIR_BATCH_MAX];
+  int len = snprintf(buf, sizeof(buf), "n=%d,tries=%d,us=%lu,addrs=", n, tries,
+                     (unsigned long)(timeUs() - start));
+  for (int i = 0; i < n; i++)
+  {
+    len += snprintf(&buf[len], sizeof(buf) - len, i ? ":%02x" : "%02x", acked[i]);
+  }
+
+  if (n < count)
+  {
+    char reason[sizeof(buf) + 48];   // two ints and the text around them
+    snprintf(reason, sizeof(reason), "%d of %d acknowledged (%s)", n, count, buf);
+    sendError(reason);
+    return;
+  }
+  sendOK(buf);
+}
+
+/**
+ * @brief Acknowledge a PAIR_PACKET to the fob that sent it
+ */
+void sendPairAck(uint8_t dst)
+{
+  uint8_t ack = ACK_SUCCESS;
   MESSAGE_PACKET message;
-  message.message_len = sizeof(PAIR_PACKET);
-  message.magic = PAIR_MAGIC;
-  message.buffer = (uint8_t *)&fob_state_ram->pair_info;
+  message.message_len = 1;
+  message.magic = PAIR_ACK_MAGIC;
+  message.dst = dst;
+  message.buffer = &ack;
   send_board_message(&message);
+}
 
-  sendOK(NULL);
+/**
+ * @brief Function that carries out pairing of the fob (unpaired fob side)
+ *
+ * Receives one message from the board link and, if it is a PAIR_PACKET,
+ * takes on the pairing information it carries and acknowledges it. A
+ * paired fob only acknowledges a repeat of its own pairing.
+ *
+ * @param fob_state_ram pointer to the current fob state in ram
+ */
+void receivePairing(FLASH_DATA *fob_state_ram)
+{
+  MESSAGE_PACKET message;
+  uint8_t buffer[255];
+  message.buffer = buffer;
+
+  if (receive_board_message(&message) != sizeof(PAIR_PACKET) ||
+      message.magic != PAIR_MAGIC)
+  {
+    return;
+  }
+
+  if (fob_state_ram->paired == FLASH_PAIRED)
+  {
+    if (memcmp(&fob_state_ram->pair_info, buffer, sizeof(PAIR_PACKET)) == 0)
+    {
+      sendPairAck(message.src);
+    }
+    return;
+  }
+
+  memcpy(&fob_state_ram->pair_info, buffer, sizeof(PAIR_PACKET));
+  fob_state_ram->paired = FLASH_PAIRED;
+  strcpy((char *)fob_state_ram->feature_info.car_id,
+         (char *)fob_state_ram->pair_info.car_id);
+  saveFobState(fob_state_ram);
+
+  sendPairAck(message.src);
+  uart_write(HOST_UART, (uint8_t *)"OK: paired\n", 11);
 }
 
 /**
@@ -410,6 +688,17 @@ void enableFeature(FLASH_DATA *fob_state_ram, const uint8_t *data, size_t len)
     return;
   }
 
+  // Verify the package was signed for this car and feature
+  uint32_t start = timeUs();
+  bool valid = ed25519_verify(enable_message->sig, data, offsetof(ENABLE_PACKET, sig),
+                              featurePubKey);
+  arm_stream_stats_sample_f32(&verifyLatency, (float32_t)(timeUs() - start));
+  if (!valid)
+  {
+    sendError("bad signature");
+    return;
+  }
+
   // Feature list full
   if (fob_state_ram->feature_info.num_active >= NUM_FEATURES)
   {
@@ -463,24 +752,35 @@ void attemptUnlock(FLASH_DATA *fob_state_ram)
   MESSAGE_PACKET message;
   message.message_len = sizeof(fob_state_ram->pair_info.password);
   message.magic = UNLOCK_MAGIC;
+  message.dst = CAR_ADDR;
   message.buffer = fob_state_ram->pair_info.password;
-  send_board_message(&message);
+  uint32_t start = timeUs();
+  if (send_board_message(&message) == 0)
+  {
+    sendError("link busy");
+    return;
+  }
 
   // Wait for ACK from car (with timeout)
-  // TODO: Add timeout to prevent hanging if car doesn't respond
-  uint8_t ack_result = receiveAck();
+  uint8_t ack_result = receiveAck(fob_state_ram);
 
   if (ack_result != ACK_SUCCESS)
   {
     sendError("unlock failed");
     return;
   }
+  arm_stream_stats_sample_f32(&unlockLatency, (float32_t)(timeUs() - start));
 
   // ACK received - send start message with feature data
   message.magic = START_MAGIC;
+  message.dst = CAR_ADDR;
   message.message_len = sizeof(FEATURE_DATA);
   message.buffer = (uint8_t *)&fob_state_ram->feature_info;
-  send_board_message(&message);
+  if (send_board_message(&message) == 0)
+  {
+    sendError("link busy");
+    return;
+  }
 
   // Unlock successful
   sendOK(NULL);
@@ -490,14 +790,67 @@ void attemptUnlock(FLASH_DATA *fob_state_ram)
  * @brief Function that receives an ack and returns whether ack was
  * success/failure
  *
+ * Answers the car's distance-bounding rounds if it asks for them first.
+ * Fails if the car sends nothing for ACK_TIMEOUT_US, as when the request
+ * or the answer was lost on the link.
+ *
+ * @param fob_state_ram pointer to the current fob state in ram
  * @return uint8_t Ack success/failure
  */
-uint8_t receiveAck(void)
+uint8_t receiveAck(const FLASH_DATA *fob_state_ram)
 {
   MESSAGE_PACKET message;
   uint8_t buffer[255];
   message.buffer = buffer;
-  receive_board_message_by_type(&message, ACK_MAGIC);
 
-  return message.buffer[0];
+  // On a shared link, skip ACKs the car sends to other fobs (those are
+  // filtered by address) and anything not from the car
+  uint32_t last = timeUs();
+  while (timeUs() - last < ACK_TIMEOUT_US)
+  {
+    if (!board_message_avail())
+    {
+      continue;
+    }
+    receive_board_message(&message);
+    if (message.magic == 0 || message.src != CAR_ADDR)
+    {
+      continue;
+    }
+    if (message.magic == BOUND_MAGIC && message.message_len == sizeof(BOUND_PACKET))
+    {
+      answerBound(fob_state_ram, (const BOUND_PACKET *)message.buffer);
+      last = timeUs();
+    }
+    else if (message.magic == ACK_MAGIC)
+    {
+      return message.buffer[0];
+    }
+  }
+  return ACK_FAIL;
+}
+
+/**
+ * @brief Answer the car's timed distance-bounding rounds
+ *
+ * The keys for the car's nonce are worked out first; each challenge byte
+ * is then answered as soon as it arrives (see boundDistance in car.c). A
+ * round that does not come is given up on, and the rest with it.
+ *
+ * @param fob_state_ram pointer to the current fob state in ram
+ * @param bound the rounds the car will send and its nonce
+ */
+void answerBound(const FLASH_DATA *fob_state_ram, const BOUND_PACKET *bound)
+{
+  uint8_t stream[2][BOUND_MAX_ROUNDS];
+  uint8_t rounds = bound->rounds < BOUND_MAX_ROUNDS ? bound->rounds : BOUND_MAX_ROUNDS;
+
+  bound_keystream(fob_state_ram->pair_info.bound_key, bound->nonce, stream);
+  for (uint8_t i = 0; i < rounds; i++)
+  {
+    if (!bound_respond(stream[0][i], stream[1][i], BOUND_TIMEOUT_US))
+    {
+      return;
+    }
+  }
 }
\ No newline at end of file
@@ -0,0 +1,306 @@
+/**
+ * @file hexCodec.c
+ * @brief Hex encoding/decoding for host command payloads
+ *
+ * Decoding is table driven: each character maps to its nibble value, or to
+ * 0xFF if it is not a hex digit. Invalid characters are caught by OR-ing
+ * every looked-up value together and checking the high bits once at the
+ * end, so the inner loop has no data-dependent branches.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "hexCodec.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define HEX_CODEC_X86 1
+#include <immintrin.h>
+#endif
+
+/*** Global variables ***/
+static const char hexChars[16] = "0123456789abcdef";
+
+static const uint8_t hexDecodeTable[256] = {
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
+
+/**
+ * @brief Convert bytes to hex string using the portable implementation
+ */
+void bytesToHexScalar(const uint8_t *bytes, size_t len, char *hex)
+{
+  for (size_t i = 0; i < len; i++)
+  {
+    hex[i * 2] = hexChars[bytes[i] >> 4];
+    hex[i * 2 + 1] = hexChars[bytes[i] & 0x0F];
+  }
+  hex[len * 2] = '\0';
+}
+
+/**
+ * @brief Convert hex characters to bytes using the portable implementation
+ * @return Number of bytes written, or -1 on error
+ */
+int hexToBytesScalar(const char *hex, size_t hexLen, uint8_t *bytes, size_t maxLen)
+{
+  if (hexLen % 2 != 0 || hexLen / 2 > maxLen)
+    return -1;
+
+  size_t byteLen = hexLen / 2;
+  uint8_t bad = 0;
+
+  for (size_t i = 0; i < byteLen; i++)
+  {
+    uint8_t hi = hexDecodeTable[(uint8_t)hex[i * 2]];
+    uint8_t lo = hexDecodeTable[(uint8_t)hex[i * 2 + 1]];
+    bad |= hi | lo;
+    bytes[i] = (uint8_t)((hi << 4) | (lo & 0x0F));
+  }
+
+  return (bad & 0xF0) ? -1 : (int)byteLen;
+}
+
+#ifdef HEX_CODEC_X86
+/*
+ * Encoding splits each byte into nibbles and maps them to ASCII with one
+ * byte shuffle. Decoding checks each character against '0'-'9' and 'a'-'f'
+ * (after folding case) with unsigned compares, then packs nibble pairs into
+ * bytes with a multiply-add.
+ */
+
+__attribute__((target("ssse3")))
+static size_t encodeSsse3(const uint8_t *bytes, size_t len, char *hex)
+{
+  const __m128i lut = _mm_loadu_si128((const __m128i *)hexChars);
+  const __m128i mask = _mm_set1_epi8(0x0F);
+  size_t i = 0;
+
+  for (; i + 16 <= len; i += 16)
+  {
+    __m128i v = _mm_loadu_si128((const __m128i *)&bytes[i]);
+    __m128i hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(v, 4), mask));
+    __m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(v, mask));
+    _mm_storeu_si128((__m128i *)&hex[i * 2], _mm_unpacklo_epi8(hi, lo));
+    _mm_storeu_si128((__m128i *)&hex[i * 2 + 16], _mm_unpackhi_epi8(hi, lo));
+  }
+  return i;
+}
+
+__attribute__((target("ssse3")))
+static inline __m128i nibblesSsse3(__m128i c, __m128i *bad)
+{
+  __m128i digit = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+  __m128i alpha = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+  __m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+  __m128i isAlpha = _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(5)), alpha);
+
+  *bad = _mm_or_si128(*bad, _mm_xor_si128(_mm_or_si128(isDigit, isAlpha), _mm_set1_epi8(-1)));
+  return _mm_or_si128(_mm_and_si128(isDigit, digit),
+                      _mm_and_si128(isAlpha, _mm_add_epi8(alpha, _mm_set1_epi8(10))));
+}
+
+__attribute__((target("ssse3")))
+static size_t decodeSsse3(const char *hex, size_t byteLen, uint8_t *bytes, bool *ok)
+{
+  const __m128i weights = _mm_set1_epi16(0x0110); // hi * 16 + lo * 1
+  __m128i bad = _mm_setzero_si128();
+  size_t i = 0;
+
+  for (; i + 16 <= byteLen; i += 16)
+  {
+    __m128i n0 = nibblesSsse3(_mm_loadu_si128((const __m128i *)&hex[i * 2]), &bad);
+    __m128i n1 = nibblesSsse3(_mm_loadu_si128((const __m128i *)&hex[i * 2 + 16]), &bad);
+    __m128i b = _mm_packus_epi16(_mm_maddubs_epi16(n0, weights),
+                                 _mm_maddubs_epi16(n1, weights));
+    _mm_storeu_si128((__m128i *)&bytes[i], b);
+  }
+
+  *ok = (_mm_movemask_epi8(bad) == 0);
+  return i;
+}
+
+__attribute__((target("avx2")))
+static size_t encodeAvx2(const uint8_t *bytes, size_t len, char *hex)
+{
+  const __m256i lut = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)hexChars));
+  const __m256i mask = _mm256_set1_epi8(0x0F);
+  size_t i = 0;
+
+  for (; i + 32 <= len; i += 32)
+  {
+    __m256i v = _mm256_loadu_si256((const __m256i *)&bytes[i]);
+    __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), mask));
+    __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(v, mask));
+    // Unpacks work per 128-bit lane: lane 0 holds bytes 0-15, lane 1 16-31
+    __m256i a = _mm256_unpacklo_epi8(hi, lo);
+    __m256i b = _mm256_unpackhi_epi8(hi, lo);
+    _mm256_storeu_si256((__m256i *)&hex[i * 2], _mm256_permute2x128_si256(a, b, 0x20));
+    _mm256_storeu_si256((__m256i *)&hex[i * 2 + 32], _mm256_permute2x128_si256(a, b, 0x31));
+  }
+  return i;
+}
+
+__attribute__((target("avx2")))
+static inline __m256i nibblesAvx2(__m256i c, __m256i *bad)
+{
+  __m256i digit = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+  __m256i alpha = _mm256_sub_epi8(_mm256_or_si256(c, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+  __m256i isDigit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+  __m256i isAlpha = _mm256_cmpeq_epi8(_mm256_min_epu8(alpha, _mm256_set1_epi8(5)), alpha);
+
+  *bad = _mm256_or_si256(*bad, _mm256_xor_si256(_mm256_or_si256(isDigit, isAlpha), _mm256_set1_epi8(-1)));
+  return _mm256_or_si256(_mm256_and_si256(isDigit, digit),
+                         _mm256_and_si256(isAlpha, _mm256_add_epi8(alpha, _mm256_set1_epi8(10))));
+}
+
+__attribute__((target("avx2")))
+static size_t decodeAvx2(const char *hex, size_t byteLen, uint8_t *bytes, bool *ok)
+{
+  const __m256i weights = _mm256_set1_epi16(0x0110);
+  __m256i bad = _mm256_setzero_si256();
+  size_t i = 0;
+
+  for (; i + 32 <= byteLen; i += 32)
+  {
+    __m256i n0 = nibblesAvx2(_mm256_loadu_si256((const __m256i *)&hex[i * 2]), &bad);
+    __m256i n1 = nibblesAvx2(_mm256_loadu_si256((const __m256i *)&hex[i * 2 + 32]), &bad);
+    __m256i b = _mm256_packus_epi16(_mm256_maddubs_epi16(n0, weights),
+                                    _mm256_maddubs_epi16(n1, weights));
+    // Packs also work per lane; put the four 64-bit quarters back in order
+    _mm256_storeu_si256((__m256i *)&bytes[i], _mm256_permute4x64_epi64(b, 0xD8));
+  }
+
+  *ok = (_mm256_movemask_epi8(bad) == 0);
+  return i;
+}
+
+typedef enum
+{
+  HEX_IMPL_UNKNOWN,
+  HEX_IMPL_SCALAR,
+  HEX_IMPL_SSSE3,
+  HEX_IMPL_AVX2
+} hex_impl_t;
+
+static hex_impl_t hexImpl = HEX_IMPL_UNKNOWN;
+
+/**
+ * @brief Pick the best implementation for this CPU (once)
+ */
+static hex_impl_t selectImpl(void)
+{
+  if (hexImpl == HEX_IMPL_UNKNOWN)
+  {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+      hexImpl = HEX_IMPL_AVX2;
+    else if (__builtin_cpu_supports("ssse3"))
+      hexImpl = HEX_IMPL_SSSE3;
+    else
+      hexImpl = HEX_IMPL_SCALAR;
+  }
+  return hexImpl;
+}
+#endif // HEX_CODEC_X86
+
+/**
+ * @brief Convert bytes to hex string
+ */
+void bytesToHex(const uint8_t *bytes, size_t len, char *hex)
+{
+  size_t done = 0;
+
+#ifdef HEX_CODEC_X86
+  switch (selectImpl())
+  {
+  case HEX_IMPL_AVX2:
+    done = encodeAvx2(bytes, len, hex);
+    break;
+  case HEX_IMPL_SSSE3:
+    done = encodeSsse3(bytes, len, hex);
+    break;
+  default:
+    break;
+  }
+#endif
+
+  bytesToHexScalar(&bytes[done], len - done, &hex[done * 2]);
+}
+
+/**
+ * @brief Convert hex characters to bytes
+ * @return Number of bytes written, or -1 on error
+ */
+int hexToBytesN(const char *hex, size_t hexLen, uint8_t *bytes, size_t maxLen)
+{
+  if (hexLen % 2 != 0 || hexLen / 2 > maxLen)
+    return -1;
+
+  size_t byteLen = hexLen / 2;
+  size_t done = 0;
+  bool ok = true;
+
+#ifdef HEX_CODEC_X86
+  switch (selectImpl())
+  {
+  case HEX_IMPL_AVX2:
+    done = decodeAvx2(hex, byteLen, bytes, &ok);
+    break;
+  case HEX_IMPL_SSSE3:
+    done = decodeSsse3(hex, byteLen, bytes, &ok);
+    break;
+  default:
+    break;
+  }
+#endif
+
+  if (!ok || hexToBytesScalar(&hex[done * 2], hexLen - done * 2, &bytes[done], maxLen - done) < 0)
+    return -1;
+
+  return (int)byteLen;
+}
+
+/**
+ * @brief Convert hex string to bytes
+ * @return Number of bytes written, or -1 on error
+ */
+int hexToBytes(const char *hex, uint8_t *bytes, size_t maxLen)
+{
+  return hexToBytesN(hex, strlen(hex), bytes, maxLen);
+}
+
+/**
+ * @brief Name of the implementation in use
+ */
+const char *hexCodecImpl(void)
+{
+#ifdef HEX_CODEC_X86
+  switch (selectImpl())
+  {
+  case HEX_IMPL_AVX2:
+    return "avx2";
+  case HEX_IMPL_SSSE3:
+    return "ssse3";
+  default:
+    break;
+  }
+#endif
+  return "scalar";
+}
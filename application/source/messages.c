@@ -14,22 +14,390 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
+#include "dataFormats.h"
 #include "messages.h"
+#include "platform.h"
+#include "sha512.h"
 #include "uart.h"
 
+/*** Macros ***/
+#define FRAME_HEADER_LEN 4
+#define FRAME_MAX_LEN (FRAME_HEADER_LEN + 255 + 1)
+
+// Longest silence inside a frame before the receiver gives it up
+#define FRAME_GAP_US 50000
+
+// Shared link medium access
+#define MAX_SEND_ATTEMPTS 8
+#define MAX_BACKOFF_EXP 6
+#define BYTE_TIME_US 87 // 10 bits at 115200 baud
+
+// Frames from other boards that arrive while waiting for our own echo
+#define STASH_LEN 4
+#define STASH_PAYLOAD_LEN 64
+
+/*** Structure definitions ***/
+typedef struct
+{
+  uint8_t magic;
+  uint8_t dst;
+  uint8_t src;
+  uint8_t message_len;
+  uint8_t buffer[STASH_PAYLOAD_LEN];
+} STASHED_MESSAGE;
+
+/*** Global variables ***/
+static uint8_t link_address = 0;
+static bool link_shared = false;
+static uint32_t backoff_state = 1;
+
+static STASHED_MESSAGE stash[STASH_LEN];
+static uint8_t stash_head = 0;
+static uint8_t stash_count = 0;
+
+// Bytes of a bad frame after its magic, read again to find the next frame
+static uint8_t replay[FRAME_MAX_LEN];
+static uint16_t replay_pos = 0;
+static uint16_t replay_len = 0;
+
+/**
+ * @brief CRC-8 (polynomial 0x07) used to protect each frame
+ */
+static uint8_t crc8(uint8_t crc, const uint8_t *data, uint32_t len)
+{
+  for (uint32_t i = 0; i < len; i++)
+  {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++)
+    {
+      crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+/**
+ * @brief cycleCount() ticks in a number of microseconds
+ */
+static uint32_t cycles_in_us(uint32_t us)
+{
+  // clockHz() is 0 on x86, whose cycle counter counts nanoseconds
+  uint32_t hz = clockHz() ? clockHz() : 1000000000u;
+  return us * (hz / 1000000u);
+}
+
+/**
+ * @brief Check whether a byte is waiting, replayed or on the board UART
+ */
+static bool link_avail(void)
+{
+  return replay_pos < replay_len || uart_avail(BOARD_UART);
+}
+
+/**
+ * @brief Read the next byte, replayed bytes first (blocking)
+ */
+static uint8_t link_readb(void)
+{
+  if (replay_pos < replay_len)
+  {
+    return replay[replay_pos++];
+  }
+  return (uint8_t)uart_readb(BOARD_UART);
+}
+
+/**
+ * @brief Read the next byte if one comes within timeout_us
+ *
+ * @return true if a byte was read
+ */
+static bool link_readb_within(uint8_t *byte, uint32_t timeout_us)
+{
+  uint32_t timeout = cycles_in_us(timeout_us);
+  uint32_t start = cycleCount();
+
+  while (!link_avail())
+  {
+    if (cycleCount() - start >= timeout)
+    {
+      return false;
+    }
+  }
+  *byte = link_readb();
+  return true;
+}
+
+/**
+ * @brief Hand bytes back to be read again, ahead of any still unread
+ */
+static void link_unread(const uint8_t *bytes, uint32_t len)
+{
+  uint16_t rest = replay_len - replay_pos;
+
+  memmove(&replay[len], &replay[replay_pos], rest);
+  memcpy(replay, bytes, len);
+  replay_pos = 0;
+  replay_len = (uint16_t)(len + rest);
+}
+
+/**
+ * @brief Check that a byte could start a frame, so that the receiver can
+ * resynchronise one byte at a time after line noise
+ */
+static bool valid_magic(uint8_t magic)
+{
+  switch (magic)
+  {
+  case ACK_MAGIC:
+  case PAIR_MAGIC:
+  case UNLOCK_MAGIC:
+  case START_MAGIC:
+  case PAIR_ACK_MAGIC:
+  case BOUND_MAGIC:
+    return true;
+  default:
+    return false;
+  }
+}
+
+/**
+ * @brief Read the rest of a frame whose first byte has been read
+ *
+ * Gives the frame up if the link goes quiet for FRAME_GAP_US before it is
+ * complete. The bytes of a frame that is cut short or fails its CRC are
+ * read again, so that a garbled length byte cannot swallow the frames
+ * behind it: the receiver resynchronises on the next magic byte among them.
+ *
+ * @return true if a complete frame with a valid CRC was read
+ */
+static bool read_frame_from(uint8_t first, MESSAGE_PACKET *message)
+{
+  uint8_t frame[FRAME_MAX_LEN];
+  uint32_t len = 1;
+  uint32_t frame_len = FRAME_HEADER_LEN + 1;
+
+  frame[0] = first;
+  if (!valid_magic(frame[0]))
+  {
+    return false;
+  }
+
+  while (len < frame_len && link_readb_within(&frame[len], FRAME_GAP_US))
+  {
+    if (++len == FRAME_HEADER_LEN)
+    {
+      frame_len = FRAME_HEADER_LEN + frame[3] + 1;
+    }
+  }
+
+  if (len < frame_len || frame[frame_len - 1] != crc8(0, frame, frame_len - 1))
+  {
+    link_unread(&frame[1], len - 1);
+    return false;
+  }
+
+  message->magic = frame[0];
+  message->dst = frame[1];
+  message->src = frame[2];
+  message->message_len = frame[3];
+  memcpy(message->buffer, &frame[FRAME_HEADER_LEN], message->message_len);
+  return true;
+}
+
+/**
+ * @brief Read one frame from the board UART
+ *
+ * @return true if a complete frame with a valid CRC was read
+ */
+static bool read_frame(MESSAGE_PACKET *message)
+{
+  return read_frame_from(link_readb(), message);
+}
+
+/**
+ * @brief Whether a frame from another board is addressed to this one
+ */
+static bool for_us(const MESSAGE_PACKET *message)
+{
+  // On a shared link we hear our own transmissions; drop any stale echoes
+  if (link_shared && message->src == link_address)
+  {
+    return false;
+  }
+  return message->dst == link_address || message->dst == BROADCAST_ADDR;
+}
+
+/**
+ * @brief Keep a frame for a later call to receive_board_message
+ */
+static void stash_message(const MESSAGE_PACKET *message)
+{
+  if (stash_count == STASH_LEN || message->message_len > STASH_PAYLOAD_LEN)
+  {
+    return;
+  }
+
+  STASHED_MESSAGE *slot = &stash[(stash_head + stash_count) % STASH_LEN];
+  slot->magic = message->magic;
+  slot->dst = message->dst;
+  slot->src = message->src;
+  slot->message_len = message->message_len;
+  memcpy(slot->buffer, message->buffer, message->message_len);
+  stash_count++;
+}
+
+/**
+ * @brief Read frames until our own transmission comes back
+ *
+ * Every board on a shared link hears every byte, so a frame that comes back
+ * intact was not disturbed by anyone else. Intact frames from other boards
+ * that arrive first are stashed for the application.
+ *
+ * @return true if the echo matched, false on a collision
+ */
+static bool await_echo(const uint8_t *frame, uint32_t frame_len)
+{
+  uint8_t buffer[255];
+  MESSAGE_PACKET echo;
+  echo.buffer = buffer;
+
+  while (true)
+  {
+    // Distance-bounding bytes between other boards are not a collision;
+    // an echo that never comes is
+    uint8_t first;
+    if (!link_readb_within(&first, FRAME_GAP_US))
+    {
+      return false;
+    }
+    if ((first & ~BOUND_BITS) == 0)
+    {
+      continue;
+    }
+    if (!read_frame_from(first, &echo))
+    {
+      return false;
+    }
+
+    if (echo.src == link_address)
+    {
+      return echo.message_len == frame[3] &&
+             memcmp(echo.buffer, &frame[FRAME_HEADER_LEN], echo.message_len) == 0 &&
+             echo.magic == frame[0] && echo.dst == frame[1];
+    }
+
+    if (for_us(&echo))
+    {
+      stash_message(&echo);
+    }
+  }
+}
+
+/**
+ * @brief Wait a random number of frame times after a collision
+ *
+ * Binary exponential backoff, seeded from the board address so that boards
+ * that collided pick different delays.
+ */
+static void backoff(uint32_t attempt, uint32_t frame_len)
+{
+  uint32_t exp = (attempt + 1 < MAX_BACKOFF_EXP) ? attempt + 1 : MAX_BACKOFF_EXP;
+
+  backoff_state = backoff_state * 1103515245u + 12345u;
+  uint32_t slots = (backoff_state >> 16) & ((1u << exp) - 1);
+
+  delayUs(slots * frame_len * BYTE_TIME_US);
+}
+
+/**
+ * @brief Set up the board link
+ *
+ * @param address this board's address
+ * @param shared true if the link is a shared medium
+ */
+void board_link_init(uint8_t address, bool shared)
+{
+  link_address = address;
+  link_shared = shared;
+  backoff_state = (uint32_t)address * 2654435761u + 1;
+  stash_head = 0;
+  stash_count = 0;
+  replay_pos = 0;
+  replay_len = 0;
+}
+
+/**
+ * @brief Check whether a message may be waiting on the board link
+ *
+ * Bytes that cannot start a frame are dropped without waiting for more.
+ *
+ * @return true if a message (or the start of one) has been received
+ */
+bool board_message_avail(void)
+{
+  while (stash_count == 0 && link_avail())
+  {
+    uint8_t byte = link_readb();
+    if (valid_magic(byte))
+    {
+      link_unread(&byte, 1);
+      return true;
+    }
+  }
+  return stash_count > 0;
+}
+
 /**
  * @brief Send a message between boards
  *
  * @param message pointer to message to send
- * @return uint32_t the number of bytes sent
+ * @return uint32_t the number of bytes sent - 0 if it could not be sent
  */
 uint32_t send_board_message(MESSAGE_PACKET *message)
 {
-  uart_writeb(BOARD_UART, message->magic);
-  uart_writeb(BOARD_UART, message->message_len);
-  uart_write(BOARD_UART, message->buffer, message->message_len);
-  return message->message_len;
+  uint8_t frame[FRAME_MAX_LEN];
+  uint32_t frame_len = FRAME_HEADER_LEN + message->message_len + 1;
+
+  message->src = link_address;
+  frame[0] = message->magic;
+  frame[1] = message->dst;
+  frame[2] = message->src;
+  frame[3] = message->message_len;
+  memcpy(&frame[FRAME_HEADER_LEN], message->buffer, message->message_len);
+  frame[frame_len - 1] = crc8(0, frame, frame_len - 1);
+
+  if (!link_shared)
+  {
+    uart_write(BOARD_UART, frame, frame_len);
+    return message->message_len;
+  }
+
+  for (uint32_t attempt = 0; attempt < MAX_SEND_ATTEMPTS; attempt++)
+  {
+    // Listen before talking: take in anything already on the link
+    while (link_avail())
+    {
+      uint8_t buffer[255];
+      MESSAGE_PACKET other;
+      other.buffer = buffer;
+      if (read_frame(&other) && for_us(&other))
+      {
+        stash_message(&other);
+      }
+    }
+
+    uart_write(BOARD_UART, frame, frame_len);
+    if (await_echo(frame, frame_len))
+    {
+      return message->message_len;
+    }
+
+    backoff(attempt, frame_len);
+  }
+
+  return 0;
 }
 
 /**
@@ -40,15 +408,25 @@ uint32_t send_board_message(MESSAGE_PACKET *message)
  */
 uint32_t receive_board_message(MESSAGE_PACKET *message)
 {
-  message->magic = (uint8_t)uart_readb(BOARD_UART);
+  if (stash_count > 0)
+  {
+    STASHED_MESSAGE *slot = &stash[stash_head];
+    message->magic = slot->magic;
+    message->dst = slot->dst;
+    message->src = slot->src;
+    message->message_len = slot->message_len;
+    memcpy(message->buffer, slot->buffer, slot->message_len);
+    stash_head = (stash_head + 1) % STASH_LEN;
+    stash_count--;
+    return message->message_len;
+  }
 
-  if (message->magic == 0) {
+  if (!read_frame(message) || !for_us(message))
+  {
+    message->magic = 0;
     return 0;
   }
 
-  message->message_len = (uint8_t)uart_readb(BOARD_UART);
-  uart_read(BOARD_UART, message->buffer, message->message_len);
-  
   return message->message_len;
 }
 
@@ -66,3 +444,112 @@ uint32_t receive_board_message_by_type(MESSAGE_PACKET *message, uint8_t type) {
 
   return message->message_len;
 }
+
+/**
+ * @brief Read the next distance-bounding byte before a cycleCount() deadline
+ *
+ * Frames from other boards can come in between on a shared link; they are
+ * read whole and kept for the application, as await_echo keeps them.
+ *
+ * @return the byte, or -1 on timeout
+ */
+static int32_t read_bound_byte(uint32_t start, uint32_t timeout)
+{
+  uint8_t buffer[255];
+  MESSAGE_PACKET other;
+  other.buffer = buffer;
+
+  while (true)
+  {
+    while (!link_avail())
+    {
+      if (cycleCount() - start >= timeout)
+      {
+        return -1;
+      }
+    }
+
+    uint8_t byte = link_readb();
+    if ((byte & ~BOUND_BITS) == 0)
+    {
+      return byte;
+    }
+    if (read_frame_from(byte, &other) && for_us(&other))
+    {
+      stash_message(&other);
+    }
+  }
+}
+
+/**
+ * @brief Time one distance-bounding round
+ *
+ * @return uint32_t the round trip in cycleCount() ticks - 0 on timeout
+ */
+uint32_t bound_challenge(uint8_t challenge, uint8_t *response, uint32_t timeout_us)
+{
+  uint32_t timeout = cycles_in_us(timeout_us);
+  uint32_t start = cycleCount();
+
+  uart_writeb(BOARD_UART, challenge);
+  if (link_shared && read_bound_byte(start, timeout) < 0)
+  {
+    return 0;
+  }
+
+  int32_t byte = read_bound_byte(start, timeout);
+  uint32_t elapsed = cycleCount() - start;
+  if (byte < 0)
+  {
+    return 0;
+  }
+  *response = (uint8_t)byte;
+  return elapsed ? elapsed : 1;
+}
+
+/**
+ * @brief Answer one distance-bounding round
+ *
+ * @return true if a challenge was answered
+ */
+bool bound_respond(uint8_t key0, uint8_t key1, uint32_t timeout_us)
+{
+  uint32_t timeout = cycles_in_us(timeout_us);
+  uint32_t start = cycleCount();
+
+  int32_t challenge = read_bound_byte(start, timeout);
+  if (challenge < 0)
+  {
+    return false;
+  }
+  uart_writeb(BOARD_UART, bound_response((uint8_t)challenge, key0, key1));
+
+  // Our own response comes back on a shared link
+  if (link_shared)
+  {
+    read_bound_byte(cycleCount(), timeout);
+  }
+  return true;
+}
+
+uint8_t bound_response(uint8_t challenge, uint8_t key0, uint8_t key1)
+{
+  return ((key0 & ~challenge) | (key1 & challenge)) & BOUND_BITS;
+}
+
+void bound_keystream(const uint8_t *key, const uint8_t *nonce, uint8_t stream[2][BOUND_MAX_ROUNDS])
+{
+  uint8_t msg[BOUND_NONCE_SIZE + 1];
+  uint8_t mac[SHA512_SIZE];
+
+  memcpy(msg, nonce, BOUND_NONCE_SIZE);
+  for (uint8_t r = 0; r < 2; r++)
+  {
+    msg[BOUND_NONCE_SIZE] = r;
+    hmac_sha512(key, BOUND_KEY_SIZE, msg, sizeof(msg), mac);
+    for (int i = 0; i < BOUND_MAX_ROUNDS; i++)
+    {
+      stream[r][i] = mac[i] & BOUND_BITS;
+    }
+  }
+}
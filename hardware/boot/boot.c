@@ -0,0 +1,458 @@
+/**
+ * @file boot.c
+ * @brief Bootloader protocol, common to every port
+ */
+
+#include <string.h>
+
+#include "boot.h"
+#include "ed25519.h"
+#include "measure.h"
+#include "sha256.h"
+#include "uart.h"
+
+typedef struct
+{
+    uint8_t cmd;
+    uint16_t len;
+    uint8_t payload[BOOT_MAX_PAYLOAD];
+} boot_frame_t;
+
+static boot_frame_t rx;
+static uint8_t reply_data[BOOT_MAX_PAYLOAD];
+static uint8_t block[BOOT_BLOCK_SIZE] __attribute__((aligned(4)));  // flash is programmed in words
+
+static const uint8_t boot_pubkey[ED25519_KEY_SIZE] = BOOT_PUBKEY;
+
+// Time of the BAUD reply while the new rate is unconfirmed, else 0 and false
+static uint32_t baud_switched_ms;
+static bool baud_pending;
+
+uint16_t bootCrc16(const uint8_t *data, uint32_t len, uint16_t crc)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static uint16_t get16(const uint8_t *p)
+{
+    return p[0] | (uint16_t)p[1] << 8;
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    return p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static uint8_t *put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    return p + 2;
+}
+
+static uint8_t *put32(uint8_t *p, uint32_t v)
+{
+    p = put16(p, (uint16_t)v);
+    return put16(p, (uint16_t)(v >> 16));
+}
+
+static bool erased(const uint8_t *p, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        if (p[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool readByte(uint8_t *byte, uint32_t timeout_ms)
+{
+    uint32_t start = bootTimeMs();
+
+    while (!uart_avail(HOST_UART)) {
+        if (bootTimeMs() - start >= timeout_ms) {
+            return false;
+        }
+    }
+    *byte = (uint8_t)uart_readb(HOST_UART);
+    return true;
+}
+
+/**
+ * @brief Wait up to wait_ms for the start of a frame and read it whole
+ *
+ * Bytes before BOOT_SOF are skipped. A frame that stalls, is too long or
+ * fails its CRC is dropped.
+ */
+static bool receiveFrame(boot_frame_t *f, uint32_t wait_ms)
+{
+    uint8_t header[3];
+    uint8_t crc[2];
+    uint8_t byte;
+
+    do {
+        if (!readByte(&byte, wait_ms)) {
+            return false;
+        }
+    } while (byte != BOOT_SOF);
+
+    for (int i = 0; i < 3; i++) {
+        if (!readByte(&header[i], BOOT_BYTE_TIMEOUT_MS)) {
+            return false;
+        }
+    }
+    f->cmd = header[0];
+    f->len = get16(&header[1]);
+    if (f->len > BOOT_MAX_PAYLOAD) {
+        return false;
+    }
+    for (uint32_t i = 0; i < f->len; i++) {
+        if (!readByte(&f->payload[i], BOOT_BYTE_TIMEOUT_MS)) {
+            return false;
+        }
+    }
+    for (int i = 0; i < 2; i++) {
+        if (!readByte(&crc[i], BOOT_BYTE_TIMEOUT_MS)) {
+            return false;
+        }
+    }
+
+    return bootCrc16(f->payload, f->len, bootCrc16(header, 3, 0xFFFF)) == get16(crc);
+}
+
+static void sendReply(uint8_t cmd, boot_status_t status, const uint8_t *data, uint32_t len)
+{
+    uint8_t header[5] = { BOOT_SOF, cmd | BOOT_REPLY };
+    uint8_t crc[2];
+
+    put16(&header[2], (uint16_t)(len + 1));
+    header[4] = (uint8_t)status;
+    put16(crc, bootCrc16(data, len, bootCrc16(&header[1], 4, 0xFFFF)));
+
+    uart_write(HOST_UART, header, sizeof(header));
+    uart_write(HOST_UART, (uint8_t *)data, len);
+    uart_write(HOST_UART, crc, sizeof(crc));
+}
+
+/**
+ * @brief The sector a request names, if it exists and may be written
+ */
+static boot_status_t findSector(const uint8_t *p, bool write, const boot_region_t **region, uint32_t *address)
+{
+    uint8_t r = p[0];
+    uint16_t index = get16(&p[1]);
+
+    if (r >= boot_region_count || index >= boot_regions[r].count) {
+        return BOOT_ERR_RANGE;
+    }
+    if (write && (boot_regions[r].kind == BOOT_REGION_BOOT || boot_regions[r].kind == BOOT_REGION_RECORD)) {
+        return BOOT_ERR_PROTECTED;
+    }
+    *region = &boot_regions[r];
+    *address = boot_regions[r].base + index * boot_regions[r].sector_size;
+    return BOOT_OK;
+}
+
+static uint32_t hello(uint8_t *out)
+{
+    uint8_t *p = out;
+
+    *p++ = BOOT_VERSION;
+    p = put16(p, BOOT_BLOCK_SIZE);
+    p = put16(p, BOOT_MAX_PAYLOAD);
+    *p++ = boot_region_count;
+    for (uint8_t r = 0; r < boot_region_count; r++) {
+        p = put32(p, boot_regions[r].base);
+        p = put32(p, boot_regions[r].sector_size);
+        p = put16(p, boot_regions[r].count);
+        *p++ = boot_regions[r].kind;
+    }
+    return (uint32_t)(p - out);
+}
+
+static boot_status_t hash(const uint8_t *p, uint32_t *len)
+{
+    uint8_t r = p[0];
+    uint16_t first = get16(&p[1]);
+    uint16_t count = get16(&p[3]);
+    uint8_t digest[SHA256_SIZE];
+
+    if (r >= boot_region_count || count > BOOT_MAX_HASHES ||
+        (uint32_t)first + count > boot_regions[r].count) {
+        return BOOT_ERR_RANGE;
+    }
+
+    const boot_region_t *region = &boot_regions[r];
+    for (uint16_t i = 0; i < count; i++) {
+        uint32_t address = region->base + (first + i) * region->sector_size;
+        sha256(bootFlashRead(address), region->sector_size, digest);
+        if (region->kind == BOOT_REGION_STATE && !erased(bootFlashRead(address), region->sector_size)) {
+            memset(digest, 0, sizeof(digest));
+        }
+        memcpy(&reply_data[i * BOOT_HASH_SIZE], digest, BOOT_HASH_SIZE);
+    }
+    *len = count * BOOT_HASH_SIZE;
+    return BOOT_OK;
+}
+
+static boot_status_t eraseAt(uint32_t address, uint32_t size)
+{
+    measureSectorChanged(address);
+    if (!bootFlashErase(address) || !erased(bootFlashRead(address), size)) {
+        return BOOT_ERR_FLASH;
+    }
+    return BOOT_OK;
+}
+
+static boot_status_t eraseSector(const uint8_t *p)
+{
+    const boot_region_t *region;
+    uint32_t address;
+    boot_status_t status = findSector(p, true, &region, &address);
+
+    if (status != BOOT_OK) {
+        return status;
+    }
+    return eraseAt(address, region->sector_size);
+}
+
+static boot_status_t writeBlock(const uint8_t *p, uint32_t len)
+{
+    const boot_region_t *region;
+    uint32_t address;
+    boot_status_t status = findSector(p, true, &region, &address);
+
+    if (status != BOOT_OK) {
+        return status;
+    }
+
+    uint32_t offset = get32(&p[3]);
+    int32_t n = bootDecompress(&p[7], len - 7, block, sizeof(block));
+    if (n < 0 || n % 4 != 0) {
+        return BOOT_ERR_DATA;
+    }
+    if (offset % 4 != 0 || offset > region->sector_size || (uint32_t)n > region->sector_size - offset) {
+        return BOOT_ERR_RANGE;
+    }
+
+    address += offset;
+    measureSectorChanged(address);
+    if (!bootFlashProgram(address, block, (uint32_t)n) || memcmp(bootFlashRead(address), block, (size_t)n) != 0) {
+        return BOOT_ERR_FLASH;
+    }
+    return BOOT_OK;
+}
+
+/**
+ * @brief Verify the signature of the image at the start of the application
+ *        and erase the application sectors past it, so nothing unsigned is
+ *        left to run
+ */
+static boot_status_t signImage(const uint8_t *p)
+{
+    uint32_t len = get32(p);
+    uint32_t base = 0;
+    uint32_t end = 0;
+    bool found = false;
+
+    // The image must lie in application sectors that follow on without a gap
+    for (uint8_t r = 0; r < boot_region_count; r++) {
+        const boot_region_t *region = &boot_regions[r];
+        if (region->kind != BOOT_REGION_APP) {
+            continue;
+        }
+        if (!found) {
+            base = end = region->base;
+            found = true;
+        } else if (region->base != end) {
+            break;
+        }
+        end += region->count * region->sector_size;
+    }
+    if (!found || len == 0 || len > end - base) {
+        return BOOT_ERR_RANGE;
+    }
+
+    // The rest of the sector the image ends in is written with it, erased
+    for (uint8_t r = 0; r < boot_region_count; r++) {
+        const boot_region_t *region = &boot_regions[r];
+        uint32_t offset = base + len - region->base;
+        if (region->kind != BOOT_REGION_APP || base + len < region->base ||
+            offset >= region->count * region->sector_size) {
+            continue;
+        }
+        uint32_t tail = region->sector_size - offset % region->sector_size;
+        if (tail != region->sector_size && !erased(bootFlashRead(base + len), tail)) {
+            return BOOT_ERR_UNSIGNED;
+        }
+    }
+    if (!ed25519_verify(&p[4], bootFlashRead(base), len, boot_pubkey)) {
+        return BOOT_ERR_UNSIGNED;
+    }
+
+    for (uint8_t r = 0; r < boot_region_count; r++) {
+        const boot_region_t *region = &boot_regions[r];
+        if (region->kind != BOOT_REGION_APP) {
+            continue;
+        }
+        for (uint16_t i = 0; i < region->count; i++) {
+            uint32_t address = region->base + i * region->sector_size;
+            if (address >= base + len && !erased(bootFlashRead(address), region->sector_size)) {
+                boot_status_t status = eraseAt(address, region->sector_size);
+                if (status != BOOT_OK) {
+                    return status;
+                }
+            }
+        }
+    }
+    measureSign();
+    return BOOT_OK;
+}
+
+static void handle(const boot_frame_t *f)
+{
+    static const uint8_t min_len[] = {
+        [BOOT_CMD_HELLO] = 0, [BOOT_CMD_HASH] = 5, [BOOT_CMD_BAUD] = 4,
+        [BOOT_CMD_ERASE] = 3, [BOOT_CMD_WRITE] = 7, [BOOT_CMD_BOOT] = 0,
+        [BOOT_CMD_MEASURE] = 1, [BOOT_CMD_SIGN] = 4 + ED25519_SIG_SIZE,
+    };
+    boot_status_t status = BOOT_OK;
+    measure_report_t report;
+    uint32_t len = 0;
+
+    if (f->cmd < BOOT_CMD_HELLO || f->cmd > BOOT_CMD_SIGN || f->len < min_len[f->cmd]) {
+        sendReply(f->cmd, BOOT_ERR_COMMAND, NULL, 0);
+        return;
+    }
+
+    switch (f->cmd) {
+    case BOOT_CMD_HELLO:
+        len = hello(reply_data);
+        break;
+    case BOOT_CMD_HASH:
+        status = hash(f->payload, &len);
+        break;
+    case BOOT_CMD_BAUD: {
+        uint32_t baud = get32(f->payload);
+        if (!bootBaudValid(baud)) {
+            status = BOOT_ERR_BAUD;
+            break;
+        }
+        sendReply(f->cmd, BOOT_OK, NULL, 0);
+        bootSetBaud(baud);
+        baud_switched_ms = bootTimeMs();
+        baud_pending = baud != BOOT_DEFAULT_BAUD;
+        return;
+    }
+    case BOOT_CMD_ERASE:
+        status = eraseSector(f->payload);
+        break;
+    case BOOT_CMD_WRITE:
+        status = writeBlock(f->payload, f->len);
+        break;
+    case BOOT_CMD_BOOT:
+        if (!bootAppValid()) {
+            status = BOOT_ERR_NO_APP;
+            break;
+        }
+        if (!measureSigned()) {
+            status = BOOT_ERR_UNSIGNED;
+            break;
+        }
+        if (!measureRun(false, &report)) {
+            status = BOOT_ERR_TAMPERED;
+            break;
+        }
+        sendReply(f->cmd, BOOT_OK, reply_data, measurePack(&report, reply_data));
+        bootStartApp();
+        return;
+    case BOOT_CMD_MEASURE:
+        measureRun(f->payload[0] != 0, &report);
+        len = measurePack(&report, reply_data);
+        break;
+    case BOOT_CMD_SIGN:
+        status = signImage(f->payload);
+        break;
+    }
+
+    sendReply(f->cmd, status, reply_data, status == BOOT_OK ? len : 0);
+}
+
+int32_t bootDecompress(const uint8_t *src, uint32_t len, uint8_t *dst, uint32_t max)
+{
+    uint32_t in = 0;
+    uint32_t out = 0;
+
+    while (in < len) {
+        uint8_t token = src[in++];
+
+        if (token < 0x80) {
+            uint32_t run = token + 1u;
+            if (run > len - in || run > max - out) {
+                return -1;
+            }
+            memcpy(&dst[out], &src[in], run);
+            in += run;
+            out += run;
+        } else {
+            uint32_t count = (token & 0x7Fu) + BOOT_LZ_MATCH_MIN;
+            if (len - in < 2) {
+                return -1;
+            }
+            uint32_t distance = get16(&src[in]);
+            in += 2;
+            if (distance == 0 || distance > out || count > max - out) {
+                return -1;
+            }
+            // Byte by byte, so that a match overlapping its source repeats it
+            for (uint32_t i = 0; i < count; i++, out++) {
+                dst[out] = dst[out - distance];
+            }
+        }
+    }
+    return (int32_t)out;
+}
+
+void bootRun(void)
+{
+    measureInit();
+
+    bool stay = !bootAppValid();
+    uint32_t listen_ms = bootListenRequested() ? BOOT_LISTEN_MS : 0;
+    uint32_t start = bootTimeMs();
+
+    for (;;) {
+        uint32_t now = bootTimeMs();
+        if (baud_pending && now - baud_switched_ms >= BOOT_BAUD_CONFIRM_MS) {
+            bootSetBaud(BOOT_DEFAULT_BAUD);
+            baud_pending = false;
+        }
+        if (!stay && now - start >= listen_ms) {
+            // A tampered or unsigned application waits for the host to rewrite it
+            measure_report_t report;
+            bool intact = measureRun(false, &report);
+            measurePrint(&report);
+            if (!measureSigned()) {
+                static const char unsigned_line[] = "boot: application not signed\n";
+                uart_write(HOST_UART, (uint8_t *)unsigned_line, sizeof(unsigned_line) - 1);
+            } else if (intact) {
+                bootStartApp();
+            }
+            stay = true;
+        }
+
+        if (receiveFrame(&rx, 10)) {
+            // The first frame keeps the bootloader, any frame confirms a baud rate
+            stay = true;
+            baud_pending = false;
+            handle(&rx);
+        }
+    }
+}
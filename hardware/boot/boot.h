@@ -0,0 +1,158 @@
+/**
+ * @file boot.h
+ * @brief Resident UART bootloader for incremental reflashing
+ *
+ * The bootloader owns the first BOOT_SIZE bytes of flash and starts the
+ * application linked behind it (scons ... bootloader=1). For BOOT_LISTEN_MS
+ * after reset it listens on the host UART; a valid frame in that window, or
+ * no valid application, keeps it in the bootloader until a BOOT command. A
+ * software reset starts the application without listening, unless the
+ * application asked for the window first (boot_request.h).
+ *
+ * The host (tools/boot_tool.py) asks for a hash of every flash sector the
+ * new image covers and rewrites only those that differ, sending each block
+ * compressed and at the fastest baud rate both ends agree on.
+ *
+ * Before it starts the application the bootloader measures it (measure.h).
+ * BOOT replies with the measurement; a start after the listening window
+ * reports it on the host UART as a text line instead.
+ *
+ * Anyone on the host UART may rewrite the application, so none is started
+ * until SIGN checks an Ed25519 signature of it against BOOT_PUBKEY, the
+ * public half of secrets/boot_key.json compiled in, and erases the
+ * application sectors past the signed length. Any later ERASE or WRITE of
+ * an application sector revokes the signature. HASH of a state
+ * sector only tells whether it is erased, so the host cannot search the
+ * saved state (pairing data, PIN) against its hash.
+ *
+ * Frames, in both directions:
+ *
+ *     BOOT_SOF, cmd, len (u16), payload[len], crc (u16)
+ *
+ * All integers are little-endian and the CRC is CRC-16/CCITT-FALSE over
+ * cmd, len and payload. A reply carries cmd | BOOT_REPLY and starts with a
+ * status byte. Frames with a bad CRC are dropped unanswered and the host
+ * retries.
+ */
+
+#ifndef BOOT_H
+#define BOOT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BOOT_VERSION 3
+
+#define BOOT_SOF 0xB7
+#define BOOT_REPLY 0x80
+
+#define BOOT_DEFAULT_BAUD 115200
+#define BOOT_LISTEN_MS 300          // after reset, before the application starts
+#define BOOT_BAUD_CONFIRM_MS 1000   // for a frame at a new baud rate, or fall back
+#define BOOT_BYTE_TIMEOUT_MS 100    // between bytes of one frame
+
+#define BOOT_BLOCK_SIZE 1024        // largest decompressed WRITE
+#define BOOT_MAX_PAYLOAD 1088       // a block that did not compress, and its header
+#define BOOT_HASH_SIZE 16           // SHA-256 of a sector, truncated
+#define BOOT_MAX_HASHES 64          // per HASH request
+
+/**
+ * @brief Commands
+ */
+typedef enum
+{
+    BOOT_CMD_HELLO = 0x01,  // -> version, block size (u16), max payload (u16), region count (u8), regions
+    BOOT_CMD_HASH = 0x02,   // region (u8), first (u16), count (u16) -> count hashes
+    BOOT_CMD_BAUD = 0x03,   // baud (u32) -> status at the old rate, then switch
+    BOOT_CMD_ERASE = 0x04,  // region (u8), index (u16)
+    BOOT_CMD_WRITE = 0x05,  // region (u8), index (u16), offset (u32), compressed data
+    BOOT_CMD_BOOT = 0x06,   // -> measure_report_t (measure.h), then start the application
+    BOOT_CMD_MEASURE = 0x07, // full (u8) -> measure_report_t
+    BOOT_CMD_SIGN = 0x08,   // length (u32), Ed25519 signature of the image from the first application sector
+} boot_cmd_t;
+
+typedef enum
+{
+    BOOT_OK = 0,
+    BOOT_ERR_COMMAND,       // unknown command or malformed payload
+    BOOT_ERR_RANGE,         // no such sector, or outside it
+    BOOT_ERR_PROTECTED,     // the bootloader's own sectors
+    BOOT_ERR_DATA,          // the compressed data does not decode
+    BOOT_ERR_FLASH,         // erase, program or verify failed
+    BOOT_ERR_BAUD,          // the UART cannot run at that rate
+    BOOT_ERR_NO_APP,        // nothing valid to start
+    BOOT_ERR_TAMPERED,      // a full measurement found sectors changed behind the bootloader
+    BOOT_ERR_UNSIGNED,      // the signature does not verify, or none since the last change
+} boot_status_t;
+
+/**
+ * @brief What a region's sectors hold
+ */
+typedef enum
+{
+    BOOT_REGION_BOOT = 0,   // the bootloader, read only
+    BOOT_REGION_APP = 1,    // the application image
+    BOOT_REGION_STATE = 2,  // saved device state, erased by a fresh flash
+    BOOT_REGION_RECORD = 3, // the measurement record, read only
+} boot_region_kind_t;
+
+/**
+ * @brief A run of equal flash sectors, sent 11 bytes each in HELLO
+ */
+typedef struct
+{
+    uint32_t base;
+    uint32_t sector_size;
+    uint16_t count;
+    uint8_t kind;
+} boot_region_t;
+
+/*
+ * WRITE data is a sequence of tokens, each decoding to bytes appended to
+ * the block:
+ *
+ *     0x00-0x7F  literal run: the next token + 1 bytes, as they are
+ *     0x80-0xFF  match: (token & 0x7F) + 3 bytes copied from distance (u16)
+ *                bytes back in the block, which may overlap the copy
+ */
+#define BOOT_LZ_LITERAL_MAX 128
+#define BOOT_LZ_MATCH_MIN 3
+#define BOOT_LZ_MATCH_MAX 130
+
+/**
+ * @brief Decode WRITE data
+ * @return the block length, or -1 if the data is malformed or decodes to
+ *         more than max bytes
+ */
+int32_t bootDecompress(const uint8_t *src, uint32_t len, uint8_t *dst, uint32_t max);
+
+/**
+ * @brief CRC-16/CCITT-FALSE, continuing from crc (0xFFFF to start)
+ */
+uint16_t bootCrc16(const uint8_t *data, uint32_t len, uint16_t crc);
+
+/**
+ * @brief Serve the host until it sends BOOT, or start the application if
+ *        none asks in time; the port's main calls it once the host UART is up
+ */
+void bootRun(void);
+
+/*
+ * Implemented by each port (boot_<platform>.c), along with the host UART
+ * functions of uart.h
+ */
+extern const boot_region_t boot_regions[];
+extern const uint8_t boot_region_count;
+
+uint32_t bootTimeMs(void);
+uint32_t bootTimeUs(void);
+bool bootBaudValid(uint32_t baud);              // within the UART's divider tolerance
+void bootSetBaud(uint32_t baud);                // once the transmitter is idle
+bool bootFlashErase(uint32_t address);          // the sector starting at address
+bool bootFlashProgram(uint32_t address, const uint8_t *data, uint32_t len);  // words
+const uint8_t *bootFlashRead(uint32_t address);
+bool bootAppValid(void);
+bool bootListenRequested(void);                 // not a software reset, or one the application asked to listen after
+void bootStartApp(void);                        // does not return
+
+#endif // BOOT_H
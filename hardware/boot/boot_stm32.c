@@ -0,0 +1,239 @@
+/**
+ * @file boot_stm32.c
+ * @brief Bootloader port for the STM32F411
+ *
+ * Runs from the 16 MHz HSI that reset leaves selected, with no interrupts
+ * and no HAL: USART2 (the ST-LINK virtual COM port) and the flash
+ * controller are driven through their registers. The bootloader is sector
+ * 0; sector 5 holds the fob state that main.c saves there, and sector 6 the
+ * measurement record.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "stm32f4xx.h"
+
+#include "boot.h"
+#include "boot_request.h"
+#include "uart.h"
+
+#if BOOT_SIZE != 0x4000
+#error "The STM32 bootloader is exactly flash sector 0 (scons boot=stm32)"
+#endif
+
+#define CLOCK_HZ 16000000
+#define APP_BASE (FLASH_BASE + BOOT_SIZE)
+#define STATE_SECTOR 0x08020000
+#define RECORD_SECTOR 0x08040000
+#define RAM_END (SRAM1_BASE + 0x20000)
+
+#define FLASH_ERRORS (FLASH_SR_SOP | FLASH_SR_WRPERR | FLASH_SR_PGAERR | FLASH_SR_PGPERR | \
+                      FLASH_SR_PGSERR | FLASH_SR_RDERR)
+
+const boot_region_t boot_regions[] = {
+    { FLASH_BASE, 0x4000, 1, BOOT_REGION_BOOT },
+    { APP_BASE, 0x4000, 3, BOOT_REGION_APP },
+    { 0x08010000, 0x10000, 1, BOOT_REGION_APP },
+    { STATE_SECTOR, 0x20000, 1, BOOT_REGION_STATE },
+    { RECORD_SECTOR, 0x20000, 1, BOOT_REGION_RECORD },
+};
+const uint8_t boot_region_count = sizeof(boot_regions) / sizeof(boot_regions[0]);
+
+static const uint32_t sector_start[] = {
+    0x08000000, 0x08004000, 0x08008000, 0x0800C000, 0x08010000, 0x08020000, 0x08040000, 0x08060000
+};
+
+static uint64_t cycles;
+static uint32_t last_cycles;
+
+static uint64_t cyclesNow(void)
+{
+    uint32_t now = DWT->CYCCNT;
+
+    cycles += now - last_cycles;
+    last_cycles = now;
+    return cycles;
+}
+
+uint32_t bootTimeMs(void)
+{
+    return (uint32_t)(cyclesNow() / (CLOCK_HZ / 1000));
+}
+
+uint32_t bootTimeUs(void)
+{
+    return (uint32_t)(cyclesNow() / (CLOCK_HZ / 1000000));
+}
+
+static uint32_t baudDivider(uint32_t baud)
+{
+    return (CLOCK_HZ + baud / 2) / baud;
+}
+
+// BRR is the bit time in clocks with 16x oversampling; 2% off at most
+bool bootBaudValid(uint32_t baud)
+{
+    if (baud < 9600 || baud > CLOCK_HZ / 16) {
+        return false;
+    }
+    uint32_t actual = CLOCK_HZ / baudDivider(baud);
+    uint32_t error = actual > baud ? actual - baud : baud - actual;
+    return error * 50 <= baud;
+}
+
+void bootSetBaud(uint32_t baud)
+{
+    while (!(USART2->SR & USART_SR_TC)) {
+    }
+    USART2->CR1 &= ~USART_CR1_UE;
+    USART2->BRR = baudDivider(baud);
+    USART2->CR1 |= USART_CR1_UE;
+}
+
+bool uart_avail(hw_uart_t uart)
+{
+    return (USART2->SR & (USART_SR_RXNE | USART_SR_ORE)) != 0;
+}
+
+// Reading SR then DR clears an overrun too; the frame CRC catches the loss
+int32_t uart_readb(hw_uart_t uart)
+{
+    while (!uart_avail(uart)) {
+    }
+    (void)USART2->SR;
+    return (int32_t)(USART2->DR & 0xFF);
+}
+
+void uart_writeb(hw_uart_t uart, uint8_t data)
+{
+    while (!(USART2->SR & USART_SR_TXE)) {
+    }
+    USART2->DR = data;
+}
+
+uint32_t uart_write(hw_uart_t uart, uint8_t *buf, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        uart_writeb(uart, buf[i]);
+    }
+    return len;
+}
+
+static bool flashWait(void)
+{
+    while (FLASH->SR & FLASH_SR_BSY) {
+    }
+    bool ok = (FLASH->SR & FLASH_ERRORS) == 0;
+    FLASH->SR = FLASH_ERRORS | FLASH_SR_EOP;
+    return ok;
+}
+
+bool bootFlashErase(uint32_t address)
+{
+    uint32_t sector = 0;
+
+    while (sector < sizeof(sector_start) / sizeof(sector_start[0]) && sector_start[sector] != address) {
+        sector++;
+    }
+    if (sector == sizeof(sector_start) / sizeof(sector_start[0])) {
+        return false;
+    }
+
+    FLASH->CR = FLASH_CR_PSIZE_1 | FLASH_CR_SER | (sector << FLASH_CR_SNB_Pos);
+    FLASH->CR |= FLASH_CR_STRT;
+    bool ok = flashWait();
+    FLASH->CR = 0;
+    return ok;
+}
+
+bool bootFlashProgram(uint32_t address, const uint8_t *data, uint32_t len)
+{
+    const uint32_t *words = (const uint32_t *)data;
+    bool ok = true;
+
+    FLASH->CR = FLASH_CR_PSIZE_1 | FLASH_CR_PG;
+    for (uint32_t i = 0; ok && i < len / 4; i++) {
+        *(volatile uint32_t *)(address + 4 * i) = words[i];
+        ok = flashWait();
+    }
+    FLASH->CR = 0;
+    return ok;
+}
+
+const uint8_t *bootFlashRead(uint32_t address)
+{
+    return (const uint8_t *)address;
+}
+
+// The application's initial stack pointer and reset handler look like its own
+bool bootAppValid(void)
+{
+    uint32_t sp = *(const uint32_t *)APP_BASE;
+    uint32_t pc = *(const uint32_t *)(APP_BASE + 4);
+
+    return sp > SRAM1_BASE && sp <= RAM_END && (pc & 1) && pc >= APP_BASE && pc < STATE_SECTOR;
+}
+
+// A software reset (the restart test command) goes straight back to the
+// application unless it left the request
+bool bootListenRequested(void)
+{
+    bool software = (RCC->CSR & RCC_CSR_SFTRSTF) != 0;
+    bool requested = BOOT_REQUEST(RAM_END) == BOOT_REQUEST_MAGIC;
+
+    RCC->CSR |= RCC_CSR_RMVF;
+    BOOT_REQUEST(RAM_END) = 0;
+    return !software || requested;
+}
+
+void bootStartApp(void)
+{
+    uint32_t sp = *(const uint32_t *)APP_BASE;
+    uint32_t pc = *(const uint32_t *)(APP_BASE + 4);
+
+    // Hand over the flash and peripherals as reset left them
+    while (!(USART2->SR & USART_SR_TC)) {
+    }
+    FLASH->CR = FLASH_CR_LOCK;
+    RCC->APB1RSTR = RCC_APB1RSTR_USART2RST;
+    RCC->APB1RSTR = 0;
+    RCC->AHB1RSTR = RCC_AHB1RSTR_GPIOARST;
+    RCC->AHB1RSTR = 0;
+    RCC->APB1ENR &= ~RCC_APB1ENR_USART2EN;
+    RCC->AHB1ENR &= ~RCC_AHB1ENR_GPIOAEN;
+
+    SCB->VTOR = APP_BASE;
+    __DSB();
+    __asm volatile("msr msp, %0\n"
+                   "bx %1\n"
+                   :
+                   : "r"(sp), "r"(pc));
+    for (;;) {
+    }
+}
+
+int main(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    // USART2 on PA2 (TX) and PA3 (RX), alternate function 7
+    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOAEN;
+    RCC->APB1ENR |= RCC_APB1ENR_USART2EN;
+    (void)RCC->APB1ENR;
+    GPIOA->MODER = (GPIOA->MODER & ~(GPIO_MODER_MODER2 | GPIO_MODER_MODER3)) |
+                   GPIO_MODER_MODER2_1 | GPIO_MODER_MODER3_1;
+    GPIOA->AFR[0] = (GPIOA->AFR[0] & ~(0xFFu << 8)) | (0x77u << 8);
+    USART2->BRR = baudDivider(BOOT_DEFAULT_BAUD);
+    USART2->CR1 = USART_CR1_UE | USART_CR1_TE | USART_CR1_RE;
+
+    if (FLASH->CR & FLASH_CR_LOCK) {
+        FLASH->KEYR = 0x45670123;
+        FLASH->KEYR = 0xCDEF89AB;
+    }
+
+    bootRun();
+    return 0;
+}
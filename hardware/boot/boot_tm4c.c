@@ -0,0 +1,192 @@
+/**
+ * @file boot_tm4c.c
+ * @brief Bootloader port for the TM4C123
+ *
+ * Runs from the 16 MHz PIOSC with no interrupts. Flash is erased and
+ * programmed in 1 KB pages through driverlib; the last page is the fob
+ * state that tm4c.c keeps at FOB_STATE_PTR, and the 16 pages before it the
+ * measurement record, which the application is linked to stay clear of.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "inc/hw_memmap.h"
+#include "inc/hw_nvic.h"
+#include "inc/hw_types.h"
+#include "driverlib/flash.h"
+#include "driverlib/gpio.h"
+#include "driverlib/pin_map.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/uart.h"
+
+#include "boot.h"
+#include "boot_request.h"
+#include "uart.h"
+
+#ifndef BOOT_SIZE
+#error "BOOT_SIZE is set by the build (scons boot=tm4c)"
+#endif
+
+#define CLOCK_HZ 16000000
+#define PAGE_SIZE 1024
+#define STATE_PAGE 0x3FC00
+#define RECORD_PAGES 16
+#define RECORD_BASE (STATE_PAGE - RECORD_PAGES * PAGE_SIZE)
+
+#if RECORD_BASE != 0x3BC00
+#error "hardware/tm4c/SConscript links applications up to RECORD_BASE; change both"
+#endif
+#define SRAM_START 0x20000000
+#define SRAM_END 0x20008000
+
+// Cortex-M4 debug cycle counter, as in tm4c.c
+#define DEMCR 0xE000EDFC
+#define DEMCR_TRCENA 0x01000000
+#define DWT_CTRL 0xE0001000
+#define DWT_CTRL_CYCCNTENA 0x00000001
+#define DWT_CYCCNT 0xE0001004
+
+const boot_region_t boot_regions[] = {
+    { 0, PAGE_SIZE, BOOT_SIZE / PAGE_SIZE, BOOT_REGION_BOOT },
+    { BOOT_SIZE, PAGE_SIZE, (RECORD_BASE - BOOT_SIZE) / PAGE_SIZE, BOOT_REGION_APP },
+    { RECORD_BASE, PAGE_SIZE, RECORD_PAGES, BOOT_REGION_RECORD },
+    { STATE_PAGE, PAGE_SIZE, 1, BOOT_REGION_STATE },
+};
+const uint8_t boot_region_count = sizeof(boot_regions) / sizeof(boot_regions[0]);
+
+static uint64_t cycles;
+static uint32_t last_cycles;
+
+static uint64_t cyclesNow(void)
+{
+    uint32_t now = HWREG(DWT_CYCCNT);
+
+    cycles += now - last_cycles;
+    last_cycles = now;
+    return cycles;
+}
+
+uint32_t bootTimeMs(void)
+{
+    return (uint32_t)(cyclesNow() / (CLOCK_HZ / 1000));
+}
+
+uint32_t bootTimeUs(void)
+{
+    return (uint32_t)(cyclesNow() / (CLOCK_HZ / 1000000));
+}
+
+// The fractional divider is within 1% down to 16 cycles per bit
+bool bootBaudValid(uint32_t baud)
+{
+    return baud >= 9600 && baud <= CLOCK_HZ / 16;
+}
+
+void bootSetBaud(uint32_t baud)
+{
+    while (UARTBusy(UART0_BASE)) {
+    }
+    UARTConfigSetExpClk(UART0_BASE, CLOCK_HZ, baud,
+                        UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE);
+}
+
+bool uart_avail(hw_uart_t uart)
+{
+    return UARTCharsAvail(UART0_BASE);
+}
+
+int32_t uart_readb(hw_uart_t uart)
+{
+    return UARTCharGet(UART0_BASE) & 0xFF;
+}
+
+void uart_writeb(hw_uart_t uart, uint8_t data)
+{
+    UARTCharPut(UART0_BASE, data);
+}
+
+uint32_t uart_write(hw_uart_t uart, uint8_t *buf, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        UARTCharPut(UART0_BASE, buf[i]);
+    }
+    return len;
+}
+
+bool bootFlashErase(uint32_t address)
+{
+    return FlashErase(address) == 0;
+}
+
+bool bootFlashProgram(uint32_t address, const uint8_t *data, uint32_t len)
+{
+    return len == 0 || FlashProgram((uint32_t *)data, address, len) == 0;
+}
+
+const uint8_t *bootFlashRead(uint32_t address)
+{
+    return (const uint8_t *)address;
+}
+
+// The application's initial stack pointer and reset handler look like its own
+bool bootAppValid(void)
+{
+    uint32_t sp = HWREG(BOOT_SIZE);
+    uint32_t pc = HWREG(BOOT_SIZE + 4);
+
+    return sp > SRAM_START && sp <= SRAM_END && (pc & 1) &&
+           pc >= BOOT_SIZE && pc < RECORD_BASE;
+}
+
+// A software reset (the restart test command) goes straight back to the
+// application unless it left the request
+bool bootListenRequested(void)
+{
+    uint32_t cause = SysCtlResetCauseGet();
+    bool requested = BOOT_REQUEST(SRAM_END) == BOOT_REQUEST_MAGIC;
+
+    SysCtlResetCauseClear(cause);
+    BOOT_REQUEST(SRAM_END) = 0;
+    return !(cause & SYSCTL_CAUSE_SW) || requested;
+}
+
+void bootStartApp(void)
+{
+    uint32_t sp = HWREG(BOOT_SIZE);
+    uint32_t pc = HWREG(BOOT_SIZE + 4);
+
+    // Hand over the peripherals as reset left them
+    while (UARTBusy(UART0_BASE)) {
+    }
+    SysCtlPeripheralReset(SYSCTL_PERIPH_UART0);
+    SysCtlPeripheralDisable(SYSCTL_PERIPH_UART0);
+    SysCtlPeripheralDisable(SYSCTL_PERIPH_GPIOA);
+
+    HWREG(NVIC_VTABLE) = BOOT_SIZE;
+    __asm volatile("msr msp, %0\n"
+                   "bx %1\n"
+                   :
+                   : "r"(sp), "r"(pc));
+    for (;;) {
+    }
+}
+
+int main(void)
+{
+    SysCtlClockSet(SYSCTL_SYSDIV_1 | SYSCTL_USE_OSC | SYSCTL_OSC_INT | SYSCTL_MAIN_OSC_DIS);
+
+    HWREG(DEMCR) |= DEMCR_TRCENA;
+    HWREG(DWT_CYCCNT) = 0;
+    HWREG(DWT_CTRL) |= DWT_CTRL_CYCCNTENA;
+
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_UART0);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOA);
+    GPIOPinConfigure(GPIO_PA0_U0RX);
+    GPIOPinConfigure(GPIO_PA1_U0TX);
+    GPIOPinTypeUART(GPIO_PORTA_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+    bootSetBaud(BOOT_DEFAULT_BAUD);
+
+    bootRun();
+    return 0;
+}
@@ -0,0 +1,159 @@
+/**
+ * @file boot_x86.c
+ * @brief Bootloader port for the x86 simulator: flash emulated in a file
+ *
+ * Runs the bootloader protocol against an emulated flash so that the host
+ * tool can be tested without a board:
+ *
+ *     boot_x86 host=/path/to/host/tty [flash=/path/to/flash.bin] [reset=software]
+ *
+ * The flash file, boot_flash.bin next to the executable by default, is
+ * created erased and mapped into memory. As on the real parts, erasing sets
+ * a sector to 0xFF and programming can only clear bits, so a write to
+ * unerased flash fails verification. Starting the application just exits.
+ * reset=software starts as after a software reset with no request from the
+ * application, which skips the listening window.
+ */
+
+#include <fcntl.h>
+#include <libgen.h>
+#include <linux/limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "boot.h"
+#include "uart.h"
+
+#define FLASH_SIZE 0x22000
+
+// Mixed sector sizes, as on the STM32, so the host handles more than one
+const boot_region_t boot_regions[] = {
+    { 0x00000, 0x1000, 4, BOOT_REGION_BOOT },
+    { 0x04000, 0x1000, 12, BOOT_REGION_APP },
+    { 0x10000, 0x4000, 4, BOOT_REGION_APP },
+    { 0x20000, 0x1000, 1, BOOT_REGION_STATE },
+    { 0x21000, 0x1000, 1, BOOT_REGION_RECORD },
+};
+const uint8_t boot_region_count = sizeof(boot_regions) / sizeof(boot_regions[0]);
+
+static uint8_t *flash;
+static bool software_reset;
+
+static void openFlash(const char *path)
+{
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    off_t size = fd >= 0 ? lseek(fd, 0, SEEK_END) : -1;
+
+    if (fd < 0 || (size != FLASH_SIZE && ftruncate(fd, FLASH_SIZE) != 0)) {
+        perror(path);
+        exit(1);
+    }
+    flash = mmap(NULL, FLASH_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (flash == MAP_FAILED) {
+        perror("mmap");
+        exit(1);
+    }
+    if (size != FLASH_SIZE) {
+        memset(flash, 0xFF, FLASH_SIZE);
+    }
+}
+
+uint32_t bootTimeMs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u);
+}
+
+uint32_t bootTimeUs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u);
+}
+
+// A pseudo-terminal has no baud rate; any the real ports reach is accepted
+bool bootBaudValid(uint32_t baud)
+{
+    return baud >= 9600 && baud <= 1000000;
+}
+
+void bootSetBaud(uint32_t baud)
+{
+}
+
+bool bootFlashErase(uint32_t address)
+{
+    for (uint8_t r = 0; r < boot_region_count; r++) {
+        const boot_region_t *region = &boot_regions[r];
+        uint32_t offset = address - region->base;
+        if (address >= region->base && offset < region->count * region->sector_size &&
+            offset % region->sector_size == 0) {
+            memset(&flash[address], 0xFF, region->sector_size);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool bootFlashProgram(uint32_t address, const uint8_t *data, uint32_t len)
+{
+    if (address % 4 != 0 || len % 4 != 0 || address > FLASH_SIZE || len > FLASH_SIZE - address) {
+        return false;
+    }
+    for (uint32_t i = 0; i < len; i++) {
+        flash[address + i] &= data[i];
+    }
+    return true;
+}
+
+const uint8_t *bootFlashRead(uint32_t address)
+{
+    return &flash[address];
+}
+
+bool bootAppValid(void)
+{
+    uint32_t first;
+    memcpy(&first, &flash[boot_regions[1].base], sizeof(first));
+    return first != 0xFFFFFFFF;
+}
+
+bool bootListenRequested(void)
+{
+    return !software_reset;
+}
+
+void bootStartApp(void)
+{
+    printf("boot: starting application\n");
+    exit(0);
+}
+
+int main(int argc, char **argv)
+{
+    char path[PATH_MAX];
+    char exe[PATH_MAX];
+
+    snprintf(path, sizeof(path), "boot_flash.bin");
+    if (realpath(argv[0], exe) != NULL) {
+        snprintf(path, sizeof(path), "%.*s/boot_flash.bin", PATH_MAX - 32, dirname(exe));
+    }
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "flash=", 6) == 0) {
+            snprintf(path, sizeof(path), "%s", argv[i] + 6);
+        } else if (strcmp(argv[i], "reset=software") == 0) {
+            software_reset = true;
+        }
+    }
+
+    openFlash(path);
+    uart_init(HOST_UART, argc, argv);
+    bootRun();
+    return 0;
+}
@@ -0,0 +1,423 @@
+/**
+ * @file measure.c
+ * @brief Measured boot with a flash cache of sector digests (see measure.h)
+ */
+
+#include <string.h>
+
+#include "measure.h"
+#include "sha256.h"
+#include "uart.h"
+
+#define MEASURE_MAGIC 0x4D52
+#define ENTRY_SIZE 32
+
+// No digest cached for the sector since the record began
+#define UNMEASURED 0xFFFFFFFFu
+
+typedef enum
+{
+    ENTRY_HEADER = 1,       // sector = sector count, generation = layout CRC
+    ENTRY_GENERATION = 2,   // the sector is about to change
+    ENTRY_DIGEST = 3,       // the sector's digest at this generation
+    ENTRY_TAMPERED = 4,     // a full check found the sector changed at this generation
+    ENTRY_SIGNED = 5,       // SIGN verified the application
+    ENTRY_UNSIGNED = 6,     // an application sector is about to change
+} entry_type_t;
+
+typedef struct
+{
+    uint16_t magic;
+    uint8_t type;
+    uint8_t reserved;
+    uint16_t sector;
+    uint16_t crc;           // CRC-16/CCITT-FALSE of the entry with this field 0
+    uint32_t generation;
+    uint8_t digest[BOOT_HASH_SIZE];
+    uint32_t spare;
+} __attribute__((aligned(4))) measure_entry_t;
+
+static uint16_t sector_count;
+static uint32_t generation[MEASURE_MAX_SECTORS];
+static uint32_t measured[MEASURE_MAX_SECTORS];
+static uint8_t tampered[MEASURE_MAX_SECTORS];
+static uint8_t digests[MEASURE_MAX_SECTORS][BOOT_HASH_SIZE];
+static bool app_signed;
+
+// The record, or NULL if the port has none and digests are kept until reset
+static const boot_region_t *record;
+static uint32_t record_entries;
+static uint32_t next_entry;
+
+static uint32_t layoutCrc(void)
+{
+    return bootCrc16((const uint8_t *)boot_regions, boot_region_count * sizeof(boot_region_t), 0xFFFF);
+}
+
+/**
+ * @brief Flash address and size of an application sector, numbered across
+ *        the application regions in order
+ */
+static void sectorAt(uint16_t id, uint32_t *address, uint32_t *size)
+{
+    for (uint8_t r = 0; r < boot_region_count; r++) {
+        const boot_region_t *region = &boot_regions[r];
+        if (region->kind != BOOT_REGION_APP) {
+            continue;
+        }
+        if (id < region->count) {
+            *address = region->base + id * region->sector_size;
+            *size = region->sector_size;
+            return;
+        }
+        id -= region->count;
+    }
+}
+
+static bool inApplication(uint32_t address)
+{
+    for (uint8_t r = 0; r < boot_region_count; r++) {
+        const boot_region_t *region = &boot_regions[r];
+        if (region->kind == BOOT_REGION_APP && address >= region->base &&
+            address - region->base < region->count * region->sector_size) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static int32_t sectorOf(uint32_t address)
+{
+    int32_t id = 0;
+
+    for (uint8_t r = 0; r < boot_region_count; r++) {
+        const boot_region_t *region = &boot_regions[r];
+        if (region->kind != BOOT_REGION_APP) {
+            continue;
+        }
+        uint32_t offset = address - region->base;
+        if (address >= region->base && offset < region->count * region->sector_size) {
+            id += offset / region->sector_size;
+            return id < sector_count ? id : -1;
+        }
+        id += region->count;
+    }
+    return -1;
+}
+
+static uint16_t entryCrc(const measure_entry_t *entry)
+{
+    measure_entry_t copy = *entry;
+
+    copy.crc = 0;
+    return bootCrc16((const uint8_t *)&copy, sizeof(copy), 0xFFFF);
+}
+
+static bool writeEntry(uint8_t type, uint16_t sector)
+{
+    measure_entry_t entry;
+
+    if (next_entry >= record_entries) {
+        return false;
+    }
+    memset(&entry, 0xFF, sizeof(entry));
+    entry.magic = MEASURE_MAGIC;
+    entry.type = type;
+    entry.sector = sector;
+    if (type == ENTRY_HEADER) {
+        entry.generation = layoutCrc();
+    } else if (type == ENTRY_SIGNED || type == ENTRY_UNSIGNED) {
+        entry.generation = 0;
+    } else {
+        entry.generation = generation[sector];
+        if (type == ENTRY_DIGEST) {
+            memcpy(entry.digest, digests[sector], BOOT_HASH_SIZE);
+        }
+    }
+    entry.crc = entryCrc(&entry);
+
+    // A failed write still takes the slot: it cannot be programmed again
+    bootFlashProgram(record->base + next_entry * ENTRY_SIZE, (const uint8_t *)&entry, sizeof(entry));
+    next_entry++;
+    return true;
+}
+
+/**
+ * @brief Start the record over with one entry per sector that needs one
+ */
+static void compact(void)
+{
+    for (uint16_t i = 0; i < record->count; i++) {
+        bootFlashErase(record->base + i * record->sector_size);
+    }
+    next_entry = 0;
+    writeEntry(ENTRY_HEADER, sector_count);
+    for (uint16_t id = 0; id < sector_count; id++) {
+        if (measured[id] == generation[id]) {
+            writeEntry(ENTRY_DIGEST, id);
+            if (tampered[id]) {
+                writeEntry(ENTRY_TAMPERED, id);
+            }
+        } else if (generation[id] != 0) {
+            writeEntry(ENTRY_GENERATION, id);
+        }
+    }
+    if (app_signed) {
+        writeEntry(ENTRY_SIGNED, 0);
+    }
+}
+
+/**
+ * @brief Record a change already made to the RAM copy
+ */
+static void persist(uint8_t type, uint16_t sector)
+{
+    if (record != NULL && !writeEntry(type, sector)) {
+        compact();
+    }
+}
+
+static void apply(const measure_entry_t *entry)
+{
+    uint16_t id = entry->sector;
+
+    if (entry->type == ENTRY_SIGNED || entry->type == ENTRY_UNSIGNED) {
+        app_signed = entry->type == ENTRY_SIGNED;
+        return;
+    }
+    if (id >= sector_count) {
+        return;
+    }
+    switch (entry->type) {
+    case ENTRY_GENERATION:
+        generation[id] = entry->generation;
+        tampered[id] = 0;
+        break;
+    case ENTRY_DIGEST:
+        generation[id] = entry->generation;
+        measured[id] = entry->generation;
+        memcpy(digests[id], entry->digest, BOOT_HASH_SIZE);
+        tampered[id] = 0;
+        break;
+    case ENTRY_TAMPERED:
+        if (entry->generation == generation[id]) {
+            tampered[id] = 1;
+        }
+        break;
+    }
+}
+
+static bool erased(const uint8_t *p, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        if (p[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void measureInit(void)
+{
+    record = NULL;
+    sector_count = 0;
+    app_signed = false;
+    for (uint8_t r = 0; r < boot_region_count; r++) {
+        if (boot_regions[r].kind == BOOT_REGION_APP) {
+            sector_count += boot_regions[r].count;
+        } else if (boot_regions[r].kind == BOOT_REGION_RECORD) {
+            record = &boot_regions[r];
+        }
+    }
+    if (sector_count > MEASURE_MAX_SECTORS) {
+        sector_count = 0;
+    }
+    for (uint16_t id = 0; id < sector_count; id++) {
+        generation[id] = 0;
+        measured[id] = UNMEASURED;
+        tampered[id] = 0;
+    }
+
+    // Compaction needs room for a digest and a tampered mark per sector,
+    // and the signed mark
+    record_entries = record ? record->count * record->sector_size / ENTRY_SIZE : 0;
+    if (record_entries < 2u + 2u * sector_count) {
+        record = NULL;
+        return;
+    }
+
+    bool valid = false;
+    next_entry = record_entries;
+    for (uint32_t n = 0; n < record_entries; n++) {
+        const uint8_t *p = bootFlashRead(record->base + n * ENTRY_SIZE);
+        measure_entry_t entry;
+
+        if (erased(p, ENTRY_SIZE)) {
+            next_entry = n;
+            break;
+        }
+        memcpy(&entry, p, sizeof(entry));
+        if (entry.magic != MEASURE_MAGIC || entry.crc != entryCrc(&entry)) {
+            continue;
+        }
+        if (n == 0) {
+            valid = entry.type == ENTRY_HEADER && entry.sector == sector_count &&
+                    entry.generation == layoutCrc();
+            if (!valid) {
+                break;
+            }
+        } else {
+            apply(&entry);
+        }
+    }
+
+    if (!valid) {
+        for (uint16_t id = 0; id < sector_count; id++) {
+            generation[id] = 0;
+            measured[id] = UNMEASURED;
+            tampered[id] = 0;
+        }
+        app_signed = false;
+        compact();
+    }
+}
+
+void measureSectorChanged(uint32_t address)
+{
+    int32_t id = sectorOf(address);
+
+    // Before the change, so that a reset part way through leaves it unsigned
+    if (app_signed && inApplication(address)) {
+        app_signed = false;
+        persist(ENTRY_UNSIGNED, 0);
+    }
+    // One marker per rewrite: a sector already waiting to be measured keeps its own
+    if (id < 0 || measured[id] != generation[id]) {
+        return;
+    }
+    generation[id]++;
+    tampered[id] = 0;
+    persist(ENTRY_GENERATION, (uint16_t)id);
+}
+
+void measureSign(void)
+{
+    if (!app_signed) {
+        app_signed = true;
+        persist(ENTRY_SIGNED, 0);
+    }
+}
+
+bool measureSigned(void)
+{
+    return app_signed;
+}
+
+bool measureRun(bool full, measure_report_t *report)
+{
+    uint32_t start = bootTimeUs();
+    uint8_t digest[SHA256_SIZE];
+
+    report->hashed = 0;
+    report->tampered = 0;
+    for (uint16_t id = 0; id < sector_count; id++) {
+        bool stale = measured[id] != generation[id];
+
+        if (stale || full) {
+            uint32_t address = 0, size = 0;
+            sectorAt(id, &address, &size);
+            sha256(bootFlashRead(address), size, digest);
+            report->hashed++;
+
+            if (stale) {
+                memcpy(digests[id], digest, BOOT_HASH_SIZE);
+                measured[id] = generation[id];
+                tampered[id] = 0;
+                persist(ENTRY_DIGEST, id);
+            } else if (memcmp(digests[id], digest, BOOT_HASH_SIZE) != 0) {
+                if (!tampered[id]) {
+                    tampered[id] = 1;
+                    persist(ENTRY_TAMPERED, id);
+                }
+            } else if (tampered[id]) {
+                // Put back as it was measured
+                tampered[id] = 0;
+                persist(ENTRY_DIGEST, id);
+            }
+        }
+        report->tampered += tampered[id];
+    }
+
+    sha256(&digests[0][0], sector_count * BOOT_HASH_SIZE, digest);
+    memcpy(report->image, digest, BOOT_HASH_SIZE);
+    report->sectors = sector_count;
+    report->full = full;
+    report->us = bootTimeUs() - start;
+    return report->tampered == 0;
+}
+
+uint32_t measurePack(const measure_report_t *report, uint8_t *out)
+{
+    uint8_t *p = out;
+
+    for (int i = 0; i < 4; i++) {
+        *p++ = (uint8_t)(report->us >> (8 * i));
+    }
+    *p++ = (uint8_t)report->hashed;
+    *p++ = (uint8_t)(report->hashed >> 8);
+    *p++ = (uint8_t)report->sectors;
+    *p++ = (uint8_t)(report->sectors >> 8);
+    *p++ = (uint8_t)report->tampered;
+    *p++ = (uint8_t)(report->tampered >> 8);
+    *p++ = report->full;
+    memcpy(p, report->image, BOOT_HASH_SIZE);
+    return MEASURE_REPORT_SIZE;
+}
+
+static char *putText(char *p, const char *text)
+{
+    while (*text) {
+        *p++ = *text++;
+    }
+    return p;
+}
+
+static char *putDecimal(char *p, uint32_t v)
+{
+    char digits[10];
+    int n = 0;
+
+    do {
+        digits[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    while (n) {
+        *p++ = digits[--n];
+    }
+    return p;
+}
+
+void measurePrint(const measure_report_t *report)
+{
+    static const char hex[] = "0123456789abcdef";
+    char line[128];
+    char *p = line;
+
+    p = putText(p, "boot: measure us=");
+    p = putDecimal(p, report->us);
+    p = putText(p, ",hashed=");
+    p = putDecimal(p, report->hashed);
+    p = putText(p, ",sectors=");
+    p = putDecimal(p, report->sectors);
+    p = putText(p, ",full=");
+    p = putDecimal(p, report->full);
+    p = putText(p, ",tampered=");
+    p = putDecimal(p, report->tampered);
+    p = putText(p, ",image=");
+    for (int i = 0; i < BOOT_HASH_SIZE; i++) {
+        *p++ = hex[report->image[i] >> 4];
+        *p++ = hex[report->image[i] & 15];
+    }
+    *p++ = '\n';
+    uart_write(HOST_UART, (uint8_t *)line, (uint32_t)(p - line));
+}
@@ -0,0 +1,91 @@
+/**
+ * @file measure.h
+ * @brief Measured boot: per-sector digests of the application, cached in flash
+ *
+ * Every application sector has a generation marker that the bootloader
+ * advances before it erases or writes the sector. The record (the
+ * BOOT_REGION_RECORD sectors, which the host cannot write) caches the
+ * digest of each sector with the generation it was taken at. A boot hashes
+ * only the sectors whose generation moved since their digest was cached, so
+ * a board that was not reflashed starts without hashing anything.
+ *
+ * A full check, on the host's request, hashes every sector and compares it
+ * with the cached digest. A sector that differs was changed other than
+ * through the bootloader; it is marked tampered in the record and the
+ * application is not started until the sector is rewritten.
+ *
+ * The record also keeps whether the application is signed (boot.h): SIGN
+ * sets it and a change to any application sector through the bootloader
+ * clears it first.
+ *
+ * The record is a log of 32-byte entries, programmed in place and erased
+ * only when it fills up and is compacted. A torn entry fails its CRC and is
+ * skipped. A record that is lost or from another layout costs one full
+ * measurement, which rebuilds it.
+ */
+
+#ifndef MEASURE_H
+#define MEASURE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "boot.h"
+
+#define MEASURE_MAX_SECTORS 256
+
+/**
+ * @brief The outcome of a measurement, as the MEASURE reply carries it
+ */
+typedef struct
+{
+    uint32_t us;                        // time taken
+    uint16_t hashed;                    // sectors hashed
+    uint16_t sectors;                   // application sectors
+    uint16_t tampered;                  // sectors that differ from their cached digest
+    uint8_t full;                       // every sector was hashed
+    uint8_t image[BOOT_HASH_SIZE];      // SHA-256 of the sector digests, truncated
+} measure_report_t;
+
+#define MEASURE_REPORT_SIZE 27          // packed, little-endian
+
+/**
+ * @brief Load the record; bootRun calls it first
+ */
+void measureInit(void);
+
+/**
+ * @brief Advance the generation of the application sector holding address,
+ *        before it is erased or written
+ */
+void measureSectorChanged(uint32_t address);
+
+/**
+ * @brief Mark the application as signed, once SIGN has verified it
+ */
+void measureSign(void);
+
+/**
+ * @brief Whether the application was signed and not changed since
+ */
+bool measureSigned(void);
+
+/**
+ * @brief Hash the sectors whose generation moved, or all of them
+ * @return true if no sector is tampered
+ */
+bool measureRun(bool full, measure_report_t *report);
+
+/**
+ * @brief Pack a report for the MEASURE reply
+ * @return MEASURE_REPORT_SIZE
+ */
+uint32_t measurePack(const measure_report_t *report, uint8_t *out);
+
+/**
+ * @brief Write the report to the host UART as a line:
+ *        "boot: measure us=,hashed=,sectors=,full=,tampered=,image="
+ */
+void measurePrint(const measure_report_t *report);
+
+#endif // MEASURE_H
@@ -0,0 +1,15 @@
+/**
+ * @file sha256.h
+ * @brief SHA-256 of a buffer in one call, small enough for the bootloader
+ */
+
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <stdint.h>
+
+#define SHA256_SIZE 32
+
+void sha256(const uint8_t *data, uint32_t len, uint8_t digest[SHA256_SIZE]);
+
+#endif // SHA256_H
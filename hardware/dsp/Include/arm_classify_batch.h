@@ -0,0 +1,71 @@
+/**
+ * @file arm_classify_batch.h
+ * @brief Batch prediction for the CMSIS-DSP SVM and naive Bayes classifiers
+ *
+ * arm_svm_linear_predict_f32, arm_svm_rbf_predict_f32 and
+ * arm_gaussian_naive_bayes_predict_f32 classify one vector per call, and
+ * each call streams every support vector or class again. These take the
+ * same instances and classify a row-major array of vectors per call: a
+ * support vector or class is loaded once for a group of inputs, and work
+ * that does not depend on the input is done once per call instead of once
+ * per vector.
+ */
+
+#ifndef ARM_CLASSIFY_BATCH_H
+#define ARM_CLASSIFY_BATCH_H
+
+#include "arm_math.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief  Linear SVM prediction for many vectors.
+ * @param[in]  S           points to an instance of the linear SVM structure.
+ * @param[in]  pIn         points to numVectors input vectors, row-major.
+ * @param[in]  numVectors  number of input vectors.
+ * @param[out] pResult     points to numVectors decisions.
+ * @param[out] pBuffer     points to a scratch buffer of vectorDimension values.
+ */
+void arm_svm_linear_predict_batch_f32(
+  const arm_svm_linear_instance_f32 * S,
+  const float32_t * pIn,
+        uint32_t numVectors,
+        int32_t * pResult,
+        float32_t * pBuffer);
+
+/**
+ * @brief  RBF SVM prediction for many vectors.
+ * @param[in]  S           points to an instance of the RBF SVM structure.
+ * @param[in]  pIn         points to numVectors input vectors, row-major.
+ * @param[in]  numVectors  number of input vectors.
+ * @param[out] pResult     points to numVectors decisions.
+ */
+void arm_svm_rbf_predict_batch_f32(
+  const arm_svm_rbf_instance_f32 * S,
+  const float32_t * pIn,
+        uint32_t numVectors,
+        int32_t * pResult);
+
+/**
+ * @brief  Naive Gaussian Bayesian prediction for many vectors.
+ * @param[in]  S           points to a naive Bayes instance structure.
+ * @param[in]  pIn         points to numVectors input vectors, row-major.
+ * @param[in]  numVectors  number of input vectors.
+ * @param[out] pResult     points to numVectors class indices.
+ * @param[out] pBuffer     points to a scratch buffer of numberOfClasses*(vectorDimension+1) values.
+ */
+void arm_gaussian_naive_bayes_predict_batch_f32(
+  const arm_gaussian_naive_bayes_instance_f32 * S,
+  const float32_t * pIn,
+        uint32_t numVectors,
+        uint32_t * pResult,
+        float32_t * pBuffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARM_CLASSIFY_BATCH_H */
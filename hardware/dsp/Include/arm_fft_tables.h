@@ -0,0 +1,66 @@
+/**
+ * @file arm_fft_tables.h
+ * @brief FFT tables computed at run time, in the style of CMSIS-DSP
+ *
+ * arm_common_tables.c holds the twiddle factors and bit-reversal tables of
+ * every FFT length as constants. These compute the tables of one length into
+ * a caller's buffer instead, with the values the library's tables hold (the
+ * twiddles to within a couple of ulp), so a firmware can keep the tables it
+ * uses in RAM and build them at boot rather than carry them in flash.
+ *
+ * tools/dsp_tables.py finds the lengths a firmware uses and generates the
+ * buffers, the arm_cfft_sR_f32_lenN style instances pointing at them and
+ * arm_dsp_tables_init().
+ */
+
+#ifndef ARM_FFT_TABLES_H
+#define ARM_FFT_TABLES_H
+
+#include "arm_math_types.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief  Twiddle factors of the floating-point complex FFT, as twiddleCoef_N.
+ * @param[out] pTwiddle  points to 2*fftLen values.
+ * @param[in]  fftLen    FFT length, a power of two from 16 to 4096.
+ */
+void arm_cfft_twiddle_init_f32(
+  float32_t * pTwiddle,
+  uint16_t fftLen);
+
+/**
+ * @brief  Bit-reversal table of the floating-point complex FFT, as armBitRevIndexTableN.
+ * @param[out] pTable  points to at most 2*fftLen values.
+ * @param[in]  fftLen  FFT length, a power of two from 16 to 4096.
+ * @return     table length, as ARMBITREVINDEXTABLE_N_TABLE_LENGTH
+ */
+uint16_t arm_cfft_bitrev_init_f32(
+  uint16_t * pTable,
+  uint16_t fftLen);
+
+/**
+ * @brief  Twiddle factors of the floating-point real FFT, as twiddleCoef_rfft_N.
+ * @param[out] pTwiddle  points to fftLen values.
+ * @param[in]  fftLen    real FFT length, a power of two from 32 to 4096.
+ */
+void arm_rfft_fast_twiddle_init_f32(
+  float32_t * pTwiddle,
+  uint16_t fftLen);
+
+/**
+ * @brief  Builds the FFT tables a firmware keeps in RAM.
+ *
+ * Generated by tools/dsp_tables.py for each firmware; a no-op unless it was
+ * built with dsp_tables=ram. Must run before the first transform.
+ */
+void arm_dsp_tables_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARM_FFT_TABLES_H */
@@ -0,0 +1,125 @@
+/**
+ * @file arm_knn.h
+ * @brief Batched k-nearest-neighbour search in the style of CMSIS-DSP
+ *
+ * arm_euclidean_distance_f32 and the other DistanceFunctions compare one
+ * pair of vectors per call, so searching a set of templates costs a call,
+ * and a reload of the query, per template. These search a whole reference
+ * matrix for one query in a single call and return the k nearest rows.
+ * References are compared several at a time, sharing each load of the
+ * query, and for the Euclidean and city block metrics a reference is
+ * dropped as soon as its partial distance can no longer make the top k.
+ */
+
+#ifndef ARM_KNN_H
+#define ARM_KNN_H
+
+#include "arm_math.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Distance used by the floating-point k-NN search
+ */
+typedef enum
+{
+  ARM_KNN_EUCLIDEAN = 0,           /**< as arm_euclidean_distance_f32. */
+  ARM_KNN_CITYBLOCK = 1,           /**< as arm_cityblock_distance_f32. */
+  ARM_KNN_COSINE = 2               /**< as arm_cosine_distance_f32. */
+} arm_knn_metric;
+
+/**
+ * @brief Instance structure for the floating-point k-NN search
+ */
+typedef struct
+{
+  uint32_t numRefs;                /**< number of reference vectors (rows). */
+  uint32_t dim;                    /**< length of each vector. */
+  arm_knn_metric metric;           /**< distance between the query and a reference. */
+  const float32_t *pRefs;          /**< points to the numRefs x dim reference matrix, row-major. */
+  float32_t *pInvNorms;            /**< for ARM_KNN_COSINE, points to numRefs reciprocal row norms. */
+} arm_knn_instance_f32;
+
+/**
+ * @brief Instance structure for the Q15 k-NN search, Euclidean distance only
+ */
+typedef struct
+{
+  uint32_t numRefs;                /**< number of reference vectors (rows). */
+  uint32_t dim;                    /**< length of each vector. */
+  const q15_t *pRefs;              /**< points to the numRefs x dim reference matrix, row-major. */
+  q63_t *pNorms;                   /**< points to numRefs squared row norms. */
+} arm_knn_instance_q15;
+
+/**
+ * @brief  Initialization function for the floating-point k-NN search.
+ * @param[out] S          points to an instance of the search structure.
+ * @param[in]  numRefs    number of reference vectors.
+ * @param[in]  dim        length of each vector.
+ * @param[in]  metric     distance to search by.
+ * @param[in]  pRefs      points to the numRefs x dim reference matrix, row-major.
+ * @param[out] pInvNorms  points to numRefs values for ARM_KNN_COSINE; may be NULL otherwise.
+ */
+void arm_knn_init_f32(
+        arm_knn_instance_f32 * S,
+        uint32_t numRefs,
+        uint32_t dim,
+        arm_knn_metric metric,
+  const float32_t * pRefs,
+        float32_t * pInvNorms);
+
+/**
+ * @brief  Floating-point k-NN search.
+ * @param[in]  S       points to an instance of the search structure.
+ * @param[in]  pQuery  points to the query vector of length dim.
+ * @param[in]  k       number of neighbours wanted.
+ * @param[out] pIndex  points to k reference indices, nearest first.
+ * @param[out] pDist   points to k distances, in the same order.
+ * @return     number of neighbours found, the smaller of k and numRefs
+ */
+uint32_t arm_knn_f32(
+  const arm_knn_instance_f32 * S,
+  const float32_t * pQuery,
+        uint32_t k,
+        uint32_t * pIndex,
+        float32_t * pDist);
+
+/**
+ * @brief  Initialization function for the Q15 k-NN search.
+ * @param[out] S        points to an instance of the search structure.
+ * @param[in]  numRefs  number of reference vectors.
+ * @param[in]  dim      length of each vector.
+ * @param[in]  pRefs    points to the numRefs x dim reference matrix, row-major.
+ * @param[out] pNorms   points to numRefs values.
+ */
+void arm_knn_init_q15(
+        arm_knn_instance_q15 * S,
+        uint32_t numRefs,
+        uint32_t dim,
+  const q15_t * pRefs,
+        q63_t * pNorms);
+
+/**
+ * @brief  Q15 k-NN search by Euclidean distance.
+ * @param[in]  S       points to an instance of the search structure.
+ * @param[in]  pQuery  points to the query vector of length dim.
+ * @param[in]  k       number of neighbours wanted.
+ * @param[out] pIndex  points to k reference indices, nearest first.
+ * @param[out] pDist   points to k squared distances in 34.30 format, in the same order.
+ * @return     number of neighbours found, the smaller of k and numRefs
+ */
+uint32_t arm_knn_q15(
+  const arm_knn_instance_q15 * S,
+  const q15_t * pQuery,
+        uint32_t k,
+        uint32_t * pIndex,
+        q63_t * pDist);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARM_KNN_H */
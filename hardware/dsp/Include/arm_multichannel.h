@@ -0,0 +1,186 @@
+/**
+ * @file arm_multichannel.h
+ * @brief Multi-channel filters in the style of CMSIS-DSP
+ *
+ * The CMSIS-DSP filters take one channel per call (two for the stereo
+ * biquad). These run one set of coefficients over any number of channels
+ * in a single call, so the coefficients are loaded once per sample rather
+ * than once per channel and the channels can share SIMD lanes: AVX2 lanes
+ * on x86 hosts, and on Cortex-M4/M7 the dual 16-bit MACs for q15.
+ *
+ * Coefficient and state conventions follow the single-channel functions
+ * (arm_biquad_cascade_df2T_f32, arm_fir_f32, arm_fir_q15), so existing
+ * coefficient tables can be used unchanged.
+ */
+
+#ifndef ARM_MULTICHANNEL_H
+#define ARM_MULTICHANNEL_H
+
+#include "arm_math.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Arrangement of the channels in the source and destination buffers
+ *
+ * For numChannels channels of blockSize samples each, sample n of channel c
+ * is at [n * numChannels + c] when interleaved and at [c * blockSize + n]
+ * when planar.
+ */
+typedef enum
+{
+  ARM_MULTICHANNEL_INTERLEAVED = 0,
+  ARM_MULTICHANNEL_PLANAR = 1
+} arm_multichannel_layout;
+
+/**
+ * @brief Instance structure for the multi-channel floating-point transposed
+ *        direct form II biquad cascade
+ */
+typedef struct
+{
+  uint16_t numChannels;            /**< number of channels filtered per call. */
+  uint8_t numStages;               /**< number of 2nd order stages in the filter. */
+  arm_multichannel_layout layout;  /**< arrangement of the channels in the buffers. */
+  float32_t *pState;               /**< points to the array of state coefficients. The array is of length 2*numStages*numChannels. */
+  const float32_t *pCoeffs;        /**< points to the array of coefficients. The array is of length 5*numStages. */
+} arm_biquad_cascade_df2T_multi_instance_f32;
+
+/**
+ * @brief Instance structure for the multi-channel floating-point FIR filter
+ */
+typedef struct
+{
+  uint16_t numTaps;                /**< number of filter coefficients in the filter. */
+  uint16_t numChannels;            /**< number of channels filtered per call. */
+  arm_multichannel_layout layout;  /**< arrangement of the channels in the buffers. */
+  uint32_t maxBlockSize;           /**< largest blockSize a call may pass. */
+  float32_t *pState;               /**< points to the state array of length (numTaps+maxBlockSize-1)*numChannels. */
+  const float32_t *pCoeffs;        /**< points to the coefficient array. The array is of length numTaps. */
+} arm_fir_multi_instance_f32;
+
+/**
+ * @brief Instance structure for the multi-channel Q15 FIR filter
+ */
+typedef struct
+{
+  uint16_t numTaps;                /**< number of filter coefficients in the filter. */
+  uint16_t numChannels;            /**< number of channels filtered per call. */
+  arm_multichannel_layout layout;  /**< arrangement of the channels in the buffers. */
+  uint32_t maxBlockSize;           /**< largest blockSize a call may pass. */
+  q15_t *pState;                   /**< points to the state array of length (numTaps+maxBlockSize-1)*numChannels. */
+  const q15_t *pCoeffs;            /**< points to the coefficient array. The array is of length numTaps. */
+} arm_fir_multi_instance_q15;
+
+/**
+ * @brief  Initialization function for the multi-channel floating-point
+ *         transposed direct form II biquad cascade.
+ * @param[in,out] S            points to an instance of the filter structure.
+ * @param[in]     numStages    number of 2nd order stages in the filter.
+ * @param[in]     numChannels  number of channels filtered per call.
+ * @param[in]     layout       arrangement of the channels in the buffers.
+ * @param[in]     pCoeffs      points to the filter coefficients, {b10, b11, b12, a11, a12, b20, ...}
+ *                             as for arm_biquad_cascade_df2T_f32.
+ * @param[in]     pState       points to the state buffer of 2*numStages*numChannels values.
+ */
+void arm_biquad_cascade_df2T_multi_init_f32(
+        arm_biquad_cascade_df2T_multi_instance_f32 * S,
+        uint8_t numStages,
+        uint16_t numChannels,
+        arm_multichannel_layout layout,
+  const float32_t * pCoeffs,
+        float32_t * pState);
+
+/**
+ * @brief  Processing function for the multi-channel floating-point
+ *         transposed direct form II biquad cascade.
+ * @param[in]  S          points to an instance of the filter structure.
+ * @param[in]  pSrc       points to blockSize samples of every channel.
+ * @param[out] pDst       points to blockSize samples of every channel; may be pSrc.
+ * @param[in]  blockSize  number of samples per channel to process.
+ */
+void arm_biquad_cascade_df2T_multi_f32(
+  const arm_biquad_cascade_df2T_multi_instance_f32 * S,
+  const float32_t * pSrc,
+        float32_t * pDst,
+        uint32_t blockSize);
+
+/**
+ * @brief  Initialization function for the multi-channel floating-point FIR filter.
+ * @param[in,out] S            points to an instance of the filter structure.
+ * @param[in]     numTaps      number of filter coefficients in the filter.
+ * @param[in]     numChannels  number of channels filtered per call.
+ * @param[in]     layout       arrangement of the channels in the buffers.
+ * @param[in]     pCoeffs      points to the filter coefficients, in time reversed order as for arm_fir_f32.
+ * @param[in]     pState       points to the state buffer of (numTaps+blockSize-1)*numChannels values.
+ * @param[in]     blockSize    largest number of samples per channel processed per call.
+ */
+void arm_fir_multi_init_f32(
+        arm_fir_multi_instance_f32 * S,
+        uint16_t numTaps,
+        uint16_t numChannels,
+        arm_multichannel_layout layout,
+  const float32_t * pCoeffs,
+        float32_t * pState,
+        uint32_t blockSize);
+
+/**
+ * @brief  Processing function for the multi-channel floating-point FIR filter.
+ * @param[in]  S          points to an instance of the filter structure.
+ * @param[in]  pSrc       points to blockSize samples of every channel.
+ * @param[out] pDst       points to blockSize samples of every channel; may be pSrc.
+ * @param[in]  blockSize  number of samples per channel to process; at most the init blockSize.
+ */
+void arm_fir_multi_f32(
+  const arm_fir_multi_instance_f32 * S,
+  const float32_t * pSrc,
+        float32_t * pDst,
+        uint32_t blockSize);
+
+/**
+ * @brief  Initialization function for the multi-channel Q15 FIR filter.
+ * @param[in,out] S            points to an instance of the filter structure.
+ * @param[in]     numTaps      number of filter coefficients; must be even and at least 4, as for arm_fir_q15.
+ * @param[in]     numChannels  number of channels filtered per call.
+ * @param[in]     layout       arrangement of the channels in the buffers.
+ * @param[in]     pCoeffs      points to the filter coefficients, in time reversed order.
+ * @param[in]     pState       points to the state buffer of (numTaps+blockSize-1)*numChannels values.
+ * @param[in]     blockSize    largest number of samples per channel processed per call.
+ * @return        execution status
+ *                  - \ref ARM_MATH_SUCCESS        : Operation successful
+ *                  - \ref ARM_MATH_ARGUMENT_ERROR : <code>numTaps</code> is not greater than or equal to 4 and even
+ */
+arm_status arm_fir_multi_init_q15(
+        arm_fir_multi_instance_q15 * S,
+        uint16_t numTaps,
+        uint16_t numChannels,
+        arm_multichannel_layout layout,
+  const q15_t * pCoeffs,
+        q15_t * pState,
+        uint32_t blockSize);
+
+/**
+ * @brief  Processing function for the multi-channel Q15 FIR filter.
+ *
+ * Results are bit-exact with arm_fir_q15 run on each channel: products are
+ * summed in a 64-bit accumulator and the result saturated to 1.15.
+ *
+ * @param[in]  S          points to an instance of the filter structure.
+ * @param[in]  pSrc       points to blockSize samples of every channel.
+ * @param[out] pDst       points to blockSize samples of every channel; may be pSrc.
+ * @param[in]  blockSize  number of samples per channel to process; at most the init blockSize.
+ */
+void arm_fir_multi_q15(
+  const arm_fir_multi_instance_q15 * S,
+  const q15_t * pSrc,
+        q15_t * pDst,
+        uint32_t blockSize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARM_MULTICHANNEL_H */
@@ -0,0 +1,114 @@
+/**
+ * @file arm_stream_stats.h
+ * @brief Streaming statistics in the style of CMSIS-DSP
+ *
+ * arm_mean_f32, arm_var_f32, arm_min_f32 and the rest each take a whole
+ * buffer and make their own pass over it. The accumulator here is updated a
+ * sample or a block at a time instead and holds only its running totals, so
+ * statistics of a stream can be kept without storing it. Accumulators of
+ * separate blocks or threads merge into one, and an optional decay factor
+ * makes the mean and variance follow recent samples.
+ *
+ * Only arm_math_types.h is needed, so the firmware can use this without
+ * linking the rest of CMSIS-DSP.
+ */
+
+#ifndef ARM_STREAM_STATS_H
+#define ARM_STREAM_STATS_H
+
+#include "arm_math_types.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Instance structure for the floating-point streaming statistics
+ *
+ * Each sample is weighted by decay^age, age counting the samples that came
+ * after it; with a decay of 1 all weights are 1. count, mean, min and max
+ * can be read directly once count is non-zero. min and max do not decay.
+ */
+typedef struct
+{
+  uint32_t count;                  /**< number of samples accumulated. */
+  float32_t decay;                 /**< weight kept by the past for each new sample, in (0, 1]. */
+  float32_t weight;                /**< sum of the sample weights. */
+  float32_t weight2;               /**< sum of the squared sample weights. */
+  float32_t mean;                  /**< weighted mean. */
+  float32_t m2;                    /**< weighted sum of squared differences from the mean. */
+  float32_t min;                   /**< smallest sample. */
+  float32_t max;                   /**< largest sample. */
+} arm_stream_stats_instance_f32;
+
+/**
+ * @brief  Initialization function for the floating-point streaming statistics.
+ * @param[out] S      points to an instance of the statistics structure.
+ * @param[in]  decay  weight kept by the past for each new sample; 1 for none.
+ */
+void arm_stream_stats_init_f32(
+  arm_stream_stats_instance_f32 * S,
+  float32_t decay);
+
+/**
+ * @brief  Adds one sample to the floating-point streaming statistics.
+ * @param[in,out] S  points to an instance of the statistics structure.
+ * @param[in]     x  sample to add.
+ */
+void arm_stream_stats_sample_f32(
+  arm_stream_stats_instance_f32 * S,
+  float32_t x);
+
+/**
+ * @brief  Adds a block of samples to the floating-point streaming statistics.
+ * @param[in,out] S          points to an instance of the statistics structure.
+ * @param[in]     pSrc       points to the input vector.
+ * @param[in]     blockSize  number of samples in the input vector.
+ */
+void arm_stream_stats_f32(
+        arm_stream_stats_instance_f32 * S,
+  const float32_t * pSrc,
+        uint32_t blockSize);
+
+/**
+ * @brief  Merges two floating-point streaming statistics.
+ * @param[in,out] S       points to the instance that receives the merge.
+ * @param[in]     pOther  points to the instance merged into S.
+ */
+void arm_stream_stats_merge_f32(
+        arm_stream_stats_instance_f32 * S,
+  const arm_stream_stats_instance_f32 * pOther);
+
+/**
+ * @brief  Variance of the samples so far, as arm_var_f32.
+ * @param[in]  S        points to an instance of the statistics structure.
+ * @param[out] pResult  variance value returned here.
+ */
+void arm_stream_stats_var_f32(
+  const arm_stream_stats_instance_f32 * S,
+        float32_t * pResult);
+
+/**
+ * @brief  Standard deviation of the samples so far, as arm_std_f32.
+ * @param[in]  S        points to an instance of the statistics structure.
+ * @param[out] pResult  standard deviation value returned here.
+ */
+void arm_stream_stats_std_f32(
+  const arm_stream_stats_instance_f32 * S,
+        float32_t * pResult);
+
+/**
+ * @brief  Largest absolute value of the samples so far, as arm_absmax_no_idx_f32.
+ * @param[in]  S        points to an instance of the statistics structure.
+ * @param[out] pResult  maximum absolute value returned here.
+ */
+void arm_stream_stats_absmax_f32(
+  const arm_stream_stats_instance_f32 * S,
+        float32_t * pResult);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARM_STREAM_STATS_H */
@@ -0,0 +1,91 @@
+/**
+ * @file arm_dsp_ext_x86.h
+ * @brief Helpers for the AVX2 paths of the CMSIS-DSP additions
+ *
+ * ARM_DSP_EXT_X86 is defined when building for x86 with GCC or Clang.
+ * The AVX2 code is compiled with target attributes and only called when
+ * the CPU has AVX2 and FMA, so the library still runs on older hosts.
+ */
+
+#ifndef ARM_DSP_EXT_X86_H
+#define ARM_DSP_EXT_X86_H
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define ARM_DSP_EXT_X86 1
+
+#include <stdbool.h>
+#include <immintrin.h>
+
+/**
+ * @brief Whether the AVX2/FMA paths can be used on this CPU
+ */
+static inline bool arm_dsp_ext_avx2(void)
+{
+  static int supported = -1;
+
+  if (supported < 0)
+  {
+    __builtin_cpu_init();
+    supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  }
+  return supported;
+}
+
+/**
+ * @brief Transpose eight vectors of eight floats in place
+ */
+__attribute__((target("avx2,fma")))
+static inline void arm_dsp_ext_transpose8(__m256 r[8])
+{
+  __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]);
+  __m256 t1 = _mm256_unpackhi_ps(r[0], r[1]);
+  __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]);
+  __m256 t3 = _mm256_unpackhi_ps(r[2], r[3]);
+  __m256 t4 = _mm256_unpacklo_ps(r[4], r[5]);
+  __m256 t5 = _mm256_unpackhi_ps(r[4], r[5]);
+  __m256 t6 = _mm256_unpacklo_ps(r[6], r[7]);
+  __m256 t7 = _mm256_unpackhi_ps(r[6], r[7]);
+
+  __m256 s0 = _mm256_shuffle_ps(t0, t2, 0x44);
+  __m256 s1 = _mm256_shuffle_ps(t0, t2, 0xEE);
+  __m256 s2 = _mm256_shuffle_ps(t1, t3, 0x44);
+  __m256 s3 = _mm256_shuffle_ps(t1, t3, 0xEE);
+  __m256 s4 = _mm256_shuffle_ps(t4, t6, 0x44);
+  __m256 s5 = _mm256_shuffle_ps(t4, t6, 0xEE);
+  __m256 s6 = _mm256_shuffle_ps(t5, t7, 0x44);
+  __m256 s7 = _mm256_shuffle_ps(t5, t7, 0xEE);
+
+  r[0] = _mm256_permute2f128_ps(s0, s4, 0x20);
+  r[1] = _mm256_permute2f128_ps(s1, s5, 0x20);
+  r[2] = _mm256_permute2f128_ps(s2, s6, 0x20);
+  r[3] = _mm256_permute2f128_ps(s3, s7, 0x20);
+  r[4] = _mm256_permute2f128_ps(s0, s4, 0x31);
+  r[5] = _mm256_permute2f128_ps(s1, s5, 0x31);
+  r[6] = _mm256_permute2f128_ps(s2, s6, 0x31);
+  r[7] = _mm256_permute2f128_ps(s3, s7, 0x31);
+}
+
+/**
+ * @brief Load mask for the first n (0 to 8) lanes, for _mm256_maskload_ps
+ */
+__attribute__((target("avx2,fma")))
+static inline __m256i arm_dsp_ext_tail_mask(uint32_t n)
+{
+  return _mm256_cmpgt_epi32(_mm256_set1_epi32((int32_t)n), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+}
+
+/**
+ * @brief Sums of eight vectors, one per lane
+ */
+__attribute__((target("avx2,fma")))
+static inline __m256 arm_dsp_ext_hsum8(const __m256 a[8])
+{
+  __m256 t0 = _mm256_hadd_ps(_mm256_hadd_ps(a[0], a[1]), _mm256_hadd_ps(a[2], a[3]));
+  __m256 t1 = _mm256_hadd_ps(_mm256_hadd_ps(a[4], a[5]), _mm256_hadd_ps(a[6], a[7]));
+
+  return _mm256_add_ps(_mm256_permute2f128_ps(t0, t1, 0x20), _mm256_permute2f128_ps(t0, t1, 0x31));
+}
+
+#endif
+
+#endif /* ARM_DSP_EXT_X86_H */
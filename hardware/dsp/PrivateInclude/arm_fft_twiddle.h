@@ -0,0 +1,65 @@
+/**
+ * @file arm_fft_twiddle.h
+ * @brief Exact-angle cosines and sines for the FFT table builders
+ *
+ * cosf(2*pi*i/n) loses accuracy as i*2*pi/n grows, since the angle itself is
+ * rounded. The angle is instead reduced to the first octant by whole
+ * quadrants and octant reflection, both exact on the index, so each value is
+ * as accurate as cosf and sinf are near zero.
+ */
+
+#ifndef ARM_FFT_TWIDDLE_H
+#define ARM_FFT_TWIDDLE_H
+
+#include "arm_math_types.h"
+
+/**
+ * @brief cos and sin of 2*pi*i/n, n a power of two of at least 8
+ */
+static inline void arm_fft_cos_sin(
+  uint32_t i,
+  uint32_t n,
+  float32_t * pCos,
+  float32_t * pSin)
+{
+  uint32_t quarter = n >> 2U;
+  uint32_t q = (i / quarter) & 3U;
+  uint32_t m = i % quarter;
+  float32_t c, s;
+
+  /* cos and sin of 2*pi*m/n, m in the first quadrant */
+  if (2U * m <= quarter)
+  {
+    float32_t a = (6.28318530717958647692f * (float32_t) m) / (float32_t) n;
+    c = cosf(a);
+    s = sinf(a);
+  }
+  else
+  {
+    float32_t a = (6.28318530717958647692f * (float32_t) (quarter - m)) / (float32_t) n;
+    c = sinf(a);
+    s = cosf(a);
+  }
+
+  switch (q)
+  {
+  case 0U:
+    *pCos = c;
+    *pSin = s;
+    break;
+  case 1U:
+    *pCos = -s;
+    *pSin = c;
+    break;
+  case 2U:
+    *pCos = -c;
+    *pSin = -s;
+    break;
+  default:
+    *pCos = s;
+    *pSin = -c;
+    break;
+  }
+}
+
+#endif /* ARM_FFT_TWIDDLE_H */
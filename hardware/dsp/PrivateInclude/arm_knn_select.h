@@ -0,0 +1,85 @@
+/**
+ * @file arm_knn_select.h
+ * @brief Keeping the k best candidates of a k-NN search
+ *
+ * k is small next to the number of references, so the best so far are kept
+ * sorted and a candidate is placed by insertion. Of equal distances the
+ * earlier reference stays ahead.
+ */
+
+#ifndef ARM_KNN_SELECT_H
+#define ARM_KNN_SELECT_H
+
+#include "arm_math.h"
+
+/**
+ * @brief Offer a candidate to the held results; returns how many are held
+ */
+static inline uint32_t arm_knn_insert_f32(
+  float32_t * pDist,
+  uint32_t * pIndex,
+  uint32_t held,
+  uint32_t k,
+  float32_t dist,
+  uint32_t index)
+{
+  uint32_t i;
+
+  if (held == k)
+  {
+    if (!(dist < pDist[k - 1U]))
+      return held;
+    i = k - 1U;
+  }
+  else
+  {
+    i = held++;
+  }
+
+  while ((i > 0U) && (dist < pDist[i - 1U]))
+  {
+    pDist[i] = pDist[i - 1U];
+    pIndex[i] = pIndex[i - 1U];
+    i--;
+  }
+  pDist[i] = dist;
+  pIndex[i] = index;
+  return held;
+}
+
+/**
+ * @brief Offer a candidate to the held results; returns how many are held
+ */
+static inline uint32_t arm_knn_insert_q63(
+  q63_t * pDist,
+  uint32_t * pIndex,
+  uint32_t held,
+  uint32_t k,
+  q63_t dist,
+  uint32_t index)
+{
+  uint32_t i;
+
+  if (held == k)
+  {
+    if (dist >= pDist[k - 1U])
+      return held;
+    i = k - 1U;
+  }
+  else
+  {
+    i = held++;
+  }
+
+  while ((i > 0U) && (dist < pDist[i - 1U]))
+  {
+    pDist[i] = pDist[i - 1U];
+    pIndex[i] = pIndex[i - 1U];
+    i--;
+  }
+  pDist[i] = dist;
+  pIndex[i] = index;
+  return held;
+}
+
+#endif /* ARM_KNN_SELECT_H */
@@ -0,0 +1,8 @@
+/**
+ * @file ClassifyBatchFunctions.c
+ * @brief Combination of all batch classifier source files
+ */
+
+#include "arm_svm_linear_predict_batch_f32.c"
+#include "arm_svm_rbf_predict_batch_f32.c"
+#include "arm_gaussian_naive_bayes_predict_batch_f32.c"
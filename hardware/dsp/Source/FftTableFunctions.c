@@ -0,0 +1,8 @@
+/**
+ * @file FftTableFunctions.c
+ * @brief Combination of all FFT table source files
+ */
+
+#include "arm_cfft_twiddle_init_f32.c"
+#include "arm_cfft_bitrev_init_f32.c"
+#include "arm_rfft_fast_twiddle_init_f32.c"
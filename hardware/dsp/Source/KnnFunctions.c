@@ -0,0 +1,9 @@
+/**
+ * @file KnnFunctions.c
+ * @brief Combination of all k-NN search source files
+ */
+
+#include "arm_knn_init_f32.c"
+#include "arm_knn_f32.c"
+#include "arm_knn_init_q15.c"
+#include "arm_knn_q15.c"
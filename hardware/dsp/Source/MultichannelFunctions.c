@@ -0,0 +1,11 @@
+/**
+ * @file MultichannelFunctions.c
+ * @brief Combination of all multi-channel filter source files
+ */
+
+#include "arm_biquad_cascade_df2T_multi_f32.c"
+#include "arm_biquad_cascade_df2T_multi_init_f32.c"
+#include "arm_fir_multi_f32.c"
+#include "arm_fir_multi_init_f32.c"
+#include "arm_fir_multi_q15.c"
+#include "arm_fir_multi_init_q15.c"
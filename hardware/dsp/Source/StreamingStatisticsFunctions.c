@@ -0,0 +1,12 @@
+/**
+ * @file StreamingStatisticsFunctions.c
+ * @brief Combination of all streaming statistics source files
+ */
+
+#include "arm_stream_stats_init_f32.c"
+#include "arm_stream_stats_sample_f32.c"
+#include "arm_stream_stats_f32.c"
+#include "arm_stream_stats_merge_f32.c"
+#include "arm_stream_stats_var_f32.c"
+#include "arm_stream_stats_std_f32.c"
+#include "arm_stream_stats_absmax_f32.c"
@@ -0,0 +1,243 @@
+/**
+ * @file arm_biquad_cascade_df2T_multi_f32.c
+ * @brief Multi-channel floating-point transposed direct form II biquad cascade
+ *
+ * The recursion runs along time, so SIMD goes across channels instead: on
+ * x86 with AVX2, eight channels share each vector. Interleaved buffers give
+ * eight neighbouring channels of a sample in one load; planar buffers are
+ * read eight samples by eight channels at a time and transposed. Channels
+ * left over from a group of eight, and other targets, use the scalar loop,
+ * which still keeps each stage's coefficients in registers for every
+ * channel.
+ */
+
+#include "arm_multichannel.h"
+#include "arm_dsp_ext_x86.h"
+
+/**
+ * @brief Scalar cascade over channels [chFirst, numChannels)
+ */
+static void biquad_multi_scalar(
+  const arm_biquad_cascade_df2T_multi_instance_f32 * S,
+  const float32_t * pSrc,
+        float32_t * pDst,
+        uint32_t blockSize,
+        uint32_t chFirst)
+{
+  uint32_t numChannels = S->numChannels;
+  uint32_t sampleStep = (S->layout == ARM_MULTICHANNEL_INTERLEAVED) ? numChannels : 1U;
+  const float32_t *pCoeffs = S->pCoeffs;
+  const float32_t *pIn = pSrc;
+
+  for (uint32_t stage = 0U; stage < S->numStages; stage++)
+  {
+    float32_t b0 = pCoeffs[0];
+    float32_t b1 = pCoeffs[1];
+    float32_t b2 = pCoeffs[2];
+    float32_t a1 = pCoeffs[3];
+    float32_t a2 = pCoeffs[4];
+    float32_t *pD1 = S->pState + (2U * stage) * numChannels;
+    float32_t *pD2 = pD1 + numChannels;
+
+    for (uint32_t ch = chFirst; ch < numChannels; ch++)
+    {
+      uint32_t first = (S->layout == ARM_MULTICHANNEL_INTERLEAVED) ? ch : ch * blockSize;
+      const float32_t *px = pIn + first;
+      float32_t *py = pDst + first;
+      float32_t d1 = pD1[ch];
+      float32_t d2 = pD2[ch];
+
+      for (uint32_t n = 0U; n < blockSize; n++)
+      {
+        float32_t x = *px;
+        float32_t y = b0 * x + d1;
+        d1 = b1 * x + a1 * y + d2;
+        d2 = b2 * x + a2 * y;
+        *py = y;
+        px += sampleStep;
+        py += sampleStep;
+      }
+
+      pD1[ch] = d1;
+      pD2[ch] = d2;
+    }
+
+    /* Later stages work in place on the output */
+    pIn = pDst;
+    pCoeffs += 5U;
+  }
+}
+
+#ifdef ARM_DSP_EXT_X86
+/**
+ * @brief One sample of eight channels through every stage
+ */
+__attribute__((target("avx2,fma")))
+static inline __m256 biquad_multi_avx2_sample(
+  const arm_biquad_cascade_df2T_multi_instance_f32 * S,
+        float32_t * pState,
+        __m256 x)
+{
+  uint32_t numChannels = S->numChannels;
+  const float32_t *pCoeffs = S->pCoeffs;
+
+  for (uint32_t stage = 0U; stage < S->numStages; stage++)
+  {
+    float32_t *pD1 = pState + (2U * stage) * numChannels;
+    float32_t *pD2 = pD1 + numChannels;
+    __m256 d1 = _mm256_loadu_ps(pD1);
+    __m256 d2 = _mm256_loadu_ps(pD2);
+
+    __m256 y = _mm256_fmadd_ps(_mm256_set1_ps(pCoeffs[0]), x, d1);
+    d1 = _mm256_fmadd_ps(_mm256_set1_ps(pCoeffs[1]), x,
+                         _mm256_fmadd_ps(_mm256_set1_ps(pCoeffs[3]), y, d2));
+    d2 = _mm256_fmadd_ps(_mm256_set1_ps(pCoeffs[2]), x,
+                         _mm256_mul_ps(_mm256_set1_ps(pCoeffs[4]), y));
+
+    _mm256_storeu_ps(pD1, d1);
+    _mm256_storeu_ps(pD2, d2);
+    x = y;
+    pCoeffs += 5U;
+  }
+  return x;
+}
+
+/**
+ * @brief Interleaved channels, eight at a time; returns channels done
+ *
+ * Stage by stage over the block, as the scalar code does, so each stage's
+ * state and coefficients stay in registers along the whole block.
+ */
+__attribute__((target("avx2,fma")))
+static uint32_t biquad_multi_avx2_interleaved(
+  const arm_biquad_cascade_df2T_multi_instance_f32 * S,
+  const float32_t * pSrc,
+        float32_t * pDst,
+        uint32_t blockSize)
+{
+  uint32_t numChannels = S->numChannels;
+  uint32_t ch;
+
+  for (ch = 0U; ch + 8U <= numChannels; ch += 8U)
+  {
+    const float32_t *pCoeffs = S->pCoeffs;
+    const float32_t *pIn = pSrc;
+
+    for (uint32_t stage = 0U; stage < S->numStages; stage++)
+    {
+      __m256 b0 = _mm256_set1_ps(pCoeffs[0]);
+      __m256 b1 = _mm256_set1_ps(pCoeffs[1]);
+      __m256 b2 = _mm256_set1_ps(pCoeffs[2]);
+      __m256 a1 = _mm256_set1_ps(pCoeffs[3]);
+      __m256 a2 = _mm256_set1_ps(pCoeffs[4]);
+      float32_t *pD1 = S->pState + (2U * stage) * numChannels + ch;
+      float32_t *pD2 = pD1 + numChannels;
+      __m256 d1 = _mm256_loadu_ps(pD1);
+      __m256 d2 = _mm256_loadu_ps(pD2);
+
+      for (uint32_t n = 0U; n < blockSize; n++)
+      {
+        __m256 x = _mm256_loadu_ps(pIn + n * numChannels + ch);
+        __m256 y = _mm256_fmadd_ps(b0, x, d1);
+        d1 = _mm256_fmadd_ps(b1, x, _mm256_fmadd_ps(a1, y, d2));
+        d2 = _mm256_fmadd_ps(b2, x, _mm256_mul_ps(a2, y));
+        _mm256_storeu_ps(pDst + n * numChannels + ch, y);
+      }
+
+      _mm256_storeu_ps(pD1, d1);
+      _mm256_storeu_ps(pD2, d2);
+      pIn = pDst;
+      pCoeffs += 5U;
+    }
+  }
+  return ch;
+}
+
+/**
+ * @brief Planar channels, eight at a time; returns channels done
+ *
+ * Tiles of eight samples by eight channels are transposed so that each
+ * vector holds one sample of every channel, run through the cascade, and
+ * transposed back.
+ */
+__attribute__((target("avx2,fma")))
+static uint32_t biquad_multi_avx2_planar(
+  const arm_biquad_cascade_df2T_multi_instance_f32 * S,
+  const float32_t * pSrc,
+        float32_t * pDst,
+        uint32_t blockSize)
+{
+  uint32_t numChannels = S->numChannels;
+  uint32_t ch;
+
+  for (ch = 0U; ch + 8U <= numChannels; ch += 8U)
+  {
+    float32_t *pState = S->pState + ch;
+    const float32_t *pIn = pSrc + ch * blockSize;
+    float32_t *pOut = pDst + ch * blockSize;
+    uint32_t n;
+
+    for (n = 0U; n + 8U <= blockSize; n += 8U)
+    {
+      __m256 tile[8];
+
+      for (uint32_t i = 0U; i < 8U; i++)
+        tile[i] = _mm256_loadu_ps(pIn + i * blockSize + n);
+      arm_dsp_ext_transpose8(tile);
+
+      for (uint32_t i = 0U; i < 8U; i++)
+        tile[i] = biquad_multi_avx2_sample(S, pState, tile[i]);
+
+      arm_dsp_ext_transpose8(tile);
+      for (uint32_t i = 0U; i < 8U; i++)
+        _mm256_storeu_ps(pOut + i * blockSize + n, tile[i]);
+    }
+
+    for (; n < blockSize; n++)
+    {
+      float32_t sample[8];
+
+      for (uint32_t i = 0U; i < 8U; i++)
+        sample[i] = pIn[i * blockSize + n];
+      _mm256_storeu_ps(sample, biquad_multi_avx2_sample(S, pState, _mm256_loadu_ps(sample)));
+      for (uint32_t i = 0U; i < 8U; i++)
+        pOut[i * blockSize + n] = sample[i];
+    }
+  }
+  return ch;
+}
+#endif /* ARM_DSP_EXT_X86 */
+
+/**
+  @brief         Processing function for the multi-channel floating-point
+                 transposed direct form II biquad cascade.
+  @param[in]     S          points to an instance of the filter structure.
+  @param[in]     pSrc       points to blockSize samples of every channel.
+  @param[out]    pDst       points to blockSize samples of every channel.
+  @param[in]     blockSize  number of samples per channel to process.
+
+  @par           Each channel gives the same result as its own
+                 arm_biquad_cascade_df2T_f32 instance with the same
+                 coefficients, up to rounding where fused multiply-add is used.
+ */
+void arm_biquad_cascade_df2T_multi_f32(
+  const arm_biquad_cascade_df2T_multi_instance_f32 * S,
+  const float32_t * pSrc,
+        float32_t * pDst,
+        uint32_t blockSize)
+{
+  uint32_t done = 0U;
+
+#ifdef ARM_DSP_EXT_X86
+  if (arm_dsp_ext_avx2())
+  {
+    if (S->layout == ARM_MULTICHANNEL_INTERLEAVED)
+      done = biquad_multi_avx2_interleaved(S, pSrc, pDst, blockSize);
+    else
+      done = biquad_multi_avx2_planar(S, pSrc, pDst, blockSize);
+  }
+#endif
+
+  if (done < S->numChannels)
+    biquad_multi_scalar(S, pSrc, pDst, blockSize, done);
+}
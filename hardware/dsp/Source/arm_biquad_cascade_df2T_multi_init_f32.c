@@ -0,0 +1,45 @@
+/**
+ * @file arm_biquad_cascade_df2T_multi_init_f32.c
+ * @brief Initialization of the multi-channel floating-point biquad cascade
+ */
+
+#include <string.h>
+
+#include "arm_multichannel.h"
+
+/**
+  @brief         Initialization function for the multi-channel floating-point
+                 transposed direct form II biquad cascade.
+  @param[in,out] S            points to an instance of the filter structure.
+  @param[in]     numStages    number of 2nd order stages in the filter.
+  @param[in]     numChannels  number of channels filtered per call.
+  @param[in]     layout       arrangement of the channels in the buffers.
+  @param[in]     pCoeffs      points to the filter coefficients.
+  @param[in]     pState       points to the state buffer.
+
+  @par           Coefficient and State Ordering
+                   The coefficients are those of arm_biquad_cascade_df2T_f32,
+                   five per stage, shared by every channel:
+  <pre>
+      {b10, b11, b12, a11, a12, b20, b21, b22, a21, a22, ...}
+  </pre>
+                   The state holds d1 and d2 of each stage for every channel,
+                   channel fastest: {d1 stage 1 channels 0..N-1, d2 stage 1
+                   channels 0..N-1, d1 stage 2 ...}. It is zeroed here.
+ */
+void arm_biquad_cascade_df2T_multi_init_f32(
+        arm_biquad_cascade_df2T_multi_instance_f32 * S,
+        uint8_t numStages,
+        uint16_t numChannels,
+        arm_multichannel_layout layout,
+  const float32_t * pCoeffs,
+        float32_t * pState)
+{
+  S->numStages = numStages;
+  S->numChannels = numChannels;
+  S->layout = layout;
+  S->pCoeffs = pCoeffs;
+
+  memset(pState, 0, (2U * numStages * numChannels) * sizeof(float32_t));
+  S->pState = pState;
+}
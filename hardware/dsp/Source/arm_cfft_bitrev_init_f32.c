@@ -0,0 +1,72 @@
+/**
+ * @file arm_cfft_bitrev_init_f32.c
+ * @brief Bit-reversal table of the floating-point complex FFT
+ *
+ * arm_cfft_f32 runs radix-8 stages, after a first radix-2 or radix-4 stage
+ * when the length is not a power of 8, and leaves the outputs in digit
+ * reversed order: frequency k is at the position whose low radix-8 digits
+ * are those of k >> r reversed, and whose top r bits are the low r bits of
+ * k, r being log2(fftLen) mod 3. arm_bitreversal_32 then applies the table
+ * as a list of swaps, each a pair of byte offsets of complex samples. Every
+ * cycle of the permutation becomes a chain of swaps, one fewer than its
+ * length, so the table is as long as the library's own.
+ */
+
+#include "arm_fft_tables.h"
+
+/**
+ * @brief Position of frequency k before bit reversal
+ */
+static uint32_t cfft_position(uint32_t k, uint32_t log2Len)
+{
+  uint32_t lowBits = log2Len % 3U;
+  uint32_t digits = k >> lowBits;
+  uint32_t reversed = 0U;
+
+  for (uint32_t d = 0U; d < log2Len / 3U; d++)
+  {
+    reversed = (reversed << 3U) | (digits & 7U);
+    digits >>= 3U;
+  }
+  return ((k & ((1U << lowBits) - 1U)) << (log2Len - lowBits)) | reversed;
+}
+
+/**
+  @brief         Bit-reversal table of the floating-point complex FFT.
+  @param[out]    pTable  points to at most 2*fftLen values.
+  @param[in]     fftLen  FFT length, a power of two from 16 to 4096.
+  @return        table length, as ARMBITREVINDEXTABLE_N_TABLE_LENGTH
+
+  @par           Details
+                   The table moves samples as armBitRevIndexTableN does; the
+                   order of the swaps may differ.
+ */
+uint16_t arm_cfft_bitrev_init_f32(
+  uint16_t * pTable,
+  uint16_t fftLen)
+{
+  uint32_t log2Len = 0U;
+  uint32_t length = 0U;
+
+  while ((1U << log2Len) < fftLen)
+    log2Len++;
+
+  for (uint32_t k = 0U; k < fftLen; k++)
+  {
+    uint32_t p = cfft_position(k, log2Len);
+
+    /* Each cycle once, from its smallest member */
+    while (p > k)
+      p = cfft_position(p, log2Len);
+    if (p < k)
+      continue;
+
+    /* Position x takes the sample at cfft_position(x) */
+    for (uint32_t x = k; (p = cfft_position(x, log2Len)) != k; x = p)
+    {
+      pTable[length++] = (uint16_t) (x * 8U);
+      pTable[length++] = (uint16_t) (p * 8U);
+    }
+  }
+  return (uint16_t) length;
+}
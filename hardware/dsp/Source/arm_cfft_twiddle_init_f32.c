@@ -0,0 +1,24 @@
+/**
+ * @file arm_cfft_twiddle_init_f32.c
+ * @brief Twiddle factors of the floating-point complex FFT
+ */
+
+#include "arm_fft_tables.h"
+#include "arm_fft_twiddle.h"
+
+/**
+  @brief         Twiddle factors of the floating-point complex FFT.
+  @param[out]    pTwiddle  points to 2*fftLen values.
+  @param[in]     fftLen    FFT length, a power of two from 16 to 4096.
+
+  @par           Details
+                   Entry i is cos(2*pi*i/fftLen), sin(2*pi*i/fftLen), for i
+                   from 0 to fftLen - 1, the layout of twiddleCoef_N.
+ */
+void arm_cfft_twiddle_init_f32(
+  float32_t * pTwiddle,
+  uint16_t fftLen)
+{
+  for (uint32_t i = 0U; i < fftLen; i++)
+    arm_fft_cos_sin(i, fftLen, &pTwiddle[2U * i], &pTwiddle[2U * i + 1U]);
+}
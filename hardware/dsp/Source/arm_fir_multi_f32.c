@@ -0,0 +1,203 @@
+/**
+ * @file arm_fir_multi_f32.c
+ * @brief Multi-channel floating-point FIR filter
+ *
+ * The history of interleaved channels is kept interleaved, so on x86 with
+ * AVX2 each coefficient is broadcast once and applied to eight channels per
+ * load. Planar channels keep planar history and are filtered along time,
+ * eight outputs per vector, with the coefficients shared across channels.
+ * Other targets, and channels left over from a group of eight, use the
+ * scalar loops.
+ */
+
+#include <string.h>
+
+#include "arm_multichannel.h"
+#include "arm_dsp_ext_x86.h"
+
+#ifdef ARM_DSP_EXT_X86
+/**
+ * @brief Interleaved channels, eight at a time; returns channels done
+ */
+__attribute__((target("avx2,fma")))
+static uint32_t fir_multi_avx2_interleaved(
+  const arm_fir_multi_instance_f32 * S,
+  const float32_t * pState,
+        float32_t * pDst,
+        uint32_t blockSize)
+{
+  uint32_t numChannels = S->numChannels;
+  uint32_t numTaps = S->numTaps;
+  const float32_t *pCoeffs = S->pCoeffs;
+  uint32_t ch;
+
+  for (ch = 0U; ch + 8U <= numChannels; ch += 8U)
+  {
+    uint32_t n = 0U;
+
+    /* Four outputs per coefficient broadcast */
+    for (; n + 4U <= blockSize; n += 4U)
+    {
+      const float32_t *px = pState + n * numChannels + ch;
+      __m256 acc0 = _mm256_setzero_ps();
+      __m256 acc1 = _mm256_setzero_ps();
+      __m256 acc2 = _mm256_setzero_ps();
+      __m256 acc3 = _mm256_setzero_ps();
+
+      for (uint32_t k = 0U; k < numTaps; k++)
+      {
+        __m256 c = _mm256_set1_ps(pCoeffs[k]);
+        acc0 = _mm256_fmadd_ps(c, _mm256_loadu_ps(px), acc0);
+        acc1 = _mm256_fmadd_ps(c, _mm256_loadu_ps(px + numChannels), acc1);
+        acc2 = _mm256_fmadd_ps(c, _mm256_loadu_ps(px + 2U * numChannels), acc2);
+        acc3 = _mm256_fmadd_ps(c, _mm256_loadu_ps(px + 3U * numChannels), acc3);
+        px += numChannels;
+      }
+
+      float32_t *py = pDst + n * numChannels + ch;
+      _mm256_storeu_ps(py, acc0);
+      _mm256_storeu_ps(py + numChannels, acc1);
+      _mm256_storeu_ps(py + 2U * numChannels, acc2);
+      _mm256_storeu_ps(py + 3U * numChannels, acc3);
+    }
+
+    for (; n < blockSize; n++)
+    {
+      const float32_t *px = pState + n * numChannels + ch;
+      __m256 acc = _mm256_setzero_ps();
+
+      for (uint32_t k = 0U; k < numTaps; k++)
+      {
+        acc = _mm256_fmadd_ps(_mm256_set1_ps(pCoeffs[k]), _mm256_loadu_ps(px), acc);
+        px += numChannels;
+      }
+      _mm256_storeu_ps(pDst + n * numChannels + ch, acc);
+    }
+  }
+  return ch;
+}
+
+/**
+ * @brief One planar channel, eight outputs at a time; returns outputs done
+ */
+__attribute__((target("avx2,fma")))
+static uint32_t fir_multi_avx2_planar(
+  const float32_t * pCoeffs,
+        uint32_t numTaps,
+  const float32_t * pState,
+        float32_t * pDst,
+        uint32_t blockSize)
+{
+  uint32_t n = 0U;
+
+  for (; n + 16U <= blockSize; n += 16U)
+  {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+
+    for (uint32_t k = 0U; k < numTaps; k++)
+    {
+      __m256 c = _mm256_set1_ps(pCoeffs[k]);
+      acc0 = _mm256_fmadd_ps(c, _mm256_loadu_ps(pState + n + k), acc0);
+      acc1 = _mm256_fmadd_ps(c, _mm256_loadu_ps(pState + n + 8U + k), acc1);
+    }
+    _mm256_storeu_ps(pDst + n, acc0);
+    _mm256_storeu_ps(pDst + n + 8U, acc1);
+  }
+
+  for (; n + 8U <= blockSize; n += 8U)
+  {
+    __m256 acc = _mm256_setzero_ps();
+
+    for (uint32_t k = 0U; k < numTaps; k++)
+      acc = _mm256_fmadd_ps(_mm256_set1_ps(pCoeffs[k]), _mm256_loadu_ps(pState + n + k), acc);
+    _mm256_storeu_ps(pDst + n, acc);
+  }
+  return n;
+}
+#endif /* ARM_DSP_EXT_X86 */
+
+/**
+  @brief         Processing function for the multi-channel floating-point FIR filter.
+  @param[in]     S          points to an instance of the filter structure.
+  @param[in]     pSrc       points to blockSize samples of every channel.
+  @param[out]    pDst       points to blockSize samples of every channel.
+  @param[in]     blockSize  number of samples per channel to process.
+
+  @par           Each channel gives the same result as its own arm_fir_f32
+                 instance with the same coefficients, up to rounding where
+                 fused multiply-add is used.
+ */
+void arm_fir_multi_f32(
+  const arm_fir_multi_instance_f32 * S,
+  const float32_t * pSrc,
+        float32_t * pDst,
+        uint32_t blockSize)
+{
+  uint32_t numTaps = S->numTaps;
+  uint32_t numChannels = S->numChannels;
+  uint32_t history = numTaps - 1U;
+  const float32_t *pCoeffs = S->pCoeffs;
+
+  if (S->layout == ARM_MULTICHANNEL_INTERLEAVED)
+  {
+    float32_t *pState = S->pState;
+    uint32_t ch = 0U;
+
+    /* New samples go after the history, rows of numChannels */
+    memcpy(pState + history * numChannels, pSrc, (blockSize * numChannels) * sizeof(float32_t));
+
+#ifdef ARM_DSP_EXT_X86
+    if (arm_dsp_ext_avx2())
+      ch = fir_multi_avx2_interleaved(S, pState, pDst, blockSize);
+#endif
+
+    for (; ch < numChannels; ch++)
+    {
+      for (uint32_t n = 0U; n < blockSize; n++)
+      {
+        const float32_t *px = pState + n * numChannels + ch;
+        float32_t acc = 0.0f;
+
+        for (uint32_t k = 0U; k < numTaps; k++)
+        {
+          acc += pCoeffs[k] * *px;
+          px += numChannels;
+        }
+        pDst[n * numChannels + ch] = acc;
+      }
+    }
+
+    /* Keep the last numTaps-1 rows for the next call */
+    memmove(pState, pState + blockSize * numChannels, (history * numChannels) * sizeof(float32_t));
+  }
+  else
+  {
+    uint32_t stride = history + S->maxBlockSize;
+
+    for (uint32_t ch = 0U; ch < numChannels; ch++)
+    {
+      float32_t *pState = S->pState + ch * stride;
+      float32_t *py = pDst + ch * blockSize;
+      uint32_t n = 0U;
+
+      memcpy(pState + history, pSrc + ch * blockSize, blockSize * sizeof(float32_t));
+
+#ifdef ARM_DSP_EXT_X86
+      if (arm_dsp_ext_avx2())
+        n = fir_multi_avx2_planar(pCoeffs, numTaps, pState, py, blockSize);
+#endif
+
+      for (; n < blockSize; n++)
+      {
+        float32_t acc = 0.0f;
+
+        for (uint32_t k = 0U; k < numTaps; k++)
+          acc += pCoeffs[k] * pState[n + k];
+        py[n] = acc;
+      }
+
+      memmove(pState, pState + blockSize, history * sizeof(float32_t));
+    }
+  }
+}
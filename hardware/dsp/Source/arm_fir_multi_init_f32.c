@@ -0,0 +1,49 @@
+/**
+ * @file arm_fir_multi_init_f32.c
+ * @brief Initialization of the multi-channel floating-point FIR filter
+ */
+
+#include <string.h>
+
+#include "arm_multichannel.h"
+
+/**
+  @brief         Initialization function for the multi-channel floating-point FIR filter.
+  @param[in,out] S            points to an instance of the filter structure.
+  @param[in]     numTaps      number of filter coefficients in the filter.
+  @param[in]     numChannels  number of channels filtered per call.
+  @param[in]     layout       arrangement of the channels in the buffers.
+  @param[in]     pCoeffs      points to the filter coefficients buffer.
+  @param[in]     pState       points to the state buffer.
+  @param[in]     blockSize    largest number of samples per channel processed per call.
+
+  @par           Details
+                   <code>pCoeffs</code> holds the coefficients in time reversed
+                   order, as for arm_fir_f32:
+  <pre>
+      {b[numTaps-1], b[numTaps-2], b[N-2], ..., b[1], b[0]}
+  </pre>
+                   <code>pState</code> is of length
+                   <code>(numTaps+blockSize-1)*numChannels</code>. It keeps
+                   the history of every channel in the same arrangement as the
+                   data, so that interleaved channels are filtered across
+                   channels and planar channels along time.
+ */
+void arm_fir_multi_init_f32(
+        arm_fir_multi_instance_f32 * S,
+        uint16_t numTaps,
+        uint16_t numChannels,
+        arm_multichannel_layout layout,
+  const float32_t * pCoeffs,
+        float32_t * pState,
+        uint32_t blockSize)
+{
+  S->numTaps = numTaps;
+  S->numChannels = numChannels;
+  S->layout = layout;
+  S->maxBlockSize = blockSize;
+  S->pCoeffs = pCoeffs;
+
+  memset(pState, 0, ((numTaps + (blockSize - 1U)) * numChannels) * sizeof(float32_t));
+  S->pState = pState;
+}
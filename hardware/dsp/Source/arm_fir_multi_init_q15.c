@@ -0,0 +1,59 @@
+/**
+ * @file arm_fir_multi_init_q15.c
+ * @brief Initialization of the multi-channel Q15 FIR filter
+ */
+
+#include <string.h>
+
+#include "arm_multichannel.h"
+
+/**
+  @brief         Initialization function for the multi-channel Q15 FIR filter.
+  @param[in,out] S            points to an instance of the filter structure.
+  @param[in]     numTaps      number of filter coefficients in the filter.
+  @param[in]     numChannels  number of channels filtered per call.
+  @param[in]     layout       arrangement of the channels in the buffers.
+  @param[in]     pCoeffs      points to the filter coefficients buffer.
+  @param[in]     pState       points to the state buffer.
+  @param[in]     blockSize    largest number of samples per channel processed per call.
+  @return        execution status
+                   - \ref ARM_MATH_SUCCESS        : Operation successful
+                   - \ref ARM_MATH_ARGUMENT_ERROR : <code>numTaps</code> is not greater than or equal to 4 and even
+
+  @par           Details
+                   <code>pCoeffs</code> holds the coefficients in time reversed
+                   order, as for arm_fir_q15:
+  <pre>
+      {b[numTaps-1], b[numTaps-2], b[N-2], ..., b[1], b[0]}
+  </pre>
+                   <code>pState</code> is of length
+                   <code>(numTaps+blockSize-1)*numChannels</code>. Whatever the
+                   layout of the data, it keeps each channel's history in one
+                   run, so that pairs of samples and pairs of coefficients can
+                   be read as 32-bit words. As for arm_fir_q15,
+                   <code>numTaps</code> must be even and at least 4; pad an
+                   odd length filter with a zero coefficient.
+ */
+arm_status arm_fir_multi_init_q15(
+        arm_fir_multi_instance_q15 * S,
+        uint16_t numTaps,
+        uint16_t numChannels,
+        arm_multichannel_layout layout,
+  const q15_t * pCoeffs,
+        q15_t * pState,
+        uint32_t blockSize)
+{
+  if ((numTaps < 4U) || (numTaps & 1U))
+    return ARM_MATH_ARGUMENT_ERROR;
+
+  S->numTaps = numTaps;
+  S->numChannels = numChannels;
+  S->layout = layout;
+  S->maxBlockSize = blockSize;
+  S->pCoeffs = pCoeffs;
+
+  memset(pState, 0, ((numTaps + (blockSize - 1U)) * numChannels) * sizeof(q15_t));
+  S->pState = pState;
+
+  return ARM_MATH_SUCCESS;
+}
@@ -0,0 +1,205 @@
+/**
+ * @file arm_fir_multi_q15.c
+ * @brief Multi-channel Q15 FIR filter
+ *
+ * Each channel's history is one contiguous run in the state buffer (new
+ * samples of interleaved channels are spread out into it on the way in),
+ * so on cores with the DSP extension a sample pair and a coefficient pair
+ * are each one 32-bit read, and two channels are filtered per pass with
+ * __SMLALD so that every coefficient pair read serves both. On x86 with
+ * AVX2, _mm256_madd_epi16 does the same for sixteen outputs of a channel at
+ * a time, widening each pair sum to 64 bits before it is accumulated.
+ * Elsewhere the same arithmetic runs one product at a time.
+ */
+
+#include <string.h>
+
+#include "arm_multichannel.h"
+#include "arm_dsp_ext_x86.h"
+
+#ifdef ARM_DSP_EXT_X86
+/**
+ * @brief Whether _mm256_madd_epi16 is exact for these coefficients
+ *
+ * A pair sum only overflows 32 bits when both samples and both
+ * coefficients of the pair are -32768.
+ */
+static bool fir_multi_madd_safe(const q15_t * pCoeffs, uint32_t numTaps)
+{
+  for (uint32_t k = 0U; k < numTaps; k += 2U)
+  {
+    if ((pCoeffs[k] == INT16_MIN) && (pCoeffs[k + 1U] == INT16_MIN))
+      return false;
+  }
+  return true;
+}
+
+/**
+ * @brief One channel, sixteen outputs at a time; returns outputs done
+ */
+__attribute__((target("avx2,fma")))
+static uint32_t fir_multi_avx2_q15(
+  const q15_t * pCoeffs,
+        uint32_t numTaps,
+  const q15_t * pState,
+        q15_t * pDst,
+        uint32_t sampleStep,
+        uint32_t blockSize)
+{
+  uint32_t n = 0U;
+
+  for (; n + 16U <= blockSize; n += 16U)
+  {
+    /* Outputs n+0..3, n+8..11, n+4..7, n+12..15 */
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    __m256i acc2 = _mm256_setzero_si256();
+    __m256i acc3 = _mm256_setzero_si256();
+
+    for (uint32_t k = 0U; k < numTaps; k += 2U)
+    {
+      __m256i c = _mm256_set1_epi32((int32_t)(((uint32_t)(uint16_t)pCoeffs[k + 1U] << 16) |
+                                              (uint16_t)pCoeffs[k]));
+      __m256i x0 = _mm256_loadu_si256((const __m256i *)(pState + n + k));
+      __m256i x1 = _mm256_loadu_si256((const __m256i *)(pState + n + k + 1U));
+
+      /* 32-bit lane j holds samples n+j+k and n+j+k+1 */
+      __m256i lo = _mm256_madd_epi16(_mm256_unpacklo_epi16(x0, x1), c);
+      __m256i hi = _mm256_madd_epi16(_mm256_unpackhi_epi16(x0, x1), c);
+
+      acc0 = _mm256_add_epi64(acc0, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(lo)));
+      acc1 = _mm256_add_epi64(acc1, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(lo, 1)));
+      acc2 = _mm256_add_epi64(acc2, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(hi)));
+      acc3 = _mm256_add_epi64(acc3, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(hi, 1)));
+    }
+
+    int64_t sums[16];
+    _mm256_storeu_si256((__m256i *)&sums[0], acc0);
+    _mm256_storeu_si256((__m256i *)&sums[8], acc1);
+    _mm256_storeu_si256((__m256i *)&sums[4], acc2);
+    _mm256_storeu_si256((__m256i *)&sums[12], acc3);
+
+    for (uint32_t j = 0U; j < 16U; j++)
+      pDst[(n + j) * sampleStep] = (q15_t) (__SSAT((sums[j] >> 15), 16));
+  }
+  return n;
+}
+#endif /* ARM_DSP_EXT_X86 */
+
+/**
+  @brief         Processing function for the multi-channel Q15 FIR filter.
+  @param[in]     S          points to an instance of the filter structure.
+  @param[in]     pSrc       points to blockSize samples of every channel.
+  @param[out]    pDst       points to blockSize samples of every channel.
+  @param[in]     blockSize  number of samples per channel to process.
+
+  @par           Scaling and Overflow Behavior
+                   As arm_fir_q15: 1.15 x 1.15 products are accumulated in a
+                   64-bit accumulator in 34.30 format, then shifted right by
+                   15 bits and saturated to 1.15.
+ */
+void arm_fir_multi_q15(
+  const arm_fir_multi_instance_q15 * S,
+  const q15_t * pSrc,
+        q15_t * pDst,
+        uint32_t blockSize)
+{
+  uint32_t numTaps = S->numTaps;
+  uint32_t numChannels = S->numChannels;
+  uint32_t history = numTaps - 1U;
+  uint32_t stride = history + S->maxBlockSize;
+  uint32_t sampleStep = (S->layout == ARM_MULTICHANNEL_INTERLEAVED) ? numChannels : 1U;
+  uint32_t channelStep = (S->layout == ARM_MULTICHANNEL_INTERLEAVED) ? 1U : blockSize;
+  const q15_t *pCoeffs = S->pCoeffs;
+  uint32_t ch;
+
+  /* New samples of each channel go after its history */
+  for (ch = 0U; ch < numChannels; ch++)
+  {
+    const q15_t *px = pSrc + ch * channelStep;
+    q15_t *pState = S->pState + ch * stride + history;
+
+    for (uint32_t n = 0U; n < blockSize; n++)
+    {
+      pState[n] = *px;
+      px += sampleStep;
+    }
+  }
+
+  ch = 0U;
+
+#ifdef ARM_DSP_EXT_X86
+  if (arm_dsp_ext_avx2() && fir_multi_madd_safe(pCoeffs, numTaps))
+  {
+    for (ch = 0U; ch < numChannels; ch++)
+    {
+      const q15_t *pState = S->pState + ch * stride;
+      q15_t *py = pDst + ch * channelStep;
+      uint32_t n = fir_multi_avx2_q15(pCoeffs, numTaps, pState, py, sampleStep, blockSize);
+
+      for (; n < blockSize; n++)
+      {
+        q63_t acc = 0;
+
+        for (uint32_t k = 0U; k < numTaps; k++)
+          acc += (q31_t) pState[n + k] * pCoeffs[k];
+
+        py[n * sampleStep] = (q15_t) (__SSAT((acc >> 15), 16));
+      }
+    }
+  }
+#endif
+
+#if defined (ARM_MATH_DSP)
+  /* Two channels per pass, sharing each coefficient pair */
+  for (; ch + 2U <= numChannels; ch += 2U)
+  {
+    const q15_t *pState0 = S->pState + ch * stride;
+    const q15_t *pState1 = pState0 + stride;
+    q15_t *py0 = pDst + ch * channelStep;
+    q15_t *py1 = py0 + channelStep;
+
+    for (uint32_t n = 0U; n < blockSize; n++)
+    {
+      const q15_t *px0 = pState0 + n;
+      const q15_t *px1 = pState1 + n;
+      const q15_t *pb = pCoeffs;
+      q63_t acc0 = 0;
+      q63_t acc1 = 0;
+
+      for (uint32_t k = numTaps >> 1U; k > 0U; k--)
+      {
+        q31_t c = read_q15x2_ia(&pb);
+        acc0 = __SMLALD(read_q15x2_ia(&px0), c, acc0);
+        acc1 = __SMLALD(read_q15x2_ia(&px1), c, acc1);
+      }
+
+      py0[n * sampleStep] = (q15_t) (__SSAT((acc0 >> 15), 16));
+      py1[n * sampleStep] = (q15_t) (__SSAT((acc1 >> 15), 16));
+    }
+  }
+#endif /* defined (ARM_MATH_DSP) */
+
+  for (; ch < numChannels; ch++)
+  {
+    const q15_t *pState = S->pState + ch * stride;
+    q15_t *py = pDst + ch * channelStep;
+
+    for (uint32_t n = 0U; n < blockSize; n++)
+    {
+      q63_t acc = 0;
+
+      for (uint32_t k = 0U; k < numTaps; k++)
+        acc += (q31_t) pState[n + k] * pCoeffs[k];
+
+      py[n * sampleStep] = (q15_t) (__SSAT((acc >> 15), 16));
+    }
+  }
+
+  /* Keep the last numTaps-1 samples of each channel for the next call */
+  for (ch = 0U; ch < numChannels; ch++)
+  {
+    q15_t *pState = S->pState + ch * stride;
+    memmove(pState, pState + blockSize, history * sizeof(q15_t));
+  }
+}
@@ -0,0 +1,170 @@
+/**
+ * @file arm_gaussian_naive_bayes_predict_batch_f32.c
+ * @brief Naive Gaussian Bayesian prediction for many vectors
+ *
+ * arm_gaussian_naive_bayes_predict_f32 takes a logarithm for every class
+ * and dimension on every call. The log terms and the reciprocal variances
+ * do not depend on the input, so here they are computed once per call,
+ * leaving a weighted squared distance per class and input. Inputs are taken
+ * in groups and each class is compared with the whole group before moving
+ * on: four inputs per group in the scalar code, eight on x86 with AVX2.
+ */
+
+#include "arm_classify_batch.h"
+#include "arm_dsp_ext_x86.h"
+
+#define PI_F 3.1415926535897932384626433832795f
+
+#ifdef ARM_DSP_EXT_X86
+/**
+ * @brief Inputs eight at a time; returns inputs done
+ */
+__attribute__((target("avx2,fma")))
+static uint32_t bayes_batch_avx2(
+  const arm_gaussian_naive_bayes_instance_f32 * S,
+  const float32_t * pIn,
+        uint32_t numVectors,
+        uint32_t * pResult,
+  const float32_t * pInvVar,
+  const float32_t * pConst)
+{
+  uint32_t dim = S->vectorDimension;
+  uint32_t dim8 = dim & ~7U;
+  __m256i tailMask = arm_dsp_ext_tail_mask(dim - dim8);
+  uint32_t n;
+
+  for (n = 0U; n + 8U <= numVectors; n += 8U)
+  {
+    const float32_t *px = pIn + n * dim;
+    __m256 best = _mm256_set1_ps(-INFINITY);
+    __m256i bestClass = _mm256_setzero_si256();
+
+    for (uint32_t c = 0U; c < S->numberOfClasses; c++)
+    {
+      const float32_t *pTheta = S->theta + c * dim;
+      const float32_t *pIv = pInvVar + c * dim;
+      __m256 acc[8];
+      uint32_t d, t;
+
+      #pragma GCC unroll 8
+      for (t = 0U; t < 8U; t++)
+        acc[t] = _mm256_setzero_ps();
+
+      for (d = 0U; d < dim8; d += 8U)
+      {
+        __m256 theta = _mm256_loadu_ps(pTheta + d);
+        __m256 iv = _mm256_loadu_ps(pIv + d);
+        #pragma GCC unroll 8
+        for (t = 0U; t < 8U; t++)
+        {
+          __m256 diff = _mm256_sub_ps(_mm256_loadu_ps(px + t * dim + d), theta);
+          acc[t] = _mm256_fmadd_ps(_mm256_mul_ps(diff, diff), iv, acc[t]);
+        }
+      }
+      if (d < dim)
+      {
+        __m256 theta = _mm256_maskload_ps(pTheta + d, tailMask);
+        __m256 iv = _mm256_maskload_ps(pIv + d, tailMask);
+        #pragma GCC unroll 8
+        for (t = 0U; t < 8U; t++)
+        {
+          __m256 diff = _mm256_sub_ps(_mm256_maskload_ps(px + t * dim + d, tailMask), theta);
+          acc[t] = _mm256_fmadd_ps(_mm256_mul_ps(diff, diff), iv, acc[t]);
+        }
+      }
+
+      __m256 score = _mm256_fnmadd_ps(_mm256_set1_ps(0.5f), arm_dsp_ext_hsum8(acc),
+                                      _mm256_set1_ps(pConst[c]));
+      __m256 better = _mm256_cmp_ps(score, best, _CMP_GT_OQ);
+      best = _mm256_blendv_ps(best, score, better);
+      bestClass = _mm256_blendv_epi8(bestClass, _mm256_set1_epi32((int32_t)c), _mm256_castps_si256(better));
+    }
+
+    _mm256_storeu_si256((__m256i *)(pResult + n), bestClass);
+  }
+  return n;
+}
+#endif /* ARM_DSP_EXT_X86 */
+
+/**
+  @brief         Naive Gaussian Bayesian prediction for many vectors.
+  @param[in]     S          points to a naive Bayes instance structure.
+  @param[in]     pIn        points to the input vectors, row-major.
+  @param[in]     numVectors number of input vectors.
+  @param[out]    pResult    points to the class indices.
+  @param[out]    pBuffer    points to a scratch buffer of numberOfClasses*(vectorDimension+1) values.
+
+  @par           Each index is that of arm_gaussian_naive_bayes_predict_f32
+                 on the same vector, except where two classes are within
+                 rounding of each other. As there, the first of equal
+                 classes wins.
+ */
+void arm_gaussian_naive_bayes_predict_batch_f32(
+  const arm_gaussian_naive_bayes_instance_f32 * S,
+  const float32_t * pIn,
+        uint32_t numVectors,
+        uint32_t * pResult,
+        float32_t * pBuffer)
+{
+  uint32_t dim = S->vectorDimension;
+  uint32_t numClasses = S->numberOfClasses;
+  float32_t *pInvVar = pBuffer;
+  float32_t *pConst = pBuffer + numClasses * dim;
+  uint32_t n = 0U;
+
+  /* log prior - 0.5 * sum log(2 pi sigma), and 1/sigma, for each class */
+  for (uint32_t c = 0U; c < numClasses; c++)
+  {
+    float32_t logs = 0.0f;
+
+    for (uint32_t d = 0U; d < dim; d++)
+    {
+      float32_t sigma = S->sigma[c * dim + d] + S->epsilon;
+
+      logs += logf(2.0f * PI_F * sigma);
+      pInvVar[c * dim + d] = 1.0f / sigma;
+    }
+    pConst[c] = logf(S->classPriors[c]) - 0.5f * logs;
+  }
+
+#ifdef ARM_DSP_EXT_X86
+  if (arm_dsp_ext_avx2())
+    n = bayes_batch_avx2(S, pIn, numVectors, pResult, pInvVar, pConst);
+#endif
+
+  /* Four inputs per pass over the classes */
+  for (; n < numVectors; n += 4U)
+  {
+    uint32_t group = ((numVectors - n) < 4U) ? (numVectors - n) : 4U;
+    const float32_t *px = pIn + n * dim;
+    float32_t best[4] = { -INFINITY, -INFINITY, -INFINITY, -INFINITY };
+    uint32_t bestClass[4] = { 0U, 0U, 0U, 0U };
+
+    for (uint32_t c = 0U; c < numClasses; c++)
+    {
+      const float32_t *pTheta = S->theta + c * dim;
+      const float32_t *pIv = pInvVar + c * dim;
+      float32_t acc[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+      for (uint32_t d = 0U; d < dim; d++)
+      {
+        for (uint32_t t = 0U; t < group; t++)
+          acc[t] += SQ(px[t * dim + d] - pTheta[d]) * pIv[d];
+      }
+
+      for (uint32_t t = 0U; t < group; t++)
+      {
+        float32_t score = pConst[c] - 0.5f * acc[t];
+
+        if (score > best[t])
+        {
+          best[t] = score;
+          bestClass[t] = c;
+        }
+      }
+    }
+
+    for (uint32_t t = 0U; t < group; t++)
+      pResult[n + t] = bestClass[t];
+  }
+}
@@ -0,0 +1,290 @@
+/**
+ * @file arm_knn_f32.c
+ * @brief Floating-point k-NN search
+ *
+ * Distances are ranked by a key that is cheaper than the distance itself:
+ * the squared distance for Euclidean, so only the k results take a square
+ * root. Euclidean and city block partial sums only grow, so every
+ * KNN_BLOCK elements the partial sum is compared with the k-th best so far
+ * and the reference is dropped once it cannot beat it. On x86 with AVX2,
+ * four references are compared per pass, eight elements at a time, and
+ * dropped together once all four are out. Other targets compare one
+ * reference at a time with four independent sums.
+ */
+
+#include "arm_knn.h"
+#include "arm_knn_select.h"
+#include "arm_dsp_ext_x86.h"
+
+/* Elements compared between checks against the k-th best */
+#define KNN_BLOCK 32U
+
+/**
+ * @brief Ranking key of one reference, or some value >= threshold once it
+ *        cannot make the results
+ */
+static float32_t knn_key_f32(
+        arm_knn_metric metric,
+  const float32_t * pQuery,
+  const float32_t * pRef,
+        uint32_t dim,
+        float32_t threshold)
+{
+  float32_t acc = 0.0f;
+  uint32_t d = 0U;
+
+  while (d < dim)
+  {
+    uint32_t end = ((dim - d) > KNN_BLOCK) ? (d + KNN_BLOCK) : dim;
+    float32_t acc0 = 0.0f, acc1 = 0.0f, acc2 = 0.0f, acc3 = 0.0f;
+
+    for (; d + 4U <= end; d += 4U)
+    {
+      float32_t x0 = pRef[d] - pQuery[d];
+      float32_t x1 = pRef[d + 1U] - pQuery[d + 1U];
+      float32_t x2 = pRef[d + 2U] - pQuery[d + 2U];
+      float32_t x3 = pRef[d + 3U] - pQuery[d + 3U];
+
+      if (metric == ARM_KNN_EUCLIDEAN)
+      {
+        acc0 += x0 * x0;
+        acc1 += x1 * x1;
+        acc2 += x2 * x2;
+        acc3 += x3 * x3;
+      }
+      else if (metric == ARM_KNN_CITYBLOCK)
+      {
+        acc0 += fabsf(x0);
+        acc1 += fabsf(x1);
+        acc2 += fabsf(x2);
+        acc3 += fabsf(x3);
+      }
+      else
+      {
+        acc0 += pRef[d] * pQuery[d];
+        acc1 += pRef[d + 1U] * pQuery[d + 1U];
+        acc2 += pRef[d + 2U] * pQuery[d + 2U];
+        acc3 += pRef[d + 3U] * pQuery[d + 3U];
+      }
+    }
+
+    for (; d < end; d++)
+    {
+      float32_t x = pRef[d] - pQuery[d];
+
+      if (metric == ARM_KNN_EUCLIDEAN)
+        acc0 += x * x;
+      else if (metric == ARM_KNN_CITYBLOCK)
+        acc0 += fabsf(x);
+      else
+        acc0 += pRef[d] * pQuery[d];
+    }
+
+    acc += (acc0 + acc1) + (acc2 + acc3);
+    if ((metric != ARM_KNN_COSINE) && (acc >= threshold))
+      break;
+  }
+  return acc;
+}
+
+#ifdef ARM_DSP_EXT_X86
+/**
+ * @brief Sums of four vectors, one per lane
+ */
+__attribute__((target("avx2,fma")))
+static inline __m128 knn_hsum4(__m256 a0, __m256 a1, __m256 a2, __m256 a3)
+{
+  __m256 t = _mm256_hadd_ps(_mm256_hadd_ps(a0, a1), _mm256_hadd_ps(a2, a3));
+  return _mm_add_ps(_mm256_castps256_ps128(t), _mm256_extractf128_ps(t, 1));
+}
+
+__attribute__((target("avx2,fma"), always_inline))
+static inline __m256 knn_avx2_acc(arm_knn_metric metric, __m256 acc, __m256 q, __m256 r)
+{
+  if (metric == ARM_KNN_EUCLIDEAN)
+  {
+    __m256 x = _mm256_sub_ps(r, q);
+    return _mm256_fmadd_ps(x, x, acc);
+  }
+  if (metric == ARM_KNN_CITYBLOCK)
+  {
+    __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    return _mm256_add_ps(acc, _mm256_and_ps(absMask, _mm256_sub_ps(r, q)));
+  }
+  return _mm256_fmadd_ps(r, q, acc);
+}
+
+/**
+ * @brief References four at a time; returns references done
+ *
+ * Inlined into one copy per metric so that the inner loop has no branches.
+ */
+__attribute__((target("avx2,fma"), always_inline))
+static inline uint32_t knn_avx2_metric(
+  const arm_knn_instance_f32 * S,
+  const float32_t * pQuery,
+        uint32_t k,
+        uint32_t * pIndex,
+        float32_t * pKey,
+        uint32_t * pHeld,
+        float32_t invQuery,
+        arm_knn_metric metric)
+{
+  uint32_t dim = S->dim;
+  uint32_t dim8 = dim & ~7U;
+  uint32_t held = *pHeld;
+  uint32_t m;
+  __m256i tailMask = arm_dsp_ext_tail_mask(dim - dim8);
+
+  for (m = 0U; m + 4U <= S->numRefs; m += 4U)
+  {
+    const float32_t *r0 = S->pRefs + m * dim;
+    const float32_t *r1 = r0 + dim;
+    const float32_t *r2 = r1 + dim;
+    const float32_t *r3 = r2 + dim;
+    __m256 a0 = _mm256_setzero_ps();
+    __m256 a1 = _mm256_setzero_ps();
+    __m256 a2 = _mm256_setzero_ps();
+    __m256 a3 = _mm256_setzero_ps();
+    float32_t threshold = (held == k) ? pKey[k - 1U] : FLT_MAX;
+    bool dropped = false;
+    uint32_t d = 0U;
+
+    while (d < dim8)
+    {
+      uint32_t end = ((dim8 - d) > KNN_BLOCK) ? (d + KNN_BLOCK) : dim8;
+
+      for (; d < end; d += 8U)
+      {
+        __m256 q = _mm256_loadu_ps(pQuery + d);
+        a0 = knn_avx2_acc(metric, a0, q, _mm256_loadu_ps(r0 + d));
+        a1 = knn_avx2_acc(metric, a1, q, _mm256_loadu_ps(r1 + d));
+        a2 = knn_avx2_acc(metric, a2, q, _mm256_loadu_ps(r2 + d));
+        a3 = knn_avx2_acc(metric, a3, q, _mm256_loadu_ps(r3 + d));
+      }
+
+      if ((metric != ARM_KNN_COSINE) && (held == k) && (d < dim))
+      {
+        __m128 sums = knn_hsum4(a0, a1, a2, a3);
+        if (_mm_movemask_ps(_mm_cmpge_ps(sums, _mm_set1_ps(threshold))) == 0xF)
+        {
+          dropped = true;
+          break;
+        }
+      }
+    }
+    if (dropped)
+      continue;
+
+    if (d < dim)
+    {
+      /* Masked-off lanes load as zero and add nothing */
+      __m256 q = _mm256_maskload_ps(pQuery + d, tailMask);
+      a0 = knn_avx2_acc(metric, a0, q, _mm256_maskload_ps(r0 + d, tailMask));
+      a1 = knn_avx2_acc(metric, a1, q, _mm256_maskload_ps(r1 + d, tailMask));
+      a2 = knn_avx2_acc(metric, a2, q, _mm256_maskload_ps(r2 + d, tailMask));
+      a3 = knn_avx2_acc(metric, a3, q, _mm256_maskload_ps(r3 + d, tailMask));
+    }
+
+    float32_t sums[4];
+    _mm_storeu_ps(sums, knn_hsum4(a0, a1, a2, a3));
+
+    for (uint32_t i = 0U; i < 4U; i++)
+    {
+      float32_t key = sums[i];
+
+      if (metric == ARM_KNN_COSINE)
+        key = 1.0f - key * S->pInvNorms[m + i] * invQuery;
+      held = arm_knn_insert_f32(pKey, pIndex, held, k, key, m + i);
+    }
+  }
+
+  *pHeld = held;
+  return m;
+}
+
+__attribute__((target("avx2,fma")))
+static uint32_t knn_avx2_f32(
+  const arm_knn_instance_f32 * S,
+  const float32_t * pQuery,
+        uint32_t k,
+        uint32_t * pIndex,
+        float32_t * pKey,
+        uint32_t * pHeld,
+        float32_t invQuery)
+{
+  switch (S->metric)
+  {
+  case ARM_KNN_EUCLIDEAN:
+    return knn_avx2_metric(S, pQuery, k, pIndex, pKey, pHeld, invQuery, ARM_KNN_EUCLIDEAN);
+  case ARM_KNN_CITYBLOCK:
+    return knn_avx2_metric(S, pQuery, k, pIndex, pKey, pHeld, invQuery, ARM_KNN_CITYBLOCK);
+  default:
+    return knn_avx2_metric(S, pQuery, k, pIndex, pKey, pHeld, invQuery, ARM_KNN_COSINE);
+  }
+}
+#endif /* ARM_DSP_EXT_X86 */
+
+/**
+  @brief         Floating-point k-NN search.
+  @param[in]     S          points to an instance of the search structure.
+  @param[in]     pQuery     points to the query vector.
+  @param[in]     k          number of neighbours wanted.
+  @param[out]    pIndex     points to the reference indices, nearest first.
+  @param[out]    pDist      points to the distances, in the same order.
+  @return        number of neighbours found, the smaller of k and numRefs
+
+  @par           Details
+                   The distances are those the matching DistanceFunctions
+                   function would give, up to rounding. Of references at
+                   equal distance, the lower index comes first.
+ */
+uint32_t arm_knn_f32(
+  const arm_knn_instance_f32 * S,
+  const float32_t * pQuery,
+        uint32_t k,
+        uint32_t * pIndex,
+        float32_t * pDist)
+{
+  arm_knn_metric metric = S->metric;
+  float32_t invQuery = 0.0f;
+  uint32_t held = 0U;
+  uint32_t m = 0U;
+
+  if (k > S->numRefs)
+    k = S->numRefs;
+  if (k == 0U)
+    return 0U;
+
+  if (metric == ARM_KNN_COSINE)
+  {
+    float32_t sumSq = 0.0f;
+
+    for (uint32_t d = 0U; d < S->dim; d++)
+      sumSq += pQuery[d] * pQuery[d];
+    invQuery = (sumSq > 0.0f) ? (1.0f / sqrtf(sumSq)) : 0.0f;
+  }
+
+  /* pDist holds the ranking keys until the end */
+#ifdef ARM_DSP_EXT_X86
+  if (arm_dsp_ext_avx2())
+    m = knn_avx2_f32(S, pQuery, k, pIndex, pDist, &held, invQuery);
+#endif
+
+  for (; m < S->numRefs; m++)
+  {
+    float32_t threshold = (held == k) ? pDist[k - 1U] : FLT_MAX;
+    float32_t key = knn_key_f32(metric, pQuery, S->pRefs + m * S->dim, S->dim, threshold);
+
+    if (metric == ARM_KNN_COSINE)
+      key = 1.0f - key * S->pInvNorms[m] * invQuery;
+    held = arm_knn_insert_f32(pDist, pIndex, held, k, key, m);
+  }
+
+  if (metric == ARM_KNN_EUCLIDEAN)
+  {
+    for (uint32_t i = 0U; i < held; i++)
+      pDist[i] = sqrtf(pDist[i]);
+  }
+  return held;
+}
@@ -0,0 +1,50 @@
+/**
+ * @file arm_knn_init_f32.c
+ * @brief Initialization of the floating-point k-NN search
+ */
+
+#include "arm_knn.h"
+
+/**
+  @brief         Initialization function for the floating-point k-NN search.
+  @param[out]    S          points to an instance of the search structure.
+  @param[in]     numRefs    number of reference vectors.
+  @param[in]     dim        length of each vector.
+  @param[in]     metric     distance to search by.
+  @param[in]     pRefs      points to the reference matrix.
+  @param[out]    pInvNorms  points to the reciprocal norm buffer, or NULL.
+
+  @par           Details
+                   For ARM_KNN_COSINE the reciprocal of each row's norm is
+                   computed here once, so that each search needs only the
+                   dot products. A row of zeros gets 0, which puts it at
+                   distance 1 from every query.
+ */
+void arm_knn_init_f32(
+        arm_knn_instance_f32 * S,
+        uint32_t numRefs,
+        uint32_t dim,
+        arm_knn_metric metric,
+  const float32_t * pRefs,
+        float32_t * pInvNorms)
+{
+  S->numRefs = numRefs;
+  S->dim = dim;
+  S->metric = metric;
+  S->pRefs = pRefs;
+  S->pInvNorms = pInvNorms;
+
+  if (metric != ARM_KNN_COSINE)
+    return;
+
+  for (uint32_t m = 0U; m < numRefs; m++)
+  {
+    const float32_t *pr = pRefs + m * dim;
+    float32_t sumSq = 0.0f;
+
+    for (uint32_t d = 0U; d < dim; d++)
+      sumSq += pr[d] * pr[d];
+
+    pInvNorms[m] = (sumSq > 0.0f) ? (1.0f / sqrtf(sumSq)) : 0.0f;
+  }
+}
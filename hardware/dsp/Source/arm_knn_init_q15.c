@@ -0,0 +1,43 @@
+/**
+ * @file arm_knn_init_q15.c
+ * @brief Initialization of the Q15 k-NN search
+ */
+
+#include "arm_knn.h"
+
+/**
+  @brief         Initialization function for the Q15 k-NN search.
+  @param[out]    S          points to an instance of the search structure.
+  @param[in]     numRefs    number of reference vectors.
+  @param[in]     dim        length of each vector.
+  @param[in]     pRefs      points to the reference matrix.
+  @param[out]    pNorms     points to the squared norm buffer.
+
+  @par           Details
+                   The squared norm of each row, in 34.30 format, is
+                   computed here once; a search then needs only the dot
+                   product of the query with each row.
+ */
+void arm_knn_init_q15(
+        arm_knn_instance_q15 * S,
+        uint32_t numRefs,
+        uint32_t dim,
+  const q15_t * pRefs,
+        q63_t * pNorms)
+{
+  S->numRefs = numRefs;
+  S->dim = dim;
+  S->pRefs = pRefs;
+  S->pNorms = pNorms;
+
+  for (uint32_t m = 0U; m < numRefs; m++)
+  {
+    const q15_t *pr = pRefs + m * dim;
+    q63_t sumSq = 0;
+
+    for (uint32_t d = 0U; d < dim; d++)
+      sumSq += (q31_t) pr[d] * pr[d];
+
+    pNorms[m] = sumSq;
+  }
+}
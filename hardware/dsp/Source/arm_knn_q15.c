@@ -0,0 +1,195 @@
+/**
+ * @file arm_knn_q15.c
+ * @brief Q15 k-NN search
+ *
+ * The squared distance is expanded as |q|^2 + |r|^2 - 2 q.r, with |r|^2
+ * computed once at init, so the search is a dot product per reference and
+ * runs on the dual 16-bit MACs: on cores with the DSP extension two
+ * references are compared per pass with __SMLALD, each pair of query
+ * samples read once for both; on x86 with AVX2, _mm256_madd_epi16 does
+ * sixteen samples of two references at a time, widening each pair sum to
+ * 64 bits. All sums are exact, so every path gives the same results.
+ */
+
+#include "arm_knn.h"
+#include "arm_knn_select.h"
+#include "arm_dsp_ext_x86.h"
+
+#ifdef ARM_DSP_EXT_X86
+/**
+ * @brief Whether _mm256_madd_epi16 is exact for this query
+ *
+ * A pair sum only overflows 32 bits when both samples of the query pair
+ * and of the reference pair are -32768.
+ */
+static bool knn_madd_safe(const q15_t * pQuery, uint32_t dim)
+{
+  for (uint32_t d = 0U; d + 1U < dim; d += 2U)
+  {
+    if ((pQuery[d] == INT16_MIN) && (pQuery[d + 1U] == INT16_MIN))
+      return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Sum of the four 64-bit lanes
+ */
+__attribute__((target("avx2,fma")))
+static inline q63_t knn_hsum_epi64(__m256i acc)
+{
+  __m128i s = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+  return _mm_cvtsi128_si64(s) + _mm_extract_epi64(s, 1);
+}
+
+/**
+ * @brief Dot products of the query with references two at a time
+ *
+ * Fills pDot for references [0, numRefs & ~1) and returns how many.
+ */
+__attribute__((target("avx2,fma")))
+static uint32_t knn_avx2_q15(
+  const arm_knn_instance_q15 * S,
+  const q15_t * pQuery,
+        q63_t * pDot)
+{
+  uint32_t dim = S->dim;
+  uint32_t m;
+
+  for (m = 0U; m + 2U <= S->numRefs; m += 2U)
+  {
+    const q15_t *r0 = S->pRefs + m * dim;
+    const q15_t *r1 = r0 + dim;
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    uint32_t d = 0U;
+
+    for (; d + 16U <= dim; d += 16U)
+    {
+      __m256i q = _mm256_loadu_si256((const __m256i *)(pQuery + d));
+      __m256i p0 = _mm256_madd_epi16(q, _mm256_loadu_si256((const __m256i *)(r0 + d)));
+      __m256i p1 = _mm256_madd_epi16(q, _mm256_loadu_si256((const __m256i *)(r1 + d)));
+
+      acc0 = _mm256_add_epi64(acc0, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(p0)));
+      acc0 = _mm256_add_epi64(acc0, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(p0, 1)));
+      acc1 = _mm256_add_epi64(acc1, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(p1)));
+      acc1 = _mm256_add_epi64(acc1, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(p1, 1)));
+    }
+
+    q63_t dot0 = knn_hsum_epi64(acc0);
+    q63_t dot1 = knn_hsum_epi64(acc1);
+
+    for (; d < dim; d++)
+    {
+      dot0 += (q31_t) pQuery[d] * r0[d];
+      dot1 += (q31_t) pQuery[d] * r1[d];
+    }
+
+    pDot[0] = dot0;
+    pDot[1] = dot1;
+    pDot += 2;
+  }
+  return m;
+}
+#endif /* ARM_DSP_EXT_X86 */
+
+/**
+  @brief         Q15 k-NN search by Euclidean distance.
+  @param[in]     S          points to an instance of the search structure.
+  @param[in]     pQuery     points to the query vector.
+  @param[in]     k          number of neighbours wanted.
+  @param[out]    pIndex     points to the reference indices, nearest first.
+  @param[out]    pDist      points to the squared distances, in the same order.
+  @return        number of neighbours found, the smaller of k and numRefs
+
+  @par           Scaling and Overflow Behavior
+                   1.15 x 1.15 products are summed exactly in 64 bits, so the
+                   squared distances are exact in 34.30 format. Of references
+                   at equal distance, the lower index comes first.
+ */
+uint32_t arm_knn_q15(
+  const arm_knn_instance_q15 * S,
+  const q15_t * pQuery,
+        uint32_t k,
+        uint32_t * pIndex,
+        q63_t * pDist)
+{
+  uint32_t dim = S->dim;
+  uint32_t held = 0U;
+  uint32_t m = 0U;
+  q63_t queryNorm = 0;
+
+  if (k > S->numRefs)
+    k = S->numRefs;
+  if (k == 0U)
+    return 0U;
+
+  for (uint32_t d = 0U; d < dim; d++)
+    queryNorm += (q31_t) pQuery[d] * pQuery[d];
+
+#ifdef ARM_DSP_EXT_X86
+  if (arm_dsp_ext_avx2() && knn_madd_safe(pQuery, dim))
+  {
+    /* Dot products in small batches, so they are still in cache when ranked */
+    q63_t dots[64];
+
+    while (m + 2U <= S->numRefs)
+    {
+      arm_knn_instance_q15 batch = *S;
+      uint32_t done;
+
+      batch.pRefs = S->pRefs + m * dim;
+      batch.numRefs = ((S->numRefs - m) > 64U) ? 64U : (S->numRefs - m);
+      done = knn_avx2_q15(&batch, pQuery, dots);
+
+      for (uint32_t i = 0U; i < done; i++)
+      {
+        q63_t dist = queryNorm + S->pNorms[m + i] - 2 * dots[i];
+        held = arm_knn_insert_q63(pDist, pIndex, held, k, dist, m + i);
+      }
+      m += done;
+    }
+  }
+#endif
+
+#if defined (ARM_MATH_DSP)
+  /* Two references per pass, sharing each query pair */
+  for (; m + 2U <= S->numRefs; m += 2U)
+  {
+    const q15_t *pq = pQuery;
+    const q15_t *pr0 = S->pRefs + m * dim;
+    const q15_t *pr1 = pr0 + dim;
+    q63_t dot0 = 0;
+    q63_t dot1 = 0;
+    uint32_t d;
+
+    for (d = dim >> 1U; d > 0U; d--)
+    {
+      q31_t q = read_q15x2_ia(&pq);
+      dot0 = __SMLALD(q, read_q15x2_ia(&pr0), dot0);
+      dot1 = __SMLALD(q, read_q15x2_ia(&pr1), dot1);
+    }
+    if (dim & 1U)
+    {
+      dot0 += (q31_t) *pq * *pr0;
+      dot1 += (q31_t) *pq * *pr1;
+    }
+
+    held = arm_knn_insert_q63(pDist, pIndex, held, k, queryNorm + S->pNorms[m] - 2 * dot0, m);
+    held = arm_knn_insert_q63(pDist, pIndex, held, k, queryNorm + S->pNorms[m + 1U] - 2 * dot1, m + 1U);
+  }
+#endif /* defined (ARM_MATH_DSP) */
+
+  for (; m < S->numRefs; m++)
+  {
+    const q15_t *pr = S->pRefs + m * dim;
+    q63_t dot = 0;
+
+    for (uint32_t d = 0U; d < dim; d++)
+      dot += (q31_t) pQuery[d] * pr[d];
+
+    held = arm_knn_insert_q63(pDist, pIndex, held, k, queryNorm + S->pNorms[m] - 2 * dot, m);
+  }
+
+  return held;
+}
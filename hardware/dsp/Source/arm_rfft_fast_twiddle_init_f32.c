@@ -0,0 +1,24 @@
+/**
+ * @file arm_rfft_fast_twiddle_init_f32.c
+ * @brief Twiddle factors of the floating-point real FFT
+ */
+
+#include "arm_fft_tables.h"
+#include "arm_fft_twiddle.h"
+
+/**
+  @brief         Twiddle factors of the floating-point real FFT.
+  @param[out]    pTwiddle  points to fftLen values.
+  @param[in]     fftLen    real FFT length, a power of two from 32 to 4096.
+
+  @par           Details
+                   Entry i is sin(2*pi*i/fftLen), cos(2*pi*i/fftLen), for i
+                   from 0 to fftLen/2 - 1, the layout of twiddleCoef_rfft_N.
+ */
+void arm_rfft_fast_twiddle_init_f32(
+  float32_t * pTwiddle,
+  uint16_t fftLen)
+{
+  for (uint32_t i = 0U; i < fftLen / 2U; i++)
+    arm_fft_cos_sin(i, fftLen, &pTwiddle[2U * i + 1U], &pTwiddle[2U * i]);
+}
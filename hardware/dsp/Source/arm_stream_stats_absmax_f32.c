@@ -0,0 +1,33 @@
+/**
+ * @file arm_stream_stats_absmax_f32.c
+ * @brief Largest absolute value of the floating-point streaming statistics
+ */
+
+#include "arm_stream_stats.h"
+
+/**
+  @brief         Largest absolute value of the samples so far, as arm_absmax_no_idx_f32.
+  @param[in]     S          points to an instance of the statistics structure.
+  @param[out]    pResult    maximum absolute value returned here.
+
+  @par           Details
+                   The largest magnitude is at one end of the range, so it
+                   comes from min and max rather than being tracked itself.
+                   With no samples the result is 0.
+ */
+void arm_stream_stats_absmax_f32(
+  const arm_stream_stats_instance_f32 * S,
+        float32_t * pResult)
+{
+  float32_t lo, hi;
+
+  if (S->count == 0U)
+  {
+    *pResult = 0.0f;
+    return;
+  }
+
+  lo = fabsf(S->min);
+  hi = fabsf(S->max);
+  *pResult = (lo > hi) ? lo : hi;
+}
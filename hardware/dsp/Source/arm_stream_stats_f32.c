@@ -0,0 +1,144 @@
+/**
+ * @file arm_stream_stats_f32.c
+ * @brief Block update of the floating-point streaming statistics
+ *
+ * The block is read once. Its own sum and sum of squares are taken about a
+ * shift near the mean (the running mean, or the block's first sample when
+ * there is none), which keeps the one-pass formulas accurate, and the
+ * block's statistics are then merged into the running ones. Without decay
+ * the loop keeps four independent sums so that consecutive additions do
+ * not wait on each other.
+ */
+
+#include "arm_stream_stats.h"
+
+/**
+  @brief         Adds a block of samples to the floating-point streaming statistics.
+  @param[in,out] S          points to an instance of the statistics structure.
+  @param[in]     pSrc       points to the input vector.
+  @param[in]     blockSize  number of samples in the input vector.
+
+  @par           Details
+                   Gives the same statistics as arm_stream_stats_sample_f32
+                   on each sample in turn, up to rounding.
+ */
+void arm_stream_stats_f32(
+        arm_stream_stats_instance_f32 * S,
+  const float32_t * pSrc,
+        uint32_t blockSize)
+{
+  arm_stream_stats_instance_f32 block;
+  const float32_t *px = pSrc;
+  float32_t decay = S->decay;
+  float32_t shift, sum, sumSq, weight, weight2;
+  float32_t fade = 1.0f;
+  float32_t minVal, maxVal;
+  uint32_t blkCnt;
+
+  if (blockSize == 0U)
+    return;
+
+  shift = (S->count > 0U) ? S->mean : pSrc[0];
+  minVal = pSrc[0];
+  maxVal = pSrc[0];
+
+  if (decay == 1.0f)
+  {
+    float32_t sum0 = 0.0f, sum1 = 0.0f, sum2 = 0.0f, sum3 = 0.0f;
+    float32_t sq0 = 0.0f, sq1 = 0.0f, sq2 = 0.0f, sq3 = 0.0f;
+
+    blkCnt = blockSize >> 2U;
+    while (blkCnt > 0U)
+    {
+      float32_t d0 = px[0] - shift;
+      float32_t d1 = px[1] - shift;
+      float32_t d2 = px[2] - shift;
+      float32_t d3 = px[3] - shift;
+
+      sum0 += d0;
+      sum1 += d1;
+      sum2 += d2;
+      sum3 += d3;
+      sq0 += d0 * d0;
+      sq1 += d1 * d1;
+      sq2 += d2 * d2;
+      sq3 += d3 * d3;
+
+      for (uint32_t i = 0U; i < 4U; i++)
+      {
+        if (px[i] < minVal)
+          minVal = px[i];
+        if (px[i] > maxVal)
+          maxVal = px[i];
+      }
+
+      px += 4U;
+      blkCnt--;
+    }
+
+    blkCnt = blockSize & 3U;
+    while (blkCnt > 0U)
+    {
+      float32_t d = *px - shift;
+
+      sum0 += d;
+      sq0 += d * d;
+      if (*px < minVal)
+        minVal = *px;
+      if (*px > maxVal)
+        maxVal = *px;
+
+      px++;
+      blkCnt--;
+    }
+
+    sum = (sum0 + sum1) + (sum2 + sum3);
+    sumSq = (sq0 + sq1) + (sq2 + sq3);
+    weight = (float32_t) blockSize;
+    weight2 = weight;
+  }
+  else
+  {
+    /* Each new sample ages everything before it, in the block and out */
+    float32_t decay2 = decay * decay;
+
+    sum = 0.0f;
+    sumSq = 0.0f;
+    weight = 0.0f;
+    weight2 = 0.0f;
+
+    for (blkCnt = blockSize; blkCnt > 0U; blkCnt--)
+    {
+      float32_t d = *px - shift;
+
+      sum = decay * sum + d;
+      sumSq = decay * sumSq + d * d;
+      weight = decay * weight + 1.0f;
+      weight2 = decay2 * weight2 + 1.0f;
+      fade *= decay;
+
+      if (*px < minVal)
+        minVal = *px;
+      if (*px > maxVal)
+        maxVal = *px;
+
+      px++;
+    }
+  }
+
+  block.count = blockSize;
+  block.decay = decay;
+  block.weight = weight;
+  block.weight2 = weight2;
+  block.mean = shift + sum / weight;
+  block.m2 = sumSq - sum * (sum / weight);
+  if (block.m2 < 0.0f)
+    block.m2 = 0.0f;
+  block.min = minVal;
+  block.max = maxVal;
+
+  S->weight *= fade;
+  S->weight2 *= fade * fade;
+  S->m2 *= fade;
+  arm_stream_stats_merge_f32(S, &block);
+}
@@ -0,0 +1,31 @@
+/**
+ * @file arm_stream_stats_init_f32.c
+ * @brief Initialization of the floating-point streaming statistics
+ */
+
+#include "arm_stream_stats.h"
+
+/**
+  @brief         Initialization function for the floating-point streaming statistics.
+  @param[out]    S          points to an instance of the statistics structure.
+  @param[in]     decay      weight kept by the past for each new sample; 1 for none.
+
+  @par           Details
+                   With a decay below 1 the mean and variance are those of
+                   samples weighted by decay^age, so their memory is about
+                   1/(1-decay) samples long; 0.99 follows roughly the last
+                   hundred. count, min and max still cover every sample.
+ */
+void arm_stream_stats_init_f32(
+  arm_stream_stats_instance_f32 * S,
+  float32_t decay)
+{
+  S->count = 0U;
+  S->decay = decay;
+  S->weight = 0.0f;
+  S->weight2 = 0.0f;
+  S->mean = 0.0f;
+  S->m2 = 0.0f;
+  S->min = FLT_MAX;
+  S->max = -FLT_MAX;
+}
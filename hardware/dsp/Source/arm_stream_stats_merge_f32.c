@@ -0,0 +1,57 @@
+/**
+ * @file arm_stream_stats_merge_f32.c
+ * @brief Merging of floating-point streaming statistics
+ */
+
+#include "arm_stream_stats.h"
+
+/**
+  @brief         Merges two floating-point streaming statistics.
+  @param[in,out] S          points to the instance that receives the merge.
+  @param[in]     pOther     points to the instance merged into S.
+
+  @par           Details
+                   Afterwards S holds the statistics of both sets of samples,
+                   combined with the pairwise formula of Chan et al.:
+  <pre>
+      delta = mean_b - mean_a
+      mean  = mean_a + delta * w_b / (w_a + w_b)
+      m2    = m2_a + m2_b + delta^2 * w_a * w_b / (w_a + w_b)
+  </pre>
+                   Neither side is decayed against the other, so the two
+                   should cover the same stretch of time, as with blocks of
+                   channels or threads sampling side by side. S keeps its
+                   own decay.
+ */
+void arm_stream_stats_merge_f32(
+        arm_stream_stats_instance_f32 * S,
+  const arm_stream_stats_instance_f32 * pOther)
+{
+  float32_t weight, delta;
+
+  if (pOther->count == 0U)
+    return;
+
+  if (S->count == 0U)
+  {
+    float32_t decay = S->decay;
+
+    *S = *pOther;
+    S->decay = decay;
+    return;
+  }
+
+  weight = S->weight + pOther->weight;
+  delta = pOther->mean - S->mean;
+
+  S->mean += delta * (pOther->weight / weight);
+  S->m2 += pOther->m2 + delta * delta * (S->weight * pOther->weight / weight);
+  S->weight = weight;
+  S->weight2 += pOther->weight2;
+  S->count += pOther->count;
+
+  if (pOther->min < S->min)
+    S->min = pOther->min;
+  if (pOther->max > S->max)
+    S->max = pOther->max;
+}
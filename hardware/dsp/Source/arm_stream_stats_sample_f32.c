@@ -0,0 +1,45 @@
+/**
+ * @file arm_stream_stats_sample_f32.c
+ * @brief One-sample update of the floating-point streaming statistics
+ */
+
+#include "arm_stream_stats.h"
+
+/**
+  @brief         Adds one sample to the floating-point streaming statistics.
+  @param[in,out] S          points to an instance of the statistics structure.
+  @param[in]     x          sample to add.
+
+  @par           Algorithm
+                   Welford's update, with the past first weighted down by
+                   the decay:
+  <pre>
+      weight = decay * weight + 1
+      delta  = x - mean
+      mean   = mean + delta / weight
+      m2     = decay * m2 + delta * (x - mean)
+  </pre>
+                   Unlike the sum of squares, m2 does not lose precision
+                   when the mean is large next to the spread.
+ */
+void arm_stream_stats_sample_f32(
+  arm_stream_stats_instance_f32 * S,
+  float32_t x)
+{
+  float32_t decay = S->decay;
+  float32_t delta;
+
+  S->weight = decay * S->weight + 1.0f;
+  S->weight2 = decay * decay * S->weight2 + 1.0f;
+
+  delta = x - S->mean;
+  S->mean += delta / S->weight;
+  S->m2 = decay * S->m2 + delta * (x - S->mean);
+
+  if (x < S->min)
+    S->min = x;
+  if (x > S->max)
+    S->max = x;
+
+  S->count++;
+}
@@ -0,0 +1,21 @@
+/**
+ * @file arm_stream_stats_std_f32.c
+ * @brief Standard deviation of the floating-point streaming statistics
+ */
+
+#include "arm_stream_stats.h"
+
+/**
+  @brief         Standard deviation of the samples so far, as arm_std_f32.
+  @param[in]     S          points to an instance of the statistics structure.
+  @param[out]    pResult    standard deviation value returned here.
+ */
+void arm_stream_stats_std_f32(
+  const arm_stream_stats_instance_f32 * S,
+        float32_t * pResult)
+{
+  float32_t var;
+
+  arm_stream_stats_var_f32(S, &var);
+  *pResult = sqrtf(var);
+}
@@ -0,0 +1,33 @@
+/**
+ * @file arm_stream_stats_var_f32.c
+ * @brief Variance of the floating-point streaming statistics
+ */
+
+#include "arm_stream_stats.h"
+
+/**
+  @brief         Variance of the samples so far, as arm_var_f32.
+  @param[in]     S          points to an instance of the statistics structure.
+  @param[out]    pResult    variance value returned here.
+
+  @par           Details
+                   m2 is divided by weight - weight2/weight, which is
+                   count - 1 with no decay, giving the same unbiased
+                   estimate as arm_var_f32. As there, fewer than two samples
+                   give 0.
+ */
+void arm_stream_stats_var_f32(
+  const arm_stream_stats_instance_f32 * S,
+        float32_t * pResult)
+{
+  float32_t dof;
+
+  if (S->count <= 1U)
+  {
+    *pResult = 0.0f;
+    return;
+  }
+
+  dof = S->weight - S->weight2 / S->weight;
+  *pResult = (dof > 0.0f) ? (S->m2 / dof) : 0.0f;
+}
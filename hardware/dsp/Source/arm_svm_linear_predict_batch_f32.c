@@ -0,0 +1,118 @@
+/**
+ * @file arm_svm_linear_predict_batch_f32.c
+ * @brief Linear SVM prediction for many vectors
+ *
+ * The decision function of a linear SVM is
+ *   intercept + sum_i alpha_i <x, sv_i> = intercept + <x, sum_i alpha_i sv_i>
+ * so the support vectors are folded into one weight vector at the start of
+ * the call and each input then costs one dot product, however many support
+ * vectors there are. On x86 with AVX2, eight inputs share each load of the
+ * weights.
+ */
+
+#include <string.h>
+
+#include "arm_classify_batch.h"
+#include "arm_dsp_ext_x86.h"
+
+#ifdef ARM_DSP_EXT_X86
+/**
+ * @brief Inputs eight at a time; returns inputs done
+ *
+ * The loops over the group are unrolled so that the eight accumulators stay
+ * in registers.
+ */
+__attribute__((target("avx2,fma")))
+static uint32_t svm_linear_batch_avx2(
+  const arm_svm_linear_instance_f32 * S,
+  const float32_t * pIn,
+        uint32_t numVectors,
+        int32_t * pResult,
+  const float32_t * pWeights)
+{
+  uint32_t dim = S->vectorDimension;
+  uint32_t dim8 = dim & ~7U;
+  __m256i tailMask = arm_dsp_ext_tail_mask(dim - dim8);
+  uint32_t n;
+
+  for (n = 0U; n + 8U <= numVectors; n += 8U)
+  {
+    const float32_t *px = pIn + n * dim;
+    __m256 acc[8];
+    uint32_t d, t;
+
+    #pragma GCC unroll 8
+    for (t = 0U; t < 8U; t++)
+      acc[t] = _mm256_setzero_ps();
+
+    for (d = 0U; d < dim8; d += 8U)
+    {
+      __m256 w = _mm256_loadu_ps(pWeights + d);
+      #pragma GCC unroll 8
+      for (t = 0U; t < 8U; t++)
+        acc[t] = _mm256_fmadd_ps(_mm256_loadu_ps(px + t * dim + d), w, acc[t]);
+    }
+    if (d < dim)
+    {
+      __m256 w = _mm256_maskload_ps(pWeights + d, tailMask);
+      #pragma GCC unroll 8
+      for (t = 0U; t < 8U; t++)
+        acc[t] = _mm256_fmadd_ps(_mm256_maskload_ps(px + t * dim + d, tailMask), w, acc[t]);
+    }
+
+    float32_t sum[8];
+    _mm256_storeu_ps(sum, _mm256_add_ps(arm_dsp_ext_hsum8(acc), _mm256_set1_ps(S->intercept)));
+    for (t = 0U; t < 8U; t++)
+      pResult[n + t] = S->classes[STEP(sum[t])];
+  }
+  return n;
+}
+#endif /* ARM_DSP_EXT_X86 */
+
+/**
+  @brief         Linear SVM prediction for many vectors.
+  @param[in]     S          points to an instance of the linear SVM structure.
+  @param[in]     pIn        points to the input vectors, row-major.
+  @param[in]     numVectors number of input vectors.
+  @param[out]    pResult    points to the decisions.
+  @param[out]    pBuffer    points to a scratch buffer of vectorDimension values.
+
+  @par           Each decision is that of arm_svm_linear_predict_f32 on the
+                 same vector, except where the decision value is within
+                 rounding of zero.
+ */
+void arm_svm_linear_predict_batch_f32(
+  const arm_svm_linear_instance_f32 * S,
+  const float32_t * pIn,
+        uint32_t numVectors,
+        int32_t * pResult,
+        float32_t * pBuffer)
+{
+  uint32_t dim = S->vectorDimension;
+  const float32_t *pSupport = S->supportVectors;
+  uint32_t n = 0U;
+
+  memset(pBuffer, 0, dim * sizeof(float32_t));
+  for (uint32_t i = 0U; i < S->nbOfSupportVectors; i++)
+  {
+    float32_t alpha = S->dualCoefficients[i];
+
+    for (uint32_t d = 0U; d < dim; d++)
+      pBuffer[d] += alpha * *pSupport++;
+  }
+
+#ifdef ARM_DSP_EXT_X86
+  if (arm_dsp_ext_avx2())
+    n = svm_linear_batch_avx2(S, pIn, numVectors, pResult, pBuffer);
+#endif
+
+  for (; n < numVectors; n++)
+  {
+    const float32_t *px = pIn + n * dim;
+    float32_t sum = S->intercept;
+
+    for (uint32_t d = 0U; d < dim; d++)
+      sum += px[d] * pBuffer[d];
+    pResult[n] = S->classes[STEP(sum)];
+  }
+}
@@ -0,0 +1,179 @@
+/**
+ * @file arm_svm_rbf_predict_batch_f32.c
+ * @brief RBF SVM prediction for many vectors
+ *
+ * Inputs are taken in groups and each support vector is compared with the
+ * whole group before moving on, so it is read once per group rather than
+ * once per input: four inputs per group in the scalar code, eight on x86
+ * with AVX2, where the eight kernel values are also computed together with
+ * a vector exponential.
+ */
+
+#include "arm_classify_batch.h"
+#include "arm_dsp_ext_x86.h"
+
+#ifdef ARM_DSP_EXT_X86
+/**
+ * @brief expf of eight values
+ *
+ * Range reduction by ln 2 and a degree-6 polynomial (as in Cephes expf),
+ * within a few ulp of expf. Results below the smallest normal flush to 0.
+ */
+__attribute__((target("avx2,fma")))
+static inline __m256 svm_rbf_exp_avx2(__m256 x)
+{
+  const __m256 ln2Hi = _mm256_set1_ps(0.693359375f);
+  const __m256 ln2Lo = _mm256_set1_ps(-2.12194440e-4f);
+  __m256 underflow = _mm256_cmp_ps(x, _mm256_set1_ps(-87.3f), _CMP_LT_OQ);
+
+  x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(-87.3f)), _mm256_set1_ps(88.3f));
+
+  __m256 n = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(1.44269504088896341f)),
+                             _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  x = _mm256_fnmadd_ps(n, ln2Hi, x);
+  x = _mm256_fnmadd_ps(n, ln2Lo, x);
+
+  __m256 p = _mm256_set1_ps(1.9875691500e-4f);
+  p = _mm256_fmadd_ps(p, x, _mm256_set1_ps(1.3981999507e-3f));
+  p = _mm256_fmadd_ps(p, x, _mm256_set1_ps(8.3334519073e-3f));
+  p = _mm256_fmadd_ps(p, x, _mm256_set1_ps(4.1665795894e-2f));
+  p = _mm256_fmadd_ps(p, x, _mm256_set1_ps(1.6666665459e-1f));
+  p = _mm256_fmadd_ps(p, x, _mm256_set1_ps(5.0000001201e-1f));
+  p = _mm256_fmadd_ps(p, _mm256_mul_ps(x, x), _mm256_add_ps(x, _mm256_set1_ps(1.0f)));
+
+  __m256i e = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+  return _mm256_andnot_ps(underflow, _mm256_mul_ps(p, _mm256_castsi256_ps(e)));
+}
+
+/**
+ * @brief Inputs eight at a time; returns inputs done
+ */
+__attribute__((target("avx2,fma")))
+static uint32_t svm_rbf_batch_avx2(
+  const arm_svm_rbf_instance_f32 * S,
+  const float32_t * pIn,
+        uint32_t numVectors,
+        int32_t * pResult)
+{
+  uint32_t dim = S->vectorDimension;
+  uint32_t dim8 = dim & ~7U;
+  __m256i tailMask = arm_dsp_ext_tail_mask(dim - dim8);
+  __m256 negGamma = _mm256_set1_ps(-S->gamma);
+  uint32_t n;
+
+  for (n = 0U; n + 8U <= numVectors; n += 8U)
+  {
+    const float32_t *px = pIn + n * dim;
+    const float32_t *pSupport = S->supportVectors;
+    __m256 sum = _mm256_set1_ps(S->intercept);
+
+    for (uint32_t i = 0U; i < S->nbOfSupportVectors; i++)
+    {
+      __m256 acc[8];
+      uint32_t d, t;
+
+      #pragma GCC unroll 8
+      for (t = 0U; t < 8U; t++)
+        acc[t] = _mm256_setzero_ps();
+
+      for (d = 0U; d < dim8; d += 8U)
+      {
+        __m256 sv = _mm256_loadu_ps(pSupport + d);
+        #pragma GCC unroll 8
+        for (t = 0U; t < 8U; t++)
+        {
+          __m256 diff = _mm256_sub_ps(_mm256_loadu_ps(px + t * dim + d), sv);
+          acc[t] = _mm256_fmadd_ps(diff, diff, acc[t]);
+        }
+      }
+      if (d < dim)
+      {
+        __m256 sv = _mm256_maskload_ps(pSupport + d, tailMask);
+        #pragma GCC unroll 8
+        for (t = 0U; t < 8U; t++)
+        {
+          __m256 diff = _mm256_sub_ps(_mm256_maskload_ps(px + t * dim + d, tailMask), sv);
+          acc[t] = _mm256_fmadd_ps(diff, diff, acc[t]);
+        }
+      }
+
+      __m256 kernel = svm_rbf_exp_avx2(_mm256_mul_ps(negGamma, arm_dsp_ext_hsum8(acc)));
+      sum = _mm256_fmadd_ps(_mm256_set1_ps(S->dualCoefficients[i]), kernel, sum);
+      pSupport += dim;
+    }
+
+    float32_t sums[8];
+    _mm256_storeu_ps(sums, sum);
+    for (uint32_t t = 0U; t < 8U; t++)
+      pResult[n + t] = S->classes[STEP(sums[t])];
+  }
+  return n;
+}
+#endif /* ARM_DSP_EXT_X86 */
+
+/**
+  @brief         RBF SVM prediction for many vectors.
+  @param[in]     S          points to an instance of the RBF SVM structure.
+  @param[in]     pIn        points to the input vectors, row-major.
+  @param[in]     numVectors number of input vectors.
+  @param[out]    pResult    points to the decisions.
+
+  @par           Each decision is that of arm_svm_rbf_predict_f32 on the
+                 same vector, except where the decision value is within
+                 rounding of zero.
+ */
+void arm_svm_rbf_predict_batch_f32(
+  const arm_svm_rbf_instance_f32 * S,
+  const float32_t * pIn,
+        uint32_t numVectors,
+        int32_t * pResult)
+{
+  uint32_t dim = S->vectorDimension;
+  uint32_t n = 0U;
+
+#ifdef ARM_DSP_EXT_X86
+  if (arm_dsp_ext_avx2())
+    n = svm_rbf_batch_avx2(S, pIn, numVectors, pResult);
+#endif
+
+  /* Four inputs per pass over the support vectors */
+  for (; n + 4U <= numVectors; n += 4U)
+  {
+    const float32_t *px0 = pIn + n * dim;
+    const float32_t *px1 = px0 + dim;
+    const float32_t *px2 = px1 + dim;
+    const float32_t *px3 = px2 + dim;
+    const float32_t *pSupport = S->supportVectors;
+    float32_t sum0 = S->intercept, sum1 = S->intercept, sum2 = S->intercept, sum3 = S->intercept;
+
+    for (uint32_t i = 0U; i < S->nbOfSupportVectors; i++)
+    {
+      float32_t dot0 = 0.0f, dot1 = 0.0f, dot2 = 0.0f, dot3 = 0.0f;
+      float32_t alpha = S->dualCoefficients[i];
+
+      for (uint32_t d = 0U; d < dim; d++)
+      {
+        float32_t sv = pSupport[d];
+
+        dot0 += SQ(px0[d] - sv);
+        dot1 += SQ(px1[d] - sv);
+        dot2 += SQ(px2[d] - sv);
+        dot3 += SQ(px3[d] - sv);
+      }
+
+      sum0 += alpha * expf(-S->gamma * dot0);
+      sum1 += alpha * expf(-S->gamma * dot1);
+      sum2 += alpha * expf(-S->gamma * dot2);
+      sum3 += alpha * expf(-S->gamma * dot3);
+      pSupport += dim;
+    }
+
+    pResult[n] = S->classes[STEP(sum0)];
+    pResult[n + 1U] = S->classes[STEP(sum1)];
+    pResult[n + 2U] = S->classes[STEP(sum2)];
+    pResult[n + 3U] = S->classes[STEP(sum3)];
+  }
+
+  for (; n < numVectors; n++)
+    arm_svm_rbf_predict_f32(S, pIn + n * dim, &pResult[n]);
+}
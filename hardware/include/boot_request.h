@@ -0,0 +1,26 @@
+/**
+ * @file boot_request.h
+ * @brief The application asking the resident bootloader to listen
+ *
+ * After a power-on or pin reset the bootloader listens on the host UART
+ * for BOOT_LISTEN_MS before it starts the application. A software reset
+ * (the restart test command) skips that window, unless the application
+ * left BOOT_REQUEST_MAGIC in the request word first: that is how a running
+ * test build hands over to tools/boot_tool.py.
+ *
+ * The word is the last 8 bytes of SRAM, which both linker scripts keep out
+ * of RAM, so neither the application nor the bootloader overwrites it and
+ * a software reset leaves it as it was.
+ */
+
+#ifndef BOOT_REQUEST_H
+#define BOOT_REQUEST_H
+
+#include <stdint.h>
+
+#define BOOT_REQUEST_MAGIC 0xB0071157u
+
+// The request word below the end of SRAM at ram_end
+#define BOOT_REQUEST(ram_end) (*(volatile uint32_t *)((ram_end) - 8))
+
+#endif // BOOT_REQUEST_H
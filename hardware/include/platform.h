@@ -9,6 +9,18 @@
 typedef enum { UNLOCK, FEATURE1 = 1, FEATURE2 = 2, FEATURE3 = 3 } flag_t;
 typedef enum { OFF, RED, GREEN, WHITE } led_color_t;
 
+/**
+ * @brief System clock profiles
+ *
+ * Each platform maps these to its own PLL, flash wait state and cache
+ * settings. The profile at boot is CLOCK_PROFILE, chosen at build time.
+ */
+typedef enum { CLOCK_PERFORMANCE, CLOCK_BALANCED, CLOCK_LOW_POWER, CLOCK_PROFILE_COUNT } clock_profile_t;
+
+#ifndef CLOCK_PROFILE
+#   define CLOCK_PROFILE CLOCK_PERFORMANCE
+#endif
+
 void initHardware_car(int argc, char ** argv);
 void initHardware_fob(int argc, char ** argv);
 void loadFlag(uint8_t* dest, flag_t flag);
@@ -17,5 +29,16 @@ bool saveFobState(const FLASH_DATA *flash_data);
 void setLED(led_color_t color);
 bool buttonPressed(void);
 void softwareReset(void);
+uint8_t boardLinkAddress(void);
+bool boardLinkShared(void);
+void delayUs(uint32_t us);
+uint32_t timeUs(void);
+uint32_t cycleCount(void);
+bool setClockProfile(clock_profile_t profile);
+clock_profile_t clockProfile(void);
+uint32_t clockHz(void);
+uint32_t snapshotPlatform(uint8_t *dest, uint32_t max);
+bool restorePlatform(const uint8_t *src, uint32_t len);
+bool processPlatformCommand(const char *cmd);
 
 #endif // PLATFORM_H
\ No newline at end of file
@@ -27,6 +27,16 @@ typedef enum { HOST_UART, BOARD_UART } hw_uart_t;
  */
 void uart_init(hw_uart_t uart, int argc, char ** argv);
 
+/**
+ * @brief Recompute a UART's baud rate divider for the current system clock.
+ *
+ * Called after a clock profile change; waits for bytes still being sent
+ * and keeps bytes already received.
+ *
+ * @param uart is the UART to retime.
+ */
+void uart_reclock(hw_uart_t uart);
+
 /**
  * @brief Check if there are characters available on a UART interface.
  *
@@ -81,4 +91,44 @@ void uart_writeb(hw_uart_t uart, uint8_t data);
  */
 uint32_t uart_write(hw_uart_t uart, uint8_t *buf, uint32_t len);
 
+/*
+ * Transmit queue
+ *
+ * Every UART sends from a ring of UART_RING_SIZE bytes, drained by its
+ * transmit interrupt on the boards and by uart_avail() and the blocking
+ * calls on x86. uart_writeb() and uart_write() wait only for room in the
+ * ring, not for their bytes to go out; anything that must reach the wire
+ * first (a reset, a baud rate change) flushes.
+ */
+
+/**
+ * @brief Queue as much of a sequence of bytes as there is room for.
+ *
+ * Never waits. Bytes are sent in the order they were queued, after any
+ * queued earlier by uart_writeb() or uart_write().
+ *
+ * @param uart is the UART to write to.
+ * @param buf is a pointer to the data to send.
+ * @param len is the number of bytes to send.
+ * @return the number of bytes queued, from the start of buf.
+ */
+uint32_t uart_write_async(hw_uart_t uart, const uint8_t *buf, uint32_t len);
+
+/**
+ * @brief Room left in a UART's transmit queue.
+ *
+ * @param uart is the UART to check.
+ * @return the number of bytes uart_write_async() would take now.
+ */
+uint32_t uart_tx_free(hw_uart_t uart);
+
+/**
+ * @brief Wait for a UART's queued bytes to be sent.
+ *
+ * @param uart is the UART to flush.
+ * @param timeout_us is how long to wait at most.
+ * @return true if the queue emptied and the UART finished sending in time.
+ */
+bool uart_flush(hw_uart_t uart, uint32_t timeout_us);
+
 #endif // UART_H
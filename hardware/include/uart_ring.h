@@ -0,0 +1,69 @@
+/**
+ * @file uart_ring.h
+ * @brief Ring buffers between a UART interrupt and the main loop
+ *
+ * One side only writes and the other only reads: for receive the interrupt
+ * handler writes and the main loop reads, for transmit the other way round.
+ * Neither needs to disable interrupts. Every function is forced inline: the
+ * handler runs from RAM while flash is being erased, and an out-of-line copy
+ * would be fetched from flash.
+ */
+
+#ifndef UART_RING_H
+#define UART_RING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// About 90 ms of continuous traffic at 115200 baud; a power of two
+#define UART_RING_SIZE 1024
+
+typedef struct
+{
+    volatile uint32_t head;     // next byte to write, only the writer moves it
+    volatile uint32_t tail;     // next byte to read, only the reader moves it
+    volatile uint32_t dropped;  // bytes lost to a full ring or a hardware overrun
+    uint32_t size;              // bytes of storage, a power of two
+    uint8_t *data;
+} uart_ring_t;
+
+// Initialiser for a ring over a byte array, e.g. UART_RING_INIT(rx_data)
+#define UART_RING_INIT(storage) { .size = sizeof(storage), .data = (storage) }
+
+static inline __attribute__((always_inline)) void uart_ring_put(uart_ring_t *ring, uint8_t byte)
+{
+    uint32_t head = ring->head;
+
+    if (head - ring->tail == ring->size) {
+        ring->dropped++;
+        return;
+    }
+    ring->data[head & (ring->size - 1)] = byte;
+    __asm volatile("" ::: "memory");    // the byte is stored before it is published
+    ring->head = head + 1;
+}
+
+static inline __attribute__((always_inline)) bool uart_ring_empty(const uart_ring_t *ring)
+{
+    return ring->head == ring->tail;
+}
+
+static inline __attribute__((always_inline)) uint32_t uart_ring_free(const uart_ring_t *ring)
+{
+    return ring->size - (ring->head - ring->tail);
+}
+
+/**
+ * @brief Take the oldest byte; the ring must not be empty
+ */
+static inline __attribute__((always_inline)) uint8_t uart_ring_get(uart_ring_t *ring)
+{
+    uint32_t tail = ring->tail;
+    uint8_t byte = ring->data[tail & (ring->size - 1)];
+
+    __asm volatile("" ::: "memory");    // and read before its slot is given back
+    ring->tail = tail + 1;
+    return byte;
+}
+
+#endif // UART_RING_H
@@ -0,0 +1,104 @@
+/**
+ * @file arm_nn_arena.h
+ * @brief Static memory planning for chains of CMSIS-NN layers
+ *
+ * Every CMSIS-NN layer reads and writes caller-owned activation buffers and
+ * many take a scratch buffer sized by their _get_buffer_size function. Given
+ * when each of those buffers is first and last used, the planner gives each
+ * an offset in one arena so that buffers alive at the same time never share
+ * bytes and the others reuse the same memory. The arena needed, the peak, is
+ * reported back, and is usually far below the sum of the buffers.
+ *
+ * Planning needs no memory of its own and is deterministic, so it can run
+ * once at init on the device or on the host to size a static arena.
+ */
+
+#ifndef ARM_NN_ARENA_H
+#define ARM_NN_ARENA_H
+
+#include "arm_nn_math_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief A buffer to place in the arena
+ *
+ * first and last are the indices of the first and last layer that use the
+ * buffer; it is alive for both and everything between. A buffer of size 0,
+ * or with last < first, is never alive and gets offset 0.
+ */
+typedef struct
+{
+    int32_t size;   /**< Bytes */
+    int32_t first;  /**< First layer that uses the buffer */
+    int32_t last;   /**< Last layer that uses the buffer */
+    int32_t offset; /**< Set by the planner: byte offset in the arena */
+} cmsis_nn_arena_buffer;
+
+/**
+ * @brief A layer of a network, by the activations it reads and writes
+ *
+ * Activations are numbered by the caller. The graph's inputs are those no
+ * layer writes, and they are alive from their first reader on; its outputs
+ * are those no layer reads, and they stay alive to the end. Layers run in
+ * the order given.
+ */
+typedef struct
+{
+    const int32_t *inputs; /**< Activations the layer reads */
+    int32_t input_count;   /**< Number of inputs */
+    int32_t output;        /**< Activation the layer writes, or -1 */
+    int32_t scratch_size;  /**< The layer's _get_buffer_size, or 0 */
+} cmsis_nn_arena_layer;
+
+/**
+ * @brief Place buffers of known lifetimes in one arena
+ * @param[in, out] buffers   Buffers to place; offset is set in each
+ * @param[in]      count     Number of buffers
+ * @param[in]      alignment Alignment of every offset in bytes, a power of two
+ * @param[out]     peak      Arena size the placement needs
+ * @return         ARM_CMSIS_NN_ARG_ERROR for a negative count or size, or a bad alignment;
+ *                 ARM_CMSIS_NN_SUCCESS otherwise
+ *
+ * @details Buffers are placed largest first, each at the lowest aligned offset
+ *          that does not overlap a placed buffer whose lifetime meets its own.
+ *          The time is quadratic to cubic in count, which is fine for the tens
+ *          of buffers a microcontroller model has.
+ */
+arm_cmsis_nn_status arm_nn_arena_plan(cmsis_nn_arena_buffer *buffers,
+                                      const int32_t count,
+                                      const int32_t alignment,
+                                      int32_t *peak);
+
+/**
+ * @brief Plan the activations and scratch buffers of a layer chain
+ * @param[in]  layers           Layers in execution order
+ * @param[in]  layer_count      Number of layers
+ * @param[in]  activation_sizes Bytes of each activation
+ * @param[in]  activation_count Number of activations
+ * @param[in]  alignment        Alignment of every offset in bytes, a power of two
+ * @param[out] buffers          activation_count + layer_count buffers: the activations in
+ *                              order, then each layer's scratch
+ * @param[out] peak             Arena size the plan needs
+ * @return     ARM_CMSIS_NN_ARG_ERROR if an activation index is out of range, an activation
+ *             is written twice or read before it is written, or as arm_nn_arena_plan;
+ *             ARM_CMSIS_NN_SUCCESS otherwise
+ *
+ * @details A layer's output is alive at the same time as its inputs and its scratch,
+ *          so none of the three share memory. Activations no layer uses take no space.
+ */
+arm_cmsis_nn_status arm_nn_arena_plan_layers(const cmsis_nn_arena_layer *layers,
+                                             const int32_t layer_count,
+                                             const int32_t *activation_sizes,
+                                             const int32_t activation_count,
+                                             const int32_t alignment,
+                                             cmsis_nn_arena_buffer *buffers,
+                                             int32_t *peak);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARM_NN_ARENA_H */
@@ -0,0 +1,192 @@
+/**
+ * @file arm_nn_arena.c
+ * @brief Static memory planning for chains of CMSIS-NN layers
+ */
+
+#include "arm_nn_arena.h"
+
+#define NN_ARENA_NONE INT32_MAX
+
+static int32_t align_up(const int32_t value, const int32_t alignment)
+{
+    return (value + alignment - 1) & -alignment;
+}
+
+static int alive(const cmsis_nn_arena_buffer *buffer)
+{
+    return buffer->size > 0 && buffer->first <= buffer->last;
+}
+
+static int overlap_in_time(const cmsis_nn_arena_buffer *a, const cmsis_nn_arena_buffer *b)
+{
+    return a->first <= b->last && b->first <= a->last;
+}
+
+/* Lowest aligned offset for buffers[index] clear of every placed buffer alive with it.
+ * The best offset is either 0 or the end of one of those, so only those are tried. */
+static int32_t lowest_offset(const cmsis_nn_arena_buffer *buffers, const int32_t count, const int32_t index,
+                             const int32_t alignment)
+{
+    const cmsis_nn_arena_buffer *buffer = &buffers[index];
+    int32_t best = NN_ARENA_NONE;
+
+    for (int32_t c = -1; c < count; c++)
+    {
+        int32_t candidate = 0;
+        if (c >= 0)
+        {
+            if (buffers[c].offset < 0 || !alive(&buffers[c]) || !overlap_in_time(buffer, &buffers[c]))
+            {
+                continue;
+            }
+            candidate = align_up(buffers[c].offset + buffers[c].size, alignment);
+        }
+        if (candidate >= best)
+        {
+            continue;
+        }
+
+        int fits = 1;
+        for (int32_t o = 0; o < count && fits; o++)
+        {
+            const cmsis_nn_arena_buffer *other = &buffers[o];
+            if (o == index || other->offset < 0 || !alive(other) || !overlap_in_time(buffer, other))
+            {
+                continue;
+            }
+            fits = candidate + buffer->size <= other->offset || other->offset + other->size <= candidate;
+        }
+        if (fits)
+        {
+            best = candidate;
+        }
+    }
+    return best;
+}
+
+arm_cmsis_nn_status arm_nn_arena_plan(cmsis_nn_arena_buffer *buffers,
+                                      const int32_t count,
+                                      const int32_t alignment,
+                                      int32_t *peak)
+{
+    if (count < 0 || alignment <= 0 || (alignment & (alignment - 1)) != 0)
+    {
+        return ARM_CMSIS_NN_ARG_ERROR;
+    }
+    for (int32_t i = 0; i < count; i++)
+    {
+        if (buffers[i].size < 0)
+        {
+            return ARM_CMSIS_NN_ARG_ERROR;
+        }
+        buffers[i].offset = alive(&buffers[i]) ? -1 : 0;
+    }
+
+    *peak = 0;
+    for (;;)
+    {
+        /* Largest unplaced buffer, the earliest first among equals */
+        int32_t next = -1;
+        for (int32_t i = 0; i < count; i++)
+        {
+            if (buffers[i].offset >= 0)
+            {
+                continue;
+            }
+            if (next < 0 || buffers[i].size > buffers[next].size ||
+                (buffers[i].size == buffers[next].size && buffers[i].first < buffers[next].first))
+            {
+                next = i;
+            }
+        }
+        if (next < 0)
+        {
+            break;
+        }
+
+        buffers[next].offset = lowest_offset(buffers, count, next, alignment);
+        if (buffers[next].offset + buffers[next].size > *peak)
+        {
+            *peak = buffers[next].offset + buffers[next].size;
+        }
+    }
+    return ARM_CMSIS_NN_SUCCESS;
+}
+
+arm_cmsis_nn_status arm_nn_arena_plan_layers(const cmsis_nn_arena_layer *layers,
+                                             const int32_t layer_count,
+                                             const int32_t *activation_sizes,
+                                             const int32_t activation_count,
+                                             const int32_t alignment,
+                                             cmsis_nn_arena_buffer *buffers,
+                                             int32_t *peak)
+{
+    if (layer_count < 0 || activation_count < 0)
+    {
+        return ARM_CMSIS_NN_ARG_ERROR;
+    }
+    for (int32_t a = 0; a < activation_count; a++)
+    {
+        buffers[a].size = activation_sizes[a];
+        buffers[a].first = NN_ARENA_NONE;
+        buffers[a].last = -1;
+    }
+
+    /* Each activation is alive from the layer that writes it */
+    for (int32_t l = 0; l < layer_count; l++)
+    {
+        const int32_t out = layers[l].output;
+        if (out < -1 || out >= activation_count || (out >= 0 && buffers[out].first != NN_ARENA_NONE))
+        {
+            return ARM_CMSIS_NN_ARG_ERROR;
+        }
+        if (out >= 0)
+        {
+            buffers[out].first = l;
+        }
+    }
+
+    /* to the last layer that reads it */
+    for (int32_t l = 0; l < layer_count; l++)
+    {
+        for (int32_t i = 0; i < layers[l].input_count; i++)
+        {
+            const int32_t in = layers[l].inputs[i];
+            if (in < 0 || in >= activation_count)
+            {
+                return ARM_CMSIS_NN_ARG_ERROR;
+            }
+            if (buffers[in].first == NN_ARENA_NONE)
+            {
+                buffers[in].first = l;
+            }
+            else if (buffers[in].first >= l && buffers[in].last < 0)
+            {
+                return ARM_CMSIS_NN_ARG_ERROR;
+            }
+            buffers[in].last = l;
+        }
+    }
+
+    for (int32_t a = 0; a < activation_count; a++)
+    {
+        if (buffers[a].first == NN_ARENA_NONE)
+        {
+            buffers[a].first = 0;
+        }
+        else if (buffers[a].last < 0)
+        {
+            buffers[a].last = layer_count - 1;
+        }
+    }
+
+    for (int32_t l = 0; l < layer_count; l++)
+    {
+        cmsis_nn_arena_buffer *scratch = &buffers[activation_count + l];
+        scratch->size = layers[l].scratch_size;
+        scratch->first = l;
+        scratch->last = l;
+    }
+
+    return arm_nn_arena_plan(buffers, activation_count + layer_count, alignment, peak);
+}
@@ -23,10 +23,12 @@
 /* USER CODE BEGIN Includes */
 #include <string.h>
 #include <stdio.h>
+#include "boot_request.h"
 #include "messages.h"
 #include "platform.h"
 #include "dataFormats.h"
 #include "uart.h"
+#include "uart_ring.h"
 //#include "stm32f0xx.h"
 /* USER CODE END Includes */
 
@@ -53,12 +55,15 @@
 #   define FEATURE3_FLAG "default_feature3"
 #endif
 
-#define FLASH_DATA_BYTES         \
-    (sizeof(FLASH_DATA) % 4 == 0) \
-        ? sizeof(FLASH_DATA)      \
-        : sizeof(FLASH_DATA) + (4 - (sizeof(FLASH_DATA) % 4))
+#define FLASH_DATA_BYTES          \
+    ((sizeof(FLASH_DATA) % 4 == 0) \
+        ? sizeof(FLASH_DATA)       \
+        : sizeof(FLASH_DATA) + (4 - (sizeof(FLASH_DATA) % 4)))
 #define FLASH_DATA_WORDS (FLASH_DATA_BYTES / 4)
 
+/* A full transmit queue takes about 90 ms at 115200 baud */
+#define RESET_FLUSH_US 100000
+
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -82,6 +87,55 @@ static FLASH_DATA flash_data __attribute__((section(".flash_data"))) = {
 };
 
 static UART_HandleTypeDef* const uart_base[2] = { [HOST_UART] = &huart2, [BOARD_UART] = &huart1 };
+
+/*
+ * Clock profiles, all from the 16 MHz HSI. Flash wait states are the
+ * reference manual's for 2.7-3.6 V, and each profile runs at the lowest
+ * regulator scale that allows its frequency. The ART accelerator's prefetch
+ * and caches are kept on in every profile.
+ */
+typedef struct
+{
+  bool pll;
+  uint32_t pllN;          /* VCO = 1 MHz * pllN, SYSCLK = VCO / 4 */
+  uint32_t latency;
+  uint32_t voltageScale;
+  uint32_t apb1Divider;   /* APB1 runs at 50 MHz at most */
+  const char *name;       /* for the clock test command */
+} clock_setting_t;
+
+static const clock_setting_t clock_settings[CLOCK_PROFILE_COUNT] = {
+  [CLOCK_PERFORMANCE] = { true, 400, FLASH_LATENCY_3, PWR_REGULATOR_VOLTAGE_SCALE1, RCC_HCLK_DIV2, "performance" }, /* 100 MHz */
+  [CLOCK_BALANCED]    = { true, 336, FLASH_LATENCY_2, PWR_REGULATOR_VOLTAGE_SCALE2, RCC_HCLK_DIV2, "balanced" },    /* 84 MHz */
+  [CLOCK_LOW_POWER]   = { false, 0,  FLASH_LATENCY_0, PWR_REGULATOR_VOLTAGE_SCALE3, RCC_HCLK_DIV1, "low_power" },   /* 16 MHz */
+};
+
+static clock_profile_t clock_profile = CLOCK_BALANCED;
+
+/*
+ * Flash can be neither read nor fetched from while a sector is erased or
+ * programmed, so everything that has to keep running meanwhile lives in RAM:
+ * the vector table, the UART handlers and their rings, and the erase and
+ * program loops themselves.
+ */
+#define VECTOR_COUNT (16 + 86)    /* SPI5 is the F411's last interrupt */
+
+extern const uint32_t g_pfnVectors[VECTOR_COUNT];
+static uint32_t ram_vectors[VECTOR_COUNT] __attribute__((aligned(512)));
+
+/*
+ * Erasing the fob state's 128 KB sector takes up to 2 s with x32
+ * programming (datasheet t_ERASE128KB), 23 KB of steady traffic at 115200
+ * baud, so the board ring holds that much and more
+ */
+#define BOARD_RX_SIZE 32768
+
+static uint8_t board_rx_data[BOARD_RX_SIZE];
+static uart_ring_t board_rx = UART_RING_INIT(board_rx_data);
+
+/* Queued for sending, moved into DR by each UART's TXE interrupt */
+static uint8_t tx_data[2][UART_RING_SIZE];
+static uart_ring_t tx_ring[2] = { UART_RING_INIT(tx_data[0]), UART_RING_INIT(tx_data[1]) };
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -95,6 +149,68 @@ static void MX_USART2_UART_Init(void);
 
 /* Private user code ---------------------------------------------------------*/
 /* USER CODE BEGIN 0 */
+/**
+ * @brief Reprogram the PLL, flash latency and regulator for a clock profile
+ *
+ * The PLL cannot be changed while it drives SYSCLK, so the core runs from
+ * the HSI in between. HAL_RCC_ClockConfig orders the flash latency change
+ * around the switch, and restarts SysTick for the new HCLK.
+ */
+static bool applyClockProfile(clock_profile_t profile)
+{
+  const clock_setting_t *setting = &clock_settings[profile];
+  RCC_OscInitTypeDef osc = {0};
+  RCC_ClkInitTypeDef clk = {0};
+  uint32_t latency;
+
+  HAL_RCC_GetClockConfig(&clk, &latency);
+  clk.ClockType = RCC_CLOCKTYPE_HCLK | RCC_CLOCKTYPE_SYSCLK | RCC_CLOCKTYPE_PCLK1 | RCC_CLOCKTYPE_PCLK2;
+  clk.SYSCLKSource = RCC_SYSCLKSOURCE_HSI;
+  clk.AHBCLKDivider = RCC_SYSCLK_DIV1;
+  clk.APB1CLKDivider = RCC_HCLK_DIV1;
+  clk.APB2CLKDivider = RCC_HCLK_DIV1;
+  if (HAL_RCC_ClockConfig(&clk, latency) != HAL_OK)
+  {
+    return false;
+  }
+
+  /* The regulator scale may only change with the PLL off */
+  osc.OscillatorType = RCC_OSCILLATORTYPE_NONE;
+  osc.PLL.PLLState = RCC_PLL_OFF;
+  if (HAL_RCC_OscConfig(&osc) != HAL_OK)
+  {
+    return false;
+  }
+  __HAL_RCC_PWR_CLK_ENABLE();
+  __HAL_PWR_VOLTAGESCALING_CONFIG(setting->voltageScale);
+
+  if (setting->pll)
+  {
+    osc.PLL.PLLState = RCC_PLL_ON;
+    osc.PLL.PLLSource = RCC_PLLSOURCE_HSI;
+    osc.PLL.PLLM = 16;
+    osc.PLL.PLLN = setting->pllN;
+    osc.PLL.PLLP = RCC_PLLP_DIV4;
+    osc.PLL.PLLQ = 8;
+    if (HAL_RCC_OscConfig(&osc) != HAL_OK)
+    {
+      return false;
+    }
+    clk.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
+  }
+  clk.APB1CLKDivider = setting->apb1Divider;
+  if (HAL_RCC_ClockConfig(&clk, setting->latency) != HAL_OK)
+  {
+    return false;
+  }
+
+  __HAL_FLASH_PREFETCH_BUFFER_ENABLE();
+  __HAL_FLASH_INSTRUCTION_CACHE_ENABLE();
+  __HAL_FLASH_DATA_CACHE_ENABLE();
+  clock_profile = profile;
+  return true;
+}
+
 static void initHardware(int argc, char ** argv)
 {
   /* Reset of all peripherals, Initializes the Flash interface and the Systick. */
@@ -102,15 +218,28 @@ static void initHardware(int argc, char ** argv)
 
   /* Configure the system clock */
   SystemClock_Config();
+  if (!applyClockProfile(CLOCK_PROFILE))
+  {
+    Error_Handler();
+  }
 
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
   
+  memcpy(ram_vectors, g_pfnVectors, sizeof(ram_vectors));
+  SCB->VTOR = (uint32_t)ram_vectors;
+  __DSB();
+
   //setup_board_link();
   uart_init(BOARD_UART, argc, argv);
   //uart_init();
   uart_init(HOST_UART, argc, argv);
 
+  // Start the DWT cycle counter for cycleCount()
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
   setLED(OFF);
 }
 
@@ -157,48 +286,78 @@ static uint32_t flash_sector_start(uint32_t sector)
   return start_addr[sector];
 }
 
-/* -----------------------------------------------------------
-   Config Flash Write (Overwrite Whole Sector)
-   ----------------------------------------------------------- */
-bool saveFobState(const FLASH_DATA *src)
+#define FLASH_ERROR_FLAGS (FLASH_FLAG_OPERR | FLASH_FLAG_WRPERR | FLASH_FLAG_PGAERR | \
+                           FLASH_FLAG_PGPERR | FLASH_FLAG_PGSERR | FLASH_FLAG_RDERR)
+
+/**
+ * @brief Wait for a flash operation to end, from RAM
+ *
+ * The SysTick handler is in flash, so its interrupt is off for the whole
+ * write and the HAL tick is kept here from the counter's wrap flag instead.
+ */
+__RAM_FUNC static bool flashWaitRam(void)
 {
-  FLASH_EraseInitTypeDef erase =
+  while (FLASH->SR & FLASH_SR_BSY)
   {
-      .TypeErase    = FLASH_TYPEERASE_SECTORS,
-      .Sector       = FLASH_SECTOR_5,
-      .NbSectors    = 1,
-      .VoltageRange = FLASH_VOLTAGE_RANGE_3,
-  };
+    if (SysTick->CTRL & SysTick_CTRL_COUNTFLAG_Msk)
+    {
+      uwTick += uwTickFreq;
+    }
+  }
+  return (FLASH->SR & FLASH_ERROR_FLAGS) == 0;
+}
 
-  uint8_t padded_data[FLASH_DATA_BYTES];
-  memset(padded_data, 0xFF, sizeof(padded_data));
-  memcpy((FLASH_DATA*)(&padded_data), src, sizeof(FLASH_DATA));
+/**
+ * @brief Erase a sector and program words from its start, all from RAM
+ *
+ * The same register sequence as HAL_FLASHEx_Erase and HAL_FLASH_Program
+ * with a 2.7-3.6 V supply, without their calls back into flash. The flash
+ * must be unlocked.
+ */
+__RAM_FUNC static bool flashRewriteSectorRam(uint32_t sector, uint32_t addr, const uint32_t *words, uint32_t count)
+{
+  bool ok;
 
-  uint32_t sector_err = 0;
-  HAL_FLASH_Unlock();
+  __HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_EOP | FLASH_ERROR_FLAGS);
+
+  FLASH->CR = (FLASH->CR & ~(FLASH_CR_PSIZE | FLASH_CR_SNB)) | FLASH_PSIZE_WORD |
+              FLASH_CR_SER | (sector << FLASH_CR_SNB_Pos);
+  FLASH->CR |= FLASH_CR_STRT;
+  ok = flashWaitRam();
+  FLASH->CR &= ~(FLASH_CR_SER | FLASH_CR_SNB);
 
-  if (HAL_FLASHEx_Erase(&erase, &sector_err) != HAL_OK)
+  FLASH->CR |= FLASH_CR_PG;
+  for (uint32_t i = 0; ok && i < count; i++)
   {
-      HAL_FLASH_Lock();
-      return false;
+    *(__IO uint32_t *)(addr + 4 * i) = words[i];
+    ok = flashWaitRam();
   }
+  FLASH->CR &= ~FLASH_CR_PG;
 
-  // Program new config data
-  const uint32_t *words = (const uint32_t *)padded_data;
-  uint32_t addr = flash_sector_start(FLASH_SECTOR_5);
+  return ok;
+}
 
-  for (size_t i = 0; i < FLASH_DATA_WORDS; i++)
-  {
-      if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, addr, words[i]) != HAL_OK) {
-          HAL_FLASH_Lock();
-          return false;
-      }
-      addr += 4;
-  }
+/* -----------------------------------------------------------
+   Config Flash Write (Overwrite Whole Sector)
+   ----------------------------------------------------------- */
+bool saveFobState(const FLASH_DATA *src)
+{
+  uint32_t padded_data[FLASH_DATA_WORDS];
+  memset(padded_data, 0xFF, sizeof(padded_data));
+  memcpy(padded_data, src, sizeof(FLASH_DATA));
+
+  HAL_FLASH_Unlock();
 
+  // The board UART keeps receiving into its ring while the sector erases
+  SysTick->CTRL &= ~SysTick_CTRL_TICKINT_Msk;
+  bool ok = flashRewriteSectorRam(FLASH_SECTOR_5, flash_sector_start(FLASH_SECTOR_5),
+                                  padded_data, FLASH_DATA_WORDS);
+  SysTick->CTRL |= SysTick_CTRL_TICKINT_Msk;
+
+  FLASH_FlushCaches();
   HAL_FLASH_Lock();
 
-  return true;
+  return ok;
 }
 
 bool buttonPressed(void)
@@ -223,6 +382,101 @@ bool buttonPressed(void)
   return false;
 }
 
+/**
+ * @brief This fob's board link address, folded from the 96-bit unique ID
+ * unless the image was built with addr= (BOARD_ADDR), for two boards whose
+ * IDs fold to the same address
+ *
+ * Never returns 0, CAR_ADDR or BROADCAST_ADDR.
+ */
+uint8_t boardLinkAddress(void)
+{
+#ifdef BOARD_ADDR
+  return BOARD_ADDR;
+#else
+  uint32_t uid = HAL_GetUIDw0() ^ HAL_GetUIDw1() ^ HAL_GetUIDw2();
+  uint8_t addr = (uint8_t)(uid ^ (uid >> 8) ^ (uid >> 16) ^ (uid >> 24));
+  return (addr < 0x02 || addr == 0xFF) ? 0x10 : addr;
+#endif
+}
+
+bool boardLinkShared(void)
+{
+#ifdef SHARED_BOARD_BUS
+  return true;
+#else
+  return false;
+#endif
+}
+
+void delayUs(uint32_t us)
+{
+  // About 4 cycles per iteration at -O2
+  for (volatile uint32_t i = 0; i < us * (SystemCoreClock / 4000000); i++);
+}
+
+/**
+ * @brief Microseconds since startup, wrapping at 2^32
+ *
+ * The HAL millisecond tick plus however far SysTick has counted down into
+ * the current millisecond. The tick is read on both sides of the counter so
+ * that a rollover in between is retried.
+ */
+uint32_t timeUs(void)
+{
+  uint32_t ms, count;
+
+  do
+  {
+    ms = HAL_GetTick();
+    count = SysTick->VAL;
+  } while (ms != HAL_GetTick());
+
+  uint32_t load = SysTick->LOAD + 1;
+  return ms * 1000 + ((load - 1 - count) * 1000) / load;
+}
+
+/**
+ * @brief Core cycles from the DWT counter, wrapping at 2^32 (clockHz() per second)
+ */
+uint32_t cycleCount(void)
+{
+  return DWT->CYCCNT;
+}
+
+/**
+ * @brief Switch to another clock profile
+ *
+ * Both UARTs finish sending first and are retimed for their new bus clock.
+ */
+bool setClockProfile(clock_profile_t profile)
+{
+  if (profile >= CLOCK_PROFILE_COUNT)
+  {
+    return false;
+  }
+
+  uart_flush(HOST_UART, UINT32_MAX);
+  uart_flush(BOARD_UART, UINT32_MAX);
+  if (!applyClockProfile(profile))
+  {
+    Error_Handler();
+  }
+  uart_reclock(HOST_UART);
+  uart_reclock(BOARD_UART);
+  return true;
+}
+
+clock_profile_t clockProfile(void)
+{
+  return clock_profile;
+}
+
+uint32_t clockHz(void)
+{
+  return HAL_RCC_GetHCLKFreq();
+}
+
 void setLED(led_color_t color)
 {
   HAL_GPIO_WritePin(LD2_GPIO_Port, LD2_Pin, color == GREEN);
@@ -239,20 +493,155 @@ void uart_init(hw_uart_t uart, int argc, char ** argv)
   {
   case HOST_UART:
     MX_USART2_UART_Init();
+    HAL_NVIC_SetPriority(USART2_IRQn, 0, 0);
+    HAL_NVIC_EnableIRQ(USART2_IRQn);
     break;
   case BOARD_UART:
     MX_USART1_UART_Init();
+    __HAL_UART_ENABLE_IT(&huart1, UART_IT_RXNE);
+    HAL_NVIC_SetPriority(USART1_IRQn, 0, 0);
+    HAL_NVIC_EnableIRQ(USART1_IRQn);
     break;
   }
 }
 
+/**
+ * @brief Recompute a UART's baud rate divider for the current system clock.
+ *
+ * @param uart is the UART to retime.
+ */
+void uart_reclock(hw_uart_t uart)
+{
+  while (!uart_ring_empty(&tx_ring[uart]) || __HAL_UART_GET_FLAG(uart_base[uart], UART_FLAG_TC) == RESET);
+  if (HAL_UART_Init(uart_base[uart]) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+
+// No platform state beyond what the application tracks
+uint32_t snapshotPlatform(uint8_t *dest, uint32_t max)
+{
+  return 0;
+}
+
+bool restorePlatform(const uint8_t *src, uint32_t len)
+{
+  return (len == 0);
+}
+
+static void reply(const char *msg)
+{
+  uart_write(HOST_UART, (uint8_t *)msg, strlen(msg));
+}
+
+/**
+ * @brief Handle STM32 test commands
+ *
+ *   clock [profile]  - report, or switch, the clock profile
+ *   bootloader       - reset into the bootloader's listening window
+ *
+ * @return true if the command was handled (and answered)
+ */
+bool processPlatformCommand(const char *cmd)
+{
+  char buf[48];
+
+  if (strcmp(cmd, "bootloader") == 0)
+  {
+    reply("OK\n");
+    BOOT_REQUEST(SRAM1_BASE + 0x20000) = BOOT_REQUEST_MAGIC;
+    softwareReset();
+  }
+
+  if (strncmp(cmd, "clock", 5) == 0 && (cmd[5] == '\0' || cmd[5] == ' '))
+  {
+    int profile = 0;
+    if (cmd[5] == ' ')
+    {
+      while (profile < CLOCK_PROFILE_COUNT && strcmp(cmd + 6, clock_settings[profile].name) != 0)
+      {
+        profile++;
+      }
+      if (!setClockProfile((clock_profile_t)profile))
+      {
+        reply("ERROR: invalid clock profile\n");
+        return true;
+      }
+    }
+    snprintf(buf, sizeof(buf), "OK: profile=%s,hz=%lu\n",
+             clock_settings[clock_profile].name, (unsigned long)clockHz());
+    reply(buf);
+    return true;
+  }
+
+  return false;
+}
+
 void softwareReset(void)
 {
+    /* Give queued bytes a moment to go out */
+    uart_flush(HOST_UART, RESET_FLUSH_US);
+    uart_flush(BOARD_UART, RESET_FLUSH_US);
     NVIC_SystemReset();
     // Won't reach here
     while(1);
 }
 
+/**
+ * @brief Move the next queued byte into DR
+ *
+ * TXEIE is set by the main loop once it has queued bytes and cleared here
+ * once there are none left.
+ */
+static inline __attribute__((always_inline)) void tx_service(USART_TypeDef *usart, uart_ring_t *ring)
+{
+  if ((usart->CR1 & USART_CR1_TXEIE) && (usart->SR & USART_SR_TXE))
+  {
+    if (uart_ring_empty(ring))
+    {
+      CLEAR_BIT(usart->CR1, USART_CR1_TXEIE);
+    }
+    else
+    {
+      usart->DR = uart_ring_get(ring);
+    }
+  }
+}
+
+/**
+ * @brief Host UART interrupt, from RAM: only transmit is interrupt driven
+ */
+__RAM_FUNC void USART2_IRQHandler(void)
+{
+  tx_service(USART2, &tx_ring[HOST_UART]);
+}
+
+/**
+ * @brief Board UART interrupt, from RAM
+ *
+ * Reading SR then DR clears both RXNE and an overrun; a byte lost to the
+ * overrun is counted with those the full ring turned away.
+ */
+__RAM_FUNC void USART1_IRQHandler(void)
+{
+  uint32_t sr = USART1->SR;
+
+  if (sr & (USART_SR_RXNE | USART_SR_ORE))
+  {
+    uint8_t byte = USART1->DR;
+    if (sr & USART_SR_ORE)
+    {
+      board_rx.dropped++;
+    }
+    if (sr & USART_SR_RXNE)
+    {
+      uart_ring_put(&board_rx, byte);
+    }
+  }
+  tx_service(USART1, &tx_ring[BOARD_UART]);
+}
+
 /**
  * @brief Check if there are characters available on a UART interface.
  *
@@ -260,7 +649,14 @@ void softwareReset(void)
  * @return true if there is data available.
  * @return false if there is no data available.
  */
-bool uart_avail(hw_uart_t uart) { return (__HAL_UART_GET_FLAG(uart_base[uart], UART_FLAG_RXNE) != RESET); }
+bool uart_avail(hw_uart_t uart)
+{
+  if (uart == BOARD_UART)
+  {
+    return !uart_ring_empty(&board_rx);
+  }
+  return (__HAL_UART_GET_FLAG(uart_base[uart], UART_FLAG_RXNE) != RESET);
+}
 
 /**
  * @brief Read a byte from a UART interface.
@@ -270,7 +666,12 @@ bool uart_avail(hw_uart_t uart) { return (__HAL_UART_GET_FLAG(uart_base[uart], U
  */
 int32_t uart_readb(hw_uart_t uart)
 {
-  int32_t c;
+  int32_t c = 0;
+  if (uart == BOARD_UART)
+  {
+    while (uart_ring_empty(&board_rx));
+    return uart_ring_get(&board_rx);
+  }
   HAL_UART_Receive(uart_base[uart], (uint8_t*)(&c), 1, HAL_MAX_DELAY);
   return c;
 }
@@ -285,6 +686,14 @@ int32_t uart_readb(hw_uart_t uart)
  */
 uint32_t uart_read(hw_uart_t uart, uint8_t *buf, uint32_t n)
 {
+  if (uart == BOARD_UART)
+  {
+    for (uint32_t i = 0; i < n; i++)
+    {
+      buf[i] = uart_readb(uart);
+    }
+    return n;
+  }
   HAL_UART_Receive(uart_base[uart], buf, n, HAL_MAX_DELAY);
   return n;
 }
@@ -303,7 +712,14 @@ uint32_t uart_readline(hw_uart_t uart, uint8_t *buf) {
 
   do
   {
-    HAL_UART_Receive(base, &c, 1, HAL_MAX_DELAY);
+    if (uart == BOARD_UART)
+    {
+      c = uart_readb(uart);
+    }
+    else
+    {
+      HAL_UART_Receive(base, &c, 1, HAL_MAX_DELAY);
+    }
 
     if ((c != '\r') && (c != '\n') && (c != 0xD))
     {
@@ -326,12 +742,14 @@ uint32_t uart_readline(hw_uart_t uart, uint8_t *buf) {
  */
 void uart_writeb(hw_uart_t uart, uint8_t data)
 {
-  HAL_UART_Transmit(uart_base[uart], &data, 1, HAL_MAX_DELAY);
+  uart_write(uart, &data, 1);
 }
 
 /**
  * @brief Write a sequence of bytes to a UART interface.
  *
+ * Waits only while the transmit queue is full.
+ *
  * @param uart is the base address of the UART port to write to.
  * @param buf is a pointer to the data to send.
  * @param len is the number of bytes to send.
@@ -339,9 +757,70 @@ void uart_writeb(hw_uart_t uart, uint8_t data)
  */
 uint32_t uart_write(hw_uart_t uart, uint8_t *buf, uint32_t len)
 {
-  HAL_UART_Transmit(uart_base[uart], buf, len, HAL_MAX_DELAY);
+  uint32_t i = 0;
+
+  while (i < len)
+  {
+    i += uart_write_async(uart, buf + i, len - i);
+  }
   return len;
 }
+
+/**
+ * @brief Queue as much of a sequence of bytes as there is room for.
+ *
+ * @param uart is the UART to write to.
+ * @param buf is a pointer to the data to send.
+ * @param len is the number of bytes to send.
+ * @return the number of bytes queued.
+ */
+uint32_t uart_write_async(hw_uart_t uart, const uint8_t *buf, uint32_t len)
+{
+  uart_ring_t *ring = &tx_ring[uart];
+  uint32_t i;
+
+  for (i = 0; i < len && uart_ring_free(ring) > 0; i++)
+  {
+    uart_ring_put(ring, buf[i]);
+  }
+  if (i > 0)
+  {
+    SET_BIT(uart_base[uart]->Instance->CR1, USART_CR1_TXEIE);
+  }
+  return i;
+}
+
+/**
+ * @brief Room left in a UART's transmit queue.
+ *
+ * @param uart is the UART to check.
+ * @return the number of bytes uart_write_async() would take now.
+ */
+uint32_t uart_tx_free(hw_uart_t uart)
+{
+  return uart_ring_free(&tx_ring[uart]);
+}
+
+/**
+ * @brief Wait for a UART's queued bytes to be sent.
+ *
+ * @param uart is the UART to flush.
+ * @param timeout_us is how long to wait at most.
+ * @return true if the queue emptied and the UART finished sending in time.
+ */
+bool uart_flush(hw_uart_t uart, uint32_t timeout_us)
+{
+  uint32_t start = timeUs();
+
+  while (!uart_ring_empty(&tx_ring[uart]) || __HAL_UART_GET_FLAG(uart_base[uart], UART_FLAG_TC) == RESET)
+  {
+    if (timeUs() - start >= timeout_us)
+    {
+      return false;
+    }
+  }
+  return true;
+}
 /* USER CODE END 0 */
 
 /**
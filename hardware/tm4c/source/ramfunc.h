@@ -0,0 +1,17 @@
+/**
+ * @file ramfunc.h
+ * @brief Code that runs from SRAM
+ *
+ * Flash cannot be read while it is erased or programmed, and the core
+ * stalls on any fetch from it until the operation ends. Functions marked
+ * RAMFUNC are linked into the .ramfunc section, which firmware.ld places in
+ * .data so that the startup code copies them to SRAM with the rest of it.
+ * Calls between flash and SRAM go through linker veneers.
+ */
+
+#ifndef RAMFUNC_H
+#define RAMFUNC_H
+
+#define RAMFUNC __attribute__((section(".ramfunc"), noinline))
+
+#endif // RAMFUNC_H
@@ -1,20 +1,23 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
+#include <stdio.h>
 #include <string.h>
 
+#include "inc/hw_flash.h"
 #include "inc/hw_nvic.h"
 #include "inc/hw_types.h"
 #include "inc/hw_memmap.h"
 #include "driverlib/eeprom.h"
 #include "driverlib/gpio.h"
 #include "driverlib/sysctl.h"
-#include "driverlib/flash.h"
 
+#include "boot_request.h"
 #include "messages.h"
 #include "uart.h"
 #include "dataFormats.h"
 #include "platform.h"
+#include "ramfunc.h"
 
 #define UNLOCK_EEPROM_LOC 0x7C0
 #define FEATURE_END 0x7C0
@@ -22,18 +25,70 @@
 #define FEATURE2_LOC (FEATURE_END - 2*FEATURE_SIZE)
 #define FEATURE3_LOC (FEATURE_END - 3*FEATURE_SIZE)
 
+#define BOARD_ADDR_EEPROM_LOC 0x000
+#define DEFAULT_BOARD_ADDR 0x10
+
+// Cortex-M4 debug cycle counter, used as the time base
+#define DEMCR 0xE000EDFC
+#define DEMCR_TRCENA 0x01000000
+#define DWT_CTRL 0xE0001000
+#define DWT_CTRL_CYCCNTENA 0x00000001
+#define DWT_CYCCNT 0xE0001004
+
 #define FOB_STATE_PTR 0x3FC00
 #define FLASH_DATA_SIZE         \
  		(sizeof(FLASH_DATA) % 4 == 0) \
   	 		? sizeof(FLASH_DATA)      \
      		: sizeof(FLASH_DATA) + (4 - (sizeof(FLASH_DATA) % 4))
 
+// A full transmit queue takes about 90 ms at 115200 baud
+#define RESET_FLUSH_US 100000
+
+#define SRAM_END 0x20008000
+
 static uint8_t previous_sw_state = GPIO_PIN_4;
 static uint8_t debounce_sw_state = GPIO_PIN_4;
 static uint8_t current_sw_state = GPIO_PIN_4;
 
+static uint32_t cycles_per_us;
+static uint32_t last_cycles;
+static uint32_t elapsed_us;
+static uint32_t spare_cycles;
+
+/*
+ * Clock profiles. The TM4C123's flash needs no wait state setting: above
+ * 40 MHz its prefetch buffer inserts them in hardware, so a profile is just
+ * the SysCtlClockSet configuration and the frequency it gives. The
+ * frequency is kept here rather than read back with SysCtlClockGet, which
+ * reports 66.67 MHz for the 80 MHz divider on some TivaWare releases.
+ */
+static const struct
+{
+	uint32_t config;
+	uint32_t hz;
+	const char *name;	// for the clock test command
+} clock_profiles[CLOCK_PROFILE_COUNT] = {
+	// 400 MHz PLL / 2 / 2.5, from the 16 MHz crystal
+	[CLOCK_PERFORMANCE] = { SYSCTL_SYSDIV_2_5 | SYSCTL_USE_PLL | SYSCTL_OSC_MAIN | SYSCTL_XTAL_16MHZ, 80000000, "performance" },
+	// 400 MHz PLL / 2 / 5
+	[CLOCK_BALANCED] = { SYSCTL_SYSDIV_5 | SYSCTL_USE_PLL | SYSCTL_OSC_MAIN | SYSCTL_XTAL_16MHZ, 40000000, "balanced" },
+	// 16 MHz PIOSC, the reset clock, with the main oscillator and PLL off
+	[CLOCK_LOW_POWER] = { SYSCTL_SYSDIV_1 | SYSCTL_USE_OSC | SYSCTL_OSC_INT | SYSCTL_MAIN_OSC_DIS, 16000000, "low_power" },
+};
+
+static clock_profile_t clock_profile = CLOCK_PROFILE;
+
+static void applyClockProfile(clock_profile_t profile)
+{
+	SysCtlClockSet(clock_profiles[profile].config);
+	clock_profile = profile;
+	cycles_per_us = clock_profiles[profile].hz / 1000000;
+}
+
 static void initHardware(int argc, char ** argv)
 {
+	applyClockProfile(CLOCK_PROFILE);
+
 	// Ensure EEPROM peripheral is enabled
 	SysCtlPeripheralEnable(SYSCTL_PERIPH_EEPROM0);
 	EEPROMInit();
@@ -43,6 +98,11 @@ static void initHardware(int argc, char ** argv)
 
 	// Initialize board link UART
 	uart_init(BOARD_UART, argc, argv);
+
+	// Start the cycle counter for timeUs() and cycleCount()
+	HWREG(DEMCR) |= DEMCR_TRCENA;
+	HWREG(DWT_CYCCNT) = 0;
+	HWREG(DWT_CTRL) |= DWT_CTRL_CYCCNTENA;
 }
 
 void initHardware_car(int argc, char ** argv)
@@ -108,11 +168,154 @@ void loadFobState(FLASH_DATA *dest)
   memcpy(dest, (FLASH_DATA*)FOB_STATE_PTR, sizeof(FLASH_DATA));
 }
 
+/**
+ * @brief Erase a flash block and program words from its start, from SRAM
+ *
+ * The register sequence of driverlib's FlashErase and FlashProgram, which
+ * run from flash and so would stall the board UART's interrupt for the
+ * whole erase. count is in bytes, a multiple of 4.
+ */
+RAMFUNC static bool flashRewriteRam(uint32_t address, const uint32_t *data, uint32_t count)
+{
+  HWREG(FLASH_FCMISC) = (FLASH_FCMISC_AMISC | FLASH_FCMISC_VOLTMISC | FLASH_FCMISC_ERMISC |
+                         FLASH_FCMISC_INVDMISC | FLASH_FCMISC_PROGMISC);
+
+  HWREG(FLASH_FMA) = address;
+  HWREG(FLASH_FMC) = FLASH_FMC_WRKEY | FLASH_FMC_ERASE;
+  while (HWREG(FLASH_FMC) & FLASH_FMC_ERASE)
+  {
+  }
+  if (HWREG(FLASH_FCRIS) & (FLASH_FCRIS_ARIS | FLASH_FCRIS_VOLTRIS | FLASH_FCRIS_ERRIS))
+  {
+    return false;
+  }
+
+  // One 32-word write buffer at a time
+  while (count)
+  {
+    HWREG(FLASH_FMA) = address & ~0x7f;
+    while (((address & 0x7c) || (HWREG(FLASH_FWBVAL) == 0)) && count)
+    {
+      HWREG(FLASH_FWBN + (address & 0x7c)) = *data++;
+      address += 4;
+      count -= 4;
+    }
+    HWREG(FLASH_FMC2) = FLASH_FMC2_WRKEY | FLASH_FMC2_WRBUF;
+    while (HWREG(FLASH_FMC2) & FLASH_FMC2_WRBUF)
+    {
+    }
+  }
+
+  return !(HWREG(FLASH_FCRIS) & (FLASH_FCRIS_ARIS | FLASH_FCRIS_VOLTRIS |
+                                 FLASH_FCRIS_INVDRIS | FLASH_FCRIS_PROGRIS));
+}
+
 bool saveFobState(const FLASH_DATA *flash_data)
 {
-  FlashErase(FOB_STATE_PTR);
-  FlashProgram((uint32_t *)flash_data, FOB_STATE_PTR, FLASH_DATA_SIZE);
-  return true;
+  uint32_t padded[(FLASH_DATA_SIZE) / 4];
+  memset(padded, 0xFF, sizeof(padded));
+  memcpy(padded, flash_data, sizeof(FLASH_DATA));
+
+  return flashRewriteRam(FOB_STATE_PTR, padded, sizeof(padded));
+}
+
+/**
+ * @brief This fob's board link address
+ *
+ * The TM4C123 has no unique device ID, so the address is provisioned in the
+ * first EEPROM word. An image built with addr= (BOARD_ADDR) writes it there
+ * on boot, and images built without one keep it. An erased word gives the
+ * default, which only suits a fob alone on the link.
+ */
+uint8_t boardLinkAddress(void)
+{
+	uint32_t word = 0xFFFFFFFF;
+	EEPROMRead(&word, BOARD_ADDR_EEPROM_LOC, sizeof(word));
+
+#ifdef BOARD_ADDR
+	if (word != BOARD_ADDR)
+	{
+		word = BOARD_ADDR;
+		EEPROMProgram(&word, BOARD_ADDR_EEPROM_LOC, sizeof(word));
+	}
+#endif
+
+	uint8_t addr = (uint8_t)word;
+	return (addr < 0x02 || addr == 0xFF) ? DEFAULT_BOARD_ADDR : addr;
+}
+
+bool boardLinkShared(void)
+{
+#ifdef SHARED_BOARD_BUS
+	return true;
+#else
+	return false;
+#endif
+}
+
+void delayUs(uint32_t us)
+{
+	// SysCtlDelay takes 3 cycles per loop
+	SysCtlDelay(us * cycles_per_us / 3);
+}
+
+/**
+ * @brief Switch to another clock profile
+ *
+ * Time counted so far is carried over at the old rate, and both UARTs are
+ * retimed once their last byte is out.
+ */
+bool setClockProfile(clock_profile_t profile)
+{
+	if (profile >= CLOCK_PROFILE_COUNT)
+		return false;
+
+	// Queued bytes go out at the old rate
+	uart_flush(HOST_UART, UINT32_MAX);
+	uart_flush(BOARD_UART, UINT32_MAX);
+
+	timeUs();
+	spare_cycles = 0;
+	applyClockProfile(profile);
+	uart_reclock(HOST_UART);
+	uart_reclock(BOARD_UART);
+	return true;
+}
+
+clock_profile_t clockProfile(void)
+{
+	return clock_profile;
+}
+
+uint32_t clockHz(void)
+{
+	return clock_profiles[clock_profile].hz;
+}
+
+/**
+ * @brief Microseconds since startup, wrapping at 2^32
+ *
+ * The cycle counter wraps every 53 s at 80 MHz, so whole microseconds are
+ * carried over into a 32-bit count on each call; intervals measured with
+ * it must be read at least that often.
+ */
+uint32_t timeUs(void)
+{
+	uint32_t now = HWREG(DWT_CYCCNT);
+
+	spare_cycles += now - last_cycles;
+	last_cycles = now;
+	elapsed_us += spare_cycles / cycles_per_us;
+	spare_cycles %= cycles_per_us;
+	return elapsed_us;
+}
+
+/**
+ * @brief Core cycles from the DWT counter, wrapping at 2^32 (clockHz() per second)
+ */
+uint32_t cycleCount(void)
+{
+	return HWREG(DWT_CYCCNT);
 }
 
 void setLED(led_color_t color)
@@ -159,8 +362,69 @@ bool buttonPressed(void)
     return pressed;    
 }
 
+// No platform state beyond what the application tracks
+uint32_t snapshotPlatform(uint8_t *dest, uint32_t max)
+{
+    return 0;
+}
+
+bool restorePlatform(const uint8_t *src, uint32_t len)
+{
+    return (len == 0);
+}
+
+static void reply(const char *msg)
+{
+	uart_write(HOST_UART, (uint8_t*)msg, strlen(msg));
+}
+
+/**
+ * @brief Handle TM4C test commands
+ *
+ *   clock [profile]  - report, or switch, the clock profile
+ *   bootloader       - reset into the bootloader's listening window
+ *
+ * @return true if the command was handled (and answered)
+ */
+bool processPlatformCommand(const char *cmd)
+{
+	char buf[48];
+
+	if (strcmp(cmd, "bootloader") == 0)
+	{
+		reply("OK\n");
+		BOOT_REQUEST(SRAM_END) = BOOT_REQUEST_MAGIC;
+		softwareReset();
+	}
+
+	if (strncmp(cmd, "clock", 5) == 0 && (cmd[5] == '\0' || cmd[5] == ' '))
+	{
+		int profile = 0;
+		if (cmd[5] == ' ')
+		{
+			while (profile < CLOCK_PROFILE_COUNT && strcmp(cmd + 6, clock_profiles[profile].name) != 0)
+				profile++;
+			if (!setClockProfile((clock_profile_t)profile))
+			{
+				reply("ERROR: invalid clock profile\n");
+				return true;
+			}
+		}
+		snprintf(buf, sizeof(buf), "OK: profile=%s,hz=%lu\n",
+				 clock_profiles[clock_profile].name, (unsigned long)clockHz());
+		reply(buf);
+		return true;
+	}
+
+	return false;
+}
+
 void softwareReset(void)
 {
+    // Give queued bytes a moment to go out
+    uart_flush(HOST_UART, RESET_FLUSH_US);
+    uart_flush(BOARD_UART, RESET_FLUSH_US);
+
     // Request system reset via NVIC
     HWREG(NVIC_APINT) = NVIC_APINT_VECTKEY | NVIC_APINT_SYSRESETREQ;
     // Won't reach here
@@ -18,6 +18,7 @@
 
 #include "driverlib/fpu.h"
 #include "driverlib/gpio.h"
+#include "driverlib/interrupt.h"
 #include "driverlib/pin_map.h"
 #include "driverlib/sysctl.h"
 #include "driverlib/uart.h"
@@ -25,10 +26,90 @@
 #include "inc/hw_types.h"
 #include "inc/hw_uart.h"
 
+#include "platform.h"
+#include "ramfunc.h"
 #include "uart.h"
+#include "uart_ring.h"
 
 static uint32_t const uart_base[2] = { [HOST_UART] = UART0_BASE, [BOARD_UART] = UART1_BASE };
 
+// Filled by the board UART's interrupt, so the link keeps receiving while
+// flash is busy and the 16-byte FIFO alone would overflow
+static uint8_t board_rx_data[UART_RING_SIZE];
+static uart_ring_t board_rx = UART_RING_INIT(board_rx_data);
+
+// Queued for sending, moved into the TX FIFO by each UART's interrupt
+static uint8_t tx_data[2][UART_RING_SIZE];
+static uart_ring_t tx_ring[2] = { UART_RING_INIT(tx_data[0]), UART_RING_INIT(tx_data[1]) };
+
+/**
+ * @brief Top up a UART's TX FIFO from its queue
+ *
+ * Called by the interrupt handlers while the TX interrupt is unmasked, and
+ * by tx_kick while it is masked.
+ */
+static inline __attribute__((always_inline)) void tx_fill(uint32_t base, uart_ring_t *ring) {
+  while (!uart_ring_empty(ring) && !(HWREG(base + UART_O_FR) & UART_FR_TXFF)) {
+    HWREG(base + UART_O_DR) = uart_ring_get(ring);
+  }
+}
+
+/**
+ * @brief Host UART interrupt, from SRAM: only transmit is interrupt driven
+ */
+RAMFUNC static void host_uart_isr(void) {
+  HWREG(UART0_BASE + UART_O_ICR) = HWREG(UART0_BASE + UART_O_MIS);
+  tx_fill(UART0_BASE, &tx_ring[HOST_UART]);
+}
+
+/**
+ * @brief Board UART interrupt, from SRAM
+ *
+ * Registered with UARTIntRegister, which moves the vector table to SRAM.
+ * Bytes received with an error are dropped, and an overrun counts the byte
+ * the FIFO lost before them. The TX FIFO is then topped up from the queue.
+ */
+RAMFUNC static void board_uart_isr(void) {
+  HWREG(UART1_BASE + UART_O_ICR) = HWREG(UART1_BASE + UART_O_MIS);
+
+  while (!(HWREG(UART1_BASE + UART_O_FR) & UART_FR_RXFE)) {
+    uint32_t data = HWREG(UART1_BASE + UART_O_DR);
+
+    if (data & UART_DR_OE) {
+      board_rx.dropped++;
+    }
+    if (data & (UART_DR_BE | UART_DR_PE | UART_DR_FE)) {
+      board_rx.dropped++;
+    } else {
+      uart_ring_put(&board_rx, (uint8_t)data);
+    }
+  }
+  // Not while tx_kick has the queue: a receive interrupt still gets in
+  if (HWREG(UART1_BASE + UART_O_IM) & UART_IM_TXIM) {
+    tx_fill(UART1_BASE, &tx_ring[BOARD_UART]);
+  }
+}
+
+/**
+ * @brief Start sending newly queued bytes
+ *
+ * The TX interrupt fires only as the FIFO drains past its trigger level, so
+ * the main loop fills the FIFO itself; the interrupt is masked meanwhile so
+ * that the queue keeps a single reader.
+ */
+static void tx_kick(hw_uart_t uart) {
+  UARTIntDisable(uart_base[uart], UART_INT_TX);
+  tx_fill(uart_base[uart], &tx_ring[uart]);
+  UARTIntEnable(uart_base[uart], UART_INT_TX);
+}
+
+// Configure the UART for 115,200, 8-N-1 operation at the current clock
+static void set_baud(hw_uart_t uart) {
+  UARTConfigSetExpClk(
+      uart_base[uart], clockHz(), 115200,
+      (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE));
+}
+
 /**
  * @brief Initialize the UART interfaces.
  *
@@ -59,10 +140,11 @@ void uart_init(hw_uart_t uart, int argc, char ** argv) {
     // AMSEL  Analog Mode Select
     GPIOPinTypeUART(GPIO_PORTA_BASE, GPIO_PIN_0 | GPIO_PIN_1);
 
-    // Configure the UART for 115,200, 8-N-1 operation.
-    UARTConfigSetExpClk(
-        uart_base[HOST_UART], SysCtlClockGet(), 115200,
-        (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE));
+    set_baud(HOST_UART);
+
+    UARTIntRegister(uart_base[HOST_UART], host_uart_isr);
+    UARTIntEnable(uart_base[HOST_UART], UART_INT_TX);
+    IntMasterEnable();
     break;
   case BOARD_UART:
     SysCtlPeripheralEnable(SYSCTL_PERIPH_UART1);
@@ -72,19 +154,37 @@ void uart_init(hw_uart_t uart, int argc, char ** argv) {
     GPIOPinConfigure(GPIO_PB1_U1TX);
 
     GPIOPinTypeUART(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+#ifdef SHARED_BOARD_BUS
+    // Multi-drop board bus: TX and RX of every board share one line, so TX
+    // must be open-drain with a pull-up (wired-AND)
+    GPIOPadConfigSet(GPIO_PORTB_BASE, GPIO_PIN_1, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_OD);
+    GPIOPadConfigSet(GPIO_PORTB_BASE, GPIO_PIN_0, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD_WPU);
+#endif
 
-    // Configure the UART for 115,200, 8-N-1 operation.
-    UARTConfigSetExpClk(
-        uart_base[BOARD_UART], SysCtlClockGet(), 115200,
-        (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE));
+    set_baud(BOARD_UART);
 
-    while (UARTCharsAvail(BOARD_UART)) {
-      UARTCharGet(BOARD_UART);
+    while (UARTCharsAvail(uart_base[BOARD_UART])) {
+      UARTCharGet(uart_base[BOARD_UART]);
     }
+
+    UARTIntRegister(uart_base[BOARD_UART], board_uart_isr);
+    UARTIntEnable(uart_base[BOARD_UART], UART_INT_RX | UART_INT_RT | UART_INT_TX);
+    IntMasterEnable();
     break;
   }
 }
 
+/**
+ * @brief Recompute a UART's baud rate divider for the current system clock.
+ *
+ * @param uart is the UART to retime.
+ */
+void uart_reclock(hw_uart_t uart) {
+  while (!uart_ring_empty(&tx_ring[uart]) || UARTBusy(uart_base[uart])) {
+  }
+  set_baud(uart);
+}
+
 /**
  * @brief Check if there are characters available on a UART interface.
  *
@@ -92,7 +192,12 @@ void uart_init(hw_uart_t uart, int argc, char ** argv) {
  * @return true if there is data available.
  * @return false if there is no data available.
  */
-bool uart_avail(hw_uart_t uart) { return UARTCharsAvail(uart_base[uart]); }
+bool uart_avail(hw_uart_t uart) {
+  if (uart == BOARD_UART) {
+    return !uart_ring_empty(&board_rx);
+  }
+  return UARTCharsAvail(uart_base[uart]);
+}
 
 /**
  * @brief Read a byte from a UART interface.
@@ -100,7 +205,14 @@ bool uart_avail(hw_uart_t uart) { return UARTCharsAvail(uart_base[uart]); }
  * @param uart is the base address of the UART port to read from.
  * @return the character read from the interface.
  */
-int32_t uart_readb(hw_uart_t uart) { return UARTCharGet(uart_base[uart]); }
+int32_t uart_readb(hw_uart_t uart) {
+  if (uart == BOARD_UART) {
+    while (uart_ring_empty(&board_rx)) {
+    }
+    return uart_ring_get(&board_rx);
+  }
+  return UARTCharGet(uart_base[uart]);
+}
 
 /**
  * @brief Read a sequence of bytes from a UART interface.
@@ -151,22 +263,70 @@ uint32_t uart_readline(hw_uart_t uart, uint8_t *buf) {
  * @param uart is the base address of the UART port to write to.
  * @param data is the byte value to write.
  */
-void uart_writeb(hw_uart_t uart, uint8_t data) { UARTCharPut(uart_base[uart], data); }
+void uart_writeb(hw_uart_t uart, uint8_t data) { uart_write(uart, &data, 1); }
 
 /**
  * @brief Write a sequence of bytes to a UART interface.
  *
+ * Waits only while the transmit queue is full.
+ *
  * @param uart is the base address of the UART port to write to.
  * @param buf is a pointer to the data to send.
  * @param len is the number of bytes to send.
  * @return the number of bytes written.
  */
 uint32_t uart_write(hw_uart_t uart, uint8_t *buf, uint32_t len) {
+  uint32_t i = 0;
+
+  while (i < len) {
+    i += uart_write_async(uart, buf + i, len - i);
+  }
+
+  return i;
+}
+
+/**
+ * @brief Queue as much of a sequence of bytes as there is room for.
+ *
+ * @param uart is the UART to write to.
+ * @param buf is a pointer to the data to send.
+ * @param len is the number of bytes to send.
+ * @return the number of bytes queued.
+ */
+uint32_t uart_write_async(hw_uart_t uart, const uint8_t *buf, uint32_t len) {
+  uart_ring_t *ring = &tx_ring[uart];
   uint32_t i;
 
-  for (i = 0; i < len; i++) {
-    uart_writeb(uart, buf[i]);
+  for (i = 0; i < len && uart_ring_free(ring) > 0; i++) {
+    uart_ring_put(ring, buf[i]);
   }
+  tx_kick(uart);
 
   return i;
 }
+
+/**
+ * @brief Room left in a UART's transmit queue.
+ *
+ * @param uart is the UART to check.
+ * @return the number of bytes uart_write_async() would take now.
+ */
+uint32_t uart_tx_free(hw_uart_t uart) { return uart_ring_free(&tx_ring[uart]); }
+
+/**
+ * @brief Wait for a UART's queued bytes to be sent.
+ *
+ * @param uart is the UART to flush.
+ * @param timeout_us is how long to wait at most.
+ * @return true if the queue emptied and the UART finished sending in time.
+ */
+bool uart_flush(hw_uart_t uart, uint32_t timeout_us) {
+  uint32_t start = timeUs();
+
+  while (!uart_ring_empty(&tx_ring[uart]) || UARTBusy(uart_base[uart])) {
+    if (timeUs() - start >= timeout_us) {
+      return false;
+    }
+  }
+  return true;
+}
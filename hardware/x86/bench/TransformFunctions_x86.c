@@ -0,0 +1,60 @@
+/**
+ * @file TransformFunctions_x86.c
+ * @brief CMSIS-DSP TransformFunctions group for the x86 backend
+ *
+ * The same sources as Source/TransformFunctions/TransformFunctions.c, except
+ * that the library's arm_cfft_f32 is built as arm_cfft_f32_ref so that the
+ * version in arm_cfft_f32_x86.c takes its place, including for the real and
+ * MFCC transforms in this group that call it.
+ */
+
+#include "arm_math.h"
+#include "dsp_x86.h"
+
+#include "arm_bitreversal.c"
+#include "arm_bitreversal2.c"
+#define arm_cfft_f32 arm_cfft_f32_ref
+#include "arm_cfft_f32.c"
+#undef arm_cfft_f32
+#include "arm_cfft_f64.c"
+#include "arm_cfft_q15.c"
+#include "arm_cfft_q31.c"
+#include "arm_cfft_init_f32.c"
+#include "arm_cfft_init_f64.c"
+#include "arm_cfft_init_q15.c"
+#include "arm_cfft_init_q31.c"
+#include "arm_cfft_radix2_f32.c"
+#include "arm_cfft_radix2_q15.c"
+#include "arm_cfft_radix2_q31.c"
+#include "arm_cfft_radix4_f32.c"
+#include "arm_cfft_radix4_q15.c"
+#include "arm_cfft_radix4_q31.c"
+#include "arm_cfft_radix8_f32.c"
+#include "arm_rfft_fast_f32.c"
+#include "arm_rfft_fast_f64.c"
+#include "arm_rfft_fast_init_f32.c"
+#include "arm_rfft_fast_init_f64.c"
+#include "arm_mfcc_init_f32.c"
+#include "arm_mfcc_f32.c"
+#include "arm_mfcc_init_q31.c"
+#include "arm_mfcc_q31.c"
+#include "arm_mfcc_init_q15.c"
+#include "arm_mfcc_q15.c"
+#include "arm_dct4_f32.c"
+#include "arm_dct4_init_f32.c"
+#include "arm_dct4_init_q15.c"
+#include "arm_dct4_init_q31.c"
+#include "arm_dct4_q15.c"
+#include "arm_dct4_q31.c"
+#include "arm_rfft_f32.c"
+#include "arm_rfft_q15.c"
+#include "arm_rfft_q31.c"
+#include "arm_rfft_init_f32.c"
+#include "arm_rfft_init_q15.c"
+#include "arm_rfft_init_q31.c"
+#include "arm_cfft_radix4_init_f32.c"
+#include "arm_cfft_radix4_init_q15.c"
+#include "arm_cfft_radix4_init_q31.c"
+#include "arm_cfft_radix2_init_f32.c"
+#include "arm_cfft_radix2_init_q15.c"
+#include "arm_cfft_radix2_init_q31.c"
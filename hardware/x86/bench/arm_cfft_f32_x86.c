@@ -0,0 +1,351 @@
+/**
+ * @file arm_cfft_f32_x86.c
+ * @brief AVX2/FMA arm_cfft_f32 for x86 hosts
+ *
+ * A radix-4 Stockham autosort FFT with a final radix-2 pass for odd powers
+ * of two. Each pass reads four contiguous streams and writes one, and the
+ * output comes out in natural order, so there is no separate bit reversal
+ * pass and no scattered access at any length; at CMSIS-DSP's largest size
+ * (4096) the data and the ping-pong buffer together stay within L2.
+ *
+ * The first pass works on four butterflies at a time and transposes them
+ * on the way out; later passes, where the stride is at least four, work on
+ * four neighbouring sub-transforms at a time with one broadcast twiddle.
+ *
+ * Results match the generic version within rounding, including the order
+ * of the output when bitReverseFlag is 0: the natural-order result is then
+ * put back into the instance's digit-reversed order. Lengths the instance
+ * does not describe, and CPUs without AVX2 and FMA, use the generic code.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <immintrin.h>
+
+#include "arm_math.h"
+#include "dsp_x86.h"
+
+/*******************************************************************************
+ * Configuration
+ ******************************************************************************/
+#define CFFT_MIN_LOG2 4
+#define CFFT_MAX_LOG2 12
+#define CFFT_MAX_LEN (1u << CFFT_MAX_LOG2)
+
+/*******************************************************************************
+ * Twiddles
+ ******************************************************************************/
+/**
+ * @brief Per-length twiddles, interleaved re/im, computed in double
+ *
+ * w[k] = exp(-2*pi*i*k/N) for k < N serves the strided passes; the first
+ * pass reads w^p, w^2p and w^3p for consecutive p from its own tables.
+ */
+typedef struct
+{
+    float *w;
+    float *w1;
+    float *w2;
+    float *w3;
+} cfft_twiddles_t;
+
+static cfft_twiddles_t *twiddles[CFFT_MAX_LOG2 + 1];
+
+static void twiddle_fill(float *dst, uint32_t count, uint32_t step, uint32_t len)
+{
+    for (uint32_t k = 0; k < count; k++) {
+        double a = -2.0 * M_PI * (double)((k * step) % len) / (double)len;
+        dst[2 * k] = (float)cos(a);
+        dst[2 * k + 1] = (float)sin(a);
+    }
+}
+
+static const cfft_twiddles_t *twiddles_for(uint32_t log2n)
+{
+    cfft_twiddles_t *t = __atomic_load_n(&twiddles[log2n], __ATOMIC_ACQUIRE);
+    if (t) return t;
+
+    uint32_t n = 1u << log2n;
+    uint32_t q = n / 4;
+    t = malloc(sizeof(*t) + (2 * n + 6 * q) * sizeof(float));
+    if (!t) return NULL;
+    t->w = (float *)(t + 1);
+    t->w1 = t->w + 2 * n;
+    t->w2 = t->w1 + 2 * q;
+    t->w3 = t->w2 + 2 * q;
+    twiddle_fill(t->w, n, 1, n);
+    twiddle_fill(t->w1, q, 1, n);
+    twiddle_fill(t->w2, q, 2, n);
+    twiddle_fill(t->w3, q, 3, n);
+
+    // Another thread may have got there first; keep whichever was published
+    cfft_twiddles_t *expected = NULL;
+    if (!__atomic_compare_exchange_n(&twiddles[log2n], &expected, t, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        free(t);
+        return expected;
+    }
+    return t;
+}
+
+/*******************************************************************************
+ * AVX2/FMA passes
+ *
+ * Vectors hold four complex values. For an inverse transform, conj flips
+ * the sign of the imaginary lanes of the twiddles (it is zero otherwise),
+ * im_sign does the same for broadcast twiddles and rot turns multiplication
+ * by -i into +i.
+ ******************************************************************************/
+typedef struct
+{
+    __m256 conj;
+    __m256 rot;
+    float im_sign;
+} cfft_dir_t;
+
+__attribute__((target("avx2,fma")))
+static inline __m256 cmul(__m256 a, __m256 w)
+{
+    __m256 wr = _mm256_moveldup_ps(w);
+    __m256 wi = _mm256_movehdup_ps(w);
+    __m256 swapped = _mm256_permute_ps(a, 0xB1);
+    return _mm256_fmaddsub_ps(a, wr, _mm256_mul_ps(swapped, wi));
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256 cmul_bcast(__m256 a, __m256 wr, __m256 wi)
+{
+    __m256 swapped = _mm256_permute_ps(a, 0xB1);
+    return _mm256_fmaddsub_ps(a, wr, _mm256_mul_ps(swapped, wi));
+}
+
+// -i * z for a forward transform, +i * z for an inverse one
+__attribute__((target("avx2,fma")))
+static inline __m256 mul_mi(__m256 z, __m256 rot)
+{
+    return _mm256_xor_ps(_mm256_permute_ps(z, 0xB1), rot);
+}
+
+/**
+ * @brief First radix-4 pass (stride 1), four butterflies per iteration
+ */
+__attribute__((target("avx2,fma")))
+static void pass_first(uint32_t n, const float *x, float *y, const cfft_twiddles_t *t,
+                       const cfft_dir_t *dir)
+{
+    uint32_t m = n / 4;
+
+    for (uint32_t p = 0; p < m; p += 4) {
+        __m256 a = _mm256_loadu_ps(x + 2 * p);
+        __m256 b = _mm256_loadu_ps(x + 2 * (p + m));
+        __m256 c = _mm256_loadu_ps(x + 2 * (p + 2 * m));
+        __m256 d = _mm256_loadu_ps(x + 2 * (p + 3 * m));
+
+        __m256 apc = _mm256_add_ps(a, c);
+        __m256 amc = _mm256_sub_ps(a, c);
+        __m256 bpd = _mm256_add_ps(b, d);
+        __m256 jbmd = mul_mi(_mm256_sub_ps(b, d), dir->rot);
+
+        __m256 w1 = _mm256_xor_ps(_mm256_loadu_ps(t->w1 + 2 * p), dir->conj);
+        __m256 w2 = _mm256_xor_ps(_mm256_loadu_ps(t->w2 + 2 * p), dir->conj);
+        __m256 w3 = _mm256_xor_ps(_mm256_loadu_ps(t->w3 + 2 * p), dir->conj);
+
+        __m256d r0 = _mm256_castps_pd(_mm256_add_ps(apc, bpd));
+        __m256d r1 = _mm256_castps_pd(cmul(_mm256_add_ps(amc, jbmd), w1));
+        __m256d r2 = _mm256_castps_pd(cmul(_mm256_sub_ps(apc, bpd), w2));
+        __m256d r3 = _mm256_castps_pd(cmul(_mm256_sub_ps(amc, jbmd), w3));
+
+        // Outputs of butterfly p go to y[4p..4p+3]: transpose the 4x4 block
+        // of complex values, one complex value per double lane
+        __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+        __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+        __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+        __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+
+        float *out = y + 8 * p;
+        _mm256_storeu_ps(out, _mm256_castpd_ps(_mm256_permute2f128_pd(t0, t2, 0x20)));
+        _mm256_storeu_ps(out + 8, _mm256_castpd_ps(_mm256_permute2f128_pd(t1, t3, 0x20)));
+        _mm256_storeu_ps(out + 16, _mm256_castpd_ps(_mm256_permute2f128_pd(t0, t2, 0x31)));
+        _mm256_storeu_ps(out + 24, _mm256_castpd_ps(_mm256_permute2f128_pd(t1, t3, 0x31)));
+    }
+}
+
+/**
+ * @brief Radix-4 pass of sub-length n at stride s >= 4
+ */
+__attribute__((target("avx2,fma")))
+static void pass_radix4(uint32_t n, uint32_t s, const float *x, float *y,
+                        const cfft_twiddles_t *t, const cfft_dir_t *dir)
+{
+    uint32_t m = n / 4;
+    uint32_t quarter = s * m; // a quarter of the transform
+
+    for (uint32_t p = 0; p < m; p++) {
+        const float *w1 = t->w + 2 * (p * s);
+        const float *w2 = t->w + 2 * (2 * p * s);
+        const float *w3 = t->w + 2 * (3 * p * s);
+        __m256 w1r = _mm256_set1_ps(w1[0]);
+        __m256 w1i = _mm256_set1_ps(w1[1] * dir->im_sign);
+        __m256 w2r = _mm256_set1_ps(w2[0]);
+        __m256 w2i = _mm256_set1_ps(w2[1] * dir->im_sign);
+        __m256 w3r = _mm256_set1_ps(w3[0]);
+        __m256 w3i = _mm256_set1_ps(w3[1] * dir->im_sign);
+
+        const float *xa = x + 2 * (s * p);
+        float *ya = y + 2 * (s * 4 * p);
+
+        for (uint32_t q = 0; q < s; q += 4) {
+            __m256 a = _mm256_loadu_ps(xa + 2 * q);
+            __m256 b = _mm256_loadu_ps(xa + 2 * (q + quarter));
+            __m256 c = _mm256_loadu_ps(xa + 2 * (q + 2 * quarter));
+            __m256 d = _mm256_loadu_ps(xa + 2 * (q + 3 * quarter));
+
+            __m256 apc = _mm256_add_ps(a, c);
+            __m256 amc = _mm256_sub_ps(a, c);
+            __m256 bpd = _mm256_add_ps(b, d);
+            __m256 jbmd = mul_mi(_mm256_sub_ps(b, d), dir->rot);
+
+            _mm256_storeu_ps(ya + 2 * q, _mm256_add_ps(apc, bpd));
+            _mm256_storeu_ps(ya + 2 * (q + s), cmul_bcast(_mm256_add_ps(amc, jbmd), w1r, w1i));
+            _mm256_storeu_ps(ya + 2 * (q + 2 * s), cmul_bcast(_mm256_sub_ps(apc, bpd), w2r, w2i));
+            _mm256_storeu_ps(ya + 2 * (q + 3 * s), cmul_bcast(_mm256_sub_ps(amc, jbmd), w3r, w3i));
+        }
+    }
+}
+
+/**
+ * @brief Final radix-2 pass (sub-length 2, stride len / 2)
+ */
+__attribute__((target("avx2,fma")))
+static void pass_radix2(uint32_t s, const float *x, float *y)
+{
+    for (uint32_t q = 0; q < s; q += 4) {
+        __m256 a = _mm256_loadu_ps(x + 2 * q);
+        __m256 b = _mm256_loadu_ps(x + 2 * (q + s));
+        _mm256_storeu_ps(y + 2 * q, _mm256_add_ps(a, b));
+        _mm256_storeu_ps(y + 2 * (q + s), _mm256_sub_ps(a, b));
+    }
+}
+
+/**
+ * @brief Copy (or, in place, just scale) the result into the caller's buffer
+ */
+__attribute__((target("avx2,fma")))
+static void finish(const float *src, float *dst, uint32_t len, float scale)
+{
+    if (scale == 1.0f) {
+        if (src != dst) memcpy(dst, src, 2 * len * sizeof(float));
+        return;
+    }
+    __m256 k = _mm256_set1_ps(scale);
+    for (uint32_t i = 0; i < 2 * len; i += 8) {
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(src + i), k));
+    }
+}
+
+__attribute__((target("avx2,fma")))
+static void cfft_avx2(uint32_t log2n, const cfft_twiddles_t *t, float32_t *data, bool inverse)
+{
+    static _Thread_local float scratch[2 * CFFT_MAX_LEN] __attribute__((aligned(32)));
+
+    const __m256 odd = _mm256_castsi256_ps(_mm256_set_epi32(
+        (int)0x80000000, 0, (int)0x80000000, 0, (int)0x80000000, 0, (int)0x80000000, 0));
+    const __m256 even = _mm256_castsi256_ps(_mm256_set_epi32(
+        0, (int)0x80000000, 0, (int)0x80000000, 0, (int)0x80000000, 0, (int)0x80000000));
+    cfft_dir_t dir = {
+        .conj = inverse ? odd : _mm256_setzero_ps(),
+        .rot = inverse ? even : odd,
+        .im_sign = inverse ? -1.0f : 1.0f,
+    };
+
+    uint32_t len = 1u << log2n;
+    float *src = data;
+    float *dst = scratch;
+    float *tmp;
+
+    pass_first(len, src, dst, t, &dir);
+    tmp = src; src = dst; dst = tmp;
+
+    uint32_t n = len / 4;
+    uint32_t s = 4;
+    while (n >= 4) {
+        pass_radix4(n, s, src, dst, t, &dir);
+        tmp = src; src = dst; dst = tmp;
+        n /= 4;
+        s *= 4;
+    }
+    if (n == 2) {
+        pass_radix2(s, src, dst);
+        tmp = src; src = dst; dst = tmp;
+    }
+
+    finish(src, data, len, inverse ? 1.0f / (float)len : 1.0f);
+}
+
+/*******************************************************************************
+ * Dispatch
+ ******************************************************************************/
+typedef enum
+{
+    CFFT_IMPL_UNKNOWN,
+    CFFT_IMPL_REF,
+    CFFT_IMPL_AVX2,
+} cfft_impl_t;
+
+static cfft_impl_t cfftImpl = CFFT_IMPL_UNKNOWN;
+
+static cfft_impl_t select_impl(void)
+{
+    if (cfftImpl == CFFT_IMPL_UNKNOWN) {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+            cfftImpl = CFFT_IMPL_AVX2;
+        else
+            cfftImpl = CFFT_IMPL_REF;
+    }
+    return cfftImpl;
+}
+
+const char *dsp_cfft_impl(void)
+{
+    return select_impl() == CFFT_IMPL_AVX2 ? "avx2" : "ref";
+}
+
+/**
+ * @brief Undo arm_bitreversal_32: natural order to the instance's order
+ *
+ * The table is a sequence of swaps, so running it backwards inverts it.
+ */
+static void digit_reverse_order(float32_t *data, const arm_cfft_instance_f32 *S)
+{
+    uint64_t *pairs = (uint64_t *)data;
+    for (int i = (int)S->bitRevLength - 2; i >= 0; i -= 2) {
+        uint32_t a = S->pBitRevTable[i] >> 3;
+        uint32_t b = S->pBitRevTable[i + 1] >> 3;
+        uint64_t tmp = pairs[a];
+        pairs[a] = pairs[b];
+        pairs[b] = tmp;
+    }
+}
+
+void arm_cfft_f32(const arm_cfft_instance_f32 *S, float32_t *p1,
+                  uint8_t ifftFlag, uint8_t bitReverseFlag)
+{
+    uint32_t len = S->fftLen;
+    uint32_t log2n = (uint32_t)__builtin_ctz(len ? len : 1);
+    const cfft_twiddles_t *t = NULL;
+
+    if (select_impl() == CFFT_IMPL_AVX2 && len == (1u << log2n) &&
+        log2n >= CFFT_MIN_LOG2 && log2n <= CFFT_MAX_LOG2) {
+        t = twiddles_for(log2n);
+    }
+    if (!t) {
+        arm_cfft_f32_ref(S, p1, ifftFlag, bitReverseFlag);
+        return;
+    }
+
+    cfft_avx2(log2n, t, p1, ifftFlag == 1U);
+    if (!bitReverseFlag) digit_reverse_order(p1, S);
+}
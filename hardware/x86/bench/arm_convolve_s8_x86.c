@@ -0,0 +1,86 @@
+/**
+ * @file arm_convolve_s8_x86.c
+ * @brief arm_convolve_s8 as int8 im2col and arm_nn_mat_mult_nt_t_s8
+ *
+ * The library's C path widens each im2col row to 16 bits and multiplies two
+ * rows at a time with a scalar kernel. Here the rows stay 8-bit, as many as
+ * fit the caller's buffer (four, with the size the library asks for), and
+ * go through arm_nn_mat_mult_nt_t_s8, which the x86 backend vectorizes.
+ * Padding is filled with -input_offset, which the offset brings back to
+ * zero, so the result is the library's to the byte.
+ */
+
+#include <string.h>
+
+#include "nn_x86.h"
+
+arm_status arm_convolve_s8(const cmsis_nn_context *ctx,
+                           const cmsis_nn_conv_params *conv_params,
+                           const cmsis_nn_per_channel_quant_params *quant_params,
+                           const cmsis_nn_dims *input_dims,
+                           const q7_t *input_data,
+                           const cmsis_nn_dims *filter_dims,
+                           const q7_t *filter_data,
+                           const cmsis_nn_dims *bias_dims,
+                           const int32_t *bias_data,
+                           const cmsis_nn_dims *output_dims,
+                           q7_t *output_data)
+{
+    const int32_t input_ch = input_dims->c;
+    const int32_t kernel_x = filter_dims->w;
+    const int32_t kernel_y = filter_dims->h;
+    const int32_t row_len = input_ch * kernel_x * kernel_y;
+    const int32_t input_offset = conv_params->input_offset;
+    int32_t buf_size = ctx->size > 0 ? ctx->size : arm_convolve_s8_get_buffer_size(input_dims, filter_dims);
+    int32_t rows = row_len > 0 ? buf_size / row_len : 0;
+
+    if (nn_impl() == NN_IMPL_REF || ctx->buf == NULL || rows == 0 || input_offset < -127 || input_offset > 128) {
+        return arm_convolve_s8_ref(ctx, conv_params, quant_params, input_dims, input_data, filter_dims,
+                                   filter_data, bias_dims, bias_data, output_dims, output_data);
+    }
+
+    const int32_t input_x = input_dims->w;
+    const int32_t input_y = input_dims->h;
+    const int32_t output_x = output_dims->w;
+    const int32_t output_y = output_dims->h;
+    const int32_t output_ch = output_dims->c;
+    const int32_t pixels = output_x * output_y;
+    q7_t *rows_buf = (q7_t *)ctx->buf;
+
+    for (int32_t batch = 0; batch < input_dims->n; batch++) {
+        q7_t *out = output_data;
+        int32_t filled = 0;
+
+        for (int32_t p = 0; p < pixels; p++) {
+            const int32_t base_y = conv_params->stride.h * (p / output_x) - conv_params->padding.h;
+            const int32_t base_x = conv_params->stride.w * (p % output_x) - conv_params->padding.w;
+            q7_t *row = rows_buf + filled * row_len;
+
+            for (int32_t ky = 0; ky < kernel_y; ky++) {
+                for (int32_t kx = 0; kx < kernel_x; kx++) {
+                    const int32_t y = base_y + conv_params->dilation.h * ky;
+                    const int32_t x = base_x + conv_params->dilation.w * kx;
+
+                    if (y < 0 || y >= input_y || x < 0 || x >= input_x)
+                        memset(row, -input_offset, input_ch);
+                    else
+                        memcpy(row, input_data + (y * input_x + x) * input_ch, input_ch);
+                    row += input_ch;
+                }
+            }
+
+            if (++filled == rows || p == pixels - 1) {
+                arm_nn_mat_mult_nt_t_s8(rows_buf, filter_data, bias_data, out, quant_params->multiplier,
+                                        quant_params->shift, filled, output_ch, row_len, input_offset,
+                                        conv_params->output_offset, conv_params->activation.min,
+                                        conv_params->activation.max);
+                out += filled * output_ch;
+                filled = 0;
+            }
+        }
+
+        input_data += input_x * input_y * input_ch;
+        output_data += pixels * output_ch;
+    }
+    return ARM_MATH_SUCCESS;
+}
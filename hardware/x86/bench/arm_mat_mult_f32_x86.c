@@ -0,0 +1,477 @@
+/**
+ * @file arm_mat_mult_f32_x86.c
+ * @brief Blocked, multithreaded arm_mat_mult_f32 and arm_mat_vec_mult_f32
+ *
+ * The product follows the usual GEMM structure: B is packed a KC x NC block
+ * at a time into 16-column panels, each MC-row block of A into 6-row panels,
+ * and a 6x16 AVX2/FMA micro-kernel keeps its tile of C in twelve registers
+ * over the whole KC depth. Zero padding in the packed panels means the
+ * micro-kernel never sees an edge; partial tiles of C go through a small
+ * buffer instead.
+ *
+ * Large products split the row blocks of A across a pool of threads, sized
+ * from DSP_THREADS in the environment or else the number of online CPUs
+ * (DSP_THREADS=1 keeps everything on the calling thread). Small matrices,
+ * like the ones the library was written for, and CPUs without AVX2 and FMA
+ * use the library's own code.
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <immintrin.h>
+
+#include "arm_math.h"
+#include "dsp_x86.h"
+
+/*******************************************************************************
+ * Configuration
+ ******************************************************************************/
+#define GEMM_MR 6
+#define GEMM_NR 16
+#define GEMM_MC 120   // rows of A per packed block; A block is 120 KB
+#define GEMM_KC 256   // depth per packed block; one B panel is 16 KB
+#define GEMM_NC 1024  // columns of B per packed block; 1 MB
+
+#define GEMM_MIN_WORK (1u << 12)     // M*N*K below which the reference is used
+#define GEMM_THREAD_WORK (1u << 21)  // M*N*K from which threads are used
+#define MATVEC_ROWS_PER_TASK 256
+#define MATVEC_THREAD_WORK (1u << 18)
+
+#define POOL_MAX_THREADS 16
+
+/*******************************************************************************
+ * Thread pool
+ *
+ * Tasks are numbered 0..count-1 and taken in order by whichever thread is
+ * free, the caller included; worker ids index per-thread scratch. Calls are
+ * serialised, so only one job is ever in flight.
+ ******************************************************************************/
+typedef void (*pool_fn_t)(void *ctx, uint32_t task, uint32_t worker);
+
+static struct
+{
+    pthread_once_t once;
+    pthread_mutex_t run;
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t done;
+    uint32_t threads;   // including the caller
+    uint64_t generation;
+    uint32_t busy;      // helpers still on the current job
+    pool_fn_t fn;
+    void *ctx;
+    uint32_t count;
+    uint32_t next;
+} pool = {
+    .once = PTHREAD_ONCE_INIT,
+    .run = PTHREAD_MUTEX_INITIALIZER,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .start = PTHREAD_COND_INITIALIZER,
+    .done = PTHREAD_COND_INITIALIZER,
+    .threads = 1,
+};
+
+static void pool_work(uint32_t worker)
+{
+    uint32_t task;
+    while ((task = __atomic_fetch_add(&pool.next, 1, __ATOMIC_RELAXED)) < pool.count) {
+        pool.fn(pool.ctx, task, worker);
+    }
+}
+
+static void *pool_thread(void *arg)
+{
+    uint32_t worker = (uint32_t)(uintptr_t)arg;
+    uint64_t seen = 0;
+
+    pthread_mutex_lock(&pool.lock);
+    while (true) {
+        while (pool.generation == seen) pthread_cond_wait(&pool.start, &pool.lock);
+        seen = pool.generation;
+        pthread_mutex_unlock(&pool.lock);
+
+        pool_work(worker);
+
+        pthread_mutex_lock(&pool.lock);
+        if (--pool.busy == 0) pthread_cond_signal(&pool.done);
+    }
+    return NULL;
+}
+
+static void pool_init(void)
+{
+    const char *env = getenv("DSP_THREADS");
+    long n = env ? strtol(env, NULL, 0) : sysconf(_SC_NPROCESSORS_ONLN);
+    if (n < 1) n = 1;
+    if (n > POOL_MAX_THREADS) n = POOL_MAX_THREADS;
+
+    pool.threads = 1;
+    for (long i = 1; i < n; i++) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, pool_thread, (void *)(uintptr_t)i) != 0) break;
+        pthread_detach(thread);
+        pool.threads++;
+    }
+}
+
+static uint32_t pool_threads(void)
+{
+    pthread_once(&pool.once, pool_init);
+    return pool.threads;
+}
+
+/**
+ * @brief Run fn for every task, using the pool if parallel is set
+ */
+static void pool_run(pool_fn_t fn, void *ctx, uint32_t count, bool parallel)
+{
+    if (!parallel || count < 2 || pool_threads() < 2) {
+        for (uint32_t task = 0; task < count; task++) fn(ctx, task, 0);
+        return;
+    }
+
+    pthread_mutex_lock(&pool.run);
+
+    pthread_mutex_lock(&pool.lock);
+    pool.fn = fn;
+    pool.ctx = ctx;
+    pool.count = count;
+    pool.next = 0;
+    pool.busy = pool.threads - 1;
+    pool.generation++;
+    pthread_cond_broadcast(&pool.start);
+    pthread_mutex_unlock(&pool.lock);
+
+    pool_work(0);
+
+    pthread_mutex_lock(&pool.lock);
+    while (pool.busy) pthread_cond_wait(&pool.done, &pool.lock);
+    pthread_mutex_unlock(&pool.lock);
+
+    pthread_mutex_unlock(&pool.run);
+}
+
+/*******************************************************************************
+ * Packing
+ ******************************************************************************/
+/**
+ * @brief Pack a kc x nc block of B (row stride ldb) into 16-column panels
+ */
+static void pack_b(const float *b, uint32_t ldb, uint32_t kc, uint32_t nc, float *dst)
+{
+    for (uint32_t j = 0; j < nc; j += GEMM_NR) {
+        uint32_t cols = nc - j < GEMM_NR ? nc - j : GEMM_NR;
+        for (uint32_t k = 0; k < kc; k++) {
+            const float *src = b + (size_t)k * ldb + j;
+            memcpy(dst, src, cols * sizeof(float));
+            memset(dst + cols, 0, (GEMM_NR - cols) * sizeof(float));
+            dst += GEMM_NR;
+        }
+    }
+}
+
+/**
+ * @brief Pack an mc x kc block of A (row stride lda) into 6-row panels
+ */
+static void pack_a(const float *a, uint32_t lda, uint32_t mc, uint32_t kc, float *dst)
+{
+    for (uint32_t i = 0; i < mc; i += GEMM_MR) {
+        uint32_t rows = mc - i < GEMM_MR ? mc - i : GEMM_MR;
+        for (uint32_t k = 0; k < kc; k++) {
+            for (uint32_t r = 0; r < GEMM_MR; r++) {
+                *dst++ = r < rows ? a[(size_t)(i + r) * lda + k] : 0.0f;
+            }
+        }
+    }
+}
+
+/*******************************************************************************
+ * Micro-kernel
+ ******************************************************************************/
+/**
+ * @brief C[0:mr, 0:nr] (+)= packed A panel x packed B panel over kc
+ */
+__attribute__((target("avx2,fma")))
+static void kernel_6x16(uint32_t kc, const float *a, const float *b, float *c, uint32_t ldc,
+                        uint32_t mr, uint32_t nr, bool accumulate)
+{
+    __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+    __m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+    __m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps();
+    __m256 c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+    __m256 c40 = _mm256_setzero_ps(), c41 = _mm256_setzero_ps();
+    __m256 c50 = _mm256_setzero_ps(), c51 = _mm256_setzero_ps();
+
+    for (uint32_t k = 0; k < kc; k++) {
+        __m256 b0 = _mm256_load_ps(b);
+        __m256 b1 = _mm256_load_ps(b + 8);
+        __m256 ai;
+
+        ai = _mm256_broadcast_ss(a + 0);
+        c00 = _mm256_fmadd_ps(ai, b0, c00); c01 = _mm256_fmadd_ps(ai, b1, c01);
+        ai = _mm256_broadcast_ss(a + 1);
+        c10 = _mm256_fmadd_ps(ai, b0, c10); c11 = _mm256_fmadd_ps(ai, b1, c11);
+        ai = _mm256_broadcast_ss(a + 2);
+        c20 = _mm256_fmadd_ps(ai, b0, c20); c21 = _mm256_fmadd_ps(ai, b1, c21);
+        ai = _mm256_broadcast_ss(a + 3);
+        c30 = _mm256_fmadd_ps(ai, b0, c30); c31 = _mm256_fmadd_ps(ai, b1, c31);
+        ai = _mm256_broadcast_ss(a + 4);
+        c40 = _mm256_fmadd_ps(ai, b0, c40); c41 = _mm256_fmadd_ps(ai, b1, c41);
+        ai = _mm256_broadcast_ss(a + 5);
+        c50 = _mm256_fmadd_ps(ai, b0, c50); c51 = _mm256_fmadd_ps(ai, b1, c51);
+
+        a += GEMM_MR;
+        b += GEMM_NR;
+    }
+
+    float tile[GEMM_MR * GEMM_NR] __attribute__((aligned(32)));
+    bool full = mr == GEMM_MR && nr == GEMM_NR;
+    float *out = full ? c : tile;
+    uint32_t ld = full ? ldc : GEMM_NR;
+
+    __m256 acc[GEMM_MR][2] = {
+        { c00, c01 }, { c10, c11 }, { c20, c21 }, { c30, c31 }, { c40, c41 }, { c50, c51 },
+    };
+    for (uint32_t r = 0; r < GEMM_MR; r++) {
+        float *row = out + (size_t)r * ld;
+        if (full && accumulate) {
+            acc[r][0] = _mm256_add_ps(acc[r][0], _mm256_loadu_ps(row));
+            acc[r][1] = _mm256_add_ps(acc[r][1], _mm256_loadu_ps(row + 8));
+        }
+        _mm256_storeu_ps(row, acc[r][0]);
+        _mm256_storeu_ps(row + 8, acc[r][1]);
+    }
+
+    if (!full) {
+        for (uint32_t r = 0; r < mr; r++) {
+            float *row = c + (size_t)r * ldc;
+            for (uint32_t j = 0; j < nr; j++) {
+                row[j] = accumulate ? row[j] + tile[r * GEMM_NR + j] : tile[r * GEMM_NR + j];
+            }
+        }
+    }
+}
+
+/*******************************************************************************
+ * Matrix multiply
+ ******************************************************************************/
+typedef struct
+{
+    const float *a;
+    float *c;
+    uint32_t m;
+    uint32_t k;
+    uint32_t n;
+    uint32_t pc;        // depth offset of the packed B block
+    uint32_t kc;
+    uint32_t jc;        // column offset of the packed B block
+    uint32_t nc;
+    const float *bPack;
+    float *aPack;       // GEMM_MC * GEMM_KC floats per worker
+} gemm_job_t;
+
+/**
+ * @brief One MC-row block of C against the packed block of B
+ */
+static void gemm_block(void *ctx, uint32_t task, uint32_t worker)
+{
+    const gemm_job_t *job = ctx;
+    uint32_t ic = task * GEMM_MC;
+    uint32_t mc = job->m - ic < GEMM_MC ? job->m - ic : GEMM_MC;
+    float *aPack = job->aPack + (size_t)worker * GEMM_MC * GEMM_KC;
+
+    pack_a(job->a + (size_t)ic * job->k + job->pc, job->k, mc, job->kc, aPack);
+
+    for (uint32_t jr = 0; jr < job->nc; jr += GEMM_NR) {
+        uint32_t nr = job->nc - jr < GEMM_NR ? job->nc - jr : GEMM_NR;
+        const float *bPanel = job->bPack + (size_t)jr * job->kc;
+        for (uint32_t ir = 0; ir < mc; ir += GEMM_MR) {
+            uint32_t mr = mc - ir < GEMM_MR ? mc - ir : GEMM_MR;
+            float *c = job->c + (size_t)(ic + ir) * job->n + job->jc + jr;
+            kernel_6x16(job->kc, aPack + (size_t)ir * job->kc, bPanel, c, job->n,
+                        mr, nr, job->pc > 0);
+        }
+    }
+}
+
+static bool gemm_avx2(const float *a, const float *b, float *c, uint32_t m, uint32_t k, uint32_t n)
+{
+    bool parallel = (uint64_t)m * n * k >= GEMM_THREAD_WORK;
+    uint32_t workers = parallel ? pool_threads() : 1;
+    uint32_t ncMax = n < GEMM_NC ? (n + GEMM_NR - 1) / GEMM_NR * GEMM_NR : GEMM_NC;
+    uint32_t kcMax = k < GEMM_KC ? k : GEMM_KC;
+
+    size_t bFloats = (size_t)kcMax * ncMax;
+    size_t aFloats = (size_t)workers * GEMM_MC * GEMM_KC;
+    float *buf = aligned_alloc(32, (bFloats + aFloats) * sizeof(float));
+    if (!buf) return false;
+
+    gemm_job_t job = {
+        .a = a, .c = c, .m = m, .k = k, .n = n,
+        .bPack = buf, .aPack = buf + bFloats,
+    };
+    uint32_t blocks = (m + GEMM_MC - 1) / GEMM_MC;
+
+    for (uint32_t jc = 0; jc < n; jc += GEMM_NC) {
+        job.jc = jc;
+        job.nc = n - jc < GEMM_NC ? n - jc : GEMM_NC;
+        for (uint32_t pc = 0; pc < k; pc += GEMM_KC) {
+            job.pc = pc;
+            job.kc = k - pc < GEMM_KC ? k - pc : GEMM_KC;
+            pack_b(b + (size_t)pc * n + jc, n, job.kc, job.nc, buf);
+            pool_run(gemm_block, &job, blocks, parallel);
+        }
+    }
+
+    free(buf);
+    return true;
+}
+
+/*******************************************************************************
+ * Matrix-vector multiply
+ ******************************************************************************/
+typedef struct
+{
+    const float *a;
+    const float *x;
+    float *y;
+    uint32_t rows;
+    uint32_t cols;
+} matvec_job_t;
+
+__attribute__((target("avx2,fma")))
+static inline float hsum(__m256 v)
+{
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_movehdup_ps(s));
+    return _mm_cvtss_f32(s);
+}
+
+__attribute__((target("avx2,fma")))
+static void matvec_rows(void *ctx, uint32_t task, uint32_t worker)
+{
+    const matvec_job_t *job = ctx;
+    uint32_t first = task * MATVEC_ROWS_PER_TASK;
+    uint32_t last = first + MATVEC_ROWS_PER_TASK < job->rows ? first + MATVEC_ROWS_PER_TASK : job->rows;
+    uint32_t cols = job->cols;
+    uint32_t vec = cols & ~7u;
+    (void)worker;
+
+    uint32_t i = first;
+    // Four rows at a time share each load of x
+    for (; i + 4 <= last; i += 4) {
+        const float *r0 = job->a + (size_t)i * cols;
+        const float *r1 = r0 + cols;
+        const float *r2 = r1 + cols;
+        const float *r3 = r2 + cols;
+        __m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps();
+        __m256 s2 = _mm256_setzero_ps(), s3 = _mm256_setzero_ps();
+        for (uint32_t j = 0; j < vec; j += 8) {
+            __m256 x = _mm256_loadu_ps(job->x + j);
+            s0 = _mm256_fmadd_ps(_mm256_loadu_ps(r0 + j), x, s0);
+            s1 = _mm256_fmadd_ps(_mm256_loadu_ps(r1 + j), x, s1);
+            s2 = _mm256_fmadd_ps(_mm256_loadu_ps(r2 + j), x, s2);
+            s3 = _mm256_fmadd_ps(_mm256_loadu_ps(r3 + j), x, s3);
+        }
+        float t0 = hsum(s0), t1 = hsum(s1), t2 = hsum(s2), t3 = hsum(s3);
+        for (uint32_t j = vec; j < cols; j++) {
+            t0 += r0[j] * job->x[j];
+            t1 += r1[j] * job->x[j];
+            t2 += r2[j] * job->x[j];
+            t3 += r3[j] * job->x[j];
+        }
+        job->y[i] = t0;
+        job->y[i + 1] = t1;
+        job->y[i + 2] = t2;
+        job->y[i + 3] = t3;
+    }
+    for (; i < last; i++) {
+        const float *r = job->a + (size_t)i * cols;
+        __m256 s = _mm256_setzero_ps();
+        for (uint32_t j = 0; j < vec; j += 8) {
+            s = _mm256_fmadd_ps(_mm256_loadu_ps(r + j), _mm256_loadu_ps(job->x + j), s);
+        }
+        float t = hsum(s);
+        for (uint32_t j = vec; j < cols; j++) t += r[j] * job->x[j];
+        job->y[i] = t;
+    }
+}
+
+/*******************************************************************************
+ * Dispatch
+ ******************************************************************************/
+typedef enum
+{
+    MAT_IMPL_UNKNOWN,
+    MAT_IMPL_REF,
+    MAT_IMPL_AVX2,
+} mat_impl_t;
+
+static mat_impl_t matImpl = MAT_IMPL_UNKNOWN;
+
+static mat_impl_t select_impl(void)
+{
+    if (matImpl == MAT_IMPL_UNKNOWN) {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+            matImpl = MAT_IMPL_AVX2;
+        else
+            matImpl = MAT_IMPL_REF;
+    }
+    return matImpl;
+}
+
+const char *dsp_mat_impl(void)
+{
+    return select_impl() == MAT_IMPL_AVX2 ? "avx2" : "ref";
+}
+
+uint32_t dsp_mat_threads(void)
+{
+    return pool_threads();
+}
+
+arm_status arm_mat_mult_f32(const arm_matrix_instance_f32 *pSrcA,
+                            const arm_matrix_instance_f32 *pSrcB,
+                            arm_matrix_instance_f32 *pDst)
+{
+#ifdef ARM_MATH_MATRIX_CHECK
+    if ((pSrcA->numCols != pSrcB->numRows) ||
+        (pSrcA->numRows != pDst->numRows) || (pSrcB->numCols != pDst->numCols)) {
+        return ARM_MATH_SIZE_MISMATCH;
+    }
+#endif
+
+    uint32_t m = pSrcA->numRows;
+    uint32_t k = pSrcA->numCols;
+    uint32_t n = pSrcB->numCols;
+
+    if (select_impl() == MAT_IMPL_AVX2 && (uint64_t)m * n * k >= GEMM_MIN_WORK &&
+        gemm_avx2(pSrcA->pData, pSrcB->pData, pDst->pData, m, k, n)) {
+        return ARM_MATH_SUCCESS;
+    }
+    return arm_mat_mult_f32_ref(pSrcA, pSrcB, pDst);
+}
+
+void arm_mat_vec_mult_f32(const arm_matrix_instance_f32 *pSrcMat, const float32_t *pVec,
+                          float32_t *pDst)
+{
+    if (select_impl() != MAT_IMPL_AVX2) {
+        arm_mat_vec_mult_f32_ref(pSrcMat, pVec, pDst);
+        return;
+    }
+
+    matvec_job_t job = {
+        .a = pSrcMat->pData,
+        .x = pVec,
+        .y = pDst,
+        .rows = pSrcMat->numRows,
+        .cols = pSrcMat->numCols,
+    };
+    uint32_t tasks = (job.rows + MATVEC_ROWS_PER_TASK - 1) / MATVEC_ROWS_PER_TASK;
+    pool_run(matvec_rows, &job, tasks, (uint64_t)job.rows * job.cols >= MATVEC_THREAD_WORK);
+}
@@ -0,0 +1,325 @@
+/**
+ * @file arm_nn_mat_mult_s8_x86.c
+ * @brief AVX2 and AVX-VNNI arm_nn_mat_mult_nt_t_s8 and arm_nn_vec_mat_mult_t_s8
+ *
+ * Both kernels are dot products of int8 rows, computed here in tiles of two
+ * LHS rows by four RHS rows so that each RHS load serves two LHS rows and
+ * each LHS load four RHS rows. With AVX2, sixteen values at a time are
+ * widened to 16 bits, the LHS with its offset added, and _mm256_madd_epi16
+ * sums them in pairs into 32 bits. With AVX-VNNI, _mm256_dpbusd_avx_epi32
+ * takes 32 at a time; it wants an unsigned LHS, so the LHS is biased by 128
+ * and 128 times the sum of the RHS values is taken off again.
+ *
+ * The sums are exact in 32 bits and the requantization, offset and clamp
+ * are the library's own inline functions, so every implementation gives the
+ * same bytes as the library's C code.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <immintrin.h>
+
+#include "nn_x86.h"
+
+/*******************************************************************************
+ * Configuration
+ ******************************************************************************/
+#define TILE_L 2   // LHS rows per tile
+#define TILE_R 4   // RHS rows per tile
+
+/**
+ * @brief Sums of nl x nr dot products of cols values, with the LHS offset
+ *
+ * sums[i][j] is the sum over c of (lhs[i * cols + c] + lhs_offset) *
+ * rhs[j * cols + c].
+ */
+typedef void (*tile_fn_t)(const q7_t *lhs, int32_t nl, const q7_t *rhs, int32_t nr, int32_t cols,
+                          int32_t lhs_offset, int32_t sums[TILE_L][TILE_R]);
+
+/*******************************************************************************
+ * Tiles
+ ******************************************************************************/
+__attribute__((target("avx2")))
+static inline int32_t hsum_epi32(__m256i v)
+{
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+    return _mm_cvtsi128_si32(s);
+}
+
+/**
+ * @brief Sixteen values of each row, widened to 16 bits
+ */
+__attribute__((target("avx2"), always_inline))
+static inline __m256i load_epi16(const q7_t *p)
+{
+    return _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)p));
+}
+
+__attribute__((target("avx2"), always_inline))
+static inline void tile_tail(const q7_t *lhs, int32_t nl, const q7_t *rhs, int32_t nr, int32_t cols,
+                             int32_t c, int32_t lhs_offset, int32_t sums[TILE_L][TILE_R])
+{
+    for (; c < cols; c++) {
+        for (int32_t i = 0; i < nl; i++) {
+            int32_t l = lhs[i * cols + c] + lhs_offset;
+            for (int32_t j = 0; j < nr; j++) sums[i][j] += l * rhs[j * cols + c];
+        }
+    }
+}
+
+__attribute__((target("avx2"), always_inline))
+static inline void tile_avx2_body(const q7_t *lhs, const int32_t nl, const q7_t *rhs, const int32_t nr,
+                                  int32_t cols, int32_t lhs_offset, int32_t sums[TILE_L][TILE_R])
+{
+    const __m256i offset = _mm256_set1_epi16((int16_t)lhs_offset);
+    __m256i acc[TILE_L][TILE_R];
+    int32_t c = 0;
+
+#pragma GCC unroll 2
+    for (int32_t i = 0; i < nl; i++) {
+#pragma GCC unroll 4
+        for (int32_t j = 0; j < nr; j++) acc[i][j] = _mm256_setzero_si256();
+    }
+
+    for (; c + 16 <= cols; c += 16) {
+        __m256i r[TILE_R] = { _mm256_setzero_si256() };
+#pragma GCC unroll 4
+        for (int32_t j = 0; j < nr; j++) r[j] = load_epi16(rhs + j * cols + c);
+#pragma GCC unroll 2
+        for (int32_t i = 0; i < nl; i++) {
+            __m256i l = _mm256_add_epi16(load_epi16(lhs + i * cols + c), offset);
+#pragma GCC unroll 4
+            for (int32_t j = 0; j < nr; j++) acc[i][j] = _mm256_add_epi32(acc[i][j], _mm256_madd_epi16(l, r[j]));
+        }
+    }
+
+    for (int32_t i = 0; i < nl; i++) {
+        for (int32_t j = 0; j < nr; j++) sums[i][j] = hsum_epi32(acc[i][j]);
+    }
+    tile_tail(lhs, nl, rhs, nr, cols, c, lhs_offset, sums);
+}
+
+__attribute__((target("avx2")))
+static void tile_avx2(const q7_t *lhs, int32_t nl, const q7_t *rhs, int32_t nr, int32_t cols,
+                      int32_t lhs_offset, int32_t sums[TILE_L][TILE_R])
+{
+    if (nl == 2 && nr == 4)
+        tile_avx2_body(lhs, 2, rhs, 4, cols, lhs_offset, sums);
+    else if (nl == 1 && nr == 4)
+        tile_avx2_body(lhs, 1, rhs, 4, cols, lhs_offset, sums);
+    else
+        tile_avx2_body(lhs, nl, rhs, nr, cols, lhs_offset, sums);
+}
+
+__attribute__((target("avx2,avxvnni"), always_inline))
+static inline void tile_vnni_body(const q7_t *lhs, const int32_t nl, const q7_t *rhs, const int32_t nr,
+                                  int32_t cols, int32_t lhs_offset, int32_t sums[TILE_L][TILE_R])
+{
+    const __m256i bias = _mm256_set1_epi8((char)0x80);
+    const __m256i ones = _mm256_set1_epi8(1);
+    const __m256i offset = _mm256_set1_epi16((int16_t)lhs_offset);
+    __m256i acc[TILE_L][TILE_R];
+    __m256i rsum[TILE_R];
+    int32_t c = 0;
+
+#pragma GCC unroll 4
+    for (int32_t j = 0; j < nr; j++) {
+        rsum[j] = _mm256_setzero_si256();
+#pragma GCC unroll 2
+        for (int32_t i = 0; i < nl; i++) acc[i][j] = _mm256_setzero_si256();
+    }
+
+    // (l + 128) * r over these columns; the 128 * r part is taken off below
+    for (; c + 32 <= cols; c += 32) {
+        __m256i r[TILE_R] = { _mm256_setzero_si256() };
+#pragma GCC unroll 4
+        for (int32_t j = 0; j < nr; j++) {
+            r[j] = _mm256_loadu_si256((const __m256i *)(rhs + j * cols + c));
+            rsum[j] = _mm256_dpbusd_avx_epi32(rsum[j], ones, r[j]);
+        }
+#pragma GCC unroll 2
+        for (int32_t i = 0; i < nl; i++) {
+            __m256i l = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(lhs + i * cols + c)), bias);
+#pragma GCC unroll 4
+            for (int32_t j = 0; j < nr; j++) acc[i][j] = _mm256_dpbusd_avx_epi32(acc[i][j], l, r[j]);
+        }
+    }
+
+    // (l + lhs_offset) * r, as with AVX2, for a last sixteen
+    if (c + 16 <= cols) {
+        __m256i r[TILE_R] = { _mm256_setzero_si256() };
+#pragma GCC unroll 4
+        for (int32_t j = 0; j < nr; j++) r[j] = load_epi16(rhs + j * cols + c);
+#pragma GCC unroll 2
+        for (int32_t i = 0; i < nl; i++) {
+            __m256i l = _mm256_add_epi16(load_epi16(lhs + i * cols + c), offset);
+#pragma GCC unroll 4
+            for (int32_t j = 0; j < nr; j++) acc[i][j] = _mm256_add_epi32(acc[i][j], _mm256_madd_epi16(l, r[j]));
+        }
+        c += 16;
+    }
+
+    for (int32_t j = 0; j < nr; j++) {
+        int32_t correction = (lhs_offset - 128) * hsum_epi32(rsum[j]);
+        for (int32_t i = 0; i < nl; i++) sums[i][j] = hsum_epi32(acc[i][j]) + correction;
+    }
+    tile_tail(lhs, nl, rhs, nr, cols, c, lhs_offset, sums);
+}
+
+__attribute__((target("avx2,avxvnni")))
+static void tile_vnni(const q7_t *lhs, int32_t nl, const q7_t *rhs, int32_t nr, int32_t cols,
+                      int32_t lhs_offset, int32_t sums[TILE_L][TILE_R])
+{
+    if (nl == 2 && nr == 4)
+        tile_vnni_body(lhs, 2, rhs, 4, cols, lhs_offset, sums);
+    else if (nl == 1 && nr == 4)
+        tile_vnni_body(lhs, 1, rhs, 4, cols, lhs_offset, sums);
+    else
+        tile_vnni_body(lhs, nl, rhs, nr, cols, lhs_offset, sums);
+}
+
+/*******************************************************************************
+ * Dispatch
+ ******************************************************************************/
+static int nnImpl = -1;
+
+static bool cpu_has(nn_impl_t impl)
+{
+    __builtin_cpu_init();
+    switch (impl) {
+    case NN_IMPL_AVX2:
+        return __builtin_cpu_supports("avx2");
+    case NN_IMPL_AVX_VNNI:
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("avxvnni");
+    default:
+        return impl == NN_IMPL_REF;
+    }
+}
+
+static nn_impl_t select_impl(void)
+{
+    if (nnImpl < 0) {
+        const char *env = getenv("NN_IMPL");
+
+        nnImpl = cpu_has(NN_IMPL_AVX_VNNI) ? NN_IMPL_AVX_VNNI :
+                 cpu_has(NN_IMPL_AVX2) ? NN_IMPL_AVX2 : NN_IMPL_REF;
+        for (int i = 0; env && i < NN_IMPL_COUNT; i++) {
+            if (strcmp(env, nn_impl_name((nn_impl_t)i)) == 0 && cpu_has((nn_impl_t)i)) nnImpl = i;
+        }
+    }
+    return (nn_impl_t)nnImpl;
+}
+
+nn_impl_t nn_impl(void)
+{
+    return select_impl();
+}
+
+bool nn_use_impl(nn_impl_t impl)
+{
+    if (!cpu_has(impl)) return false;
+    nnImpl = impl;
+    return true;
+}
+
+static tile_fn_t select_tile(void)
+{
+    switch (select_impl()) {
+    case NN_IMPL_AVX_VNNI:
+        return tile_vnni;
+    case NN_IMPL_AVX2:
+        return tile_avx2;
+    default:
+        return NULL;
+    }
+}
+
+static inline q7_t requantize(int32_t acc, int32_t multiplier, int32_t shift, int32_t dst_offset,
+                              int32_t activation_min, int32_t activation_max)
+{
+    acc = arm_nn_requantize(acc, multiplier, shift) + dst_offset;
+    acc = MAX(acc, activation_min);
+    acc = MIN(acc, activation_max);
+    return (q7_t)acc;
+}
+
+arm_status arm_nn_mat_mult_nt_t_s8(const q7_t *lhs,
+                                   const q7_t *rhs,
+                                   const q31_t *bias,
+                                   q7_t *dst,
+                                   const int32_t *dst_multipliers,
+                                   const int32_t *dst_shifts,
+                                   const int32_t lhs_rows,
+                                   const int32_t rhs_rows,
+                                   const int32_t rhs_cols,
+                                   const int32_t lhs_offset,
+                                   const int32_t dst_offset,
+                                   const int32_t activation_min,
+                                   const int32_t activation_max)
+{
+    tile_fn_t tile = select_tile();
+    int32_t sums[TILE_L][TILE_R];
+
+    if (!tile) {
+        return arm_nn_mat_mult_nt_t_s8_ref(lhs, rhs, bias, dst, dst_multipliers, dst_shifts, lhs_rows, rhs_rows,
+                                           rhs_cols, lhs_offset, dst_offset, activation_min, activation_max);
+    }
+
+    // A tile's RHS rows stay in L1 while every LHS row goes past them
+    for (int32_t j = 0; j < rhs_rows; j += TILE_R) {
+        int32_t nr = MIN(TILE_R, rhs_rows - j);
+
+        for (int32_t i = 0; i < lhs_rows; i += TILE_L) {
+            int32_t nl = MIN(TILE_L, lhs_rows - i);
+
+            tile(lhs + i * rhs_cols, nl, rhs + j * rhs_cols, nr, rhs_cols, lhs_offset, sums);
+            for (int32_t a = 0; a < nl; a++) {
+                for (int32_t b = 0; b < nr; b++) {
+                    int32_t acc = sums[a][b] + (bias ? bias[j + b] : 0);
+                    dst[(i + a) * rhs_rows + j + b] = requantize(acc, dst_multipliers[j + b], dst_shifts[j + b],
+                                                                 dst_offset, activation_min, activation_max);
+                }
+            }
+        }
+    }
+    return ARM_MATH_SUCCESS;
+}
+
+arm_status arm_nn_vec_mat_mult_t_s8(const q7_t *lhs,
+                                    const q7_t *rhs,
+                                    const q31_t *bias,
+                                    q7_t *dst,
+                                    const int32_t lhs_offset,
+                                    const int32_t rhs_offset,
+                                    const int32_t dst_offset,
+                                    const int32_t dst_multiplier,
+                                    const int32_t dst_shift,
+                                    const int32_t rhs_cols,
+                                    const int32_t rhs_rows,
+                                    const int32_t activation_min,
+                                    const int32_t activation_max,
+                                    const int32_t address_offset)
+{
+    tile_fn_t tile = select_tile();
+    int32_t sums[TILE_L][TILE_R];
+
+    if (!tile) {
+        return arm_nn_vec_mat_mult_t_s8_ref(lhs, rhs, bias, dst, lhs_offset, rhs_offset, dst_offset,
+                                            dst_multiplier, dst_shift, rhs_cols, rhs_rows, activation_min,
+                                            activation_max, address_offset);
+    }
+
+    for (int32_t j = 0; j < rhs_rows; j += TILE_R) {
+        int32_t nr = MIN(TILE_R, rhs_rows - j);
+
+        tile(lhs, 1, rhs + j * rhs_cols, nr, rhs_cols, lhs_offset, sums);
+        for (int32_t b = 0; b < nr; b++) {
+            int32_t acc = sums[0][b] + (bias ? bias[j + b] : 0);
+            dst[(j + b) * address_offset] = requantize(acc, dst_multiplier, dst_shift, dst_offset,
+                                                       activation_min, activation_max);
+        }
+    }
+    return ARM_MATH_SUCCESS;
+}
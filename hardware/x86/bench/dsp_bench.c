@@ -0,0 +1,161 @@
+/**
+ * @file dsp_bench.c
+ * @brief Runner for the host benchmarks
+ *
+ * Usage: dsp_bench|nn_bench [--filter TEXT] [--min-ms N] [--json FILE] [--list]
+ *
+ * Each kernel whose name or example contains TEXT is run for at least N ms
+ * (default 200) and the results are written as JSON, to FILE or stdout.
+ * The exit status is non-zero if any kernel fails its example's check.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "dsp_bench.h"
+
+/*******************************************************************************
+ * Configuration
+ ******************************************************************************/
+#define DEFAULT_MIN_MS 200
+#define WARMUP_RUNS 8
+
+/*******************************************************************************
+ * Helpers shared with the kernels
+ ******************************************************************************/
+void bench_fill(float *dst, size_t n, uint32_t seed, float lo, float hi)
+{
+    uint32_t x = seed ? seed : 1;
+    for (size_t i = 0; i < n; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        dst[i] = lo + (hi - lo) * (float)(x >> 8) / (float)(1u << 24);
+    }
+}
+
+float bench_snr(const float *ref, const float *test, size_t n)
+{
+    double signal = 0.0;
+    double noise = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        signal += (double)ref[i] * ref[i];
+        noise += ((double)ref[i] - test[i]) * ((double)ref[i] - test[i]);
+    }
+    if (noise == 0.0) return INFINITY;
+    return (float)(10.0 * log10(signal / noise));
+}
+
+void bench_fill_s8(int8_t *dst, size_t n, uint32_t seed, int lo, int hi)
+{
+    uint32_t x = seed ? seed : 1;
+    for (size_t i = 0; i < n; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        dst[i] = (int8_t)(lo + (int)((x >> 8) % (uint32_t)(hi - lo + 1)));
+    }
+}
+
+/*******************************************************************************
+ * Runner
+ ******************************************************************************/
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static bool selected(const bench_kernel_t *k, const char *filter)
+{
+    return !filter || strstr(k->name, filter) || strstr(k->example, filter);
+}
+
+int main(int argc, char **argv)
+{
+    const char *filter = NULL;
+    const char *json_path = NULL;
+    unsigned long min_ms = DEFAULT_MIN_MS;
+    bool list = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--min-ms") == 0 && i + 1 < argc) {
+            min_ms = strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (strcmp(argv[i], "--list") == 0) {
+            list = true;
+        } else {
+            fprintf(stderr, "usage: %s [--filter TEXT] [--min-ms N] [--json FILE] [--list]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (list) {
+        for (size_t i = 0; i < bench_kernel_count; i++) {
+            if (selected(&bench_kernels[i], filter)) {
+                printf("%-40s %s\n", bench_kernels[i].name, bench_kernels[i].example);
+            }
+        }
+        return 0;
+    }
+
+    FILE *out = json_path ? fopen(json_path, "w") : stdout;
+    if (!out) {
+        perror(json_path);
+        return 2;
+    }
+
+    fprintf(out, "{\n  \"suite\": \"%s\",\n  \"compiler\": \"%s\",\n", bench_suite, __VERSION__);
+    bench_describe(out);
+    fprintf(out, "  \"min_ms\": %lu,\n  \"results\": [", min_ms);
+
+    int failures = 0;
+    bool first = true;
+    for (size_t i = 0; i < bench_kernel_count; i++) {
+        const bench_kernel_t *k = &bench_kernels[i];
+        if (!selected(k, filter)) continue;
+
+        if (k->setup) k->setup();
+        for (int w = 0; w < WARMUP_RUNS; w++) k->run();
+
+        // Double the batch until one batch takes min_ms, so the clock is read
+        // rarely compared to the work being measured
+        uint64_t calls = 1;
+        uint64_t elapsed;
+        while (true) {
+            uint64_t start = now_ns();
+            for (uint64_t c = 0; c < calls; c++) k->run();
+            elapsed = now_ns() - start;
+            if (elapsed >= min_ms * 1000000ULL) break;
+            calls *= 2;
+        }
+
+        bool ok = k->check ? k->check() : true;
+        if (!ok) failures++;
+
+        double ns_per_call = (double)elapsed / (double)calls;
+        fprintf(out, "%s\n    {\"name\": \"%s\", \"example\": \"%s\", \"samples\": %u, "
+                     "\"calls\": %llu, \"ns_per_call\": %.1f, \"ns_per_sample\": %.3f, \"ok\": %s}",
+                first ? "" : ",", k->name, k->example, k->samples,
+                (unsigned long long)calls, ns_per_call, ns_per_call / k->samples,
+                ok ? "true" : "false");
+        fflush(out);
+        first = false;
+    }
+
+    fprintf(out, "\n  ]\n}\n");
+    if (out != stdout) fclose(out);
+
+    if (failures) {
+        fprintf(stderr, "%d kernel(s) failed their check\n", failures);
+        return 1;
+    }
+    return 0;
+}
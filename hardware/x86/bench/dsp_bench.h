@@ -0,0 +1,65 @@
+/**
+ * @file dsp_bench.h
+ * @brief Host benchmarks of the bundled CMSIS-DSP and CMSIS-NN libraries
+ *
+ * In the CMSIS-DSP suite (dsp_kernels.c) each kernel is the processing
+ * chain of one of the CMSIS-DSP example programs
+ * (Drivers/CMSIS/DSP/Examples/ARM), cut down to a function that can be
+ * called repeatedly. The examples' own data files are reused where they
+ * have them; the rest use deterministic generated data. In the CMSIS-NN
+ * suite (nn_layers.c) each kernel is one int8 layer. After timing, every
+ * kernel is checked, against the pass criterion of its example or
+ * bit for bit against the reference, so a fast but wrong result is
+ * reported as such. dsp_bench.c runs either suite.
+ */
+
+#ifndef DSP_BENCH_H
+#define DSP_BENCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * @brief One timed kernel
+ */
+typedef struct
+{
+    const char *name;       /* main function measured, e.g. arm_fir_f32 */
+    const char *example;    /* example program or layer type the kernel comes from */
+    uint32_t samples;       /* samples (vectors for classifiers, MACs for layers) per run() */
+    void (*setup)(void);    /* one-time initialisation, not timed */
+    void (*run)(void);      /* the timed work; must be repeatable */
+    bool (*check)(void);    /* after run(): did it pass the example's test? */
+} bench_kernel_t;
+
+extern const bench_kernel_t bench_kernels[];
+extern const size_t bench_kernel_count;
+
+/**
+ * @brief Name of the suite, for the JSON results
+ */
+extern const char bench_suite[];
+
+/**
+ * @brief Write the suite's own fields of the JSON header, each as "key": value,
+ */
+void bench_describe(FILE *out);
+
+/**
+ * @brief Fill a buffer with uniform values in [lo, hi) from a fixed seed
+ */
+void bench_fill(float *dst, size_t n, uint32_t seed, float lo, float hi);
+
+/**
+ * @brief Signal-to-noise ratio of test against ref in dB, as math_helper.c
+ */
+float bench_snr(const float *ref, const float *test, size_t n);
+
+/**
+ * @brief Fill a buffer with uniform int8 values in [lo, hi] from a fixed seed
+ */
+void bench_fill_s8(int8_t *dst, size_t n, uint32_t seed, int lo, int hi);
+
+#endif // DSP_BENCH_H
@@ -0,0 +1,1571 @@
+/**
+ * @file dsp_kernels.c
+ * @brief CMSIS-DSP example programs as timed kernels
+ *
+ * Kernels are listed in the same order as Examples/ARM. Constants that the
+ * examples define inline (classifier parameters, the matrix example's
+ * system) are repeated here; larger data comes from the examples' *_data.c
+ * files, which are linked in unchanged.
+ *
+ * After the examples come kernels for the functions the x86 backend
+ * replaces, each timed against the library's own version, and for the
+ * multi-channel filters, each timed against one call per channel. The
+ * streaming statistics, the k-NN search and the batch classifiers are
+ * timed against the StatisticsFunctions, DistanceFunctions and per-vector
+ * predict calls they stand in for. Last, building the FFT tables at run
+ * time, as a firmware with its tables in RAM does at boot.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arm_math.h"
+#include "arm_const_structs.h"
+#include "arm_multichannel.h"
+#include "arm_stream_stats.h"
+#include "arm_knn.h"
+#include "arm_classify_batch.h"
+#include "arm_fft_tables.h"
+#include "dsp_bench.h"
+#include "dsp_x86.h"
+
+/*******************************************************************************
+ * arm_bayes_example
+ ******************************************************************************/
+#define BAYES_CLASSES 3
+#define BAYES_DIM 2
+#define BAYES_VECTORS 3
+
+static const float32_t bayesTheta[BAYES_CLASSES * BAYES_DIM] = {
+    1.4539529436590528f, 0.8722776016801852f,
+    -1.5267934452462473f, 0.903204577814203f,
+    -0.15338006360932258f, -2.9997913665803964f
+};
+static const float32_t bayesSigma[BAYES_CLASSES * BAYES_DIM] = {
+    1.0063470889514925f, 0.9038018246524426f,
+    1.0224479953244736f, 0.7768764290432544f,
+    1.1217662403241206f, 1.2303890106020325f
+};
+static const float32_t bayesPriors[BAYES_CLASSES] = {
+    0.3333333333333333f, 0.3333333333333333f, 0.3333333333333333f
+};
+static const float32_t bayesIn[BAYES_VECTORS][BAYES_DIM] = {
+    { 1.5f, 1.0f }, { -1.5f, 1.0f }, { 0.0f, -3.0f }
+};
+static arm_gaussian_naive_bayes_instance_f32 bayes;
+static uint32_t bayesClass[BAYES_VECTORS];
+
+static void bayes_setup(void)
+{
+    bayes.vectorDimension = BAYES_DIM;
+    bayes.numberOfClasses = BAYES_CLASSES;
+    bayes.theta = bayesTheta;
+    bayes.sigma = bayesSigma;
+    bayes.classPriors = bayesPriors;
+    bayes.epsilon = 4.328939296523643e-09f;
+}
+
+static void bayes_run(void)
+{
+    float32_t result[BAYES_CLASSES];
+    float32_t temp[BAYES_CLASSES];
+    for (int i = 0; i < BAYES_VECTORS; i++) {
+        bayesClass[i] = arm_gaussian_naive_bayes_predict_f32(&bayes, bayesIn[i], result, temp);
+    }
+}
+
+static bool bayes_check(void)
+{
+    return bayesClass[0] == 0 && bayesClass[1] == 1 && bayesClass[2] == 2;
+}
+
+/*******************************************************************************
+ * arm_class_marks_example
+ ******************************************************************************/
+#define MARKS_STUDENTS 20
+#define MARKS_SUBJECTS 4
+
+static float32_t marks[MARKS_STUDENTS * MARKS_SUBJECTS];
+static const float32_t marksUnity[MARKS_SUBJECTS] = { 1.0f, 1.0f, 1.0f, 1.0f };
+static float32_t marksTotal[MARKS_STUDENTS];
+static float32_t marksMax, marksMin, marksMean, marksStd, marksVar;
+
+static void marks_setup(void)
+{
+    bench_fill(marks, MARKS_STUDENTS * MARKS_SUBJECTS, 11, 0.0f, 100.0f);
+}
+
+static void marks_run(void)
+{
+    arm_matrix_instance_f32 a, b, c;
+    uint32_t index;
+
+    arm_mat_init_f32(&a, MARKS_STUDENTS, MARKS_SUBJECTS, marks);
+    arm_mat_init_f32(&b, MARKS_SUBJECTS, 1, (float32_t *)marksUnity);
+    arm_mat_init_f32(&c, MARKS_STUDENTS, 1, marksTotal);
+    arm_mat_mult_f32(&a, &b, &c);
+
+    arm_max_f32(marksTotal, MARKS_STUDENTS, &marksMax, &index);
+    arm_min_f32(marksTotal, MARKS_STUDENTS, &marksMin, &index);
+    arm_mean_f32(marksTotal, MARKS_STUDENTS, &marksMean);
+    arm_std_f32(marksTotal, MARKS_STUDENTS, &marksStd);
+    arm_var_f32(marksTotal, MARKS_STUDENTS, &marksVar);
+}
+
+static bool marks_check(void)
+{
+    double sum = 0.0;
+    for (int i = 0; i < MARKS_STUDENTS * MARKS_SUBJECTS; i++) sum += marks[i];
+    double mean = sum / MARKS_STUDENTS;
+
+    return fabs(marksMean - mean) < 1e-3 * mean && marksMin <= marksMean &&
+           marksMean <= marksMax && fabsf(marksStd * marksStd - marksVar) < 1e-3f * marksVar;
+}
+
+/*******************************************************************************
+ * arm_convolution_example
+ *
+ * Linear convolution of two 32-sample signals by multiplying their 64-point
+ * spectra, checked against direct convolution with arm_conv_f32.
+ ******************************************************************************/
+#define CONV_LEN 32
+#define CONV_FFT 64
+#define CONV_SNR_THRESHOLD 90.0f
+
+static float32_t convA[CONV_LEN];
+static float32_t convB[CONV_LEN];
+static float32_t convRef[2 * CONV_LEN - 1];
+static float32_t convOut[2 * CONV_LEN - 1];
+
+static void conv_setup(void)
+{
+    bench_fill(convA, CONV_LEN, 21, -1.0f, 1.0f);
+    bench_fill(convB, CONV_LEN, 22, -1.0f, 1.0f);
+    arm_conv_f32(convA, CONV_LEN, convB, CONV_LEN, convRef);
+}
+
+static void conv_run(void)
+{
+    float32_t ak[2 * CONV_FFT];
+    float32_t bk[2 * CONV_FFT];
+    float32_t axb[2 * CONV_FFT];
+
+    // Zero-padded real signals as interleaved complex
+    memset(ak, 0, sizeof(ak));
+    memset(bk, 0, sizeof(bk));
+    for (int i = 0; i < CONV_LEN; i++) {
+        ak[2 * i] = convA[i];
+        bk[2 * i] = convB[i];
+    }
+
+    arm_cfft_f32(&arm_cfft_sR_f32_len64, ak, 0, 1);
+    arm_cfft_f32(&arm_cfft_sR_f32_len64, bk, 0, 1);
+    arm_cmplx_mult_cmplx_f32(ak, bk, axb, CONV_FFT);
+    arm_cfft_f32(&arm_cfft_sR_f32_len64, axb, 1, 1);
+
+    for (int i = 0; i < 2 * CONV_LEN - 1; i++) {
+        convOut[i] = axb[2 * i];
+    }
+}
+
+static bool conv_check(void)
+{
+    return bench_snr(convRef, convOut, 2 * CONV_LEN - 1) > CONV_SNR_THRESHOLD;
+}
+
+/*******************************************************************************
+ * arm_dotproduct_example
+ ******************************************************************************/
+#define DOT_LEN 1024
+
+static float32_t dotA[DOT_LEN];
+static float32_t dotB[DOT_LEN];
+static float32_t dotOut;
+
+static void dot_setup(void)
+{
+    bench_fill(dotA, DOT_LEN, 31, -1.0f, 1.0f);
+    bench_fill(dotB, DOT_LEN, 32, -1.0f, 1.0f);
+}
+
+static void dot_run(void)
+{
+    arm_dot_prod_f32(dotA, dotB, DOT_LEN, &dotOut);
+}
+
+static bool dot_check(void)
+{
+    double ref = 0.0;
+    double mag = 0.0;
+    for (int i = 0; i < DOT_LEN; i++) {
+        ref += (double)dotA[i] * dotB[i];
+        mag += fabs((double)dotA[i] * dotB[i]);
+    }
+    return fabs(dotOut - ref) < 1e-5 * mag;
+}
+
+/*******************************************************************************
+ * arm_fft_bin_example
+ ******************************************************************************/
+#define FFT_BIN_SIZE 1024
+#define FFT_BIN_REF_INDEX 213
+
+extern float32_t testInput_f32_10khz[2 * FFT_BIN_SIZE];
+
+static arm_cfft_instance_f32 fftBin;
+static float32_t fftBinBuf[2 * FFT_BIN_SIZE];
+static float32_t fftBinMag[FFT_BIN_SIZE];
+static uint32_t fftBinIndex;
+
+static void fft_bin_setup(void)
+{
+    arm_cfft_init_f32(&fftBin, FFT_BIN_SIZE);
+}
+
+static void fft_bin_run(void)
+{
+    float32_t maxValue;
+
+    // The transform is in place, so start from the input each time
+    memcpy(fftBinBuf, testInput_f32_10khz, sizeof(fftBinBuf));
+    arm_cfft_f32(&fftBin, fftBinBuf, 0, 1);
+    arm_cmplx_mag_f32(fftBinBuf, fftBinMag, FFT_BIN_SIZE);
+    arm_max_f32(fftBinMag, FFT_BIN_SIZE, &maxValue, &fftBinIndex);
+}
+
+static bool fft_bin_check(void)
+{
+    return fftBinIndex == FFT_BIN_REF_INDEX;
+}
+
+/*******************************************************************************
+ * arm_fir_example
+ ******************************************************************************/
+#define FIR_SAMPLES 320
+#define FIR_BLOCK 32
+#define FIR_TAPS 29
+#define FIR_SNR_THRESHOLD 75.0f
+
+extern float32_t testInput_f32_1kHz_15kHz[FIR_SAMPLES];
+extern float32_t refOutput[FIR_SAMPLES];
+
+// fir1(28, 6/24), as in the example
+static const float32_t firCoeffs[FIR_TAPS] = {
+    -0.0018225230f, -0.0015879294f, +0.0000000000f, +0.0036977508f, +0.0080754303f, +0.0085302217f, -0.0000000000f, -0.0173976984f,
+    -0.0341458607f, -0.0333591565f, +0.0000000000f, +0.0676308395f, +0.1522061835f, +0.2229246956f, +0.2504960933f, +0.2229246956f,
+    +0.1522061835f, +0.0676308395f, +0.0000000000f, -0.0333591565f, -0.0341458607f, -0.0173976984f, -0.0000000000f, +0.0085302217f,
+    +0.0080754303f, +0.0036977508f, +0.0000000000f, -0.0015879294f, -0.0018225230f
+};
+static float32_t firState[FIR_BLOCK + FIR_TAPS - 1];
+static float32_t firOut[FIR_SAMPLES];
+
+static void fir_run(void)
+{
+    arm_fir_instance_f32 s;
+    arm_fir_init_f32(&s, FIR_TAPS, firCoeffs, firState, FIR_BLOCK);
+    for (int i = 0; i < FIR_SAMPLES; i += FIR_BLOCK) {
+        arm_fir_f32(&s, &testInput_f32_1kHz_15kHz[i], &firOut[i], FIR_BLOCK);
+    }
+}
+
+static bool fir_check(void)
+{
+    return bench_snr(refOutput, firOut, FIR_SAMPLES) > FIR_SNR_THRESHOLD;
+}
+
+/*******************************************************************************
+ * arm_graphic_equalizer_example
+ *
+ * Five bands of two Q31 biquad stages each, the first two bands with the
+ * 32x64 (extended precision) filter, as in the example. The example's
+ * coefficient table is inline in its source, so the bands here are peaking
+ * filters designed at setup with the example's gains, and the result is
+ * checked against the same cascade in floating point.
+ ******************************************************************************/
+#define GEQ_SAMPLES 320
+#define GEQ_BLOCK 32
+#define GEQ_BANDS 5
+#define GEQ_STAGES 2
+#define GEQ_POST_SHIFT 2
+#define GEQ_SNR_THRESHOLD 90.0f
+
+extern float32_t geq_testInput_f32[GEQ_SAMPLES];
+
+static const float geqFreq[GEQ_BANDS] = { 0.005f, 0.015f, 0.05f, 0.15f, 0.35f };  // of fs
+static const int geqGainDB[GEQ_BANDS] = { 0, -3, 6, 4, -6 };
+
+static q31_t geqCoeffsQ31[GEQ_BANDS][5 * GEQ_STAGES];
+static float32_t geqCoeffsF32[5 * GEQ_STAGES * GEQ_BANDS];
+static float32_t geqRef[GEQ_SAMPLES];
+static float32_t geqOut[GEQ_SAMPLES];
+
+static void geq_setup(void)
+{
+    for (int band = 0; band < GEQ_BANDS; band++) {
+        // RBJ peaking filter, half of the band's gain in each stage
+        double a = pow(10.0, geqGainDB[band] / 80.0);
+        double w0 = 2.0 * PI * geqFreq[band];
+        double alpha = sin(w0) / (2.0 * 1.0);
+        double a0 = 1.0 + alpha / a;
+        double c[5] = {
+            (1.0 + alpha * a) / a0, -2.0 * cos(w0) / a0, (1.0 - alpha * a) / a0,
+            2.0 * cos(w0) / a0, -(1.0 - alpha / a) / a0    // CMSIS negates a1, a2
+        };
+
+        for (int stage = 0; stage < GEQ_STAGES; stage++) {
+            for (int k = 0; k < 5; k++) {
+                geqCoeffsQ31[band][stage * 5 + k] = (q31_t)lround(c[k] * (1 << (31 - GEQ_POST_SHIFT)));
+                geqCoeffsF32[(band * GEQ_STAGES + stage) * 5 + k] = (float32_t)c[k];
+            }
+        }
+    }
+
+    float32_t state[4 * GEQ_STAGES * GEQ_BANDS];
+    arm_biquad_casd_df1_inst_f32 ref;
+    arm_biquad_cascade_df1_init_f32(&ref, GEQ_STAGES * GEQ_BANDS, geqCoeffsF32, state);
+    arm_biquad_cascade_df1_f32(&ref, geq_testInput_f32, geqRef, GEQ_SAMPLES);
+}
+
+static void geq_run(void)
+{
+    static q63_t state64[2][4 * GEQ_STAGES];
+    static q31_t state31[3][4 * GEQ_STAGES];
+    arm_biquad_cas_df1_32x64_ins_q31 s64[2];
+    arm_biquad_casd_df1_inst_q31 s31[3];
+    q31_t buf[GEQ_BLOCK];
+
+    for (int b = 0; b < 2; b++) {
+        arm_biquad_cas_df1_32x64_init_q31(&s64[b], GEQ_STAGES, geqCoeffsQ31[b], state64[b], GEQ_POST_SHIFT);
+    }
+    for (int b = 0; b < 3; b++) {
+        arm_biquad_cascade_df1_init_q31(&s31[b], GEQ_STAGES, geqCoeffsQ31[2 + b], state31[b], GEQ_POST_SHIFT);
+    }
+
+    for (int i = 0; i < GEQ_SAMPLES; i += GEQ_BLOCK) {
+        arm_float_to_q31(&geq_testInput_f32[i], buf, GEQ_BLOCK);
+        arm_scale_q31(buf, 0x7FFFFFFF, -3, buf, GEQ_BLOCK);   // headroom for gain
+        arm_biquad_cas_df1_32x64_q31(&s64[0], buf, buf, GEQ_BLOCK);
+        arm_biquad_cas_df1_32x64_q31(&s64[1], buf, buf, GEQ_BLOCK);
+        arm_biquad_cascade_df1_q31(&s31[0], buf, buf, GEQ_BLOCK);
+        arm_biquad_cascade_df1_q31(&s31[1], buf, buf, GEQ_BLOCK);
+        arm_biquad_cascade_df1_q31(&s31[2], buf, buf, GEQ_BLOCK);
+        arm_q31_to_float(buf, &geqOut[i], GEQ_BLOCK);
+        arm_scale_f32(&geqOut[i], 8.0f, &geqOut[i], GEQ_BLOCK);
+    }
+}
+
+static bool geq_check(void)
+{
+    return bench_snr(geqRef, geqOut, GEQ_SAMPLES) > GEQ_SNR_THRESHOLD;
+}
+
+/*******************************************************************************
+ * arm_linear_interp_example
+ ******************************************************************************/
+#define INTERP_SAMPLES 1024
+#define INTERP_TABLE_LEN 1884
+#define INTERP_XSPACING 0.005f
+
+extern const float arm_linear_interep_table[INTERP_TABLE_LEN];
+
+static float32_t interpIn[INTERP_SAMPLES];
+static float32_t interpOut[INTERP_SAMPLES];
+static arm_linear_interp_instance_f32 interp;
+
+static void interp_setup(void)
+{
+    interp.nValues = INTERP_TABLE_LEN;
+    interp.x1 = -PI;
+    interp.xSpacing = INTERP_XSPACING;
+    interp.pYData = (float32_t *)arm_linear_interep_table;
+    bench_fill(interpIn, INTERP_SAMPLES, 41, -PI, PI);
+}
+
+static void interp_run(void)
+{
+    for (int i = 0; i < INTERP_SAMPLES; i++) {
+        interpOut[i] = arm_linear_interp_f32(&interp, interpIn[i]);
+    }
+}
+
+static bool interp_check(void)
+{
+    // The table holds sin(x); linear interpolation at 0.005 spacing is good
+    // to about spacing^2 / 8
+    for (int i = 0; i < INTERP_SAMPLES; i++) {
+        if (fabsf(interpOut[i] - sinf(interpIn[i])) > 1e-4f) return false;
+    }
+    return true;
+}
+
+/*******************************************************************************
+ * arm_matrix_example
+ *
+ * Least-squares fit X = inv(A' * A) * A' * B.
+ ******************************************************************************/
+#define MATRIX_SNR_THRESHOLD 90.0f
+
+static const float32_t matB[4] = { 782.0f, 7577.0f, 470.0f, 4505.0f };
+static const float32_t matA[16] = {
+    1.0f, 32.0f, 4.0f, 128.0f,
+    1.0f, 32.0f, 64.0f, 2048.0f,
+    1.0f, 16.0f, 4.0f, 64.0f,
+    1.0f, 16.0f, 64.0f, 1024.0f,
+};
+static const float32_t matXRef[4] = { 73.0f, 8.0f, 21.25f, 2.875f };
+static float32_t matX[4];
+
+static void matrix_run(void)
+{
+    float32_t at[16], atma[16], atmai[16];
+    arm_matrix_instance_f32 A, AT, ATMA, ATMAI, B, X;
+
+    arm_mat_init_f32(&A, 4, 4, (float32_t *)matA);
+    arm_mat_init_f32(&AT, 4, 4, at);
+    arm_mat_init_f32(&ATMA, 4, 4, atma);
+    arm_mat_init_f32(&ATMAI, 4, 4, atmai);
+    arm_mat_init_f32(&B, 4, 1, (float32_t *)matB);
+    arm_mat_init_f32(&X, 4, 1, matX);
+
+    arm_mat_trans_f32(&A, &AT);
+    arm_mat_mult_f32(&AT, &A, &ATMA);
+    arm_mat_inverse_f32(&ATMA, &ATMAI);
+    arm_mat_mult_f32(&ATMAI, &AT, &ATMA);
+    arm_mat_mult_f32(&ATMA, &B, &X);
+}
+
+static bool matrix_check(void)
+{
+    return bench_snr(matXRef, matX, 4) > MATRIX_SNR_THRESHOLD;
+}
+
+/*******************************************************************************
+ * arm_signal_converge_example
+ ******************************************************************************/
+#define CONVERGE_SAMPLES 1536
+#define CONVERGE_TAPS 32
+#define CONVERGE_BLOCK 32
+#define CONVERGE_MU 0.5f
+#define CONVERGE_DELTA_ERROR 0.00009f
+#define CONVERGE_DELTA_COEFF 0.0001f
+
+extern float32_t converge_testInput_f32[CONVERGE_SAMPLES];
+extern float32_t lmsNormCoeff_f32[CONVERGE_TAPS];
+extern const float32_t FIRCoeff_f32[CONVERGE_TAPS];
+
+static float32_t convergeCoeffs[CONVERGE_TAPS];
+static float32_t convergeErr[CONVERGE_BLOCK];
+
+static void converge_run(void)
+{
+    static float32_t firState[CONVERGE_TAPS + CONVERGE_BLOCK];
+    static float32_t lmsState[CONVERGE_TAPS + CONVERGE_BLOCK];
+    float32_t wire2[CONVERGE_BLOCK], wire3[CONVERGE_BLOCK];
+    arm_fir_instance_f32 lpf;
+    arm_lms_norm_instance_f32 lms;
+
+    // The adaptive filter updates its coefficients, so start over each run
+    memcpy(convergeCoeffs, lmsNormCoeff_f32, sizeof(convergeCoeffs));
+    arm_lms_norm_init_f32(&lms, CONVERGE_TAPS, convergeCoeffs, lmsState, CONVERGE_MU, CONVERGE_BLOCK);
+    arm_fir_init_f32(&lpf, CONVERGE_TAPS, FIRCoeff_f32, firState, CONVERGE_BLOCK);
+
+    for (int i = 0; i < CONVERGE_SAMPLES; i += CONVERGE_BLOCK) {
+        float32_t *wire1 = &converge_testInput_f32[i];
+        arm_fir_f32(&lpf, wire1, wire2, CONVERGE_BLOCK);
+        arm_lms_norm_f32(&lms, wire1, wire2, wire3, convergeErr, CONVERGE_BLOCK);
+        arm_scale_f32(wire3, 5, wire3, CONVERGE_BLOCK);
+    }
+}
+
+static bool converge_check(void)
+{
+    float32_t err[CONVERGE_BLOCK], diff[CONVERGE_TAPS];
+    float32_t minValue;
+    uint32_t index;
+
+    arm_abs_f32(convergeErr, err, CONVERGE_BLOCK);
+    arm_min_f32(err, CONVERGE_BLOCK, &minValue, &index);
+    if (minValue > CONVERGE_DELTA_ERROR) return false;
+
+    arm_sub_f32(FIRCoeff_f32, convergeCoeffs, diff, CONVERGE_TAPS);
+    arm_abs_f32(diff, diff, CONVERGE_TAPS);
+    arm_min_f32(diff, CONVERGE_TAPS, &minValue, &index);
+    return minValue <= CONVERGE_DELTA_COEFF;
+}
+
+/*******************************************************************************
+ * arm_sin_cos_example
+ ******************************************************************************/
+#define SINCOS_SAMPLES 1024
+#define SINCOS_DELTA 0.0001f
+
+static float32_t sincosIn[SINCOS_SAMPLES];
+static float32_t sincosOut[SINCOS_SAMPLES];
+
+static void sincos_setup(void)
+{
+    bench_fill(sincosIn, SINCOS_SAMPLES, 51, -PI, PI);
+}
+
+static void sincos_run(void)
+{
+    // sin^2 + cos^2, as in the example
+    for (int i = 0; i < SINCOS_SAMPLES; i++) {
+        float32_t s = arm_sin_f32(sincosIn[i]);
+        float32_t c = arm_cos_f32(sincosIn[i]);
+        sincosOut[i] = s * s + c * c;
+    }
+}
+
+static bool sincos_check(void)
+{
+    for (int i = 0; i < SINCOS_SAMPLES; i++) {
+        if (fabsf(sincosOut[i] - 1.0f) > SINCOS_DELTA) return false;
+    }
+    return true;
+}
+
+/*******************************************************************************
+ * arm_svm_example
+ ******************************************************************************/
+#define SVM_VECTORS 11
+#define SVM_DIM 2
+
+static const float32_t svmDualCoefficients[SVM_VECTORS] = {
+    -0.01628988f, -0.0971605f, -0.02707579f, 0.0249406f, 0.00223095f, 0.04117345f,
+    0.0262687f, 0.00800358f, 0.00581823f, 0.02346904f, 0.00862162f
+};
+static const float32_t svmSupportVectors[SVM_VECTORS * SVM_DIM] = {
+    1.2510991f, 0.47782799f, -0.32711859f, -1.49880648f, -0.08905047f, 1.31907242f,
+    1.14059333f, 2.63443767f, -2.62561524f, 1.02120701f, -1.2361353f, -2.53145187f,
+    2.28308122f, -1.58185875f, 2.73955981f, 0.35759327f, 0.56662986f, 2.79702016f,
+    -2.51380816f, 1.29295364f, -0.56658669f, -2.81944734f
+};
+static const int32_t svmClasses[2] = { 0, 1 };
+static const float32_t svmIn[2][SVM_DIM] = { { 0.4f, 0.1f }, { 3.0f, 0.0f } };
+
+static arm_svm_polynomial_instance_f32 svm;
+static int32_t svmResult[2];
+
+static void svm_setup(void)
+{
+    arm_svm_polynomial_init_f32(&svm, SVM_VECTORS, SVM_DIM, -1.661719f,
+                                svmDualCoefficients, svmSupportVectors, svmClasses,
+                                3, 1.100000f, 0.500000f);
+}
+
+static void svm_run(void)
+{
+    for (int i = 0; i < 2; i++) {
+        arm_svm_polynomial_predict_f32(&svm, svmIn[i], &svmResult[i]);
+    }
+}
+
+static bool svm_check(void)
+{
+    return svmResult[0] == 0 && svmResult[1] == 1;
+}
+
+/*******************************************************************************
+ * arm_variance_example
+ ******************************************************************************/
+#define VAR_LEN 1024
+
+static float32_t varIn[VAR_LEN];
+static float32_t varOut;
+
+static void var_setup(void)
+{
+    bench_fill(varIn, VAR_LEN, 61, -1.0f, 1.0f);
+}
+
+static void var_run(void)
+{
+    arm_var_f32(varIn, VAR_LEN, &varOut);
+}
+
+static bool var_check(void)
+{
+    double sum = 0.0, sq = 0.0;
+    for (int i = 0; i < VAR_LEN; i++) sum += varIn[i];
+    double mean = sum / VAR_LEN;
+    for (int i = 0; i < VAR_LEN; i++) sq += (varIn[i] - mean) * (varIn[i] - mean);
+    double ref = sq / (VAR_LEN - 1);
+    return fabs(varOut - ref) < 1e-5 * ref;
+}
+
+/*******************************************************************************
+ * arm_cfft_f32 backend
+ *
+ * A 4096-point forward transform with either implementation. The check runs
+ * every length both ways, with and without bit reversal, against the
+ * library's version.
+ ******************************************************************************/
+#define CFFT_LEN 4096
+#define CFFT_SNR_THRESHOLD 110.0f
+
+static float32_t cfftIn[2 * CFFT_LEN];
+static float32_t cfftBuf[2 * CFFT_LEN];
+static float32_t cfftRef[2 * CFFT_LEN];
+
+static void cfft_setup(void)
+{
+    bench_fill(cfftIn, 2 * CFFT_LEN, 81, -1.0f, 1.0f);
+}
+
+static void cfft_run(void)
+{
+    memcpy(cfftBuf, cfftIn, sizeof(cfftBuf));
+    arm_cfft_f32(&arm_cfft_sR_f32_len4096, cfftBuf, 0, 1);
+}
+
+static void cfft_ref_run(void)
+{
+    memcpy(cfftBuf, cfftIn, sizeof(cfftBuf));
+    arm_cfft_f32_ref(&arm_cfft_sR_f32_len4096, cfftBuf, 0, 1);
+}
+
+static bool cfft_check(void)
+{
+    for (uint16_t len = 16; len <= CFFT_LEN; len *= 2) {
+        arm_cfft_instance_f32 fft;
+        if (arm_cfft_init_f32(&fft, len) != ARM_MATH_SUCCESS) return false;
+
+        for (uint8_t flags = 0; flags < 4; flags++) {
+            uint8_t inverse = flags & 1;
+            uint8_t bitReverse = flags >> 1;
+            memcpy(cfftBuf, cfftIn, 2 * len * sizeof(float32_t));
+            memcpy(cfftRef, cfftIn, 2 * len * sizeof(float32_t));
+            arm_cfft_f32(&fft, cfftBuf, inverse, bitReverse);
+            arm_cfft_f32_ref(&fft, cfftRef, inverse, bitReverse);
+            if (bench_snr(cfftRef, cfftBuf, 2 * len) < CFFT_SNR_THRESHOLD) return false;
+        }
+    }
+    return true;
+}
+
+/*******************************************************************************
+ * arm_mat_mult_f32 / arm_mat_vec_mult_f32 backend
+ *
+ * A 512x512 product and a 2048x2048 matrix-vector product with either
+ * implementation. The checks cover shapes that leave partial tiles and
+ * span several cache blocks. Products are compared with the library's
+ * version; matrix-vector products with a double-precision sum, since the
+ * library's version keeps its row offset in 16 bits and goes wrong once a
+ * matrix has more than 65535 elements.
+ ******************************************************************************/
+#define MAT_DIM 512
+#define MATVEC_DIM 2048
+#define MAT_SNR_THRESHOLD 100.0f
+
+static float32_t *gemmA;
+static float32_t *gemmB;
+static float32_t *gemmC;
+static float32_t *gemvX;
+static float32_t *gemvY;
+
+static void mat_setup(void)
+{
+    if (!gemmA) {
+        gemmA = malloc(MATVEC_DIM * MATVEC_DIM * sizeof(float32_t));
+        gemmB = malloc(MAT_DIM * MAT_DIM * sizeof(float32_t));
+        gemmC = malloc(MAT_DIM * MAT_DIM * sizeof(float32_t));
+        gemvX = malloc(MATVEC_DIM * sizeof(float32_t));
+        gemvY = malloc(MATVEC_DIM * sizeof(float32_t));
+    }
+    bench_fill(gemmA, MATVEC_DIM * MATVEC_DIM, 91, -1.0f, 1.0f);
+    bench_fill(gemmB, MAT_DIM * MAT_DIM, 92, -1.0f, 1.0f);
+    bench_fill(gemvX, MATVEC_DIM, 93, -1.0f, 1.0f);
+}
+
+static void mat_run(void)
+{
+    arm_matrix_instance_f32 a = { MAT_DIM, MAT_DIM, gemmA };
+    arm_matrix_instance_f32 b = { MAT_DIM, MAT_DIM, gemmB };
+    arm_matrix_instance_f32 c = { MAT_DIM, MAT_DIM, gemmC };
+    arm_mat_mult_f32(&a, &b, &c);
+}
+
+static void mat_ref_run(void)
+{
+    arm_matrix_instance_f32 a = { MAT_DIM, MAT_DIM, gemmA };
+    arm_matrix_instance_f32 b = { MAT_DIM, MAT_DIM, gemmB };
+    arm_matrix_instance_f32 c = { MAT_DIM, MAT_DIM, gemmC };
+    arm_mat_mult_f32_ref(&a, &b, &c);
+}
+
+static bool mat_check(void)
+{
+    static const uint16_t shapes[][3] = {
+        { 1, 1, 1 }, { 5, 7, 3 }, { 6, 256, 16 }, { 37, 61, 53 },
+        { 130, 17, 300 }, { 121, 1030, 257 }, { 300, 600, 1100 }, { MAT_DIM, MAT_DIM, MAT_DIM },
+    };
+    bool ok = true;
+
+    for (size_t i = 0; i < sizeof(shapes) / sizeof(shapes[0]) && ok; i++) {
+        uint16_t m = shapes[i][0], k = shapes[i][1], n = shapes[i][2];
+        float32_t *bData = malloc((size_t)k * n * sizeof(float32_t));
+        float32_t *out = malloc((size_t)m * n * sizeof(float32_t));
+        float32_t *ref = malloc((size_t)m * n * sizeof(float32_t));
+        bench_fill(bData, (size_t)k * n, 94 + i, -1.0f, 1.0f);
+
+        arm_matrix_instance_f32 a = { m, k, gemmA };
+        arm_matrix_instance_f32 b = { k, n, bData };
+        arm_matrix_instance_f32 c = { m, n, out };
+        arm_matrix_instance_f32 r = { m, n, ref };
+        ok = arm_mat_mult_f32(&a, &b, &c) == ARM_MATH_SUCCESS &&
+             arm_mat_mult_f32_ref(&a, &b, &r) == ARM_MATH_SUCCESS &&
+             bench_snr(ref, out, (size_t)m * n) > MAT_SNR_THRESHOLD;
+
+        free(bData);
+        free(out);
+        free(ref);
+    }
+    return ok;
+}
+
+static void matvec_run(void)
+{
+    arm_matrix_instance_f32 a = { MATVEC_DIM, MATVEC_DIM, gemmA };
+    arm_mat_vec_mult_f32(&a, gemvX, gemvY);
+}
+
+static void matvec_ref_run(void)
+{
+    arm_matrix_instance_f32 a = { MATVEC_DIM, MATVEC_DIM, gemmA };
+    arm_mat_vec_mult_f32_ref(&a, gemvX, gemvY);
+}
+
+static bool matvec_check(void)
+{
+    static const uint16_t shapes[][2] = { { 1, 1 }, { 3, 13 }, { 259, 77 }, { 1031, 2047 } };
+    float32_t ref[MATVEC_DIM];
+
+    for (size_t i = 0; i < sizeof(shapes) / sizeof(shapes[0]); i++) {
+        uint16_t rows = shapes[i][0], cols = shapes[i][1];
+        arm_matrix_instance_f32 a = { rows, cols, gemmA };
+        arm_mat_vec_mult_f32(&a, gemvX, gemvY);
+        for (uint16_t r = 0; r < rows; r++) {
+            double sum = 0.0;
+            for (uint16_t c = 0; c < cols; c++) sum += (double)gemmA[r * cols + c] * gemvX[c];
+            ref[r] = (float32_t)sum;
+        }
+        if (bench_snr(ref, gemvY, rows) < MAT_SNR_THRESHOLD) return false;
+    }
+    return true;
+}
+
+/*******************************************************************************
+ * Multi-channel filters
+ *
+ * 16 channels of 256 samples through a 4-stage biquad cascade, a 32-tap
+ * f32 FIR and a 32-tap q15 FIR, in one call or in one call per channel.
+ * The checks run two blocks, so the carried state is covered too, in both
+ * layouts and with a channel count that is not a multiple of eight, and
+ * compare every channel with its own single-channel instance: f32 within
+ * rounding, q15 bit for bit.
+ ******************************************************************************/
+#define MC_CHANNELS 16
+#define MC_CHECK_CHANNELS 11
+#define MC_BLOCK 256
+#define MC_STAGES 4
+#define MC_TAPS 32
+#define MC_SNR_THRESHOLD 100.0f
+
+static float32_t mcBiquadCoeffs[5 * MC_STAGES];
+static float32_t mcFirCoeffs[MC_TAPS];
+static q15_t mcFirCoeffsQ15[MC_TAPS];
+
+static float32_t mcIn[MC_CHANNELS * MC_BLOCK];
+static float32_t mcOut[MC_CHANNELS * MC_BLOCK];
+static q15_t mcInQ15[MC_CHANNELS * MC_BLOCK];
+static q15_t mcOutQ15[MC_CHANNELS * MC_BLOCK];
+
+static float32_t mcBiquadState[MC_CHANNELS * 2 * MC_STAGES];
+static float32_t mcFirState[MC_CHANNELS * (MC_TAPS + MC_BLOCK - 1)];
+static q15_t mcFirStateQ15[MC_CHANNELS * (MC_TAPS + MC_BLOCK - 1)];
+
+static arm_biquad_cascade_df2T_multi_instance_f32 mcBiquad;
+static arm_biquad_cascade_df2T_multi_instance_f32 mcBiquadPlanar;
+static arm_fir_multi_instance_f32 mcFir;
+static arm_fir_multi_instance_f32 mcFirPlanar;
+static arm_fir_multi_instance_q15 mcFirQ15;
+
+static arm_biquad_cascade_df2T_instance_f32 mcBiquadSingle[MC_CHANNELS];
+static float32_t mcBiquadSingleState[MC_CHANNELS][2 * MC_STAGES];
+static arm_fir_instance_f32 mcFirSingle[MC_CHANNELS];
+static float32_t mcFirSingleState[MC_CHANNELS][MC_TAPS + MC_BLOCK - 1];
+static arm_fir_instance_q15 mcFirSingleQ15[MC_CHANNELS];
+static q15_t mcFirSingleStateQ15[MC_CHANNELS][MC_TAPS + MC_BLOCK];
+
+static void mc_design(void)
+{
+    // Four low-pass sections at staggered cut-offs, in CMSIS form with the
+    // feedback coefficients negated
+    for (int s = 0; s < MC_STAGES; s++) {
+        double w0 = 2.0 * M_PI * (0.05 + 0.05 * s);
+        double alpha = sin(w0) / (2.0 * 0.707);
+        double a0 = 1.0 + alpha;
+        double b1 = (1.0 - cos(w0)) / a0;
+        mcBiquadCoeffs[5 * s + 0] = (float32_t)(b1 / 2.0);
+        mcBiquadCoeffs[5 * s + 1] = (float32_t)b1;
+        mcBiquadCoeffs[5 * s + 2] = (float32_t)(b1 / 2.0);
+        mcBiquadCoeffs[5 * s + 3] = (float32_t)(2.0 * cos(w0) / a0);
+        mcBiquadCoeffs[5 * s + 4] = (float32_t)(-(1.0 - alpha) / a0);
+    }
+    bench_fill(mcFirCoeffs, MC_TAPS, 101, -0.1f, 0.1f);
+    arm_float_to_q15(mcFirCoeffs, mcFirCoeffsQ15, MC_TAPS);
+}
+
+static void mc_setup(void)
+{
+    mc_design();
+    bench_fill(mcIn, MC_CHANNELS * MC_BLOCK, 102, -1.0f, 1.0f);
+    arm_float_to_q15(mcIn, mcInQ15, MC_CHANNELS * MC_BLOCK);
+
+    arm_biquad_cascade_df2T_multi_init_f32(&mcBiquad, MC_STAGES, MC_CHANNELS, ARM_MULTICHANNEL_INTERLEAVED,
+                                           mcBiquadCoeffs, mcBiquadState);
+    arm_biquad_cascade_df2T_multi_init_f32(&mcBiquadPlanar, MC_STAGES, MC_CHANNELS, ARM_MULTICHANNEL_PLANAR,
+                                           mcBiquadCoeffs, mcBiquadState);
+    arm_fir_multi_init_f32(&mcFir, MC_TAPS, MC_CHANNELS, ARM_MULTICHANNEL_INTERLEAVED,
+                           mcFirCoeffs, mcFirState, MC_BLOCK);
+    arm_fir_multi_init_f32(&mcFirPlanar, MC_TAPS, MC_CHANNELS, ARM_MULTICHANNEL_PLANAR,
+                           mcFirCoeffs, mcFirState, MC_BLOCK);
+    arm_fir_multi_init_q15(&mcFirQ15, MC_TAPS, MC_CHANNELS, ARM_MULTICHANNEL_PLANAR,
+                           mcFirCoeffsQ15, mcFirStateQ15, MC_BLOCK);
+
+    for (int ch = 0; ch < MC_CHANNELS; ch++) {
+        arm_biquad_cascade_df2T_init_f32(&mcBiquadSingle[ch], MC_STAGES, mcBiquadCoeffs,
+                                         mcBiquadSingleState[ch]);
+        arm_fir_init_f32(&mcFirSingle[ch], MC_TAPS, mcFirCoeffs, mcFirSingleState[ch], MC_BLOCK);
+        arm_fir_init_q15(&mcFirSingleQ15[ch], MC_TAPS, mcFirCoeffsQ15, mcFirSingleStateQ15[ch], MC_BLOCK);
+    }
+}
+
+static void mc_biquad_run(void)
+{
+    arm_biquad_cascade_df2T_multi_f32(&mcBiquad, mcIn, mcOut, MC_BLOCK);
+}
+
+static void mc_biquad_planar_run(void)
+{
+    arm_biquad_cascade_df2T_multi_f32(&mcBiquadPlanar, mcIn, mcOut, MC_BLOCK);
+}
+
+static void mc_biquad_single_run(void)
+{
+    for (int ch = 0; ch < MC_CHANNELS; ch++) {
+        arm_biquad_cascade_df2T_f32(&mcBiquadSingle[ch], mcIn + ch * MC_BLOCK, mcOut + ch * MC_BLOCK, MC_BLOCK);
+    }
+}
+
+static void mc_fir_run(void)
+{
+    arm_fir_multi_f32(&mcFir, mcIn, mcOut, MC_BLOCK);
+}
+
+static void mc_fir_planar_run(void)
+{
+    arm_fir_multi_f32(&mcFirPlanar, mcIn, mcOut, MC_BLOCK);
+}
+
+static void mc_fir_single_run(void)
+{
+    for (int ch = 0; ch < MC_CHANNELS; ch++) {
+        arm_fir_f32(&mcFirSingle[ch], mcIn + ch * MC_BLOCK, mcOut + ch * MC_BLOCK, MC_BLOCK);
+    }
+}
+
+static void mc_fir_q15_run(void)
+{
+    arm_fir_multi_q15(&mcFirQ15, mcInQ15, mcOutQ15, MC_BLOCK);
+}
+
+static void mc_fir_q15_single_run(void)
+{
+    for (int ch = 0; ch < MC_CHANNELS; ch++) {
+        arm_fir_q15(&mcFirSingleQ15[ch], mcInQ15 + ch * MC_BLOCK, mcOutQ15 + ch * MC_BLOCK, MC_BLOCK);
+    }
+}
+
+/**
+ * @brief Sample n of channel ch in a buffer of MC_CHECK_CHANNELS channels
+ */
+static size_t mc_index(arm_multichannel_layout layout, int ch, int n)
+{
+    return layout == ARM_MULTICHANNEL_INTERLEAVED ? (size_t)n * MC_CHECK_CHANNELS + ch
+                                                  : (size_t)ch * MC_BLOCK + n;
+}
+
+static bool mc_check_layout(arm_multichannel_layout layout)
+{
+    static float32_t in[MC_CHECK_CHANNELS * MC_BLOCK];
+    static float32_t out[3][MC_CHECK_CHANNELS * MC_BLOCK];
+    static float32_t ref[3][MC_CHECK_CHANNELS * MC_BLOCK];
+    static q15_t inQ15[MC_CHECK_CHANNELS * MC_BLOCK];
+    static q15_t outQ15[MC_CHECK_CHANNELS * MC_BLOCK];
+    static q15_t refQ15[MC_CHECK_CHANNELS * MC_BLOCK];
+
+    arm_biquad_cascade_df2T_multi_instance_f32 biquad;
+    arm_fir_multi_instance_f32 fir;
+    arm_fir_multi_instance_q15 firQ15;
+    arm_biquad_cascade_df2T_multi_init_f32(&biquad, MC_STAGES, MC_CHECK_CHANNELS, layout,
+                                           mcBiquadCoeffs, mcBiquadState);
+    arm_fir_multi_init_f32(&fir, MC_TAPS, MC_CHECK_CHANNELS, layout, mcFirCoeffs, mcFirState, MC_BLOCK);
+    if (arm_fir_multi_init_q15(&firQ15, MC_TAPS, MC_CHECK_CHANNELS, layout, mcFirCoeffsQ15,
+                               mcFirStateQ15, MC_BLOCK) != ARM_MATH_SUCCESS) {
+        return false;
+    }
+    for (int ch = 0; ch < MC_CHECK_CHANNELS; ch++) {
+        arm_biquad_cascade_df2T_init_f32(&mcBiquadSingle[ch], MC_STAGES, mcBiquadCoeffs,
+                                         mcBiquadSingleState[ch]);
+        arm_fir_init_f32(&mcFirSingle[ch], MC_TAPS, mcFirCoeffs, mcFirSingleState[ch], MC_BLOCK);
+        arm_fir_init_q15(&mcFirSingleQ15[ch], MC_TAPS, mcFirCoeffsQ15, mcFirSingleStateQ15[ch], MC_BLOCK);
+    }
+
+    for (int block = 0; block < 2; block++) {
+        bench_fill(in, MC_CHECK_CHANNELS * MC_BLOCK, 103 + block, -1.0f, 1.0f);
+        arm_float_to_q15(in, inQ15, MC_CHECK_CHANNELS * MC_BLOCK);
+
+        arm_biquad_cascade_df2T_multi_f32(&biquad, in, out[0], MC_BLOCK);
+        arm_fir_multi_f32(&fir, in, out[1], MC_BLOCK);
+        arm_fir_multi_q15(&firQ15, inQ15, outQ15, MC_BLOCK);
+
+        for (int ch = 0; ch < MC_CHECK_CHANNELS; ch++) {
+            float32_t x[MC_BLOCK], y[MC_BLOCK];
+            q15_t xq[MC_BLOCK], yq[MC_BLOCK];
+            for (int n = 0; n < MC_BLOCK; n++) {
+                x[n] = in[mc_index(layout, ch, n)];
+                xq[n] = inQ15[mc_index(layout, ch, n)];
+            }
+
+            arm_biquad_cascade_df2T_f32(&mcBiquadSingle[ch], x, y, MC_BLOCK);
+            for (int n = 0; n < MC_BLOCK; n++) ref[0][mc_index(layout, ch, n)] = y[n];
+            arm_fir_f32(&mcFirSingle[ch], x, y, MC_BLOCK);
+            for (int n = 0; n < MC_BLOCK; n++) ref[1][mc_index(layout, ch, n)] = y[n];
+            arm_fir_q15(&mcFirSingleQ15[ch], xq, yq, MC_BLOCK);
+            for (int n = 0; n < MC_BLOCK; n++) refQ15[mc_index(layout, ch, n)] = yq[n];
+        }
+
+        if (bench_snr(ref[0], out[0], MC_CHECK_CHANNELS * MC_BLOCK) < MC_SNR_THRESHOLD ||
+            bench_snr(ref[1], out[1], MC_CHECK_CHANNELS * MC_BLOCK) < MC_SNR_THRESHOLD ||
+            memcmp(refQ15, outQ15, sizeof(refQ15)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool mc_check(void)
+{
+    bool ok = mc_check_layout(ARM_MULTICHANNEL_INTERLEAVED) && mc_check_layout(ARM_MULTICHANNEL_PLANAR);
+
+    // The check shares state buffers with the timed kernels
+    mc_setup();
+    return ok;
+}
+
+/*******************************************************************************
+ * Streaming statistics
+ *
+ * Mean, variance, standard deviation, min, max and absmax of STATS_LEN
+ * samples, fed to the accumulator in blocks of STATS_BLOCK, against one
+ * StatisticsFunctions call for each. The samples sit on an offset, as
+ * latencies or sensor readings do, which is where one-pass sums of squares
+ * lose precision. The check also feeds the samples one at a time, merges
+ * separately accumulated halves, and compares decayed statistics with a
+ * double-precision reference.
+ ******************************************************************************/
+#define STATS_LEN 4096
+#define STATS_BLOCK 256
+#define STATS_DECAY 0.99f
+#define STATS_TOLERANCE 1e-4
+
+static float32_t statsIn[STATS_LEN];
+static float32_t statsMean, statsVar, statsStd, statsMin, statsMax, statsAbsmax;
+
+static void stats_setup(void)
+{
+    bench_fill(statsIn, STATS_LEN, 113, 950.0f, 1050.0f);
+}
+
+static void stats_run(void)
+{
+    arm_stream_stats_instance_f32 stats;
+    arm_stream_stats_init_f32(&stats, 1.0f);
+    for (int i = 0; i < STATS_LEN; i += STATS_BLOCK) {
+        arm_stream_stats_f32(&stats, statsIn + i, STATS_BLOCK);
+    }
+    statsMean = stats.mean;
+    statsMin = stats.min;
+    statsMax = stats.max;
+    arm_stream_stats_var_f32(&stats, &statsVar);
+    arm_stream_stats_std_f32(&stats, &statsStd);
+    arm_stream_stats_absmax_f32(&stats, &statsAbsmax);
+}
+
+static void stats_ref_run(void)
+{
+    uint32_t index;
+    arm_mean_f32(statsIn, STATS_LEN, &statsMean);
+    arm_var_f32(statsIn, STATS_LEN, &statsVar);
+    arm_std_f32(statsIn, STATS_LEN, &statsStd);
+    arm_min_f32(statsIn, STATS_LEN, &statsMin, &index);
+    arm_max_f32(statsIn, STATS_LEN, &statsMax, &index);
+    arm_absmax_f32(statsIn, STATS_LEN, &statsAbsmax, &index);
+}
+
+static bool stats_close(double value, double ref)
+{
+    return fabs(value - ref) <= STATS_TOLERANCE * fabs(ref);
+}
+
+/**
+ * @brief Compare an accumulator over statsIn with double-precision sums
+ *
+ * Sample i is weighted by decay^(STATS_LEN-1-i).
+ */
+static bool stats_check_instance(const arm_stream_stats_instance_f32 *stats, double decay)
+{
+    double w = 0.0, w2 = 0.0, sum = 0.0, sq = 0.0;
+    double lo = statsIn[0], hi = statsIn[0];
+    for (int i = 0; i < STATS_LEN; i++) {
+        double wi = pow(decay, STATS_LEN - 1 - i);
+        w += wi;
+        w2 += wi * wi;
+        sum += wi * statsIn[i];
+        lo = fmin(lo, statsIn[i]);
+        hi = fmax(hi, statsIn[i]);
+    }
+    double mean = sum / w;
+    for (int i = 0; i < STATS_LEN; i++) {
+        sq += pow(decay, STATS_LEN - 1 - i) * (statsIn[i] - mean) * (statsIn[i] - mean);
+    }
+    double var = sq / (w - w2 / w);
+
+    float32_t v, sd, am;
+    arm_stream_stats_var_f32(stats, &v);
+    arm_stream_stats_std_f32(stats, &sd);
+    arm_stream_stats_absmax_f32(stats, &am);
+    return stats->count == STATS_LEN && stats_close(stats->mean, mean) &&
+           stats_close(v, var) && stats_close(sd, sqrt(var)) &&
+           stats->min == lo && stats->max == hi && am == fmax(fabs(lo), fabs(hi));
+}
+
+static bool stats_check(void)
+{
+    arm_stream_stats_instance_f32 stats, half;
+
+    arm_stream_stats_init_f32(&stats, 1.0f);
+    for (int i = 0; i < STATS_LEN; i += STATS_BLOCK) {
+        arm_stream_stats_f32(&stats, statsIn + i, STATS_BLOCK);
+    }
+    if (!stats_check_instance(&stats, 1.0)) return false;
+
+    arm_stream_stats_init_f32(&stats, 1.0f);
+    for (int i = 0; i < STATS_LEN; i++) arm_stream_stats_sample_f32(&stats, statsIn[i]);
+    if (!stats_check_instance(&stats, 1.0)) return false;
+
+    arm_stream_stats_init_f32(&stats, 1.0f);
+    arm_stream_stats_init_f32(&half, 1.0f);
+    arm_stream_stats_f32(&stats, statsIn, STATS_LEN / 2 - 7);
+    arm_stream_stats_f32(&half, statsIn + STATS_LEN / 2 - 7, STATS_LEN / 2 + 7);
+    arm_stream_stats_merge_f32(&stats, &half);
+    if (!stats_check_instance(&stats, 1.0)) return false;
+
+    arm_stream_stats_init_f32(&stats, STATS_DECAY);
+    arm_stream_stats_f32(&stats, statsIn, 1000);
+    for (int i = 1000; i < 1100; i++) arm_stream_stats_sample_f32(&stats, statsIn[i]);
+    arm_stream_stats_f32(&stats, statsIn + 1100, STATS_LEN - 1100);
+    return stats_check_instance(&stats, STATS_DECAY);
+}
+
+/*******************************************************************************
+ * k-NN search
+ *
+ * The nearest KNN_K of KNN_REFS templates to a query close to one of them,
+ * against one DistanceFunctions call per template. The check compares
+ * every metric with a double-precision search, including a row count and
+ * length that leave tails, and the q15 search with an exact one.
+ ******************************************************************************/
+#define KNN_REFS 512
+#define KNN_DIM 128
+#define KNN_K 5
+#define KNN_TOLERANCE 1e-4
+
+static float32_t knnRefs[KNN_REFS * KNN_DIM];
+static float32_t knnQuery[KNN_DIM];
+static float32_t knnInvNorms[KNN_REFS];
+static q15_t knnRefsQ15[KNN_REFS * KNN_DIM];
+static q15_t knnQueryQ15[KNN_DIM];
+static q63_t knnNormsQ15[KNN_REFS];
+static arm_knn_instance_f32 knnEuclidean, knnCityblock, knnCosine;
+static arm_knn_instance_q15 knnQ15;
+static uint32_t knnIndex[KNN_K];
+static float32_t knnDist[KNN_K];
+static q63_t knnDistQ15[KNN_K];
+
+static void knn_setup(void)
+{
+    bench_fill(knnRefs, KNN_REFS * KNN_DIM, 127, -1.0f, 1.0f);
+    bench_fill(knnQuery, KNN_DIM, 131, -0.05f, 0.05f);
+    for (int d = 0; d < KNN_DIM; d++) knnQuery[d] += knnRefs[301 * KNN_DIM + d];
+    arm_float_to_q15(knnRefs, knnRefsQ15, KNN_REFS * KNN_DIM);
+    arm_float_to_q15(knnQuery, knnQueryQ15, KNN_DIM);
+
+    arm_knn_init_f32(&knnEuclidean, KNN_REFS, KNN_DIM, ARM_KNN_EUCLIDEAN, knnRefs, NULL);
+    arm_knn_init_f32(&knnCityblock, KNN_REFS, KNN_DIM, ARM_KNN_CITYBLOCK, knnRefs, NULL);
+    arm_knn_init_f32(&knnCosine, KNN_REFS, KNN_DIM, ARM_KNN_COSINE, knnRefs, knnInvNorms);
+    arm_knn_init_q15(&knnQ15, KNN_REFS, KNN_DIM, knnRefsQ15, knnNormsQ15);
+}
+
+static void knn_euclidean_run(void)
+{
+    arm_knn_f32(&knnEuclidean, knnQuery, KNN_K, knnIndex, knnDist);
+}
+
+static void knn_cityblock_run(void)
+{
+    arm_knn_f32(&knnCityblock, knnQuery, KNN_K, knnIndex, knnDist);
+}
+
+static void knn_cosine_run(void)
+{
+    arm_knn_f32(&knnCosine, knnQuery, KNN_K, knnIndex, knnDist);
+}
+
+static void knn_q15_run(void)
+{
+    arm_knn_q15(&knnQ15, knnQueryQ15, KNN_K, knnIndex, knnDistQ15);
+}
+
+/**
+ * @brief Keep the KNN_K smallest of dist[0..n) in order, earlier index first
+ */
+static void knn_select(const double *dist, int n, int k, int *index)
+{
+    for (int i = 0; i < k; i++) index[i] = -1;
+    for (int m = 0; m < n; m++) {
+        int i = k;
+        while (i > 0 && (index[i - 1] < 0 || dist[m] < dist[index[i - 1]])) i--;
+        if (i == k) continue;
+        for (int j = k - 1; j > i; j--) index[j] = index[j - 1];
+        index[i] = m;
+    }
+}
+
+/**
+ * @brief The usual way: one DistanceFunctions call per template
+ */
+static void knn_pairwise_run(float32_t (*distance)(const float32_t *, const float32_t *, uint32_t))
+{
+    uint32_t held = 0;
+    for (uint32_t m = 0; m < KNN_REFS; m++) {
+        float32_t dist = distance(knnQuery, knnRefs + m * KNN_DIM, KNN_DIM);
+        uint32_t i = held < KNN_K ? held++ : KNN_K;
+        if (i == KNN_K && !(dist < knnDist[KNN_K - 1])) continue;
+        if (i == KNN_K) i--;
+        while (i > 0 && dist < knnDist[i - 1]) {
+            knnDist[i] = knnDist[i - 1];
+            knnIndex[i] = knnIndex[i - 1];
+            i--;
+        }
+        knnDist[i] = dist;
+        knnIndex[i] = m;
+    }
+}
+
+static void knn_euclidean_pairwise_run(void)
+{
+    knn_pairwise_run(arm_euclidean_distance_f32);
+}
+
+static void knn_cosine_pairwise_run(void)
+{
+    knn_pairwise_run(arm_cosine_distance_f32);
+}
+
+static bool knn_check_f32(arm_knn_metric metric, uint32_t numRefs, uint32_t dim, const float32_t *query)
+{
+    static double dist[KNN_REFS];
+    arm_knn_instance_f32 knn;
+    uint32_t index[KNN_K];
+    float32_t out[KNN_K];
+    int ref[KNN_K];
+
+    arm_knn_init_f32(&knn, numRefs, dim, metric, knnRefs, knnInvNorms);
+    if (arm_knn_f32(&knn, query, KNN_K, index, out) != KNN_K) return false;
+
+    for (uint32_t m = 0; m < numRefs; m++) {
+        const float32_t *r = knnRefs + m * dim;
+        double acc = 0.0, rr = 0.0, qq = 0.0;
+        for (uint32_t d = 0; d < dim; d++) {
+            double x = (double)r[d] - query[d];
+            acc += metric == ARM_KNN_EUCLIDEAN ? x * x : metric == ARM_KNN_CITYBLOCK ? fabs(x)
+                                                                                     : (double)r[d] * query[d];
+            rr += (double)r[d] * r[d];
+            qq += (double)query[d] * query[d];
+        }
+        dist[m] = metric == ARM_KNN_EUCLIDEAN ? sqrt(acc)
+                : metric == ARM_KNN_CITYBLOCK ? acc : 1.0 - acc / (sqrt(rr) * sqrt(qq));
+    }
+    knn_select(dist, numRefs, KNN_K, ref);
+
+    for (int i = 0; i < KNN_K; i++) {
+        if ((int)index[i] != ref[i] || fabs(out[i] - dist[ref[i]]) > KNN_TOLERANCE * fmax(1.0, dist[ref[i]])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool knn_check_q15(uint32_t numRefs, uint32_t dim, const q15_t *query)
+{
+    static double dist[KNN_REFS];
+    arm_knn_instance_q15 knn;
+    uint32_t index[KNN_K];
+    q63_t out[KNN_K];
+    int ref[KNN_K];
+
+    arm_knn_init_q15(&knn, numRefs, dim, knnRefsQ15, knnNormsQ15);
+    if (arm_knn_q15(&knn, query, KNN_K, index, out) != KNN_K) return false;
+
+    for (uint32_t m = 0; m < numRefs; m++) {
+        int64_t acc = 0;
+        for (uint32_t d = 0; d < dim; d++) {
+            int32_t x = (int32_t)knnRefsQ15[m * dim + d] - query[d];
+            acc += (int64_t)x * x;
+        }
+        dist[m] = (double)acc;
+    }
+    knn_select(dist, numRefs, KNN_K, ref);
+
+    for (int i = 0; i < KNN_K; i++) {
+        if ((int)index[i] != ref[i] || (double)out[i] != dist[ref[i]]) return false;
+    }
+    return true;
+}
+
+static bool knn_check(void)
+{
+    static const arm_knn_metric metrics[] = { ARM_KNN_EUCLIDEAN, ARM_KNN_CITYBLOCK, ARM_KNN_COSINE };
+    float32_t far[KNN_DIM];
+    q15_t farQ15[KNN_DIM];
+    bench_fill(far, KNN_DIM, 137, -1.0f, 1.0f);
+    arm_float_to_q15(far, farQ15, KNN_DIM);
+
+    for (int i = 0; i < 3; i++) {
+        if (!knn_check_f32(metrics[i], KNN_REFS, KNN_DIM, knnQuery) ||
+            !knn_check_f32(metrics[i], KNN_REFS - 3, KNN_DIM - 5, far)) {
+            return false;
+        }
+    }
+    if (!knn_check_q15(KNN_REFS, KNN_DIM, knnQueryQ15) ||
+        !knn_check_q15(KNN_REFS - 3, KNN_DIM - 5, farQ15)) {
+        return false;
+    }
+
+    // Fewer references than k
+    arm_knn_instance_f32 few;
+    uint32_t index[KNN_K];
+    float32_t out[KNN_K];
+    arm_knn_init_f32(&few, 3, KNN_DIM, ARM_KNN_EUCLIDEAN, knnRefs, NULL);
+    bool ok = arm_knn_f32(&few, knnQuery, KNN_K, index, out) == 3;
+
+    // The checks share the norm buffers with the timed kernels
+    knn_setup();
+    return ok;
+}
+
+/*******************************************************************************
+ * Batch classifiers
+ *
+ * CLS_VECTORS feature vectors, as from a recorded dataset, classified by a
+ * linear SVM, an RBF SVM and naive Bayes in one batch call each, against
+ * one predict call per vector. The check runs a count and length that
+ * leave tails and compares every decision with the per-vector function,
+ * skipping inputs whose decision is within rounding (CLS_MARGIN) in double
+ * precision.
+ ******************************************************************************/
+#define CLS_VECTORS 1024
+#define CLS_DIM 16
+#define CLS_SV 64
+#define CLS_CLASSES 8
+#define CLS_GAMMA 0.1f
+#define CLS_MARGIN 1e-4
+
+static float32_t clsIn[(CLS_VECTORS + 5) * CLS_DIM];
+static float32_t clsSupport[CLS_SV * CLS_DIM];
+static float32_t clsDual[CLS_SV];
+static float32_t clsTheta[CLS_CLASSES * CLS_DIM];
+static float32_t clsSigma[CLS_CLASSES * CLS_DIM];
+static float32_t clsPriors[CLS_CLASSES];
+static float32_t clsBuffer[CLS_CLASSES * (CLS_DIM + 1)];
+static const int32_t clsSvmClasses[2] = { 0, 1 };
+static arm_svm_linear_instance_f32 clsLinear;
+static arm_svm_rbf_instance_f32 clsRbf;
+static arm_gaussian_naive_bayes_instance_f32 clsBayes;
+static int32_t clsSvmOut[CLS_VECTORS + 5];
+static uint32_t clsBayesOut[CLS_VECTORS + 5];
+
+static void cls_init(uint32_t dim)
+{
+    arm_svm_linear_init_f32(&clsLinear, CLS_SV, dim, 0.1f, clsDual, clsSupport, clsSvmClasses);
+    arm_svm_rbf_init_f32(&clsRbf, CLS_SV, dim, 0.1f, clsDual, clsSupport, clsSvmClasses, CLS_GAMMA);
+    clsBayes.vectorDimension = dim;
+    clsBayes.numberOfClasses = CLS_CLASSES;
+    clsBayes.theta = clsTheta;
+    clsBayes.sigma = clsSigma;
+    clsBayes.classPriors = clsPriors;
+    clsBayes.epsilon = 1e-9f;
+}
+
+static void cls_setup(void)
+{
+    bench_fill(clsIn, (CLS_VECTORS + 5) * CLS_DIM, 139, -1.5f, 1.5f);
+    bench_fill(clsSupport, CLS_SV * CLS_DIM, 149, -1.0f, 1.0f);
+    bench_fill(clsDual, CLS_SV, 151, -1.0f, 1.0f);
+    bench_fill(clsTheta, CLS_CLASSES * CLS_DIM, 157, -1.0f, 1.0f);
+    bench_fill(clsSigma, CLS_CLASSES * CLS_DIM, 163, 0.2f, 1.0f);
+    bench_fill(clsPriors, CLS_CLASSES, 167, 0.5f, 1.5f);
+    cls_init(CLS_DIM);
+}
+
+static void cls_linear_run(void)
+{
+    arm_svm_linear_predict_batch_f32(&clsLinear, clsIn, CLS_VECTORS, clsSvmOut, clsBuffer);
+}
+
+static void cls_linear_single_run(void)
+{
+    for (int n = 0; n < CLS_VECTORS; n++) arm_svm_linear_predict_f32(&clsLinear, clsIn + n * CLS_DIM, &clsSvmOut[n]);
+}
+
+static void cls_rbf_run(void)
+{
+    arm_svm_rbf_predict_batch_f32(&clsRbf, clsIn, CLS_VECTORS, clsSvmOut);
+}
+
+static void cls_rbf_single_run(void)
+{
+    for (int n = 0; n < CLS_VECTORS; n++) arm_svm_rbf_predict_f32(&clsRbf, clsIn + n * CLS_DIM, &clsSvmOut[n]);
+}
+
+static void cls_bayes_run(void)
+{
+    arm_gaussian_naive_bayes_predict_batch_f32(&clsBayes, clsIn, CLS_VECTORS, clsBayesOut, clsBuffer);
+}
+
+static void cls_bayes_single_run(void)
+{
+    float32_t prob[CLS_CLASSES], temp[CLS_CLASSES];
+    for (int n = 0; n < CLS_VECTORS; n++) {
+        clsBayesOut[n] = arm_gaussian_naive_bayes_predict_f32(&clsBayes, clsIn + n * CLS_DIM, prob, temp);
+    }
+}
+
+/**
+ * @brief Double-precision SVM decision value of input n
+ */
+static double cls_svm_decision(bool rbf, uint32_t dim, int n)
+{
+    const float32_t *x = clsIn + n * dim;
+    double sum = 0.1;
+    for (int i = 0; i < CLS_SV; i++) {
+        double acc = 0.0;
+        for (uint32_t d = 0; d < dim; d++) {
+            double sv = clsSupport[i * dim + d];
+            acc += rbf ? (x[d] - sv) * (x[d] - sv) : x[d] * sv;
+        }
+        sum += clsDual[i] * (rbf ? exp(-(double)CLS_GAMMA * acc) : acc);
+    }
+    return sum;
+}
+
+/**
+ * @brief Double-precision gap between the two best naive Bayes classes
+ */
+static double cls_bayes_margin(uint32_t dim, int n)
+{
+    const float32_t *x = clsIn + n * dim;
+    double first = -INFINITY, second = -INFINITY;
+    for (int c = 0; c < CLS_CLASSES; c++) {
+        double score = log(clsPriors[c]);
+        for (uint32_t d = 0; d < dim; d++) {
+            double sigma = (double)clsSigma[c * dim + d] + 1e-9;
+            double diff = x[d] - clsTheta[c * dim + d];
+            score -= 0.5 * (log(2.0 * M_PI * sigma) + diff * diff / sigma);
+        }
+        if (score > first) {
+            second = first;
+            first = score;
+        } else if (score > second) {
+            second = score;
+        }
+    }
+    return first - second;
+}
+
+static bool cls_check(void)
+{
+    static const uint32_t dims[2] = { CLS_DIM, CLS_DIM - 3 };
+    static int32_t svmRef[CLS_VECTORS + 5];
+    static uint32_t bayesRef[CLS_VECTORS + 5];
+    const int count = CLS_VECTORS + 5;
+    bool ok = true;
+
+    for (int i = 0; i < 2 && ok; i++) {
+        uint32_t dim = dims[i];
+        float32_t prob[CLS_CLASSES], temp[CLS_CLASSES];
+        cls_init(dim);
+
+        for (int rbf = 0; rbf < 2 && ok; rbf++) {
+            if (rbf) {
+                arm_svm_rbf_predict_batch_f32(&clsRbf, clsIn, count, clsSvmOut);
+            } else {
+                arm_svm_linear_predict_batch_f32(&clsLinear, clsIn, count, clsSvmOut, clsBuffer);
+            }
+            for (int n = 0; n < count; n++) {
+                if (rbf) {
+                    arm_svm_rbf_predict_f32(&clsRbf, clsIn + n * dim, &svmRef[n]);
+                } else {
+                    arm_svm_linear_predict_f32(&clsLinear, clsIn + n * dim, &svmRef[n]);
+                }
+                if (clsSvmOut[n] != svmRef[n] && fabs(cls_svm_decision(rbf, dim, n)) > CLS_MARGIN) ok = false;
+            }
+        }
+
+        arm_gaussian_naive_bayes_predict_batch_f32(&clsBayes, clsIn, count, clsBayesOut, clsBuffer);
+        for (int n = 0; n < count; n++) {
+            bayesRef[n] = arm_gaussian_naive_bayes_predict_f32(&clsBayes, clsIn + n * dim, prob, temp);
+            if (clsBayesOut[n] != bayesRef[n] && cls_bayes_margin(dim, n) > CLS_MARGIN) ok = false;
+        }
+    }
+
+    cls_init(CLS_DIM);
+    return ok;
+}
+
+/*******************************************************************************
+ * FFT tables at run time
+ *
+ * Building the 4096-point complex and real FFT tables. The check builds
+ * every length and compares with the library's tables: twiddles to within
+ * a couple of ulp, and bit reversal by the transform it gives, which must
+ * match the library's bit for bit.
+ ******************************************************************************/
+#define FFT_TABLE_TOLERANCE 2.5e-7f
+
+static float32_t fftTableTwiddle[2 * CFFT_LEN];
+static float32_t fftTableRfft[CFFT_LEN];
+static uint16_t fftTableBitRev[2 * CFFT_LEN];
+
+static void fft_tables_run(void)
+{
+    arm_cfft_twiddle_init_f32(fftTableTwiddle, CFFT_LEN);
+    arm_cfft_bitrev_init_f32(fftTableBitRev, CFFT_LEN);
+    arm_rfft_fast_twiddle_init_f32(fftTableRfft, CFFT_LEN);
+}
+
+static bool fft_tables_close(const float32_t *a, const float32_t *b, int n)
+{
+    for (int i = 0; i < n; i++) {
+        if (fabsf(a[i] - b[i]) > FFT_TABLE_TOLERANCE) return false;
+    }
+    return true;
+}
+
+static bool fft_tables_check(void)
+{
+    for (uint16_t len = 16; len <= CFFT_LEN; len *= 2) {
+        arm_cfft_instance_f32 lib, built;
+        if (arm_cfft_init_f32(&lib, len) != ARM_MATH_SUCCESS) return false;
+
+        arm_cfft_twiddle_init_f32(fftTableTwiddle, len);
+        if (!fft_tables_close(fftTableTwiddle, lib.pTwiddle, 2 * len)) return false;
+
+        /* The library's twiddles with the built bit reversal: identical output */
+        built = lib;
+        built.pBitRevTable = fftTableBitRev;
+        built.bitRevLength = arm_cfft_bitrev_init_f32(fftTableBitRev, len);
+        if (built.bitRevLength != lib.bitRevLength) return false;
+        memcpy(cfftBuf, cfftIn, 2 * len * sizeof(float32_t));
+        memcpy(cfftRef, cfftIn, 2 * len * sizeof(float32_t));
+        arm_cfft_f32_ref(&built, cfftBuf, 0, 1);
+        arm_cfft_f32_ref(&lib, cfftRef, 0, 1);
+        if (memcmp(cfftBuf, cfftRef, 2 * len * sizeof(float32_t)) != 0) return false;
+
+        /* Everything built */
+        built.pTwiddle = fftTableTwiddle;
+        memcpy(cfftBuf, cfftIn, 2 * len * sizeof(float32_t));
+        arm_cfft_f32_ref(&built, cfftBuf, 0, 1);
+        if (bench_snr(cfftRef, cfftBuf, 2 * len) < CFFT_SNR_THRESHOLD) return false;
+
+        if (len >= 32) {
+            arm_rfft_fast_instance_f32 rfft;
+            if (arm_rfft_fast_init_f32(&rfft, len) != ARM_MATH_SUCCESS) return false;
+            arm_rfft_fast_twiddle_init_f32(fftTableRfft, len);
+            if (!fft_tables_close(fftTableRfft, rfft.pTwiddleRFFT, len)) return false;
+        }
+    }
+    return true;
+}
+
+/*******************************************************************************
+ * Kernel table
+ ******************************************************************************/
+const char bench_suite[] = "cmsis-dsp";
+
+void bench_describe(FILE *out)
+{
+    fprintf(out, "  \"cfft\": \"%s\",\n  \"mat_mult\": \"%s\",\n  \"threads\": %u,\n",
+            dsp_cfft_impl(), dsp_mat_impl(), dsp_mat_threads());
+}
+
+const bench_kernel_t bench_kernels[] = {
+    { "arm_gaussian_naive_bayes_predict_f32", "arm_bayes_example", BAYES_VECTORS, bayes_setup, bayes_run, bayes_check },
+    { "arm_mat_mult_f32+stats", "arm_class_marks_example", MARKS_STUDENTS * MARKS_SUBJECTS, marks_setup, marks_run, marks_check },
+    { "arm_cfft_f32 convolution", "arm_convolution_example", 2 * CONV_LEN - 1, conv_setup, conv_run, conv_check },
+    { "arm_dot_prod_f32", "arm_dotproduct_example", DOT_LEN, dot_setup, dot_run, dot_check },
+    { "arm_cfft_f32+cmplx_mag+max", "arm_fft_bin_example", FFT_BIN_SIZE, fft_bin_setup, fft_bin_run, fft_bin_check },
+    { "arm_fir_f32", "arm_fir_example", FIR_SAMPLES, NULL, fir_run, fir_check },
+    { "arm_biquad_cascade_df1_q31 eq", "arm_graphic_equalizer_example", GEQ_SAMPLES, geq_setup, geq_run, geq_check },
+    { "arm_linear_interp_f32", "arm_linear_interp_example", INTERP_SAMPLES, interp_setup, interp_run, interp_check },
+    { "arm_mat_inverse_f32 least squares", "arm_matrix_example", 4, NULL, matrix_run, matrix_check },
+    { "arm_lms_norm_f32+fir", "arm_signal_converge_example", CONVERGE_SAMPLES, NULL, converge_run, converge_check },
+    { "arm_sin_f32+arm_cos_f32", "arm_sin_cos_example", SINCOS_SAMPLES, sincos_setup, sincos_run, sincos_check },
+    { "arm_svm_polynomial_predict_f32", "arm_svm_example", 2, svm_setup, svm_run, svm_check },
+    { "arm_var_f32", "arm_variance_example", VAR_LEN, var_setup, var_run, var_check },
+    { "arm_cfft_f32 4096", "x86 backend", CFFT_LEN, cfft_setup, cfft_run, cfft_check },
+    { "arm_cfft_f32_ref 4096", "x86 backend", CFFT_LEN, cfft_setup, cfft_ref_run, NULL },
+    { "arm_mat_mult_f32 512", "x86 backend", MAT_DIM * MAT_DIM, mat_setup, mat_run, mat_check },
+    { "arm_mat_mult_f32_ref 512", "x86 backend", MAT_DIM * MAT_DIM, mat_setup, mat_ref_run, NULL },
+    { "arm_mat_vec_mult_f32 2048", "x86 backend", MATVEC_DIM, mat_setup, matvec_run, matvec_check },
+    { "arm_mat_vec_mult_f32_ref 2048", "x86 backend", MATVEC_DIM, mat_setup, matvec_ref_run, NULL },
+    { "arm_biquad_cascade_df2T_multi_f32 interleaved", "multichannel", MC_CHANNELS * MC_BLOCK, mc_setup, mc_biquad_run, mc_check },
+    { "arm_biquad_cascade_df2T_multi_f32 planar", "multichannel", MC_CHANNELS * MC_BLOCK, mc_setup, mc_biquad_planar_run, NULL },
+    { "arm_biquad_cascade_df2T_f32 per channel", "multichannel", MC_CHANNELS * MC_BLOCK, mc_setup, mc_biquad_single_run, NULL },
+    { "arm_fir_multi_f32 interleaved", "multichannel", MC_CHANNELS * MC_BLOCK, mc_setup, mc_fir_run, NULL },
+    { "arm_fir_multi_f32 planar", "multichannel", MC_CHANNELS * MC_BLOCK, mc_setup, mc_fir_planar_run, NULL },
+    { "arm_fir_f32 per channel", "multichannel", MC_CHANNELS * MC_BLOCK, mc_setup, mc_fir_single_run, NULL },
+    { "arm_fir_multi_q15", "multichannel", MC_CHANNELS * MC_BLOCK, mc_setup, mc_fir_q15_run, NULL },
+    { "arm_fir_q15 per channel", "multichannel", MC_CHANNELS * MC_BLOCK, mc_setup, mc_fir_q15_single_run, NULL },
+    { "arm_stream_stats_f32", "streaming statistics", STATS_LEN, stats_setup, stats_run, stats_check },
+    { "arm_mean+var+std+min+max+absmax_f32", "streaming statistics", STATS_LEN, stats_setup, stats_ref_run, NULL },
+    { "arm_knn_f32 euclidean", "k-NN search", KNN_REFS, knn_setup, knn_euclidean_run, knn_check },
+    { "arm_euclidean_distance_f32 per reference", "k-NN search", KNN_REFS, knn_setup, knn_euclidean_pairwise_run, NULL },
+    { "arm_knn_f32 cityblock", "k-NN search", KNN_REFS, knn_setup, knn_cityblock_run, NULL },
+    { "arm_knn_f32 cosine", "k-NN search", KNN_REFS, knn_setup, knn_cosine_run, NULL },
+    { "arm_cosine_distance_f32 per reference", "k-NN search", KNN_REFS, knn_setup, knn_cosine_pairwise_run, NULL },
+    { "arm_knn_q15", "k-NN search", KNN_REFS, knn_setup, knn_q15_run, NULL },
+    { "arm_svm_linear_predict_batch_f32", "batch classifiers", CLS_VECTORS, cls_setup, cls_linear_run, cls_check },
+    { "arm_svm_linear_predict_f32 per vector", "batch classifiers", CLS_VECTORS, cls_setup, cls_linear_single_run, NULL },
+    { "arm_svm_rbf_predict_batch_f32", "batch classifiers", CLS_VECTORS, cls_setup, cls_rbf_run, NULL },
+    { "arm_svm_rbf_predict_f32 per vector", "batch classifiers", CLS_VECTORS, cls_setup, cls_rbf_single_run, NULL },
+    { "arm_gaussian_naive_bayes_predict_batch_f32", "batch classifiers", CLS_VECTORS, cls_setup, cls_bayes_run, NULL },
+    { "arm_gaussian_naive_bayes_predict_f32 per vector", "batch classifiers", CLS_VECTORS, cls_setup, cls_bayes_single_run, NULL },
+    { "arm_cfft+rfft_fast_twiddle+bitrev_init_f32 4096", "FFT tables", CFFT_LEN, cfft_setup, fft_tables_run, fft_tables_check },
+};
+
+const size_t bench_kernel_count = sizeof(bench_kernels) / sizeof(bench_kernels[0]);
@@ -0,0 +1,60 @@
+/**
+ * @file dsp_x86.h
+ * @brief x86 host backend for parts of CMSIS-DSP
+ *
+ * With the x86 backend (scons bench=dsp dsp_backend=x86, the default) the
+ * functions below replace their CMSIS-DSP namesakes at link time, keeping
+ * the same API, and the library's generic C versions stay available under
+ * a _ref suffix for comparison. With dsp_backend=ref the _ref names are
+ * simply the library functions.
+ */
+
+#ifndef DSP_X86_H
+#define DSP_X86_H
+
+#include "arm_math.h"
+
+#ifdef DSP_BACKEND_REF
+
+#define arm_cfft_f32_ref arm_cfft_f32
+#define arm_mat_mult_f32_ref arm_mat_mult_f32
+#define arm_mat_vec_mult_f32_ref arm_mat_vec_mult_f32
+#define dsp_cfft_impl() "ref"
+#define dsp_mat_impl() "ref"
+#define dsp_mat_threads() 1u
+
+#else
+
+/**
+ * @brief CMSIS-DSP's own arm_cfft_f32
+ */
+void arm_cfft_f32_ref(const arm_cfft_instance_f32 *S, float32_t *p1,
+                      uint8_t ifftFlag, uint8_t bitReverseFlag);
+
+/**
+ * @brief Name of the arm_cfft_f32 implementation in use: "avx2" or "ref"
+ */
+const char *dsp_cfft_impl(void);
+
+/**
+ * @brief CMSIS-DSP's own arm_mat_mult_f32 and arm_mat_vec_mult_f32
+ */
+arm_status arm_mat_mult_f32_ref(const arm_matrix_instance_f32 *pSrcA,
+                                const arm_matrix_instance_f32 *pSrcB,
+                                arm_matrix_instance_f32 *pDst);
+void arm_mat_vec_mult_f32_ref(const arm_matrix_instance_f32 *pSrcMat, const float32_t *pVec,
+                              float32_t *pDst);
+
+/**
+ * @brief Name of the matrix multiply implementation in use: "avx2" or "ref"
+ */
+const char *dsp_mat_impl(void);
+
+/**
+ * @brief Threads large matrix products are split across (DSP_THREADS)
+ */
+uint32_t dsp_mat_threads(void);
+
+#endif // DSP_BACKEND_REF
+
+#endif // DSP_X86_H
@@ -0,0 +1,21 @@
+/**
+ * @file nn_host.h
+ * @brief What CMSIS-NN takes from the Cortex-M compiler headers, for a host build
+ *
+ * Under __GNUC_PYTHON__ CMSIS-NN defines its inline macros but none of the
+ * intrinsics and qualifiers its generic C code still uses. CMSIS-DSP has
+ * host definitions of the intrinsics for its own __GNUC_PYTHON__ build, so
+ * they are taken from there. The bench build includes this file ahead of
+ * every CMSIS-NN source.
+ */
+
+#ifndef NN_HOST_H
+#define NN_HOST_H
+
+#include "dsp/none.h"   // __CLZ, __SSAT, __USAT
+
+#ifndef __RESTRICT
+#define __RESTRICT __restrict
+#endif
+
+#endif // NN_HOST_H
@@ -0,0 +1,629 @@
+/**
+ * @file nn_layers.c
+ * @brief CMSIS-NN int8 layers as timed kernels
+ *
+ * First the two kernels the x86 backend replaces, each timed against the
+ * library's own version, then single layers of the shapes a small keyword
+ * spotting or image model has, and last a whole DS-CNN keyword spotting
+ * network on one 49x10 MFCC frame, the way a model experiment on the
+ * simulator runs it. Weights and inputs are deterministic random data, and
+ * sample counts are multiply-accumulates.
+ *
+ * Checks run the kernel with every implementation the CPU has and compare
+ * the output with the library's C code byte for byte: for the kernels and
+ * arm_convolve_s8 also over shapes that leave partial tiles, odd column
+ * counts, padding, strides and dilation. The depthwise convolution is not
+ * replaced, so it has no check; it is timed for the per-layer picture.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arm_nn_arena.h"
+#include "dsp_bench.h"
+#include "nn_x86.h"
+
+/*******************************************************************************
+ * Helpers
+ ******************************************************************************/
+#define SCRATCH_SIZE (64 * 1024)
+
+static q7_t scratch[SCRATCH_SIZE];
+
+/**
+ * @brief Per-channel requantization for a dot product of depth values
+ *
+ * For inputs in [-128, 127] and weights in [-64, 63] the outputs come out
+ * at around +-40, so that few of them clamp.
+ */
+static void quant_fill(int32_t *mult, int32_t *shift, int32_t n, int32_t depth, uint32_t seed)
+{
+    int32_t s = -(int32_t)lrintf(6.0f + 0.5f * log2f((float)depth));
+    uint32_t x = seed;
+
+    for (int32_t i = 0; i < n; i++) {
+        x = x * 1664525u + 1013904223u;
+        mult[i] = (int32_t)(0x40000000u + (x >> 2));
+        shift[i] = s;
+    }
+}
+
+static void bias_fill(int32_t *bias, int32_t n, uint32_t seed)
+{
+    uint32_t x = seed;
+
+    for (int32_t i = 0; i < n; i++) {
+        x = x * 1664525u + 1013904223u;
+        bias[i] = (int32_t)(x >> 16) - 32768;
+    }
+}
+
+/**
+ * @brief Whether run() writes the same n bytes at out with every implementation
+ */
+static bool same_for_every_impl(void (*run)(void), q7_t *out, size_t n)
+{
+    nn_impl_t impl = nn_impl();
+    q7_t *ref = malloc(n);
+    bool ok = nn_use_impl(NN_IMPL_REF);
+
+    run();
+    memcpy(ref, out, n);
+    for (int i = NN_IMPL_REF + 1; i < NN_IMPL_COUNT && ok; i++) {
+        if (!nn_use_impl((nn_impl_t)i)) continue;
+        memset(out, 0, n);
+        run();
+        ok = memcmp(ref, out, n) == 0;
+    }
+
+    nn_use_impl(impl);
+    free(ref);
+    return ok;
+}
+
+/*******************************************************************************
+ * arm_nn_mat_mult_nt_t_s8 / arm_nn_vec_mat_mult_t_s8 backend
+ *
+ * A 256x256x256 product, the size of a 1x1 convolution over a 16x16 map
+ * with 256 channels, and a 1024x1024 matrix-vector product, a large fully
+ * connected layer, with either implementation.
+ ******************************************************************************/
+#define GEMM_DIM 256
+#define GEMV_DIM 1024
+
+static q7_t *gemmLhs;
+static q7_t *gemmRhs;
+static q7_t *gemmDst;
+static q7_t *gemmRef;
+static int32_t gemmBias[GEMV_DIM];
+static int32_t gemmMult[GEMV_DIM];
+static int32_t gemmShift[GEMV_DIM];
+
+static void gemm_setup(void)
+{
+    if (!gemmLhs) {
+        gemmLhs = malloc(GEMM_DIM * GEMM_DIM);
+        gemmRhs = malloc(GEMV_DIM * GEMV_DIM);
+        gemmDst = malloc(GEMM_DIM * GEMM_DIM);
+        gemmRef = malloc(GEMM_DIM * GEMM_DIM);
+    }
+    bench_fill_s8(gemmLhs, GEMM_DIM * GEMM_DIM, 101, -128, 127);
+    bench_fill_s8(gemmRhs, GEMV_DIM * GEMV_DIM, 102, -64, 63);
+    bias_fill(gemmBias, GEMV_DIM, 103);
+    quant_fill(gemmMult, gemmShift, GEMM_DIM, GEMM_DIM, 104);
+}
+
+static void mat_mult_run(void)
+{
+    arm_nn_mat_mult_nt_t_s8(gemmLhs, gemmRhs, gemmBias, gemmDst, gemmMult, gemmShift,
+                            GEMM_DIM, GEMM_DIM, GEMM_DIM, 3, -2, -128, 127);
+}
+
+static void mat_mult_ref_run(void)
+{
+    arm_nn_mat_mult_nt_t_s8_ref(gemmLhs, gemmRhs, gemmBias, gemmDst, gemmMult, gemmShift,
+                                GEMM_DIM, GEMM_DIM, GEMM_DIM, 3, -2, -128, 127);
+}
+
+/* lhs_rows, rhs_rows, rhs_cols */
+static const int32_t gemmShapes[][3] = {
+    { 1, 1, 1 }, { 3, 5, 7 }, { 2, 4, 16 }, { 5, 9, 33 }, { 7, 6, 48 }, { 17, 13, 100 },
+    { 64, 64, 64 }, { 33, 70, 257 }, { 2, 300, 1000 }, { GEMM_DIM, GEMM_DIM, GEMM_DIM },
+};
+static const int32_t gemmOffsets[] = { 3, 128, -127, 0 };
+
+static bool mat_mult_check(void)
+{
+    nn_impl_t impl = nn_impl();
+    bool ok = true;
+
+    for (size_t s = 0; s < sizeof(gemmShapes) / sizeof(gemmShapes[0]) && ok; s++) {
+        int32_t lhsRows = gemmShapes[s][0], rhsRows = gemmShapes[s][1], cols = gemmShapes[s][2];
+        int32_t lhsOffset = gemmOffsets[s % 4];
+        const int32_t *bias = (s % 3 == 2) ? NULL : gemmBias;
+        size_t n = (size_t)lhsRows * rhsRows;
+
+        quant_fill(gemmMult, gemmShift, rhsRows, cols, 105 + s);
+        arm_nn_mat_mult_nt_t_s8_ref(gemmLhs, gemmRhs, bias, gemmRef, gemmMult, gemmShift,
+                                    lhsRows, rhsRows, cols, lhsOffset, -5, -100, 90);
+        for (int i = NN_IMPL_REF; i < NN_IMPL_COUNT && ok; i++) {
+            if (!nn_use_impl((nn_impl_t)i)) continue;
+            memset(gemmDst, 0, n);
+            arm_nn_mat_mult_nt_t_s8(gemmLhs, gemmRhs, bias, gemmDst, gemmMult, gemmShift,
+                                    lhsRows, rhsRows, cols, lhsOffset, -5, -100, 90);
+            ok = memcmp(gemmRef, gemmDst, n) == 0;
+        }
+    }
+
+    nn_use_impl(impl);
+    quant_fill(gemmMult, gemmShift, GEMM_DIM, GEMM_DIM, 104);
+    return ok;
+}
+
+static void vec_mat_run(void)
+{
+    arm_nn_vec_mat_mult_t_s8(gemmLhs, gemmRhs, gemmBias, gemmDst, 3, 0, -2, 0x5A000000, -11,
+                             GEMV_DIM, GEMV_DIM, -128, 127, 1);
+}
+
+static void vec_mat_ref_run(void)
+{
+    arm_nn_vec_mat_mult_t_s8_ref(gemmLhs, gemmRhs, gemmBias, gemmDst, 3, 0, -2, 0x5A000000, -11,
+                                 GEMV_DIM, GEMV_DIM, -128, 127, 1);
+}
+
+static bool vec_mat_check(void)
+{
+    nn_impl_t impl = nn_impl();
+    bool ok = true;
+
+    for (size_t s = 0; s < sizeof(gemmShapes) / sizeof(gemmShapes[0]) && ok; s++) {
+        int32_t rhsRows = gemmShapes[s][1], cols = gemmShapes[s][2];
+        int32_t lhsOffset = gemmOffsets[s % 4];
+        int32_t stride = (s % 2) ? 3 : 1;
+        const int32_t *bias = (s % 3 == 2) ? NULL : gemmBias;
+        int32_t shift = -(int32_t)lrintf(6.0f + 0.5f * log2f((float)cols));
+        size_t n = (size_t)rhsRows * stride;
+
+        memset(gemmRef, 0, n);
+        arm_nn_vec_mat_mult_t_s8_ref(gemmLhs, gemmRhs, bias, gemmRef, lhsOffset, 0, 7, 0x5A000000, shift,
+                                     cols, rhsRows, -128, 127, stride);
+        for (int i = NN_IMPL_REF; i < NN_IMPL_COUNT && ok; i++) {
+            if (!nn_use_impl((nn_impl_t)i)) continue;
+            memset(gemmDst, 0, n);
+            arm_nn_vec_mat_mult_t_s8(gemmLhs, gemmRhs, bias, gemmDst, lhsOffset, 0, 7, 0x5A000000, shift,
+                                     cols, rhsRows, -128, 127, stride);
+            ok = memcmp(gemmRef, gemmDst, n) == 0;
+        }
+    }
+
+    nn_use_impl(impl);
+    return ok;
+}
+
+/*******************************************************************************
+ * Layers
+ *
+ * A 3x3 convolution of a 32x32x16 map to 32 channels, a 1x1 convolution of
+ * a 32x32x32 map to 64 channels, a 3x3 depthwise convolution of a 32x32x64
+ * map and a 1024 to 256 fully connected layer.
+ ******************************************************************************/
+#define MAP_DIM 32
+#define CONV_IN 16
+#define CONV_OUT 32
+#define PW_IN 32
+#define PW_OUT 64
+#define DW_CH 64
+#define FC_IN 1024
+#define FC_OUT 256
+
+#define LAYER_MAX_IN (MAP_DIM * MAP_DIM * DW_CH)
+#define LAYER_MAX_WEIGHTS (FC_IN * FC_OUT)
+#define LAYER_MAX_CH FC_OUT
+
+static q7_t *layerIn;
+static q7_t *layerWeights;
+static q7_t *layerOut;
+static int32_t layerBias[LAYER_MAX_CH];
+static int32_t layerMult[LAYER_MAX_CH];
+static int32_t layerShift[LAYER_MAX_CH];
+
+static void layer_setup(void)
+{
+    if (!layerIn) {
+        layerIn = malloc(LAYER_MAX_IN);
+        layerWeights = malloc(LAYER_MAX_WEIGHTS);
+        layerOut = malloc(LAYER_MAX_IN);
+    }
+    bench_fill_s8(layerIn, LAYER_MAX_IN, 111, -128, 127);
+    bench_fill_s8(layerWeights, LAYER_MAX_WEIGHTS, 112, -64, 63);
+    bias_fill(layerBias, LAYER_MAX_CH, 113);
+}
+
+static void conv_setup(void)
+{
+    layer_setup();
+    quant_fill(layerMult, layerShift, CONV_OUT, 9 * CONV_IN, 114);
+}
+
+static void pointwise_setup(void)
+{
+    layer_setup();
+    quant_fill(layerMult, layerShift, PW_OUT, PW_IN, 115);
+}
+
+static void depthwise_setup(void)
+{
+    layer_setup();
+    quant_fill(layerMult, layerShift, DW_CH, 9, 116);
+}
+
+/**
+ * @brief An arm_convolve_s8 layer with the buffer the library asks for
+ */
+static void convolve(const cmsis_nn_conv_params *params, cmsis_nn_dims in, cmsis_nn_dims filter,
+                     cmsis_nn_dims out, const q7_t *input, q7_t *output, bool ref)
+{
+    cmsis_nn_per_channel_quant_params quant = { layerMult, layerShift };
+    cmsis_nn_dims bias = { 1, 1, 1, out.c };
+    cmsis_nn_context ctx = { scratch, arm_convolve_s8_get_buffer_size(&in, &filter) };
+
+    if (ref)
+        arm_convolve_s8_ref(&ctx, params, &quant, &in, input, &filter, layerWeights, &bias, layerBias, &out, output);
+    else
+        arm_convolve_s8(&ctx, params, &quant, &in, input, &filter, layerWeights, &bias, layerBias, &out, output);
+}
+
+static void conv_run(void)
+{
+    cmsis_nn_conv_params params = { 5, -3, { 1, 1 }, { 1, 1 }, { 1, 1 }, { -128, 127 } };
+    cmsis_nn_dims in = { 1, MAP_DIM, MAP_DIM, CONV_IN };
+    cmsis_nn_dims filter = { CONV_OUT, 3, 3, CONV_IN };
+    cmsis_nn_dims out = { 1, MAP_DIM, MAP_DIM, CONV_OUT };
+
+    convolve(&params, in, filter, out, layerIn, layerOut, false);
+}
+
+static bool conv_check(void)
+{
+    /* n, h, w, c in; out channels; kernel h, w; stride, padding, dilation; input offset */
+    static const int32_t cases[][11] = {
+        { 1, 32, 32, 16, 32, 3, 3, 1, 1, 1, 5 },
+        { 1, 7, 9, 3, 5, 3, 3, 1, 1, 1, 128 },
+        { 2, 11, 6, 4, 8, 5, 3, 2, 2, 1, -127 },
+        { 1, 13, 13, 8, 6, 3, 3, 1, 2, 2, 0 },
+        { 1, 49, 10, 1, 64, 10, 4, 2, 4, 1, 17 },
+        { 1, 5, 5, 33, 3, 1, 1, 1, 0, 1, -1 },
+    };
+    nn_impl_t impl = nn_impl();
+    q7_t *ref = malloc(LAYER_MAX_IN);
+    bool ok = true;
+
+    for (size_t s = 0; s < sizeof(cases) / sizeof(cases[0]) && ok; s++) {
+        const int32_t *k = cases[s];
+        int32_t stride = k[7], pad = k[8], dilation = k[9];
+        cmsis_nn_conv_params params = { k[10], 4, { stride, stride }, { pad, pad }, { dilation, dilation },
+                                        { -120, 110 } };
+        cmsis_nn_dims in = { k[0], k[1], k[2], k[3] };
+        cmsis_nn_dims filter = { k[4], k[5], k[6], k[3] };
+        cmsis_nn_dims out = { k[0], 0, 0, k[4] };
+        out.h = (k[1] + 2 * pad - dilation * (k[5] - 1) - 1) / stride + 1;
+        out.w = (k[2] + 2 * pad - dilation * (k[6] - 1) - 1) / stride + 1;
+        size_t n = (size_t)out.n * out.h * out.w * out.c;
+
+        quant_fill(layerMult, layerShift, out.c, filter.h * filter.w * in.c, 117 + s);
+        convolve(&params, in, filter, out, layerIn, ref, true);
+        for (int i = NN_IMPL_REF; i < NN_IMPL_COUNT && ok; i++) {
+            if (!nn_use_impl((nn_impl_t)i)) continue;
+            memset(layerOut, 0, n);
+            convolve(&params, in, filter, out, layerIn, layerOut, false);
+            ok = memcmp(ref, layerOut, n) == 0;
+        }
+    }
+
+    nn_use_impl(impl);
+    free(ref);
+    quant_fill(layerMult, layerShift, CONV_OUT, 9 * CONV_IN, 114);
+    return ok;
+}
+
+static void pointwise_run(void)
+{
+    cmsis_nn_conv_params params = { 5, -3, { 1, 1 }, { 0, 0 }, { 1, 1 }, { -128, 127 } };
+    cmsis_nn_per_channel_quant_params quant = { layerMult, layerShift };
+    cmsis_nn_dims in = { 1, MAP_DIM, MAP_DIM, PW_IN };
+    cmsis_nn_dims filter = { PW_OUT, 1, 1, PW_IN };
+    cmsis_nn_dims bias = { 1, 1, 1, PW_OUT };
+    cmsis_nn_dims out = { 1, MAP_DIM, MAP_DIM, PW_OUT };
+    cmsis_nn_context ctx = { scratch, SCRATCH_SIZE };
+
+    arm_convolve_1x1_s8_fast(&ctx, &params, &quant, &in, layerIn, &filter, layerWeights, &bias, layerBias,
+                             &out, layerOut);
+}
+
+static bool pointwise_check(void)
+{
+    return same_for_every_impl(pointwise_run, layerOut, MAP_DIM * MAP_DIM * PW_OUT);
+}
+
+static void depthwise_run(void)
+{
+    cmsis_nn_dw_conv_params params = { 5, -3, 1, { 1, 1 }, { 1, 1 }, { 1, 1 }, { -128, 127 } };
+    cmsis_nn_per_channel_quant_params quant = { layerMult, layerShift };
+    cmsis_nn_dims in = { 1, MAP_DIM, MAP_DIM, DW_CH };
+    cmsis_nn_dims filter = { 1, 3, 3, DW_CH };
+    cmsis_nn_dims bias = { 1, 1, 1, DW_CH };
+    cmsis_nn_dims out = { 1, MAP_DIM, MAP_DIM, DW_CH };
+    cmsis_nn_context ctx = { scratch, SCRATCH_SIZE };
+
+    arm_depthwise_conv_s8_opt(&ctx, &params, &quant, &in, layerIn, &filter, layerWeights, &bias, layerBias,
+                              &out, layerOut);
+}
+
+static void fc_run(void)
+{
+    cmsis_nn_fc_params params = { 5, 0, -3, { -128, 127 } };
+    cmsis_nn_per_tensor_quant_params quant = { 0x5A000000, -11 };
+    cmsis_nn_dims in = { 1, 1, 1, FC_IN };
+    cmsis_nn_dims filter = { FC_IN, 1, 1, FC_OUT };
+    cmsis_nn_dims bias = { 1, 1, 1, FC_OUT };
+    cmsis_nn_dims out = { 1, 1, 1, FC_OUT };
+    cmsis_nn_context ctx = { scratch, SCRATCH_SIZE };
+
+    arm_fully_connected_s8(&ctx, &params, &quant, &in, layerIn, &filter, layerWeights, &bias, layerBias,
+                           &out, layerOut);
+}
+
+static bool fc_check(void)
+{
+    return same_for_every_impl(fc_run, layerOut, FC_OUT);
+}
+
+/*******************************************************************************
+ * DS-CNN keyword spotting
+ *
+ * The small DS-CNN of "Hello Edge: Keyword Spotting on Microcontrollers":
+ * a 10x4 stride-2 convolution of the 49x10 MFCC frame to 64 channels, four
+ * depthwise-separable blocks (3x3 depthwise, 1x1 pointwise to 64), average
+ * pooling, a fully connected layer to the 12 classes and softmax.
+ *
+ * Its activations and scratch buffers are planned into one arena the way the
+ * firmware would lay them out, and the check runs it both from the arena and
+ * with every buffer apart.
+ ******************************************************************************/
+#define KWS_FRAMES 49
+#define KWS_MFCC 10
+#define KWS_CH 64
+#define KWS_OUT_Y 25
+#define KWS_OUT_X 5
+#define KWS_BLOCKS 4
+#define KWS_CLASSES 12
+
+#define KWS_MAP (KWS_OUT_Y * KWS_OUT_X * KWS_CH)
+#define KWS_MACS (KWS_MAP * 10 * 4 + KWS_BLOCKS * (KWS_MAP * 9 + KWS_MAP * KWS_CH) + KWS_CH * KWS_CLASSES)
+
+static q7_t kwsIn[KWS_FRAMES * KWS_MFCC];
+static q7_t kwsConvW[KWS_CH * 10 * 4];
+static q7_t kwsDwW[KWS_BLOCKS][9 * KWS_CH];
+static q7_t kwsPwW[KWS_BLOCKS][KWS_CH * KWS_CH];
+static q7_t kwsFcW[KWS_CLASSES * KWS_CH];
+static int32_t kwsBias[1 + 2 * KWS_BLOCKS + 1][KWS_CH];
+static int32_t kwsMult[1 + 2 * KWS_BLOCKS][KWS_CH];
+static int32_t kwsShift[1 + 2 * KWS_BLOCKS][KWS_CH];
+/* The activations and layers as the arena planner sees them */
+enum {
+    KWS_ACT_IN,
+    KWS_ACT_CONV,
+    KWS_ACT_BLOCKS,                                 // depthwise, then pointwise output of each block
+    KWS_ACT_POOL = KWS_ACT_BLOCKS + 2 * KWS_BLOCKS,
+    KWS_ACT_LOGITS,
+    KWS_ACT_PROBS,
+    KWS_ACTS
+};
+
+/* Layer l reads activation l and writes l + 1 */
+#define KWS_LAYERS (KWS_ACTS - 1)
+
+/* All of the F411's RAM: the model has to fit in it */
+#define KWS_ARENA_SIZE (128 * 1024)
+
+static const cmsis_nn_dims kwsInDims = { 1, KWS_FRAMES, KWS_MFCC, 1 };
+static const cmsis_nn_dims kwsMapDims = { 1, KWS_OUT_Y, KWS_OUT_X, KWS_CH };
+static const cmsis_nn_dims kwsChDims = { 1, 1, 1, KWS_CH };
+static const cmsis_nn_dims kwsConvFilter = { KWS_CH, 10, 4, 1 };
+static const cmsis_nn_dims kwsDwFilter = { 1, 3, 3, KWS_CH };
+static const cmsis_nn_dims kwsPwFilter = { KWS_CH, 1, 1, KWS_CH };
+static const cmsis_nn_dims kwsPoolFilter = { 1, KWS_OUT_Y, KWS_OUT_X, 1 };
+static const cmsis_nn_dims kwsFcFilter = { KWS_CH, 1, 1, KWS_CLASSES };
+static const cmsis_nn_dims kwsClassDims = { 1, 1, 1, KWS_CLASSES };
+
+static cmsis_nn_arena_buffer kwsPlan[KWS_ACTS + KWS_LAYERS];
+static int32_t kwsPeak;
+static q7_t kwsArena[KWS_ARENA_SIZE];
+
+/**
+ * @brief Plan the model's activations and scratch buffers into one arena
+ *
+ * The arena needed is left in kwsPeak, or -1 if planning fails.
+ */
+static void kws_plan(void)
+{
+    static int32_t reads[KWS_LAYERS];
+    int32_t sizes[KWS_ACTS];
+    cmsis_nn_arena_layer layers[KWS_LAYERS];
+
+    sizes[KWS_ACT_IN] = KWS_FRAMES * KWS_MFCC;
+    for (int a = KWS_ACT_CONV; a < KWS_ACT_POOL; a++) sizes[a] = KWS_MAP;
+    sizes[KWS_ACT_POOL] = KWS_CH;
+    sizes[KWS_ACT_LOGITS] = KWS_CLASSES;
+    sizes[KWS_ACT_PROBS] = KWS_CLASSES;
+
+    for (int l = 0; l < KWS_LAYERS; l++) {
+        reads[l] = l;
+        layers[l] = (cmsis_nn_arena_layer){ &reads[l], 1, l + 1, 0 };
+    }
+    layers[0].scratch_size = arm_convolve_s8_get_buffer_size(&kwsInDims, &kwsConvFilter);
+    for (int b = 0; b < KWS_BLOCKS; b++) {
+        layers[1 + 2 * b].scratch_size = arm_depthwise_conv_s8_opt_get_buffer_size(&kwsMapDims, &kwsDwFilter);
+        layers[2 + 2 * b].scratch_size = arm_convolve_1x1_s8_fast_get_buffer_size(&kwsMapDims);
+    }
+    layers[KWS_ACT_POOL - 1].scratch_size = arm_avgpool_s8_get_buffer_size(1, KWS_CH);
+    layers[KWS_ACT_LOGITS - 1].scratch_size = arm_fully_connected_s8_get_buffer_size(&kwsFcFilter);
+
+    if (arm_nn_arena_plan_layers(layers, KWS_LAYERS, sizes, KWS_ACTS, 4, kwsPlan, &kwsPeak) != ARM_CMSIS_NN_SUCCESS)
+        kwsPeak = -1;
+}
+
+static void kws_setup(void)
+{
+    bench_fill_s8(kwsIn, sizeof(kwsIn), 121, -128, 127);
+    bench_fill_s8(kwsConvW, sizeof(kwsConvW), 122, -64, 63);
+    bench_fill_s8(&kwsDwW[0][0], sizeof(kwsDwW), 123, -64, 63);
+    bench_fill_s8(&kwsPwW[0][0], sizeof(kwsPwW), 124, -64, 63);
+    bench_fill_s8(kwsFcW, sizeof(kwsFcW), 125, -64, 63);
+    for (int l = 0; l < 1 + 2 * KWS_BLOCKS + 1; l++) bias_fill(kwsBias[l], KWS_CH, 126 + l);
+
+    quant_fill(kwsMult[0], kwsShift[0], KWS_CH, 10 * 4, 140);
+    for (int b = 0; b < KWS_BLOCKS; b++) {
+        quant_fill(kwsMult[1 + 2 * b], kwsShift[1 + 2 * b], KWS_CH, 9, 141 + b);
+        quant_fill(kwsMult[2 + 2 * b], kwsShift[2 + 2 * b], KWS_CH, KWS_CH, 151 + b);
+    }
+    kws_plan();
+}
+
+/**
+ * @brief Run the model with its buffers where plan puts them in arena
+ */
+static void kws_forward(q7_t *arena, const cmsis_nn_arena_buffer *plan)
+{
+#define ACT(a) (arena + plan[a].offset)
+#define CTX(l) ((cmsis_nn_context){ arena + plan[KWS_ACTS + (l)].offset, plan[KWS_ACTS + (l)].size })
+    cmsis_nn_context ctx;
+
+    memcpy(ACT(KWS_ACT_IN), kwsIn, sizeof(kwsIn));
+
+    cmsis_nn_conv_params conv = { 128, -128, { 2, 2 }, { 1, 4 }, { 1, 1 }, { -128, 127 } };
+    cmsis_nn_per_channel_quant_params quant = { kwsMult[0], kwsShift[0] };
+    ctx = CTX(0);
+    arm_convolve_s8(&ctx, &conv, &quant, &kwsInDims, ACT(KWS_ACT_IN), &kwsConvFilter, kwsConvW, &kwsChDims,
+                    kwsBias[0], &kwsMapDims, ACT(KWS_ACT_CONV));
+
+    for (int b = 0; b < KWS_BLOCKS; b++) {
+        const int dw = 1 + 2 * b, pw = 2 + 2 * b;
+
+        cmsis_nn_dw_conv_params dwParams = { 128, -128, 1, { 1, 1 }, { 1, 1 }, { 1, 1 }, { -128, 127 } };
+        quant = (cmsis_nn_per_channel_quant_params){ kwsMult[dw], kwsShift[dw] };
+        ctx = CTX(dw);
+        arm_depthwise_conv_s8_opt(&ctx, &dwParams, &quant, &kwsMapDims, ACT(dw), &kwsDwFilter, kwsDwW[b],
+                                  &kwsChDims, kwsBias[dw], &kwsMapDims, ACT(dw + 1));
+
+        cmsis_nn_conv_params pwParams = { 128, -128, { 1, 1 }, { 0, 0 }, { 1, 1 }, { -128, 127 } };
+        quant = (cmsis_nn_per_channel_quant_params){ kwsMult[pw], kwsShift[pw] };
+        ctx = CTX(pw);
+        arm_convolve_1x1_s8_fast(&ctx, &pwParams, &quant, &kwsMapDims, ACT(pw), &kwsPwFilter, kwsPwW[b],
+                                 &kwsChDims, kwsBias[pw], &kwsMapDims, ACT(pw + 1));
+    }
+
+    cmsis_nn_pool_params pool = { { 1, 1 }, { 0, 0 }, { -128, 127 } };
+    ctx = CTX(KWS_ACT_POOL - 1);
+    arm_avgpool_s8(&ctx, &pool, &kwsMapDims, ACT(KWS_ACT_POOL - 1), &kwsPoolFilter, &kwsChDims,
+                   ACT(KWS_ACT_POOL));
+
+    cmsis_nn_fc_params fc = { 128, 0, 0, { -128, 127 } };
+    cmsis_nn_per_tensor_quant_params fcQuant = { 0x5A000000, -9 };
+    ctx = CTX(KWS_ACT_LOGITS - 1);
+    arm_fully_connected_s8(&ctx, &fc, &fcQuant, &kwsChDims, ACT(KWS_ACT_POOL), &kwsFcFilter, kwsFcW,
+                           &kwsClassDims, kwsBias[1 + 2 * KWS_BLOCKS], &kwsClassDims, ACT(KWS_ACT_LOGITS));
+
+    arm_softmax_s8(ACT(KWS_ACT_LOGITS), 1, KWS_CLASSES, 1077952576, 23, -248, ACT(KWS_ACT_PROBS));
+#undef ACT
+#undef CTX
+}
+
+static void kws_run(void)
+{
+    kws_forward(kwsArena, kwsPlan);
+}
+
+/* Every buffer in its own memory, for the checks */
+static cmsis_nn_arena_buffer kwsApart[KWS_ACTS + KWS_LAYERS];
+static q7_t *kwsApartArena;
+
+static void kws_apart_run(void)
+{
+    kws_forward(kwsApartArena, kwsApart);
+}
+
+static bool kws_check(void)
+{
+    const int n = KWS_ACTS + KWS_LAYERS;
+    size_t apartSize = 0;
+
+    if (kwsPeak < 0 || kwsPeak > KWS_ARENA_SIZE) return false;
+
+    /* Buffers alive at the same time never share bytes */
+    for (int i = 0; i < n; i++) {
+        for (int j = i + 1; j < n; j++) {
+            const cmsis_nn_arena_buffer *a = &kwsPlan[i], *b = &kwsPlan[j];
+            if (a->size == 0 || b->size == 0 || a->first > b->last || b->first > a->last) continue;
+            if (a->offset < b->offset + b->size && b->offset < a->offset + a->size) return false;
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+        kwsApart[i] = kwsPlan[i];
+        kwsApart[i].offset = (int32_t)apartSize;
+        apartSize += (size_t)(kwsPlan[i].size + 3) & ~(size_t)3;
+    }
+    kwsApartArena = calloc(apartSize, 1);
+
+    /* The probabilities of an int8 softmax sum to about 256 */
+    kws_run();
+    int32_t sum = 0;
+    for (int i = 0; i < KWS_CLASSES; i++) sum += kwsArena[kwsPlan[KWS_ACT_PROBS].offset + i] + 128;
+
+    /* The arena gives what separate buffers do, and every activation is the same with
+     * every implementation */
+    kws_apart_run();
+    bool ok = sum >= 240 && sum <= 272 &&
+              memcmp(kwsArena + kwsPlan[KWS_ACT_LOGITS].offset, kwsApartArena + kwsApart[KWS_ACT_LOGITS].offset,
+                     KWS_CLASSES) == 0 &&
+              memcmp(kwsArena + kwsPlan[KWS_ACT_PROBS].offset, kwsApartArena + kwsApart[KWS_ACT_PROBS].offset,
+                     KWS_CLASSES) == 0 &&
+              same_for_every_impl(kws_apart_run, kwsApartArena, (size_t)kwsApart[KWS_ACTS].offset);
+
+    free(kwsApartArena);
+    return ok;
+}
+
+/*******************************************************************************
+ * Kernel table
+ ******************************************************************************/
+const char bench_suite[] = "cmsis-nn";
+
+void bench_describe(FILE *out)
+{
+    int32_t buffers = 0;
+
+    kws_plan();
+    for (int i = 0; i < KWS_ACTS + KWS_LAYERS; i++) buffers += kwsPlan[i].size;
+
+    fprintf(out, "  \"nn_impl\": \"%s\",\n", nn_impl_name(nn_impl()));
+    fprintf(out, "  \"kws_arena\": %d,\n", (int)kwsPeak);
+    fprintf(out, "  \"kws_buffers\": %d,\n", (int)buffers);
+}
+
+const bench_kernel_t bench_kernels[] = {
+    { "arm_nn_mat_mult_nt_t_s8 256x256x256", "x86 backend", GEMM_DIM * GEMM_DIM * GEMM_DIM, gemm_setup, mat_mult_run, mat_mult_check },
+    { "arm_nn_mat_mult_nt_t_s8_ref 256x256x256", "x86 backend", GEMM_DIM * GEMM_DIM * GEMM_DIM, gemm_setup, mat_mult_ref_run, NULL },
+    { "arm_nn_vec_mat_mult_t_s8 1024x1024", "x86 backend", GEMV_DIM * GEMV_DIM, gemm_setup, vec_mat_run, vec_mat_check },
+    { "arm_nn_vec_mat_mult_t_s8_ref 1024x1024", "x86 backend", GEMV_DIM * GEMV_DIM, gemm_setup, vec_mat_ref_run, NULL },
+    { "arm_convolve_s8 3x3 32x32x16->32", "convolution", MAP_DIM * MAP_DIM * CONV_OUT * 9 * CONV_IN, conv_setup, conv_run, conv_check },
+    { "arm_convolve_1x1_s8_fast 32x32x32->64", "convolution", MAP_DIM * MAP_DIM * PW_OUT * PW_IN, pointwise_setup, pointwise_run, pointwise_check },
+    { "arm_depthwise_conv_s8_opt 3x3 32x32x64", "depthwise convolution", MAP_DIM * MAP_DIM * DW_CH * 9, depthwise_setup, depthwise_run, NULL },
+    { "arm_fully_connected_s8 1024->256", "fully connected", FC_IN * FC_OUT, layer_setup, fc_run, fc_check },
+    { "ds-cnn kws 49x10", "model", KWS_MACS, kws_setup, kws_run, kws_check },
+};
+
+const size_t bench_kernel_count = sizeof(bench_kernels) / sizeof(bench_kernels[0]);
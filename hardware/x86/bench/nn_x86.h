@@ -0,0 +1,92 @@
+/**
+ * @file nn_x86.h
+ * @brief x86 host backend for the core CMSIS-NN int8 kernels
+ *
+ * With the x86 backend (scons bench=nn nn_backend=x86, the default) the
+ * functions below replace their CMSIS-NN namesakes at link time, keeping
+ * the same API, and the library's generic C versions stay available under
+ * a _ref suffix for comparison. With nn_backend=ref the _ref names are
+ * simply the library functions.
+ *
+ * Every implementation gives bit-exact results; NN_IMPL=ref|avx2|avx-vnni
+ * in the environment picks one, and by default the best the CPU has is used.
+ */
+
+#ifndef NN_X86_H
+#define NN_X86_H
+
+#include <stdbool.h>
+
+#include "nn_host.h"
+#include "arm_nnfunctions.h"
+#include "arm_nnsupportfunctions.h"
+
+/**
+ * @brief Implementations of the x86 backend's kernels
+ */
+typedef enum
+{
+    NN_IMPL_REF,        // the library's C code
+    NN_IMPL_AVX2,       // _mm256_madd_epi16 on values widened to 16 bits
+    NN_IMPL_AVX_VNNI,   // _mm256_dpbusd_avx_epi32 on the int8 values
+    NN_IMPL_COUNT
+} nn_impl_t;
+
+static inline const char *nn_impl_name(nn_impl_t impl)
+{
+    return impl == NN_IMPL_AVX_VNNI ? "avx-vnni" : impl == NN_IMPL_AVX2 ? "avx2" : "ref";
+}
+
+#ifdef NN_BACKEND_REF
+
+#define arm_nn_mat_mult_nt_t_s8_ref arm_nn_mat_mult_nt_t_s8
+#define arm_nn_vec_mat_mult_t_s8_ref arm_nn_vec_mat_mult_t_s8
+#define arm_convolve_s8_ref arm_convolve_s8
+
+static inline nn_impl_t nn_impl(void)
+{
+    return NN_IMPL_REF;
+}
+
+static inline bool nn_use_impl(nn_impl_t impl)
+{
+    return impl == NN_IMPL_REF;
+}
+
+#else
+
+/**
+ * @brief CMSIS-NN's own arm_nn_mat_mult_nt_t_s8, arm_nn_vec_mat_mult_t_s8
+ *        and arm_convolve_s8
+ */
+arm_status arm_nn_mat_mult_nt_t_s8_ref(const q7_t *lhs, const q7_t *rhs, const q31_t *bias, q7_t *dst,
+                                       const int32_t *dst_multipliers, const int32_t *dst_shifts,
+                                       const int32_t lhs_rows, const int32_t rhs_rows, const int32_t rhs_cols,
+                                       const int32_t lhs_offset, const int32_t dst_offset,
+                                       const int32_t activation_min, const int32_t activation_max);
+arm_status arm_nn_vec_mat_mult_t_s8_ref(const q7_t *lhs, const q7_t *rhs, const q31_t *bias, q7_t *dst,
+                                        const int32_t lhs_offset, const int32_t rhs_offset,
+                                        const int32_t dst_offset, const int32_t dst_multiplier,
+                                        const int32_t dst_shift, const int32_t rhs_cols, const int32_t rhs_rows,
+                                        const int32_t activation_min, const int32_t activation_max,
+                                        const int32_t address_offset);
+arm_status arm_convolve_s8_ref(const cmsis_nn_context *ctx, const cmsis_nn_conv_params *conv_params,
+                               const cmsis_nn_per_channel_quant_params *quant_params,
+                               const cmsis_nn_dims *input_dims, const q7_t *input_data,
+                               const cmsis_nn_dims *filter_dims, const q7_t *filter_data,
+                               const cmsis_nn_dims *bias_dims, const int32_t *bias_data,
+                               const cmsis_nn_dims *output_dims, q7_t *output_data);
+
+/**
+ * @brief Implementation in use
+ */
+nn_impl_t nn_impl(void);
+
+/**
+ * @brief Switch implementation; false, and no change, if the CPU lacks it
+ */
+bool nn_use_impl(nn_impl_t impl);
+
+#endif // NN_BACKEND_REF
+
+#endif // NN_X86_H
@@ -0,0 +1,501 @@
+/**
+ * @file hostlink.c
+ * @brief Host-side client for many device host UARTs on one epoll loop
+ *
+ * Each device has three byte buffers: rx, parsed in place from start to
+ * end; tx, written as the port accepts it; and waiting, the command lines
+ * held back until fewer than depth are in flight. The tags of every
+ * command without a reply, sent or waiting, are a FIFO in send order.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "hostlink.h"
+
+/*******************************************************************************
+ * Configuration
+ ******************************************************************************/
+#define RX_INITIAL 4096
+#define RX_MAX (1u << 20)       // longest line kept; longer ones are dropped
+#define EPOLL_BATCH 64
+
+typedef struct
+{
+    char *data;
+    uint32_t start;
+    uint32_t end;
+    uint32_t cap;
+} buf_t;
+
+typedef struct
+{
+    int fd;                     // -1 once removed
+    uint32_t depth;
+    uint32_t inflight;          // sent, no reply yet
+    uint32_t waiting_lines;     // in waiting, not sent yet
+    buf_t rx;
+    buf_t tx;
+    buf_t waiting;
+    uint64_t *tags;             // ring of inflight + waiting_lines tags
+    uint32_t tag_head;
+    uint32_t tag_cap;
+    bool backlog;               // complete lines in rx not yet returned
+    bool hangup;
+    bool closing;               // HL_CLOSED returned; freed on the next poll
+    bool want_out;
+    uint64_t handed_out;        // the poll that last returned lines from rx
+} device_t;
+
+struct hl_loop
+{
+    int ep;
+    device_t *devs;
+    int32_t ndev;
+    int32_t cap;
+    uint64_t next_tag;
+    uint64_t poll;              // hl_poll calls so far
+};
+
+/*******************************************************************************
+ * Buffers
+ ******************************************************************************/
+static bool bufReserve(buf_t *b, uint32_t extra)
+{
+    if (b->start > 0 && b->end + extra > b->cap) {
+        memmove(b->data, b->data + b->start, b->end - b->start);
+        b->end -= b->start;
+        b->start = 0;
+    }
+    if (b->end + extra <= b->cap) {
+        return true;
+    }
+    uint32_t cap = b->cap ? b->cap : RX_INITIAL;
+    while (cap < b->end + extra) {
+        cap *= 2;
+    }
+    char *data = realloc(b->data, cap);
+    if (data == NULL) {
+        return false;
+    }
+    b->data = data;
+    b->cap = cap;
+    return true;
+}
+
+static void bufFree(buf_t *b)
+{
+    free(b->data);
+    memset(b, 0, sizeof(*b));
+}
+
+/*******************************************************************************
+ * Devices
+ ******************************************************************************/
+static device_t *getDevice(hl_loop_t *loop, int32_t dev)
+{
+    if (dev < 0 || dev >= loop->ndev || loop->devs[dev].fd < 0) {
+        return NULL;
+    }
+    return &loop->devs[dev];
+}
+
+static void setWantOut(hl_loop_t *loop, int32_t dev, bool want)
+{
+    device_t *d = &loop->devs[dev];
+    if (d->want_out == want) {
+        return;
+    }
+    struct epoll_event ev = { .events = EPOLLIN | (want ? EPOLLOUT : 0), .data.u32 = (uint32_t)dev };
+    epoll_ctl(loop->ep, EPOLL_CTL_MOD, d->fd, &ev);
+    d->want_out = want;
+}
+
+static void flush(hl_loop_t *loop, int32_t dev)
+{
+    device_t *d = &loop->devs[dev];
+
+    while (d->tx.start < d->tx.end) {
+        ssize_t n = write(d->fd, d->tx.data + d->tx.start, d->tx.end - d->tx.start);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN) {
+                d->hangup = true;
+            }
+            break;
+        }
+        d->tx.start += (uint32_t)n;
+    }
+    if (d->tx.start == d->tx.end) {
+        d->tx.start = d->tx.end = 0;
+    }
+    setWantOut(loop, dev, d->tx.start < d->tx.end && !d->hangup);
+}
+
+// Release waiting commands while fewer than depth are in flight
+static void pump(hl_loop_t *loop, int32_t dev)
+{
+    device_t *d = &loop->devs[dev];
+    bool moved = false;
+
+    while (d->waiting_lines > 0 && d->inflight < d->depth) {
+        char *line = d->waiting.data + d->waiting.start;
+        char *nl = memchr(line, '\n', d->waiting.end - d->waiting.start);
+        uint32_t len = (uint32_t)(nl - line) + 1;
+
+        if (!bufReserve(&d->tx, len)) {
+            break;
+        }
+        memcpy(d->tx.data + d->tx.end, line, len);
+        d->tx.end += len;
+        d->waiting.start += len;
+        d->waiting_lines--;
+        d->inflight++;
+        moved = true;
+    }
+    if (d->waiting.start == d->waiting.end) {
+        d->waiting.start = d->waiting.end = 0;
+    }
+    if (moved) {
+        flush(loop, dev);
+    }
+}
+
+static void closeDevice(hl_loop_t *loop, int32_t dev)
+{
+    device_t *d = &loop->devs[dev];
+
+    epoll_ctl(loop->ep, EPOLL_CTL_DEL, d->fd, NULL);
+    close(d->fd);
+    d->fd = -1;
+    bufFree(&d->rx);
+    bufFree(&d->tx);
+    bufFree(&d->waiting);
+    free(d->tags);
+    d->tags = NULL;
+}
+
+static speed_t baudConstant(uint32_t baud)
+{
+    switch (baud) {
+    case 9600: return B9600;
+    case 19200: return B19200;
+    case 38400: return B38400;
+    case 57600: return B57600;
+    case 115200: return B115200;
+    case 230400: return B230400;
+    case 460800: return B460800;
+    case 921600: return B921600;
+    case 1000000: return B1000000;
+    default: return 0;
+    }
+}
+
+/*******************************************************************************
+ * Replies
+ ******************************************************************************/
+static hl_status_t classify(const char *line, uint32_t len, const char **value, uint32_t *value_len)
+{
+    *value = line;
+    *value_len = len;
+    if (len == 2 && memcmp(line, "OK", 2) == 0) {
+        *value_len = 0;
+        return HL_OK;
+    }
+    if (len >= 4 && memcmp(line, "OK: ", 4) == 0) {
+        *value = line + 4;
+        *value_len = len - 4;
+        return HL_OK;
+    }
+    if (len >= 7 && memcmp(line, "ERROR: ", 7) == 0) {
+        *value = line + 7;
+        *value_len = len - 7;
+        return HL_ERROR;
+    }
+    return HL_LINE;
+}
+
+// Turn complete lines in rx into events; backlog is set if room ran out
+static int32_t drain(hl_loop_t *loop, int32_t dev, hl_event_t *events, int32_t room)
+{
+    device_t *d = &loop->devs[dev];
+    int32_t n = 0;
+
+    while (d->rx.start < d->rx.end) {
+        char *line = d->rx.data + d->rx.start;
+        char *nl = memchr(line, '\n', d->rx.end - d->rx.start);
+        if (nl == NULL) {
+            break;
+        }
+        if (n == room) {
+            d->backlog = true;
+            return n;
+        }
+        uint32_t len = (uint32_t)(nl - line);
+        d->rx.start += len + 1;
+        if (len > 0 && line[len - 1] == '\r') {
+            len--;
+        }
+        if (len == 0) {
+            continue;
+        }
+
+        d->handed_out = loop->poll;
+        hl_event_t *ev = &events[n++];
+        ev->dev = dev;
+        ev->tag = 0;
+        ev->status = classify(line, len, &ev->value, &ev->len);
+        if (ev->status != HL_LINE && d->inflight > 0) {
+            ev->tag = d->tags[d->tag_head];
+            d->tag_head = (d->tag_head + 1) % d->tag_cap;
+            d->inflight--;
+            pump(loop, dev);
+        } else {
+            ev->status = HL_LINE;
+            ev->value = line;
+            ev->len = len;
+        }
+    }
+    d->backlog = false;
+    return n;
+}
+
+static void receive(hl_loop_t *loop, int32_t dev)
+{
+    device_t *d = &loop->devs[dev];
+
+    for (;;) {
+        if (d->rx.end - d->rx.start >= RX_MAX) {
+            // A line this long is not a reply; keep only what follows it
+            d->rx.start = d->rx.end;
+        }
+        if (!bufReserve(&d->rx, RX_INITIAL)) {
+            return;
+        }
+        ssize_t n = read(d->fd, d->rx.data + d->rx.end, d->rx.cap - d->rx.end);
+        if (n > 0) {
+            d->rx.end += (uint32_t)n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n == 0 || errno != EAGAIN) {
+            d->hangup = true;
+        }
+        return;
+    }
+}
+
+/*******************************************************************************
+ * API
+ ******************************************************************************/
+hl_loop_t *hl_open(void)
+{
+    hl_loop_t *loop = calloc(1, sizeof(*loop));
+    if (loop == NULL) {
+        return NULL;
+    }
+    loop->ep = epoll_create1(EPOLL_CLOEXEC);
+    if (loop->ep < 0) {
+        free(loop);
+        return NULL;
+    }
+    loop->next_tag = 1;
+    return loop;
+}
+
+void hl_close(hl_loop_t *loop)
+{
+    if (loop == NULL) {
+        return;
+    }
+    for (int32_t i = 0; i < loop->ndev; i++) {
+        if (loop->devs[i].fd >= 0) {
+            closeDevice(loop, i);
+        }
+    }
+    close(loop->ep);
+    free(loop->devs);
+    free(loop);
+}
+
+int32_t hl_add(hl_loop_t *loop, const char *path, uint32_t baud, uint32_t depth)
+{
+    speed_t speed = baudConstant(baud);
+    if (speed == 0 || depth == 0) {
+        return -EINVAL;
+    }
+
+    int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        return -errno;
+    }
+    struct termios tio;
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tio.c_cflag |= CLOCAL | CREAD;
+        cfsetispeed(&tio, speed);
+        cfsetospeed(&tio, speed);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+
+    if (loop->ndev == loop->cap) {
+        int32_t cap = loop->cap ? loop->cap * 2 : 16;
+        device_t *devs = realloc(loop->devs, (size_t)cap * sizeof(*devs));
+        if (devs == NULL) {
+            close(fd);
+            return -ENOMEM;
+        }
+        loop->devs = devs;
+        loop->cap = cap;
+    }
+
+    int32_t dev = loop->ndev;
+    device_t *d = &loop->devs[dev];
+    memset(d, 0, sizeof(*d));
+    d->fd = fd;
+    d->depth = depth;
+
+    struct epoll_event ev = { .events = EPOLLIN, .data.u32 = (uint32_t)dev };
+    if (epoll_ctl(loop->ep, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        int err = errno;
+        close(fd);
+        return -err;
+    }
+    loop->ndev++;
+    return dev;
+}
+
+int32_t hl_remove(hl_loop_t *loop, int32_t dev)
+{
+    if (getDevice(loop, dev) == NULL) {
+        return -EBADF;
+    }
+    closeDevice(loop, dev);
+    return 0;
+}
+
+int64_t hl_send(hl_loop_t *loop, int32_t dev, const char *cmd, uint32_t len)
+{
+    device_t *d = getDevice(loop, dev);
+    if (d == NULL || d->hangup) {
+        return -EBADF;
+    }
+    if (memchr(cmd, '\n', len) != NULL) {
+        return -EINVAL;
+    }
+
+    uint32_t count = d->inflight + d->waiting_lines;
+    if (count == d->tag_cap) {
+        uint32_t cap = d->tag_cap ? d->tag_cap * 2 : 16;
+        uint64_t *tags = malloc(cap * sizeof(*tags));
+        if (tags == NULL) {
+            return -ENOMEM;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            tags[i] = d->tags[(d->tag_head + i) % d->tag_cap];
+        }
+        free(d->tags);
+        d->tags = tags;
+        d->tag_head = 0;
+        d->tag_cap = cap;
+    }
+    if (!bufReserve(&d->waiting, len + 1)) {
+        return -ENOMEM;
+    }
+
+    memcpy(d->waiting.data + d->waiting.end, cmd, len);
+    d->waiting.data[d->waiting.end + len] = '\n';
+    d->waiting.end += len + 1;
+    d->waiting_lines++;
+
+    uint64_t tag = loop->next_tag++;
+    d->tags[(d->tag_head + count) % d->tag_cap] = tag;
+    pump(loop, dev);
+    return (int64_t)tag;
+}
+
+int32_t hl_pending(hl_loop_t *loop, int32_t dev)
+{
+    device_t *d = getDevice(loop, dev);
+    if (d == NULL) {
+        return -EBADF;
+    }
+    return (int32_t)(d->inflight + d->waiting_lines);
+}
+
+int32_t hl_poll(hl_loop_t *loop, hl_event_t *events, int32_t max, int32_t timeout_ms)
+{
+    int32_t n = 0;
+
+    if (max <= 0) {
+        return -EINVAL;
+    }
+    loop->poll++;
+
+    // The last poll's events are no longer in use
+    for (int32_t i = 0; i < loop->ndev; i++) {
+        if (loop->devs[i].fd >= 0 && loop->devs[i].closing) {
+            closeDevice(loop, i);
+        }
+    }
+
+    // Lines that did not fit last time; rx may move again once they are out
+    for (int32_t i = 0; i < loop->ndev && n < max; i++) {
+        if (loop->devs[i].fd >= 0 && loop->devs[i].backlog) {
+            n += drain(loop, i, events + n, max - n);
+        }
+    }
+    if (n == max) {
+        return n;
+    }
+
+    struct epoll_event ready[EPOLL_BATCH];
+    int count = epoll_wait(loop->ep, ready, EPOLL_BATCH, n > 0 ? 0 : timeout_ms);
+    if (count < 0) {
+        return errno == EINTR ? n : -errno;
+    }
+
+    for (int i = 0; i < count; i++) {
+        int32_t dev = (int32_t)ready[i].data.u32;
+        device_t *d = &loop->devs[dev];
+        if (d->fd < 0 || d->closing) {
+            continue;
+        }
+        if (ready[i].events & EPOLLOUT) {
+            flush(loop, dev);
+        }
+        // Reading may move rx, so a device that has handed out lines this
+        // call, or still has some to, is read next time
+        if (d->backlog || d->handed_out == loop->poll) {
+            continue;
+        }
+        if (ready[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+            receive(loop, dev);
+        }
+        if (n < max) {
+            n += drain(loop, dev, events + n, max - n);
+        } else {
+            d->backlog = true;
+        }
+    }
+
+    // Report hang-ups once every line before them is out
+    for (int32_t i = 0; i < loop->ndev && n < max; i++) {
+        device_t *d = &loop->devs[i];
+        if (d->fd >= 0 && d->hangup && !d->backlog && !d->closing) {
+            events[n++] = (hl_event_t){ .dev = i, .status = HL_CLOSED };
+            d->closing = true;
+        }
+    }
+    return n;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file hostlink.h
+ * @brief Host-side client for many device host UARTs on one epoll loop
+ *
+ * Host tools drive a device with "cmd args\n" lines and read back one
+ * "OK", "OK: value" or "ERROR: reason" line per command (testing/protocol.py).
+ * This library keeps the links of many devices on one epoll loop. Each
+ * device may have up to depth commands outstanding, and each reply is
+ * matched to the oldest of them, since a device answers in order.
+ *
+ * Commands beyond depth wait in the library and are sent as replies come
+ * back, so a device's receive buffer is never overrun. Replies are parsed in
+ * place: an event's value points into the device's receive buffer and stays
+ * valid until the next hl_poll().
+ *
+ * A line that arrives with no command outstanding (the car's unlock flags,
+ * say), or that is neither OK nor ERROR, is an HL_LINE event with tag 0.
+ *
+ * Built as libhostlink.so (scons hostlink=1) for tools/hostlink.py.
+ */
+
+#ifndef HOSTLINK_H
+#define HOSTLINK_H
+
+#include <stdint.h>
+
+typedef struct hl_loop hl_loop_t;
+
+typedef enum
+{
+    HL_OK = 0,      // reply "OK" or "OK: value"
+    HL_ERROR = 1,   // reply "ERROR: reason"
+    HL_LINE = 2,    // any other line, or a reply nothing was waiting for
+    HL_CLOSED = 3,  // the link hung up; its outstanding commands are dropped
+} hl_status_t;
+
+typedef struct
+{
+    int32_t dev;
+    int32_t status;         // hl_status_t
+    uint64_t tag;           // from hl_send, or 0 for HL_LINE and HL_CLOSED
+    const char *value;      // after "OK: " or "ERROR: ", else the whole line; not terminated
+    uint32_t len;
+} hl_event_t;
+
+hl_loop_t *hl_open(void);
+void hl_close(hl_loop_t *loop);
+
+/**
+ * @brief Open a serial port (raw, 8N1) and add it to the loop
+ * @param depth commands in flight at once, at least 1
+ * @return the device number, or a negative errno
+ */
+int32_t hl_add(hl_loop_t *loop, const char *path, uint32_t baud, uint32_t depth);
+
+/**
+ * @brief Close a device; its outstanding commands are dropped
+ */
+int32_t hl_remove(hl_loop_t *loop, int32_t dev);
+
+/**
+ * @brief Queue a command (without its newline)
+ * @return a tag identifying the reply, unique in the loop, or a negative errno
+ */
+int64_t hl_send(hl_loop_t *loop, int32_t dev, const char *cmd, uint32_t len);
+
+/**
+ * @brief Commands sent or waiting for a device that have no reply yet
+ */
+int32_t hl_pending(hl_loop_t *loop, int32_t dev);
+
+/**
+ * @brief Move bytes and collect events
+ *
+ * Waits up to timeout_ms (-1 forever) for something to happen, unless
+ * events are already waiting to be returned.
+ *
+ * @return the number of events written, at most max, or a negative errno
+ */
+int32_t hl_poll(hl_loop_t *loop, hl_event_t *events, int32_t max, int32_t timeout_ms);
+
+#endif // HOSTLINK_H
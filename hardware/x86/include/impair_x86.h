@@ -0,0 +1,146 @@
+/**
+ * @file impair_x86.h
+ * @brief Link impairment stage for the simulated board UART
+ *
+ * Bytes received on the board UART can be passed through a programmable
+ * impairment stage before the firmware sees them: random loss, duplication,
+ * bit errors, fixed latency plus jitter, a bandwidth cap and burst outages.
+ * All randomness comes from a seeded PRNG so runs are reproducible.
+ *
+ * Settings are given as a comma-separated list of key=value pairs, either
+ * on the command line (impair=loss=0.01,seed=7) or at runtime through the
+ * "impair" test command. Keys not mentioned keep their current value:
+ *   loss=P      probability that a byte is dropped
+ *   dup=P       probability that a byte is delivered twice
+ *   ber=P       probability that each bit is flipped
+ *   delay=US    fixed latency in microseconds
+ *   jitter=US   extra latency, uniform in [0, US]
+ *   rate=BPS    bandwidth cap in bytes per second (0 = unlimited)
+ *   burst=P     probability per byte that an outage starts
+ *   burst_us=US length of an outage; every byte in it is lost
+ *   relay=US    forwarding delay of a relay between the boards, in
+ *               microseconds; set it on both boards for a relay that
+ *               forwards both ways
+ *   preask=0|1  the relay asks the fob its distance-bounding rounds ahead
+ *               of the car (see below); set it on both boards
+ *   seed=N      reseed the PRNG
+ * "off" restores a perfect link.
+ *
+ * A relay is modelled apart from delay so that relay attacks can be
+ * measured against a link that already has latency of its own: the two
+ * add up, and bytes that pass through the relay are counted.
+ *
+ * A pre-asking relay sends the fob a guessed challenge (PREASK_GUESS) as
+ * soon as it has forwarded the car's BOUND frame, and then answers each of
+ * the car's challenges itself, at once, with the fob's response adjusted
+ * by guess ^ challenge - right whenever the firmware's response is the
+ * challenge mixed with a key. Distance-bounding bytes therefore skip the
+ * relay delay, and on the fob's side each challenge is replaced by the
+ * guess and the response that goes back is rewritten (impair_transmit).
+ * Frames are followed byte by byte to tell the two apart, as the firmware
+ * does, so preask is for a point-to-point link with no other impairment.
+ */
+
+#ifndef IMPAIR_X86_H
+#define IMPAIR_X86_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Counters of what the impairment stage has done since the last reset
+ */
+typedef struct
+{
+    uint64_t in;            /* bytes offered by the link */
+    uint64_t delivered;     /* bytes handed to the firmware */
+    uint64_t dropped;       /* bytes lost to random loss */
+    uint64_t outage_drops;  /* bytes lost during burst outages */
+    uint64_t outages;       /* burst outages started */
+    uint64_t duplicated;    /* extra copies delivered */
+    uint64_t corrupted;     /* bytes with at least one flipped bit */
+    uint64_t bits_flipped;  /* total flipped bits */
+    uint64_t overflow;      /* bytes lost because the delay queue was full */
+    uint64_t relayed;       /* bytes forwarded by the simulated relay */
+    uint64_t preasked;      /* challenges the relay asked the fob ahead */
+} impair_stats_t;
+
+/**
+ * @brief Apply a settings string (see file comment)
+ * @return true if every key was recognised and valid
+ */
+bool impair_configure(const char* spec);
+
+/**
+ * @brief Whether any impairment is currently configured
+ */
+bool impair_enabled(void);
+
+/**
+ * @brief Current time on the clock used for scheduling, in microseconds
+ */
+uint64_t impair_now_us(void);
+
+/**
+ * @brief Pass a received byte through the impairment stage
+ */
+void impair_feed(uint8_t byte, uint64_t now_us);
+
+/**
+ * @brief Pass bytes about to be sent on the board UART through the stage
+ *
+ * Only a pre-asking relay (preask=1) changes anything: it rewrites the
+ * fob's distance-bounding response in place.
+ */
+void impair_transmit(uint8_t* buf, uint32_t len);
+
+/**
+ * @brief Whether a byte is due for delivery
+ */
+bool impair_ready(uint64_t now_us);
+
+/**
+ * @brief Take the next byte that is due
+ * @return the byte, or -1 if none is due yet
+ */
+int32_t impair_pop(uint64_t now_us);
+
+/**
+ * @brief Microseconds until the next queued byte is due
+ * @return the delay, or -1 if the queue is empty
+ */
+int64_t impair_next_due(uint64_t now_us);
+
+/**
+ * @brief Copy queued bytes (due or not) without removing them
+ * @return number of bytes copied
+ */
+uint32_t impair_peek(uint8_t* buf, uint32_t max);
+
+/**
+ * @brief Number of bytes queued, due or not
+ */
+uint32_t impair_queued(void);
+
+/**
+ * @brief Drop everything still queued
+ */
+void impair_flush(void);
+
+/**
+ * @brief Read the counters
+ */
+void impair_get_stats(impair_stats_t* stats);
+
+/**
+ * @brief Zero the counters
+ */
+void impair_reset_stats(void);
+
+/**
+ * @brief Format the counters as key=value pairs for a host response
+ */
+void impair_format_stats(char* buf, size_t len);
+
+#endif /* IMPAIR_X86_H */
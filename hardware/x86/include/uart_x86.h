@@ -10,6 +10,10 @@
 #define UART_X86_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "uart.h"
 
 /**
  * @brief Clean up and close all open serial ports
@@ -39,4 +43,42 @@ const char* uart_get_board_path(void);
  */
 const char* uart_get_host_path(void);
 
+/**
+ * @brief Copy the bytes received on a UART but not yet read by the firmware
+ *
+ * Bytes waiting in the kernel are moved into a small user-space buffer, or
+ * into the impairment stage when the link is impaired, so that they are
+ * reported without being consumed; the firmware still reads them afterwards
+ * as normal. Bytes in the impairment stage are copied where they stand and
+ * keep their delivery times.
+ *
+ * @param uart the UART to inspect
+ * @param buf destination for the pending bytes
+ * @param max size of buf
+ * @return number of bytes pending, of which at most max were copied
+ */
+uint32_t uart_get_pending(hw_uart_t uart, uint8_t* buf, uint32_t max);
+
+/**
+ * @brief Replace the bytes received on a UART but not yet read
+ *
+ * Discards anything currently pending and queues buf in its place, as if
+ * those bytes had just arrived.
+ *
+ * @param uart the UART to restore
+ * @param buf the bytes to queue
+ * @param len number of bytes in buf
+ * @return true on success, false if len is too large
+ */
+bool uart_set_pending(hw_uart_t uart, const uint8_t* buf, uint32_t len);
+
+/**
+ * @brief Format a UART's transmit queue counters as key=value pairs
+ *
+ * queued: bytes not yet taken by the kernel; peak: most ever queued;
+ * waits: times uart_write() found the queue full; dropped: bytes lost to
+ * a closed or failed port; size: queue capacity.
+ */
+void uart_format_tx_stats(hw_uart_t uart, char* out, size_t out_len);
+
 #endif /* UART_X86_H */
@@ -0,0 +1,365 @@
+/**
+ * @file impair_x86.c
+ * @brief Link impairment stage for the simulated board UART
+ *
+ * Received bytes are impaired on the way in and then held in a delay queue
+ * until their delivery time. Delivery is always in order, as on a real
+ * UART: jitter stretches gaps between bytes but never reorders them.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "impair_x86.h"
+
+/*******************************************************************************
+ * Configuration
+ ******************************************************************************/
+#define QUEUE_LEN 4096
+#define MAX_SPEC_LEN 256
+
+/* Board link framing, as in application/include/messages.h */
+#define FRAME_HEADER_LEN 4
+#define BOUND_MAGIC 0x59
+#define BOUND_BITS 0x3F
+
+/* The challenge a pre-asking relay sends the fob; against random
+ * challenges no guess is better than another */
+#define PREASK_GUESS 0x00
+
+/*******************************************************************************
+ * File-local variables
+ ******************************************************************************/
+typedef struct
+{
+    double loss;
+    double dup;
+    double ber;
+    uint32_t delay_us;
+    uint32_t jitter_us;
+    uint32_t rate_bps;
+    double burst;
+    uint32_t burst_us;
+    uint32_t relay_us;
+    uint32_t preask;
+} impair_config_t;
+
+typedef struct
+{
+    uint64_t due_us;
+    uint8_t byte;
+} queued_byte_t;
+
+static impair_config_t config = { 0 };
+static impair_stats_t stats = { 0 };
+static uint64_t prng_state = 0x9E3779B97F4A7C15ULL;
+
+static queued_byte_t queue[QUEUE_LEN];
+static uint32_t queue_head = 0;
+static uint32_t queue_count = 0;
+static uint64_t last_due_us = 0;
+static uint64_t outage_until_us = 0;
+
+/* Received frames, followed for a pre-asking relay: how far into the
+ * current one, its length, and whether a BOUND frame has come (so this
+ * board answers rounds) with a challenge still to answer */
+static uint32_t rx_pos = 0;
+static uint32_t rx_len = 0;
+static uint8_t rx_magic = 0;
+static bool preask_fob = false;
+static int32_t preask_challenge = -1;
+
+/*******************************************************************************
+ * Internal helpers
+ ******************************************************************************/
+/* xorshift64* - small, fast and good enough for channel simulation */
+static uint64_t prng_next(void)
+{
+    prng_state ^= prng_state >> 12;
+    prng_state ^= prng_state << 25;
+    prng_state ^= prng_state >> 27;
+    return prng_state * 0x2545F4914F6CDD1DULL;
+}
+
+static double prng_uniform(void)
+{
+    return (double)(prng_next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static bool chance(double p)
+{
+    return (p > 0.0) && (prng_uniform() < p);
+}
+
+static void enqueue(uint8_t byte, uint64_t due_us)
+{
+    if (queue_count == QUEUE_LEN) {
+        stats.overflow++;
+        return;
+    }
+
+    queue[(queue_head + queue_count) % QUEUE_LEN] = (queued_byte_t){ due_us, byte };
+    queue_count++;
+}
+
+/* Follow received framing; true if the byte is a distance-bounding byte */
+static bool track_rx(uint8_t byte)
+{
+    if (rx_pos == 0) {
+        if ((byte & ~BOUND_BITS) == 0) {
+            return true;
+        }
+        rx_magic = byte;
+        rx_len = FRAME_HEADER_LEN + 1;
+    } else if (rx_pos == FRAME_HEADER_LEN - 1) {
+        rx_len = FRAME_HEADER_LEN + byte + 1;
+    }
+
+    if (++rx_pos == rx_len) {
+        rx_pos = 0;
+        if (rx_magic == BOUND_MAGIC) {
+            preask_fob = true;
+            preask_challenge = -1;
+        }
+    }
+    return false;
+}
+
+static bool parse_probability(const char* value, double* out)
+{
+    char* end;
+    double p = strtod(value, &end);
+    if (*end != '\0' || p < 0.0 || p > 1.0) {
+        return false;
+    }
+    *out = p;
+    return true;
+}
+
+static bool parse_u32(const char* value, uint32_t* out)
+{
+    char* end;
+    unsigned long v = strtoul(value, &end, 0);
+    if (*end != '\0' || value[0] == '-' || v > UINT32_MAX) {
+        return false;
+    }
+    *out = (uint32_t)v;
+    return true;
+}
+
+/*******************************************************************************
+ * Impairment API Implementation
+ ******************************************************************************/
+bool impair_configure(const char* spec)
+{
+    char copy[MAX_SPEC_LEN];
+    bool ok = true;
+
+    if (strlen(spec) >= sizeof(copy)) {
+        return false;
+    }
+    strcpy(copy, spec);
+
+    for (char* tok = strtok(copy, ", "); tok != NULL; tok = strtok(NULL, ", "))
+    {
+        if (strcmp(tok, "off") == 0) {
+            memset(&config, 0, sizeof(config));
+            continue;
+        }
+
+        char* value = strchr(tok, '=');
+        if (value == NULL) {
+            ok = false;
+            continue;
+        }
+        *value++ = '\0';
+
+        uint32_t seed;
+        if (strcmp(tok, "loss") == 0)          ok &= parse_probability(value, &config.loss);
+        else if (strcmp(tok, "dup") == 0)      ok &= parse_probability(value, &config.dup);
+        else if (strcmp(tok, "ber") == 0)      ok &= parse_probability(value, &config.ber);
+        else if (strcmp(tok, "delay") == 0)    ok &= parse_u32(value, &config.delay_us);
+        else if (strcmp(tok, "jitter") == 0)   ok &= parse_u32(value, &config.jitter_us);
+        else if (strcmp(tok, "rate") == 0)     ok &= parse_u32(value, &config.rate_bps);
+        else if (strcmp(tok, "burst") == 0)    ok &= parse_probability(value, &config.burst);
+        else if (strcmp(tok, "burst_us") == 0) ok &= parse_u32(value, &config.burst_us);
+        else if (strcmp(tok, "relay") == 0)    ok &= parse_u32(value, &config.relay_us);
+        else if (strcmp(tok, "preask") == 0)   ok &= parse_u32(value, &config.preask) && config.preask <= 1;
+        else if (strcmp(tok, "seed") == 0 && parse_u32(value, &seed)) {
+            /* xorshift must never be seeded with zero */
+            prng_state = ((uint64_t)seed << 32) ^ 0x9E3779B97F4A7C15ULL;
+        }
+        else ok = false;
+    }
+
+    return ok;
+}
+
+bool impair_enabled(void)
+{
+    return config.loss > 0.0 || config.dup > 0.0 || config.ber > 0.0 ||
+           config.delay_us > 0 || config.jitter_us > 0 || config.rate_bps > 0 ||
+           config.burst > 0.0 || config.relay_us > 0 || config.preask || queue_count > 0;
+}
+
+uint64_t impair_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+void impair_feed(uint8_t byte, uint64_t now_us)
+{
+    stats.in++;
+
+    /* Burst outage: everything is lost until it ends */
+    if (now_us < outage_until_us) {
+        stats.outage_drops++;
+        return;
+    }
+    if (config.burst_us > 0 && chance(config.burst)) {
+        stats.outages++;
+        stats.outage_drops++;
+        outage_until_us = now_us + config.burst_us;
+        return;
+    }
+
+    if (chance(config.loss)) {
+        stats.dropped++;
+        return;
+    }
+
+    if (config.ber > 0.0) {
+        uint8_t mask = 0;
+        for (int bit = 0; bit < 8; bit++) {
+            if (chance(config.ber)) {
+                mask |= (uint8_t)(1u << bit);
+                stats.bits_flipped++;
+            }
+        }
+        if (mask) {
+            byte ^= mask;
+            stats.corrupted++;
+        }
+    }
+
+    /* A pre-asking relay answers rounds itself; the fob gets its guess */
+    uint32_t relay_us = config.relay_us;
+    if (config.preask && track_rx(byte)) {
+        relay_us = 0;
+        if (preask_fob) {
+            preask_challenge = byte;
+            byte = PREASK_GUESS;
+            stats.preasked++;
+        }
+    }
+
+    int copies = chance(config.dup) ? 2 : 1;
+    stats.duplicated += (uint64_t)(copies - 1);
+    if (relay_us > 0) {
+        stats.relayed++;
+    }
+
+    for (int i = 0; i < copies; i++) {
+        uint64_t due_us = now_us + config.delay_us + relay_us;
+        if (config.jitter_us > 0) {
+            due_us += prng_next() % ((uint64_t)config.jitter_us + 1);
+        }
+        /* Keep bytes in order, and no closer together than the rate allows */
+        uint64_t spacing_us = config.rate_bps ? 1000000ULL / config.rate_bps : 0;
+        if (due_us < last_due_us + spacing_us) {
+            due_us = last_due_us + spacing_us;
+        }
+        last_due_us = due_us;
+
+        enqueue(byte, due_us);
+    }
+}
+
+void impair_transmit(uint8_t* buf, uint32_t len)
+{
+    /* Frames go out whole; a single bound byte is the fob's response */
+    if (!config.preask || len != 1 || (buf[0] & ~BOUND_BITS) != 0 || preask_challenge < 0) {
+        return;
+    }
+    buf[0] ^= (uint8_t)(PREASK_GUESS ^ preask_challenge);
+    preask_challenge = -1;
+}
+
+bool impair_ready(uint64_t now_us)
+{
+    return queue_count > 0 && queue[queue_head].due_us <= now_us;
+}
+
+int32_t impair_pop(uint64_t now_us)
+{
+    if (!impair_ready(now_us)) {
+        return -1;
+    }
+
+    uint8_t byte = queue[queue_head].byte;
+    queue_head = (queue_head + 1) % QUEUE_LEN;
+    queue_count--;
+    stats.delivered++;
+
+    return (int32_t)byte;
+}
+
+int64_t impair_next_due(uint64_t now_us)
+{
+    if (queue_count == 0) {
+        return -1;
+    }
+
+    uint64_t due_us = queue[queue_head].due_us;
+    return (due_us > now_us) ? (int64_t)(due_us - now_us) : 0;
+}
+
+uint32_t impair_peek(uint8_t* buf, uint32_t max)
+{
+    uint32_t n = (queue_count < max) ? queue_count : max;
+
+    for (uint32_t i = 0; i < n; i++) {
+        buf[i] = queue[(queue_head + i) % QUEUE_LEN].byte;
+    }
+
+    return n;
+}
+
+uint32_t impair_queued(void)
+{
+    return queue_count;
+}
+
+void impair_flush(void)
+{
+    queue_head = 0;
+    queue_count = 0;
+}
+
+void impair_get_stats(impair_stats_t* out)
+{
+    *out = stats;
+}
+
+void impair_reset_stats(void)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+void impair_format_stats(char* buf, size_t len)
+{
+    snprintf(buf, len,
+             "in=%llu,delivered=%llu,dropped=%llu,outage_drops=%llu,outages=%llu,"
+             "duplicated=%llu,corrupted=%llu,bits_flipped=%llu,overflow=%llu,relayed=%llu,"
+             "preasked=%llu",
+             (unsigned long long)stats.in, (unsigned long long)stats.delivered,
+             (unsigned long long)stats.dropped, (unsigned long long)stats.outage_drops,
+             (unsigned long long)stats.outages, (unsigned long long)stats.duplicated,
+             (unsigned long long)stats.corrupted, (unsigned long long)stats.bits_flipped,
+             (unsigned long long)stats.overflow, (unsigned long long)stats.relayed,
+             (unsigned long long)stats.preasked);
+}
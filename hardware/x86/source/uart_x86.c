@@ -17,16 +17,23 @@
 #include <fcntl.h>
 #include <termios.h>
 #include <errno.h>
+#include <sys/ioctl.h>
 #include <sys/select.h>
 #include <sys/time.h>
+#include <time.h>
 
 #include "uart.h"
+#include "uart_ring.h"
+#include "uart_x86.h"
+#include "impair_x86.h"
 
 /*******************************************************************************
  * Configuration
  ******************************************************************************/
 #define MAX_PATH_LEN 256
 #define UART_BAUD_RATE B115200
+#define RX_PENDING_LEN 256   /* at least as much as a snapshot can restore */
+#define TX_CLOSE_FLUSH_US 100000
 
 /*******************************************************************************
  * File-local variables
@@ -35,6 +42,17 @@ static int uart_fd[2] = { -1, -1 };
 static char host_path[MAX_PATH_LEN] = "";
 static char board_path[MAX_PATH_LEN] = "";
 
+/* Received bytes held in user space ahead of the fd (see uart_get_pending) */
+static uint8_t rx_pending[2][RX_PENDING_LEN];
+static uint32_t rx_pending_len[2] = { 0, 0 };
+static uint32_t rx_pending_pos[2] = { 0, 0 };
+
+/* Bytes queued for sending that the kernel has not taken yet (see tx_drain) */
+static uint8_t tx_data[2][UART_RING_SIZE];
+static uart_ring_t tx_ring[2] = { UART_RING_INIT(tx_data[0]), UART_RING_INIT(tx_data[1]) };
+static uint32_t tx_peak[2] = { 0, 0 };
+static uint32_t tx_waits[2] = { 0, 0 };
+
 /*******************************************************************************
  * Internal helpers
  ******************************************************************************/
@@ -87,6 +105,131 @@ static int configure_serial_port(int fd)
     return 0;
 }
 
+static uint64_t tx_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+/* Hand the kernel as much of a transmit queue as it takes without blocking.
+ * Bytes for a closed or failed port are dropped. */
+static void tx_drain(hw_uart_t uart)
+{
+    uart_ring_t* ring = &tx_ring[uart];
+
+    while (!uart_ring_empty(ring)) {
+        uint32_t queued = ring->head - ring->tail;
+        uint32_t start = ring->tail & (ring->size - 1);
+        uint32_t len = (queued < ring->size - start) ? queued : ring->size - start;
+
+        ssize_t n = (uart_fd[uart] >= 0) ? write(uart_fd[uart], &ring->data[start], len) : -1;
+        if (n > 0) {
+            ring->tail += (uint32_t)n;
+            continue;
+        }
+        if (uart_fd[uart] >= 0 && (n == 0 || errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            return;
+        }
+        if (uart_fd[uart] >= 0) {
+            perror("uart_write");
+        }
+        ring->dropped += queued;
+        ring->tail = ring->head;
+    }
+}
+
+static void tx_pump(void)
+{
+    tx_drain(HOST_UART);
+    tx_drain(BOARD_UART);
+}
+
+/* Wait for the kernel to take more of a transmit queue, at most tv (NULL
+ * for no limit) */
+static void tx_wait(hw_uart_t uart, struct timeval* tv)
+{
+    fd_set write_fds;
+
+    if (uart_fd[uart] < 0) {
+        return;
+    }
+    FD_ZERO(&write_fds);
+    FD_SET(uart_fd[uart], &write_fds);
+    select(uart_fd[uart] + 1, NULL, &write_fds, NULL, tv);
+}
+
+/* select() for fd becoming readable that sends queued bytes on both UARTs
+ * while it waits; tv, if given, is left holding the time remaining */
+static int wait_readable(int fd, struct timeval* tv)
+{
+    while (true) {
+        fd_set read_fds;
+        fd_set write_fds;
+        int max_fd = fd;
+
+        FD_ZERO(&read_fds);
+        FD_ZERO(&write_fds);
+        FD_SET(fd, &read_fds);
+        for (int u = 0; u < 2; u++) {
+            if (uart_fd[u] >= 0 && !uart_ring_empty(&tx_ring[u])) {
+                FD_SET(uart_fd[u], &write_fds);
+                max_fd = (uart_fd[u] > max_fd) ? uart_fd[u] : max_fd;
+            }
+        }
+
+        int result = select(max_fd + 1, &read_fds, &write_fds, NULL, tv);
+        if (result <= 0) {
+            return result;
+        }
+        tx_pump();
+        if (FD_ISSET(fd, &read_fds)) {
+            return result;
+        }
+    }
+}
+
+/* Move everything the kernel holds for the board UART into the impairment
+ * stage, stamped with its arrival time */
+static void impair_pull(void)
+{
+    uint8_t chunk[256];
+    ssize_t n;
+
+    if (uart_fd[BOARD_UART] < 0) {
+        return;
+    }
+
+    while ((n = read(uart_fd[BOARD_UART], chunk, sizeof(chunk))) > 0) {
+        uint64_t now = impair_now_us();
+        for (ssize_t i = 0; i < n; i++) {
+            impair_feed(chunk[i], now);
+        }
+    }
+}
+
+/* Blocking read of one byte through the impairment stage */
+static int32_t impair_readb(void)
+{
+    while (true) {
+        impair_pull();
+
+        uint64_t now = impair_now_us();
+        int32_t byte = impair_pop(now);
+        if (byte >= 0) {
+            return byte;
+        }
+
+        /* Sleep until the next byte is due or more data arrives */
+        int64_t wait_us = impair_next_due(now);
+        struct timeval tv = { .tv_sec = wait_us / 1000000, .tv_usec = wait_us % 1000000 };
+
+        if (wait_readable(uart_fd[BOARD_UART], (wait_us < 0) ? NULL : &tv) < 0 && errno != EINTR) {
+            return -1;
+        }
+    }
+}
+
 static int open_serial_port(const char* path)
 {
     if (path == NULL || path[0] == '\0') {
@@ -115,6 +258,7 @@ void uart_cleanup(void)
 {
     for (int i = 0; i < 2; i++) {
         if (uart_fd[i] >= 0) {
+            uart_flush((hw_uart_t)i, TX_CLOSE_FLUSH_US);
             close(uart_fd[i]);
             uart_fd[i] = -1;
         }
@@ -137,13 +281,23 @@ void uart_init(hw_uart_t uart, int argc, char ** argv)
             strncpy(path, argv[i] + strlen(matchStr), MAX_PATH_LEN - 1);
             path[MAX_PATH_LEN - 1] = '\0';
         }
+
+        /* Board link impairments, e.g. impair=loss=0.01,jitter=500,seed=3 */
+        if (uart == BOARD_UART && strncmp(argv[i], "impair=", 7) == 0)
+        {
+            if (!impair_configure(argv[i] + 7)) {
+                fprintf(stderr, "Warning: invalid impairment settings '%s'\n", argv[i] + 7);
+            }
+        }
     }
 
-    /* Close existing connection if any */
+    /* Close existing connection if any, once what was queued for it is out */
     if (uart_fd[uart] >= 0) {
+        uart_flush(uart, TX_CLOSE_FLUSH_US);
         close(uart_fd[uart]);
         uart_fd[uart] = -1;
     }
+    tx_ring[uart].tail = tx_ring[uart].head;
     
     /* Open the serial port */
     if (path[0] != '\0') {
@@ -155,11 +309,29 @@ void uart_init(hw_uart_t uart, int argc, char ** argv)
     }
 }
 
+/* The simulated link has no baud rate divider */
+void uart_reclock(hw_uart_t uart)
+{
+}
+
 bool uart_avail(hw_uart_t uart)
 {
+    /* The firmware polls here from its main loop, so queued bytes go out
+     * from here too */
+    tx_pump();
+
+    if (rx_pending_pos[uart] < rx_pending_len[uart]) {
+        return true;
+    }
+
     if (uart_fd[uart] < 0) {
         return false;
     }
+
+    if (uart == BOARD_UART && impair_enabled()) {
+        impair_pull();
+        return impair_ready(impair_now_us());
+    }
     
     fd_set read_fds;
     struct timeval tv = { .tv_sec = 0, .tv_usec = 0 };
@@ -174,19 +346,22 @@ bool uart_avail(hw_uart_t uart)
 
 int32_t uart_readb(hw_uart_t uart)
 {
+    if (rx_pending_pos[uart] < rx_pending_len[uart]) {
+        return (int32_t)rx_pending[uart][rx_pending_pos[uart]++];
+    }
+
     if (uart_fd[uart] < 0) {
         return -1;
     }
+
+    if (uart == BOARD_UART && impair_enabled()) {
+        return impair_readb();
+    }
     
     uint8_t byte;
     
     /* Block until a byte is available */
-    fd_set read_fds;
-    FD_ZERO(&read_fds);
-    FD_SET(uart_fd[uart], &read_fds);
-    
-    /* Wait indefinitely for data */
-    int result = select(uart_fd[uart] + 1, &read_fds, NULL, NULL, NULL);
+    int result = wait_readable(uart_fd[uart], NULL);
     if (result <= 0) {
         return -1;
     }
@@ -246,47 +421,97 @@ uint32_t uart_readline(hw_uart_t uart, uint8_t* buf)
 
 void uart_writeb(hw_uart_t uart, uint8_t data)
 {
-    if (uart_fd[uart] < 0) {
-        return;
+    uart_write(uart, &data, 1);
+}
+
+uint32_t uart_write(hw_uart_t uart, uint8_t* buf, uint32_t len)
+{
+    if (uart_fd[uart] < 0 || buf == NULL) {
+        return 0;
     }
-    
-    ssize_t written = 0;
-    while (written < 1) {
-        ssize_t n = write(uart_fd[uart], &data, 1);
-        if (n > 0) {
-            written += n;
-        } else if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
-            perror("uart_writeb");
-            return;
+
+    if (uart == BOARD_UART && impair_enabled()) {
+        impair_transmit(buf, len);
+    }
+
+    uint32_t total_written = uart_write_async(uart, buf, len);
+
+    while (total_written < len) {
+        /* The queue is full: wait for the kernel to take some of it */
+        tx_waits[uart]++;
+        tx_wait(uart, NULL);
+        tx_drain(uart);
+
+        uint32_t n = uart_write_async(uart, buf + total_written, len - total_written);
+        if (n == 0 && uart_ring_empty(&tx_ring[uart])) {
+            break;      /* the port failed */
         }
-        /* If EAGAIN, we retry */
+        total_written += n;
     }
+
+    return total_written;
 }
 
-uint32_t uart_write(hw_uart_t uart, uint8_t* buf, uint32_t len)
+uint32_t uart_write_async(hw_uart_t uart, const uint8_t* buf, uint32_t len)
 {
+    uart_ring_t* ring = &tx_ring[uart];
+    uint32_t queued = 0;
+
     if (uart_fd[uart] < 0 || buf == NULL) {
         return 0;
     }
-    
-    uint32_t total_written = 0;
-    
-    while (total_written < len) {
-        ssize_t n = write(uart_fd[uart], buf + total_written, len - total_written);
+
+    /* With nothing queued ahead, whatever the kernel takes now skips the ring */
+    if (uart_ring_empty(ring)) {
+        ssize_t n = write(uart_fd[uart], buf, len);
         if (n > 0) {
-            total_written += n;
-        } else if (n < 0) {
-            if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                /* Non-blocking write would block, retry */
-                usleep(100);
-                continue;
-            }
+            queued = (uint32_t)n;
+        } else if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
             perror("uart_write");
-            break;
+            return 0;
         }
     }
-    
-    return total_written;
+
+    while (queued < len && uart_ring_free(ring) > 0) {
+        uart_ring_put(ring, buf[queued++]);
+    }
+
+    if (ring->head - ring->tail > tx_peak[uart]) {
+        tx_peak[uart] = ring->head - ring->tail;
+    }
+    return queued;
+}
+
+uint32_t uart_tx_free(hw_uart_t uart)
+{
+    return uart_ring_free(&tx_ring[uart]);
+}
+
+/* On x86 a byte is sent once the kernel has it */
+bool uart_flush(hw_uart_t uart, uint32_t timeout_us)
+{
+    uint64_t deadline = tx_now_us() + timeout_us;
+
+    tx_drain(uart);
+    while (!uart_ring_empty(&tx_ring[uart])) {
+        uint64_t now = tx_now_us();
+        if (now >= deadline) {
+            return false;
+        }
+        struct timeval tv = { .tv_sec = (deadline - now) / 1000000, .tv_usec = (deadline - now) % 1000000 };
+        tx_wait(uart, &tv);
+        tx_drain(uart);
+    }
+    return true;
+}
+
+void uart_format_tx_stats(hw_uart_t uart, char* out, size_t out_len)
+{
+    const uart_ring_t* ring = &tx_ring[uart];
+
+    snprintf(out, out_len, "queued=%u,peak=%u,waits=%u,dropped=%u,size=%u",
+             ring->head - ring->tail, tx_peak[uart], tx_waits[uart], ring->dropped,
+             (unsigned)ring->size);
 }
 
 /*******************************************************************************
@@ -298,11 +523,13 @@ bool uart_reconnect_board(const char* new_path)
         return false;
     }
     
-    /* Close existing board connection if open */
+    /* Close existing board connection if open; what was queued for it is
+     * not for the new one */
     if (uart_fd[BOARD_UART] >= 0) {
         close(uart_fd[BOARD_UART]);
         uart_fd[BOARD_UART] = -1;
     }
+    tx_ring[BOARD_UART].tail = tx_ring[BOARD_UART].head;
     
     /* Update path and reopen */
     strncpy(board_path, new_path, MAX_PATH_LEN - 1);
@@ -322,3 +549,68 @@ const char* uart_get_host_path(void)
 {
     return host_path;
 }
+
+/*******************************************************************************
+ * Receive-side state capture (for device snapshots)
+ ******************************************************************************/
+uint32_t uart_get_pending(hw_uart_t uart, uint8_t* buf, uint32_t max)
+{
+    /* Compact what is left of the pending buffer to the front */
+    uint32_t len = rx_pending_len[uart] - rx_pending_pos[uart];
+    memmove(rx_pending[uart], &rx_pending[uart][rx_pending_pos[uart]], len);
+    rx_pending_pos[uart] = 0;
+
+    /* Pull whatever the kernel is holding into user space so it can be copied
+     * out without being consumed. On an impaired link it goes into the
+     * impairment stage, as the next read would have put it */
+    uint32_t queued = 0;
+    bool impaired = (uart == BOARD_UART && impair_enabled());
+    if (impaired) {
+        impair_pull();
+        queued = impair_queued();
+    } else if (uart_fd[uart] >= 0) {
+        if (len < RX_PENDING_LEN) {
+            ssize_t n = read(uart_fd[uart], &rx_pending[uart][len], RX_PENDING_LEN - len);
+            if (n > 0) {
+                len += (uint32_t)n;
+            }
+        }
+        int more = 0;
+        if (ioctl(uart_fd[uart], FIONREAD, &more) == 0 && more > 0) {
+            queued = (uint32_t)more;
+        }
+    }
+    rx_pending_len[uart] = len;
+
+    uint32_t n = (len < max) ? len : max;
+    memcpy(buf, rx_pending[uart], n);
+
+    /* Bytes still in the impairment stage are received but not yet due;
+     * they are copied without being moved, so their delays still apply */
+    if (impaired && n == len) {
+        impair_peek(&buf[n], max - n);
+    }
+
+    return len + queued;
+}
+
+bool uart_set_pending(hw_uart_t uart, const uint8_t* buf, uint32_t len)
+{
+    if (len > RX_PENDING_LEN) {
+        return false;
+    }
+
+    /* Anything already received is replaced by the restored bytes */
+    if (uart_fd[uart] >= 0) {
+        tcflush(uart_fd[uart], TCIFLUSH);
+    }
+    if (uart == BOARD_UART) {
+        impair_flush();
+    }
+
+    memcpy(rx_pending[uart], buf, len);
+    rx_pending_len[uart] = len;
+    rx_pending_pos[uart] = 0;
+
+    return true;
+}
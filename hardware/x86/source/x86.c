@@ -7,10 +7,14 @@
 #include <unistd.h>             // For getcwd, access, execv
 #include <string.h>             // For strncpy, memcpy
 #include <signal.h>             // For signal, SIGTERM, SIGINT
+#include <setjmp.h>             // For setjmp, longjmp
+#include <time.h>               // For clock_gettime
 
 #include "platform.h"
 #include "uart.h"
 #include "uart_x86.h"
+#include "impair_x86.h"
+#include "hexCodec.h"
 
 // Defines
 #ifndef UNLOCK_FLAG
@@ -34,7 +38,66 @@ const char* FLASH_DATA_FILENAME = "flash_data.bin";
 // Private variables
 static char flash_data_file_path[PATH_MAX] = "";
 
+// Store argv[0] for re-exec
+static char *g_exe_path = NULL;
+static char **g_argv = NULL;
+
+// Warm restart state: softwareReset() longjmps back into __wrap_main, which
+// re-enters the application's main without reopening UARTs or re-exec'ing
+static jmp_buf g_warm_restart;
+static bool g_warm_boot = false;
+static bool g_cold_restart = false;
+
+// Restart timing: softwareReset() stamps the monotonic clock and the next
+// initHardware_car/_fob() reports how long getting back up took. A cold
+// restart carries the stamp across execv in the environment.
+#define RESTART_STAMP_ENV "X86_RESTART_NS"
+static uint64_t g_restart_start_ns = 0;
+static uint64_t g_restart_us = 0;
+static bool g_restart_was_cold = false;
+
+// Board link settings: addr=<n> and bus=shared on the command line
+#ifdef BOARD_ADDR
+static uint8_t g_board_addr = BOARD_ADDR;
+#else
+static uint8_t g_board_addr = 0x10;
+#endif
+#ifdef SHARED_BOARD_BUS
+static bool g_board_shared = true;
+#else
+static bool g_board_shared = false;
+#endif
+
+// Clock profile: the simulator runs at host speed whatever the profile, so
+// the profile is only recorded and clockHz() reports 0
+static clock_profile_t g_clock_profile = CLOCK_PROFILE;
+static const char *const g_clock_names[CLOCK_PROFILE_COUNT] = {
+    [CLOCK_PERFORMANCE] = "performance",
+    [CLOCK_BALANCED] = "balanced",
+    [CLOCK_LOW_POWER] = "low_power",
+};
+
+// Provided by the linker (-Wl,--wrap=main); this is the application's main()
+int __real_main(int argc, char **argv);
+void platform_save_argv(int argc, char **argv);
+
 // Function implementations
+static uint64_t monotonic_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Called once the application's hardware is back up after a restart
+static void restart_done(void)
+{
+    if (g_restart_start_ns != 0) {
+        g_restart_us = (monotonic_ns() - g_restart_start_ns) / 1000;
+        g_restart_start_ns = 0;
+    }
+}
+
 static void signal_handler(int sig)
 {
     //(void)sig;
@@ -67,6 +130,15 @@ static void setup_flash_data_file_path(const char* argv0)
 
 static void initHardware(int argc, char ** argv)
 {
+    /* A restart boots with the build's clock profile, as a reset would */
+    g_clock_profile = CLOCK_PROFILE;
+
+    /* Warm restart: UART fds, signal handlers and the state file path are
+     * still valid from the previous boot, so there is nothing to reopen */
+    if (g_warm_boot) {
+        return;
+    }
+
     /* Set up state file path based on executable location */
     if (argc > 0 && argv[0] != NULL) {
         setup_flash_data_file_path(argv[0]);
@@ -74,6 +146,22 @@ static void initHardware(int argc, char ** argv)
         setup_flash_data_file_path("./");
     }
     
+    /* Board link address and medium */
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "addr=", 5) == 0) {
+            /* 0 is never assigned, 0x01 is the car and 0xFF is broadcast */
+            char *end;
+            unsigned long addr = strtoul(argv[i] + 5, &end, 0);
+            if (end == argv[i] + 5 || *end != '\0' || addr < 0x02 || addr > 0xFE) {
+                fprintf(stderr, "Invalid board link address '%s' (0x02-0xFE)\n", argv[i] + 5);
+                exit(EXIT_FAILURE);
+            }
+            g_board_addr = (uint8_t)addr;
+        } else if (strcmp(argv[i], "bus=shared") == 0) {
+            g_board_shared = true;
+        }
+    }
+
     /* Set up signal handlers for clean shutdown */
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
@@ -87,6 +175,7 @@ void initHardware_car(int argc, char ** argv)
 {
     initHardware(argc, argv);
     setLED(RED);
+    restart_done();
 }
 
 static void create_default_fob_state(void)
@@ -120,6 +209,7 @@ void initHardware_fob(int argc, char ** argv)
     FLASH_DATA data;
     loadFobState(&data);
     setLED(WHITE); 
+    restart_done();
 }
 
 void loadFlag(uint8_t* dest, flag_t flag)
@@ -170,21 +260,307 @@ bool buttonPressed(void)
     return false;
 }
 
-// Store argv[0] for re-exec
-static char *g_exe_path = NULL;
-static char **g_argv = NULL;
+uint8_t boardLinkAddress(void)
+{
+    return g_board_addr;
+}
 
-// Call this from initHardware to save the executable path
+bool boardLinkShared(void)
+{
+    return g_board_shared;
+}
+
+void delayUs(uint32_t us)
+{
+    usleep(us);
+}
+
+uint32_t timeUs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u);
+}
+
+/**
+ * @brief Nanoseconds of CLOCK_MONOTONIC_RAW, wrapping at 2^32
+ *
+ * x86 has no fixed core clock (clockHz() is 0), so the cycle counter counts
+ * nanoseconds, unslewed by NTP.
+ */
+uint32_t cycleCount(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec);
+}
+
+bool setClockProfile(clock_profile_t profile)
+{
+    if (profile >= CLOCK_PROFILE_COUNT) {
+        return false;
+    }
+    g_clock_profile = profile;
+    return true;
+}
+
+clock_profile_t clockProfile(void)
+{
+    return g_clock_profile;
+}
+
+uint32_t clockHz(void)
+{
+    return 0;
+}
+
+// Called from __wrap_main to save the executable path for a cold restart
 void platform_save_argv(int argc, char **argv)
 {
     g_exe_path = argv[0];
     g_argv = argv;
+
+    /* "restart=cold" selects the old re-exec behaviour for softwareReset() */
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "restart=cold") == 0) {
+            g_cold_restart = true;
+        }
+    }
+
+    /* Re-exec'd by a cold restart: pick up when it started */
+    const char *stamp = getenv(RESTART_STAMP_ENV);
+    if (stamp != NULL) {
+        g_restart_start_ns = strtoull(stamp, NULL, 10);
+        g_restart_was_cold = true;
+        unsetenv(RESTART_STAMP_ENV);
+    }
+}
+
+/**
+ * @brief Process entry point; wraps the application's main()
+ *
+ * The x86 build links with -Wl,--wrap=main so that the C runtime enters here
+ * first. The jump buffer set up below is the target of a warm restart: the
+ * application's main() is simply called again, in the same process, with the
+ * same arguments and with all open UART file descriptors left untouched.
+ */
+int __wrap_main(int argc, char **argv)
+{
+    platform_save_argv(argc, argv);
+
+    if (setjmp(g_warm_restart) != 0) {
+        g_warm_boot = true;
+    }
+
+    return __real_main(argc, argv);
+}
+
+/**
+ * @brief Append platform state to a device snapshot
+ *
+ * Layout: [n] [n bytes received on the board UART but not yet read]
+ *
+ * @return bytes appended, or SNAPSHOT_NO_ROOM if more bytes are pending
+ * than fit; none are dropped to make them fit
+ */
+uint32_t snapshotPlatform(uint8_t *dest, uint32_t max)
+{
+    if (max < 1) {
+        return SNAPSHOT_NO_ROOM;
+    }
+
+    uint32_t room = (max - 1 > 255) ? 255 : max - 1;
+    uint32_t n = uart_get_pending(BOARD_UART, &dest[1], room);
+    if (n > room) {
+        return SNAPSHOT_NO_ROOM;
+    }
+
+    dest[0] = (uint8_t)n;
+    return 1 + n;
+}
+
+bool restorePlatform(const uint8_t *src, uint32_t len)
+{
+    if (len < 1 || src[0] != len - 1) {
+        return false;
+    }
+
+    return uart_set_pending(BOARD_UART, &src[1], src[0]);
+}
+
+static void reply(const char *msg)
+{
+    uart_write(HOST_UART, (uint8_t *)msg, strlen(msg));
+}
+
+/*******************************************************************************
+ * Hex codec benchmark
+ ******************************************************************************/
+#define HEX_BENCH_MAX 65536
+#define HEX_BENCH_NS 20000000ULL   // run each case for about 20 ms
+
+
+/**
+ * @brief Time the scalar and dispatched hex codecs on len random bytes
+ *
+ * Output is key=value pairs; rates are MB/s of binary data.
+ *
+ * @return false if the two implementations disagree
+ */
+static bool hex_bench(size_t len, char *out, size_t out_len)
+{
+    static uint8_t data[HEX_BENCH_MAX];
+    static uint8_t back[HEX_BENCH_MAX];
+    static char hex[HEX_BENCH_MAX * 2 + 1];
+    static char ref[HEX_BENCH_MAX * 2 + 1];
+    double mbps[4];
+
+    uint32_t x = 0x12345678;
+    for (size_t i = 0; i < len; i++) {
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        data[i] = (uint8_t)x;
+    }
+
+    // Both paths must agree before their speed means anything; check mixed
+    // case input too
+    bytesToHexScalar(data, len, ref);
+    bytesToHex(data, len, hex);
+    if (strcmp(hex, ref) != 0) return false;
+    for (size_t i = 0; i < len * 2; i += 3) {
+        if (ref[i] >= 'a') ref[i] -= 'a' - 'A';
+    }
+    if (hexToBytes(ref, back, len) != (int)len || memcmp(back, data, len) != 0) return false;
+
+    for (int c = 0; c < 4; c++) {
+        uint64_t start = monotonic_ns();
+        uint64_t elapsed;
+        uint64_t iters = 0;
+        do {
+            for (int k = 0; k < 16; k++) {
+                switch (c) {
+                case 0: bytesToHexScalar(data, len, hex); break;
+                case 1: bytesToHex(data, len, hex); break;
+                case 2: hexToBytesScalar(hex, len * 2, back, len); break;
+                default: hexToBytesN(hex, len * 2, back, len); break;
+                }
+            }
+            iters += 16;
+            elapsed = monotonic_ns() - start;
+        } while (elapsed < HEX_BENCH_NS);
+        mbps[c] = (double)(iters * len) * 1000.0 / (double)elapsed;
+    }
+
+    snprintf(out, out_len,
+             "impl=%s,bytes=%zu,encode_scalar=%.0f,encode=%.0f,decode_scalar=%.0f,decode=%.0f",
+             hexCodecImpl(), len, mbps[0], mbps[1], mbps[2], mbps[3]);
+    return true;
+}
+
+/**
+ * @brief Handle x86-only test commands
+ *
+ *   impair <settings>  - change board link impairments (see impair_x86.h)
+ *   impairStats        - report impairment counters
+ *   impairReset        - zero impairment counters
+ *   hexBench [bytes]   - benchmark the hex codec (scalar vs SIMD)
+ *   uartStats          - report the host UART's transmit queue counters
+ *   clock [profile]    - report, or switch, the clock profile
+ *   restart cold       - re-exec the process, as the restart=cold build does
+ *   restartStats       - report how long the last restart took, in us
+ *
+ * @return true if the command was handled (and answered)
+ */
+bool processPlatformCommand(const char *cmd)
+{
+    char stats[320];
+    char buf[336];
+
+    if (strncmp(cmd, "impair ", 7) == 0) {
+        reply(impair_configure(cmd + 7) ? "OK\n" : "ERROR: invalid impairment\n");
+        return true;
+    }
+
+    if (strcmp(cmd, "impairStats") == 0) {
+        impair_format_stats(stats, sizeof(stats));
+        snprintf(buf, sizeof(buf), "OK: %s\n", stats);
+        reply(buf);
+        return true;
+    }
+
+    if (strcmp(cmd, "impairReset") == 0) {
+        impair_reset_stats();
+        reply("OK\n");
+        return true;
+    }
+
+    if (strcmp(cmd, "uartStats") == 0) {
+        uart_format_tx_stats(HOST_UART, stats, sizeof(stats));
+        snprintf(buf, sizeof(buf), "OK: %s\n", stats);
+        reply(buf);
+        return true;
+    }
+
+    if (strncmp(cmd, "clock", 5) == 0 && (cmd[5] == '\0' || cmd[5] == ' ')) {
+        int profile = 0;
+        if (cmd[5] == ' ') {
+            while (profile < CLOCK_PROFILE_COUNT && strcmp(cmd + 6, g_clock_names[profile]) != 0) {
+                profile++;
+            }
+            if (!setClockProfile((clock_profile_t)profile)) {
+                reply("ERROR: invalid clock profile\n");
+                return true;
+            }
+        }
+        snprintf(buf, sizeof(buf), "OK: profile=%s,hz=%lu\n",
+                 g_clock_names[g_clock_profile], (unsigned long)clockHz());
+        reply(buf);
+        return true;
+    }
+
+    if (strncmp(cmd, "hexBench", 8) == 0 && (cmd[8] == '\0' || cmd[8] == ' ')) {
+        unsigned long len = cmd[8] ? strtoul(cmd + 9, NULL, 0) : 4096;
+        if (len == 0 || len > HEX_BENCH_MAX) {
+            reply("ERROR: invalid size\n");
+        } else if (!hex_bench(len, stats, sizeof(stats))) {
+            reply("ERROR: implementations disagree\n");
+        } else {
+            snprintf(buf, sizeof(buf), "OK: %s\n", stats);
+            reply(buf);
+        }
+        return true;
+    }
+
+    /* Answered by the application's "OK: started" once it is back up */
+    if (strcmp(cmd, "restart cold") == 0) {
+        g_cold_restart = true;
+        softwareReset();
+    }
+
+    if (strcmp(cmd, "restartStats") == 0) {
+        snprintf(buf, sizeof(buf), "OK: us=%llu,kind=%s\n",
+                 (unsigned long long)g_restart_us, g_restart_was_cold ? "cold" : "warm");
+        reply(buf);
+        return true;
+    }
+
+    return false;
 }
 
 void softwareReset(void)
 {
-    // Re-exec ourselves with same arguments
-    // This effectively restarts the process
+    g_restart_start_ns = monotonic_ns();
+
+    if (!g_cold_restart) {
+        // Warm restart: unwind the application's stack and re-enter its main()
+        g_restart_was_cold = false;
+        longjmp(g_warm_restart, 1);
+    }
+
+    // Cold restart: re-exec ourselves with same arguments
+    char stamp[24];
+    snprintf(stamp, sizeof(stamp), "%llu", (unsigned long long)g_restart_start_ns);
+    setenv(RESTART_STAMP_ENV, stamp, 1);
+    uart_cleanup();
     if (g_exe_path && g_argv) execv(g_exe_path, g_argv);
 
     // If execv fails, just exit
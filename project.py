@@ -18,6 +18,7 @@ from typing import List, Optional
 AVAILABLE_PLATFORMS = ["stm32", "tm4c", "x86"]  # Update with your actual platforms
 AVAILABLE_ROLES = ["car", "paired_fob", "unpaired_fob"]  # Update with your actual roles
 HOST_TOOLS_DIR = Path("host_tools")  # Adjust to your project structure
+BOOT_TOOL = Path("tools") / "boot_tool.py"
 #BUILD_DIR = Path(f"hardware/{args.platform}/build")  # Adjust to your build output directory
 
 
@@ -89,7 +90,10 @@ def run_scons(build_configs: List[List[str]], clean: bool = False, dry_run: bool
 def build_scons_args(platform: str, role: str, id_val: Optional[str] = None, 
                      pin: Optional[str] = None, unlock_flag: Optional[str] = None,
                      feature1_flag: Optional[str] = None, feature2_flag: Optional[str] = None,
-                     feature3_flag: Optional[str] = None, test_build: bool = False) -> List[str]:
+                     feature3_flag: Optional[str] = None, test_build: bool = False,
+                     shared_bus: bool = False, dsp_tables: str = "flash",
+                     clock: str = "performance", bootloader: bool = False,
+                     addr: Optional[str] = None) -> List[str]:
     """
     Build a list of SCons arguments for a single configuration.
     
@@ -102,6 +106,12 @@ def build_scons_args(platform: str, role: str, id_val: Optional[str] = None,
         feature1_flag: Optional custom feature 1 flag value
         feature2_flag: Optional custom feature 2 flag value
         feature3_flag: Optional custom feature 3 flag value
+        test_build: Enable test commands in firmware
+        shared_bus: Build for a shared multi-drop board bus
+        dsp_tables: Where the CMSIS-DSP floating-point FFT tables live, flash or ram
+        clock: Clock profile at boot: performance, balanced or low_power
+        bootloader: Link behind the resident UART bootloader
+        addr: Optional fob board link address, for boards with no unique ID
     
     Returns:
         List of argument strings for SCons
@@ -124,6 +134,16 @@ def build_scons_args(platform: str, role: str, id_val: Optional[str] = None,
         args.append(f"feature3_flag={feature3_flag}")
     if test_build:
         args.append("test=1")
+    if shared_bus:
+        args.append("shared_bus=1")
+    if dsp_tables != "flash":
+        args.append(f"dsp_tables={dsp_tables}")
+    if clock != "performance":
+        args.append(f"clock={clock}")
+    if bootloader:
+        args.append("bootloader=1")
+    if addr:
+        args.append(f"addr={addr}")
     
     return args
 
@@ -159,36 +179,64 @@ def get_build_configs_for_target(args) -> List[List[str]]:
                 if role == "paired_fob":
                     configs.append(build_scons_args(platform, role, args.id, args.pin,
                                                    unlock_flag, feature1_flag, feature2_flag, feature3_flag,
-                                                   getattr(args, 'test_build', False)))
+                                                   getattr(args, 'test_build', False),
+                                                   getattr(args, 'shared_bus', False),
+                                                   getattr(args, 'dsp_tables', 'flash'),
+                                                   getattr(args, 'clock', 'performance'),
+                                                   getattr(args, 'bootloader', False),
+                                                   getattr(args, 'addr', None)))
                 elif role == "car":
                     configs.append(build_scons_args(platform, role, args.id, None,
                                                    unlock_flag, feature1_flag, feature2_flag, feature3_flag,
-                                                   getattr(args, 'test_build', False)))
+                                                   getattr(args, 'test_build', False),
+                                                   getattr(args, 'shared_bus', False),
+                                                   getattr(args, 'dsp_tables', 'flash'),
+                                                   getattr(args, 'clock', 'performance'),
+                                                   getattr(args, 'bootloader', False)))
                 else:  # unpaired_fob
                     configs.append(build_scons_args(platform, role, None, None,
                                                    unlock_flag, feature1_flag, feature2_flag, feature3_flag,
-                                                   getattr(args, 'test_build', False)))
+                                                   getattr(args, 'test_build', False),
+                                                   getattr(args, 'shared_bus', False),
+                                                   getattr(args, 'dsp_tables', 'flash'),
+                                                   getattr(args, 'clock', 'performance'),
+                                                   getattr(args, 'bootloader', False),
+                                                   getattr(args, 'addr', None)))
         return configs
     
     # Pattern 2: car + id + platform
     if args.role == "car" and hasattr(args, 'id') and args.id and args.platform:
         configs.append(build_scons_args(args.platform, "car", args.id, None,
                                        unlock_flag, feature1_flag, feature2_flag, feature3_flag,
-                                       getattr(args, 'test_build', False)))
+                                       getattr(args, 'test_build', False),
+                                       getattr(args, 'shared_bus', False),
+                                       getattr(args, 'dsp_tables', 'flash'),
+                                       getattr(args, 'clock', 'performance'),
+                                       getattr(args, 'bootloader', False)))
         return configs
     
     # Pattern 3: paired_fob + id + pin + platform
     if args.role == "paired_fob" and hasattr(args, 'id') and args.id and hasattr(args, 'pin') and args.pin and args.platform:
         configs.append(build_scons_args(args.platform, "paired_fob", args.id, args.pin,
                                        unlock_flag, feature1_flag, feature2_flag, feature3_flag,
-                                       getattr(args, 'test_build', False)))
+                                       getattr(args, 'test_build', False),
+                                       getattr(args, 'shared_bus', False),
+                                       getattr(args, 'dsp_tables', 'flash'),
+                                       getattr(args, 'clock', 'performance'),
+                                       getattr(args, 'bootloader', False),
+                                       getattr(args, 'addr', None)))
         return configs
     
     # Pattern 4: unpaired_fob + platform
     if args.role == "unpaired_fob" and args.platform:
         configs.append(build_scons_args(args.platform, "unpaired_fob", None, None,
                                        unlock_flag, feature1_flag, feature2_flag, feature3_flag,
-                                       getattr(args, 'test_build', False)))
+                                       getattr(args, 'test_build', False),
+                                       getattr(args, 'shared_bus', False),
+                                       getattr(args, 'dsp_tables', 'flash'),
+                                       getattr(args, 'clock', 'performance'),
+                                       getattr(args, 'bootloader', False),
+                                       getattr(args, 'addr', None)))
         return configs
     
     # Pattern 5: No arguments (clean only) -> clean all
@@ -423,32 +471,71 @@ def clean_command(args):
 
 def flash_command(args):
     """Handle the flash subcommand"""
-    if not args.role or not args.platform:
-        print_error("flash requires --role and --platform arguments")
+    bin_path = getattr(args, 'bin', None)
+    if not args.platform or not (args.role or bin_path):
+        print_error("flash requires --platform and either --role or --bin")
         return 1
-    
-    print_info(f"Flashing {args.role} to {args.platform}...")
-    
-    # TODO: Implement actual flashing logic
-    # This might involve:
-    # 1. Finding the built executable
-    # 2. Detecting or using specified serial port
-    # 3. Calling appropriate flash tool (avrdude, openocd, etc.)
-    
-    flash_cmd = ["echo", "Flash command not yet implemented"]
-    if args.port:
-        flash_cmd.append(f"(port: {args.port})")
-    
-    result = subprocess.run(flash_cmd)
-    
+
+    if args.platform == "x86":
+        print_info("x86 builds run from their build folder; nothing to flash")
+        return 0
+
+    if not args.port:
+        print_error("flash requires --port, the board's host UART")
+        return 1
+
+    # Updates go through the resident bootloader (project.py boot), so the
+    # image must have been built with --bootloader
+    if bin_path:
+        binary = Path(bin_path)
+    else:
+        folder = f"{args.role}_{args.id}" if getattr(args, 'id', None) else args.role
+        binary = Path("hardware") / args.platform / "build" / folder / folder
+    if not binary.exists():
+        print_error(f"No image at {binary}; build it first")
+        return 1
+
+    print_info(f"Flashing {binary} to {args.platform} on {args.port}...")
+
+    cmd = [sys.executable, str(BOOT_TOOL), "--port", args.port, "--bin", str(binary)]
+    if getattr(args, 'keep_state', False):
+        cmd.append("--keep-state")
+
+    if args.dry_run:
+        print_info(f"Would run: {' '.join(cmd)}")
+        return 0
+    result = subprocess.run(cmd)
+
     if result.returncode == 0:
-        print_success(f"Successfully flashed {args.role} to {args.platform}")
+        print_success(f"Successfully flashed {binary.name} to {args.platform}")
     else:
         print_error("Flash failed!")
-    
+
     return result.returncode
 
 
+# ==============================================================================
+# BOOT COMMAND
+# ==============================================================================
+
+def boot_command(args):
+    """Handle the boot subcommand: build the resident UART bootloader"""
+    print_info(f"Building the {args.platform} bootloader...")
+
+    result = run_scons([[f"boot={args.platform}"]], dry_run=args.dry_run)
+    if result != 0:
+        print_error("Build failed!")
+        return result
+
+    exe = Path("hardware") / args.platform / "build" / "bootloader" / f"boot_{args.platform}"
+    if args.platform == "x86":
+        print_success(f"Built {exe}; run it with host=<tty> [flash=<file>]")
+    else:
+        print_success(f"Built {exe}; program it once with the debug probe, then "
+                      f"build applications with --bootloader")
+    return 0
+
+
 # ==============================================================================
 # RUN COMMAND
 # ==============================================================================
@@ -484,6 +571,42 @@ def run_command(args):
         return 1
 
 
+# ==============================================================================
+# BENCH COMMAND
+# ==============================================================================
+
+def bench_command(args):
+    """Handle the bench subcommand"""
+    print_info(f"Building {args.suite} benchmark...")
+
+    result = run_scons([[f"bench={args.suite}", f"dsp_backend={args.dsp_backend}",
+                         f"nn_backend={args.nn_backend}"]],
+                       dry_run=args.dry_run)
+    if result != 0:
+        print_error("Build failed!")
+        return result
+    if args.dry_run:
+        return 0
+
+    exe = Path("hardware/x86/build") / f"bench_{args.suite}" / f"{args.suite}_bench"
+    cmd = [str(exe), "--min-ms", str(args.min_ms)]
+    if args.filter:
+        cmd += ["--filter", args.filter]
+    if args.json:
+        cmd += ["--json", args.json]
+
+    print_info(f"Running: {' '.join(cmd)}")
+    result = subprocess.run(cmd)
+
+    if result.returncode == 0:
+        if args.json:
+            print_success(f"Results written to {args.json}")
+    else:
+        print_error("Benchmark reported failures!")
+
+    return result.returncode
+
+
 # ==============================================================================
 # PACKAGE COMMAND
 # ==============================================================================
@@ -668,6 +791,9 @@ def deploy_command(args):
         return 1
     
     print_info(f"Deploying {args.role} to {args.platform}...")
+
+    # Flashing goes through the bootloader, so link behind it
+    args.bootloader = args.platform != "x86"
     
     # First, build
     print_info("Step 1: Building...")
@@ -802,6 +928,17 @@ def main():
                              help="Custom feature 3 flag value")
     build_parser.add_argument("--test-build", action="store_true", dest="test_build",
                              help="Enable test commands in firmware")
+    build_parser.add_argument("--shared-bus", action="store_true", dest="shared_bus",
+                             help="Board link is a shared multi-drop bus (open-drain, addressed frames)")
+    build_parser.add_argument("--dsp-tables", choices=["flash", "ram"], default="flash", dest="dsp_tables",
+                             help="Keep the CMSIS-DSP floating-point FFT tables in flash, or build them in RAM at boot")
+    build_parser.add_argument("--clock", choices=["performance", "balanced", "low_power"], default="performance",
+                             help="Clock profile at boot (switchable at run time with the clock test command)")
+    build_parser.add_argument("--bootloader", action="store_true",
+                             help="Link behind the resident UART bootloader, for flash --port updates")
+    build_parser.add_argument("--addr", type=str,
+                             help="Fob board link address, 0x02-0xFE (TM4C fobs keep it in EEPROM; "
+                                  "STM32 fobs otherwise fold their unique ID)")
     build_parser.set_defaults(func=build_command)
     
     # CLEAN (with 'nuke' alias)
@@ -818,14 +955,26 @@ def main():
     clean_parser.set_defaults(func=clean_command)
     
     # FLASH
-    flash_parser = subparsers.add_parser("flash", help="Flash program to hardware")
+    flash_parser = subparsers.add_parser("flash", help="Flash program to hardware through the bootloader")
     flash_parser.add_argument("--platform", choices=AVAILABLE_PLATFORMS,
                              required=True, help="Target platform")
     flash_parser.add_argument("--role", choices=AVAILABLE_ROLES,
-                             required=True, help="Target role")
+                             help="Target role (to find its build, unless --bin is given)")
+    flash_parser.add_argument("--id", type=str,
+                             help="Device ID of the build (car and paired_fob)")
+    flash_parser.add_argument("--bin", type=str,
+                             help="Image to flash, an ELF built with --bootloader")
     flash_parser.add_argument("--port", type=str,
-                             help="Serial port (auto-detect if not specified)")
+                             help="Serial port of the board's host UART")
+    flash_parser.add_argument("--keep-state", action="store_true", dest="keep_state",
+                             help="Keep the saved device state instead of erasing it")
     flash_parser.set_defaults(func=flash_command)
+
+    # BOOT
+    boot_parser = subparsers.add_parser("boot", help="Build the resident UART bootloader")
+    boot_parser.add_argument("--platform", choices=AVAILABLE_PLATFORMS,
+                             required=True, help="Target platform")
+    boot_parser.set_defaults(func=boot_command)
     
     # RUN
     run_parser = subparsers.add_parser("run", help="Run tests or simulation")
@@ -837,6 +986,22 @@ def main():
                            help="Run in debug mode (for 'sim' target)")
     run_parser.set_defaults(func=run_command)
     
+    # BENCH
+    bench_parser = subparsers.add_parser("bench", help="Build and run a host benchmark")
+    bench_parser.add_argument("suite", choices=["dsp", "nn"],
+                             help="Benchmark suite (dsp: bundled CMSIS-DSP, nn: bundled CMSIS-NN)")
+    bench_parser.add_argument("--filter", type=str,
+                             help="Only run kernels whose name or example contains this text")
+    bench_parser.add_argument("--min-ms", type=int, default=200, dest="min_ms",
+                             help="Minimum time per kernel in ms (default: 200)")
+    bench_parser.add_argument("--json", type=str,
+                             help="Write results to this JSON file (default: stdout)")
+    bench_parser.add_argument("--dsp-backend", choices=["x86", "ref"], default="x86", dest="dsp_backend",
+                             help="x86: SIMD replacements where available, ref: library code only (default: x86)")
+    bench_parser.add_argument("--nn-backend", choices=["x86", "ref"], default="x86", dest="nn_backend",
+                             help="x86: SIMD replacements where available, ref: library code only (default: x86)")
+    bench_parser.set_defaults(func=bench_command)
+    
     # PACKAGE
     package_parser = subparsers.add_parser("package", help="Create feature package")
     package_parser.add_argument("--package-name", type=str, required=True,
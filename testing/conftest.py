@@ -12,22 +12,38 @@ Each test declares what roles it needs. The fixture system:
 
 Mode selection:
     --using platform@port1,port2  -> Hardware mode (both devices on real hardware)
-    (no --using)                  -> Simulation mode (x86 with virtual serial ports)
+    --farm inventory.json         -> Hardware mode on a leased bench of the farm (farm.py)
+    (neither)                     -> Simulation mode (x86 with virtual serial ports)
+
+On the farm each test leases one whole bench for as long as it runs: the
+smallest free one with at least as many boards as the test's
+@pytest.mark.boards(n) (2 by default). Run several pytest processes, e.g.
+pytest-xdist's -n, to use several benches at once.
 
 x86 simulation wiring (using PyVirtualSerialPorts):
     Test <--[host1]--> exe1 <--[board]--> exe2 <--[host2]--> Test
+
+Shared-bus wiring (deploy_shared_bus): every exe's board port joins one hub
+that repeats each write to all ports, including the sender's, just as every
+board on an open-drain multi-drop line hears every byte.
 """
 
 import pytest
 import subprocess
 import serial
 import os
+import shutil
 import signal
+import sys
+import tempfile
 import time
+from concurrent.futures import ThreadPoolExecutor
+from contextlib import nullcontext
 from pathlib import Path
 from dataclasses import dataclass
 from typing import Optional, List
 from virtualserialports import VirtualSerialPorts
+from farm import Farm
 
 
 PROJECT_ROOT = Path(__file__).parent.parent
@@ -35,6 +51,13 @@ PROJECT_SCRIPT = PROJECT_ROOT / "project.py"
 DEFAULT_BAUD = 115200
 DEFAULT_TIMEOUT = 1.0
 
+# Host tools (tools/boot_tool.py) are imported by the tests
+sys.path.insert(0, str(PROJECT_ROOT / "tools"))
+import ed25519
+
+# Feature package signing key; fob builds make it and bake in its public half
+FEATURE_KEY = PROJECT_ROOT / "secrets" / "feature_key.json"
+
 
 @dataclass
 class HardwareConfig:
@@ -95,7 +118,8 @@ class DeployedDevice:
             self._vsp.close()
 
 
-def build_role(cfg: RoleConfig, platform: str) -> Path:
+def build_role(cfg: RoleConfig, platform: str, shared_bus: bool = False,
+               bootloader: bool = False, addr: Optional[int] = None) -> Path:
     """Build firmware for a role, returns path to binary."""
     cmd = ["python3", str(PROJECT_SCRIPT), "build",
            "--platform", platform, "--role", cfg.role, "--test-build"]
@@ -103,6 +127,12 @@ def build_role(cfg: RoleConfig, platform: str) -> Path:
         cmd += ["--id", cfg.id]
     if cfg.pin:
         cmd += ["--pin", cfg.pin]
+    if shared_bus:
+        cmd += ["--shared-bus"]
+    if bootloader:
+        cmd += ["--bootloader"]
+    if addr is not None:
+        cmd += ["--addr", hex(addr)]
 
     result = subprocess.run(cmd, cwd=PROJECT_ROOT, capture_output=True, text=True)
     if result.returncode != 0:
@@ -130,9 +160,115 @@ def flash_hardware(platform: str, port: str, binary: Path):
         raise RuntimeError(f"Flash failed:\n{result.stderr}")
 
 
+def open_hardware(cfg: RoleConfig, platform: str, port: str) -> DeployedDevice:
+    """Open a freshly flashed device and wait for it to start."""
+    ser = serial.Serial(port, DEFAULT_BAUD, timeout=DEFAULT_TIMEOUT)
+    time.sleep(0.1)
+    ser.reset_input_buffer()
+
+    # Wait for "OK: started" message, after the bootloader's measurement line
+    startup = ser.readline().decode('ascii', errors='replace').strip()
+    while startup.startswith("boot:"):
+        startup = ser.readline().decode('ascii', errors='replace').strip()
+    if not startup.startswith("OK"):
+        ser.close()
+        raise RuntimeError(f"Device didn't start properly, got: {startup}")
+
+    return DeployedDevice(cfg.role, ser, platform)
+
+
+def deploy_hardware(cfgs: List[RoleConfig], platform: str, ports: List[str],
+                    shared_bus: bool = False, build_lock=None) -> List[DeployedDevice]:
+    """Build, flash (through the resident bootloader) and open devices on real hardware.
+
+    Builds run one at a time, under build_lock when other test processes
+    share the tree; the boards are then flashed and started in parallel.
+    Each image is copied out of the shared build folder before the lock is
+    released, since another worker may rebuild the same path while this
+    bench is still flashing. On a shared bus, fobs are given addresses
+    0x10, 0x11, ... in the order given, as simulated ones are; TM4C boards
+    have no unique ID to take one from.
+    """
+    staging = Path(tempfile.mkdtemp(prefix="deploy-"))
+    binaries = []
+    try:
+        with build_lock or nullcontext():
+            for idx, cfg in enumerate(cfgs):
+                addr = 0x10 + idx if shared_bus and cfg.role != "car" else None
+                built = build_role(cfg, platform, shared_bus, bootloader=True, addr=addr)
+                binaries.append(staging / f"{idx}_{built.name}")
+                shutil.copyfile(built, binaries[-1])
+
+        def _flash(job) -> DeployedDevice:
+            cfg, port, binary = job
+            flash_hardware(platform, port, binary)
+            return open_hardware(cfg, platform, port)
+
+        with ThreadPoolExecutor(max_workers=len(cfgs)) as pool:
+            futures = [pool.submit(_flash, job) for job in zip(cfgs, ports, binaries)]
+    finally:
+        shutil.rmtree(staging, ignore_errors=True)
+    devices = [f.result() for f in futures if f.exception() is None]
+    errors = [f.exception() for f in futures if f.exception() is not None]
+    if errors:
+        for d in devices:
+            d.close()
+        raise errors[0]
+    return devices
+
+
+def deploy_sim(cfg: RoleConfig, board_port: str, extra_args: List[str] = []) -> DeployedDevice:
+    """Build and launch an x86 device with its board UART on board_port."""
+    binary = build_role(cfg, "x86")
+
+    # Start from freshly "flashed" state, as reflashing hardware does
+    (binary.parent / "flash_data.bin").unlink(missing_ok=True)
+
+    # Create host connection for this exe
+    host_vsp = VirtualSerialPorts(2)
+    host_vsp.open()
+    host_vsp.start()
+    test_port, exe_host_port = host_vsp.ports
+
+    # Test connects to its end
+    ser = serial.Serial(test_port, DEFAULT_BAUD, timeout=DEFAULT_TIMEOUT)
+    ser.reset_input_buffer()
+
+    # Launch exe
+    pid = os.fork()
+    if pid == 0:
+        os.setsid()
+        os.execv(str(binary), [str(binary), f"host={exe_host_port}",
+                               f"board={board_port}", *extra_args])
+
+    time.sleep(0.1)
+
+    # Wait for "OK: started" message
+    startup = ser.readline().decode('ascii', errors='replace').strip()
+    if not startup.startswith("OK"):
+        raise RuntimeError(f"Device didn't start properly, got: {startup}")
+
+    return DeployedDevice(cfg.role, ser, "x86", _pid=pid, _vsp=host_vsp)
+
+
 def pytest_addoption(parser):
     parser.addoption("--using", type=str, default=None,
                      help="Hardware: platform@port1,port2 (e.g., stm32@/dev/ttyUSB0,/dev/ttyUSB1)")
+    parser.addoption("--farm", type=str, default=None,
+                     help="Hardware: lease benches from this farm inventory (see farm.py)")
+    parser.addoption("--farm-platforms", type=str, default=None,
+                     help="Only lease benches of these platforms (e.g., tm4c,stm32)")
+    parser.addoption("--farm-timeout", type=float, default=1800.0,
+                     help="Seconds to wait for a free bench")
+
+
+def pytest_configure(config):
+    config.addinivalue_line("markers", "boards(n): number of boards the test deploys on hardware")
+
+
+def boards_needed(request, default: int = 2) -> int:
+    marker = request.node.get_closest_marker("boards")
+    return marker.args[0] if marker else default
 
 
 @pytest.fixture(scope="session")
@@ -151,47 +287,86 @@ def hardware_config(request) -> Optional[HardwareConfig]:
     return HardwareConfig(platform=platform, ports=ports)
 
 
+@pytest.fixture(scope="session")
+def farm(request) -> Optional[Farm]:
+    """The board farm given by --farm, or None."""
+    inventory = request.config.getoption("--farm")
+    if not inventory:
+        return None
+    platforms = request.config.getoption("--farm-platforms")
+    return Farm(Path(inventory), platforms.split(",") if platforms else None)
+
+
+class FarmSession:
+    """A test's bench, leased on first deploy and released when the test ends."""
+
+    def __init__(self, farm: Farm, request, shared_bus: bool = False):
+        self.farm = farm
+        self.request = request
+        self.shared_bus = shared_bus
+        self.lease = None
+        self.healthy = True
+
+    def deploy(self, cfgs: List[RoleConfig], boards: int) -> List[DeployedDevice]:
+        if self.lease is None:
+            self.lease = self.farm.lease(boards, self.shared_bus,
+                                         self.request.config.getoption("--farm-timeout"))
+        ports = [self.lease.next_port() for _ in cfgs]
+        try:
+            return deploy_hardware(cfgs, self.lease.platform, ports, self.shared_bus,
+                                   self.farm.build_lock())
+        except RuntimeError as e:
+            # A build failure is the tree's fault, not the bench's
+            if not str(e).startswith("Build failed"):
+                self.healthy = False
+                self.farm.report(self.lease, False, str(e).splitlines()[0])
+            raise
+
+    def close(self) -> None:
+        if self.lease is not None:
+            if self.healthy:
+                self.farm.report(self.lease, True)
+            self.farm.release(self.lease)
+            self.lease = None
+
+
 @pytest.fixture
-def deploy(hardware_config):
+def deploy(hardware_config, farm, request):
     """
     Factory fixture for deploying roles.
     
-    Automatically selects hardware or simulation mode based on --using flag.
+    Automatically selects hardware, farm or simulation mode based on --using
+    and --farm. Several roles given in one call are flashed in parallel on
+    hardware and returned as a list.
     
     Usage:
         def test_something(deploy):
             car = deploy(RoleConfig("car", id="123"))
             fob = deploy(RoleConfig("paired_fob", id="123", pin="654321"))
+            # or: car, fob = deploy(RoleConfig(...), RoleConfig(...))
     """
     deployed = []
+    session = None
     
-    if hardware_config:
+    if farm:
+        session = FarmSession(farm, request)
+
+        def _deploy_all(cfgs: List[RoleConfig]) -> List[DeployedDevice]:
+            return session.deploy(cfgs, boards_needed(request))
+
+    elif hardware_config:
         # Hardware mode
         port_idx = 0
         
-        def _deploy(cfg: RoleConfig) -> DeployedDevice:
+        def _deploy_all(cfgs: List[RoleConfig]) -> List[DeployedDevice]:
             nonlocal port_idx
-            if port_idx >= len(hardware_config.ports):
+            if port_idx + len(cfgs) > len(hardware_config.ports):
                 raise RuntimeError(f"Not enough hardware ports (have {len(hardware_config.ports)}, need more)")
             
-            port = hardware_config.ports[port_idx]
-            port_idx += 1
-            
-            binary = build_role(cfg, hardware_config.platform)
-            flash_hardware(hardware_config.platform, port, binary)
+            ports = hardware_config.ports[port_idx:port_idx + len(cfgs)]
+            port_idx += len(cfgs)
             
-            ser = serial.Serial(port, DEFAULT_BAUD, timeout=DEFAULT_TIMEOUT)
-            time.sleep(0.1)
-            ser.reset_input_buffer()
-            
-            # Wait for "OK: started" message
-            startup = ser.readline().decode('ascii', errors='replace').strip()
-            if not startup.startswith("OK"):
-                raise RuntimeError(f"Device didn't start properly, got: {startup}")
-            
-            dev = DeployedDevice(cfg.role, ser, hardware_config.platform)
-            deployed.append(dev)
-            return dev
+            return deploy_hardware(cfgs, hardware_config.platform, ports)
     
     else:
         # Simulation mode - create all virtual ports upfront
@@ -201,48 +376,27 @@ def deploy(hardware_config):
         board_vsp.start()
         board_ports = board_vsp.ports  # [exe1_board, exe2_board]
         
-        # Host connections: test <-> exe1, test <-> exe2
-        host_vsps = []
+        # Host connections: test <-> exe1, test <-> exe2 (made per device)
         exe_idx = 0
         
-        def _deploy(cfg: RoleConfig) -> DeployedDevice:
+        def _deploy_all(cfgs: List[RoleConfig]) -> List[DeployedDevice]:
             nonlocal exe_idx
-            if exe_idx >= 2:
-                raise RuntimeError("Simulation mode only supports 2 devices")
-            
-            binary = build_role(cfg, "x86")
-            
-            # Create host connection for this exe
-            host_vsp = VirtualSerialPorts(2)
-            host_vsp.open()
-            host_vsp.start()
-            host_vsps.append(host_vsp)
-            test_port, exe_host_port = host_vsp.ports
-            
-            # Get this exe's board port
-            exe_board_port = board_ports[exe_idx]
-            exe_idx += 1
-            
-            # Test connects to its end
-            ser = serial.Serial(test_port, DEFAULT_BAUD, timeout=DEFAULT_TIMEOUT)
-            ser.reset_input_buffer()
-
-            # Launch exe
-            pid = os.fork()
-            if pid == 0:
-                os.setsid()
-                os.execv(str(binary), [str(binary), f"host={exe_host_port}", f"board={exe_board_port}"])
-            
-            time.sleep(0.1)
-                        
-            # Wait for "OK: started" message
-            startup = ser.readline().decode('ascii', errors='replace').strip()
-            if not startup.startswith("OK"):
-                raise RuntimeError(f"Device didn't start properly, got: {startup}")
-            
-            dev = DeployedDevice(cfg.role, ser, "x86", _pid=pid, _vsp=host_vsp)
-            deployed.append(dev)
-            return dev
+            devices = []
+            for cfg in cfgs:
+                if exe_idx >= 2:
+                    raise RuntimeError("Simulation mode only supports 2 devices")
+                
+                # Get this exe's board port
+                exe_board_port = board_ports[exe_idx]
+                exe_idx += 1
+                
+                devices.append(deploy_sim(cfg, exe_board_port))
+            return devices
+    
+    def _deploy(*cfgs: RoleConfig):
+        devices = _deploy_all(list(cfgs))
+        deployed.extend(devices)
+        return devices[0] if len(devices) == 1 else devices
     
     yield _deploy
     
@@ -250,12 +404,70 @@ def deploy(hardware_config):
     for d in deployed:
         d.close()
     
-    if not hardware_config:
+    if session:
+        session.close()
+    elif not hardware_config:
         # Clean up board VSP (only in simulation mode)
         board_vsp.stop()
         board_vsp.close()
 
 
+@pytest.fixture
+def deploy_shared_bus(hardware_config, farm, request):
+    """
+    Factory fixture for deploying several devices on one shared board link.
+
+    Takes every role up front, since the simulated bus is sized to fit.
+    Fobs get addresses 0x10, 0x11, ... in the order given; on hardware,
+    boards are built with --shared-bus and --addr and must be wired to one
+    open-drain line (on the farm, a bench with "shared_bus": true).
+
+    Usage:
+        def test_something(deploy_shared_bus):
+            car, fob1, fob2 = deploy_shared_bus([
+                RoleConfig("car", id="1"),
+                RoleConfig("paired_fob", id="1", pin="123456"),
+                RoleConfig("paired_fob", id="1", pin="123456"),
+            ])
+    """
+    deployed = []
+    bus_vsp = None
+    session = FarmSession(farm, request, shared_bus=True) if farm else None
+
+    def _deploy(cfgs: List[RoleConfig]) -> List[DeployedDevice]:
+        nonlocal bus_vsp
+
+        if session:
+            deployed.extend(session.deploy(cfgs, len(cfgs)))
+            return list(deployed)
+
+        if hardware_config:
+            if len(cfgs) > len(hardware_config.ports):
+                raise RuntimeError(f"Not enough hardware ports (have {len(hardware_config.ports)}, need {len(cfgs)})")
+            deployed.extend(deploy_hardware(cfgs, hardware_config.platform,
+                                            hardware_config.ports[:len(cfgs)], shared_bus=True))
+            return list(deployed)
+
+        bus_vsp = VirtualSerialPorts(len(cfgs), loopback=True)
+        bus_vsp.open()
+        bus_vsp.start()
+        for idx, (cfg, port) in enumerate(zip(cfgs, bus_vsp.ports)):
+            deployed.append(deploy_sim(cfg, port, [f"addr={0x10 + idx}", "bus=shared"]))
+        return list(deployed)
+
+    yield _deploy
+
+    # Cleanup
+    for d in deployed:
+        d.close()
+
+    if session:
+        session.close()
+    if bus_vsp:
+        bus_vsp.stop()
+        bus_vsp.close()
+
+
 # =============================================================================
 # Convenience Fixtures
 # =============================================================================
@@ -265,23 +477,98 @@ def paired_fob(deploy):
     return deploy(RoleConfig("paired_fob", id="1", pin="123456"))
 
 
+@pytest.fixture
+def feature_key():
+    """(seed, public key) that the fobs built for this run check packages against."""
+    return ed25519.load_keypair(FEATURE_KEY, create=True)
+
+
 @pytest.fixture
 def car_and_paired_fob(deploy):
-    car = deploy(RoleConfig("car", id="1"))
-    fob = deploy(RoleConfig("paired_fob", id="1", pin="123456"))
+    car, fob = deploy(RoleConfig("car", id="1"), RoleConfig("paired_fob", id="1", pin="123456"))
     return car, fob
 
 
 @pytest.fixture
 def paired_and_unpaired_fob(deploy):
-    paired = deploy(RoleConfig("paired_fob", id="1", pin="123456"))
-    unpaired = deploy(RoleConfig("unpaired_fob"))
+    paired, unpaired = deploy(RoleConfig("paired_fob", id="1", pin="123456"),
+                              RoleConfig("unpaired_fob"))
     return paired, unpaired
 
 
 @pytest.fixture
 def car_paired_unpaired(deploy):
-    car = deploy(RoleConfig("car", id="1"))
-    paired = deploy(RoleConfig("paired_fob", id="1", pin="123456"))
-    unpaired = deploy(RoleConfig("unpaired_fob"))
-    return car, paired, unpaired
\ No newline at end of file
+    car, paired, unpaired = deploy(RoleConfig("car", id="1"),
+                                   RoleConfig("paired_fob", id="1", pin="123456"),
+                                   RoleConfig("unpaired_fob"))
+    return car, paired, unpaired
+
+
+@dataclass
+class SimBootloader:
+    """The x86 bootloader on an emulated flash file, for tools/boot_tool.py."""
+    serial: serial.Serial
+    flash: Path
+    binary: Path
+    port: str
+    _pid: Optional[int] = None
+
+    def start(self, software_reset: bool = False) -> None:
+        """Launch (or relaunch, as a reset would) the bootloader."""
+        self.stop()
+        self.serial.baudrate = DEFAULT_BAUD
+        self.serial.reset_input_buffer()
+        argv = [str(self.binary), f"host={self.port}", f"flash={self.flash}"]
+        if software_reset:
+            argv.append("reset=software")
+        pid = os.fork()
+        if pid == 0:
+            os.setsid()
+            os.execv(str(self.binary), argv)
+        self._pid = pid
+
+    def wait_exit(self, timeout: float = 2.0) -> Optional[int]:
+        """Exit status once it starts the application, or None if still running."""
+        deadline = time.monotonic() + timeout
+        while self._pid and time.monotonic() < deadline:
+            pid, status = os.waitpid(self._pid, os.WNOHANG)
+            if pid:
+                self._pid = None
+                return os.waitstatus_to_exitcode(status)
+            time.sleep(0.01)
+        return None
+
+    def stop(self) -> None:
+        if self._pid:
+            try:
+                os.kill(self._pid, signal.SIGKILL)
+                os.waitpid(self._pid, 0)
+            except OSError:
+                pass
+            self._pid = None
+
+
+@pytest.fixture
+def sim_bootloader(tmp_path):
+    """The resident bootloader, built for x86 and running on a fresh, erased flash."""
+    result = subprocess.run(["python3", str(PROJECT_SCRIPT), "boot", "--platform", "x86"],
+                            cwd=PROJECT_ROOT, capture_output=True, text=True)
+    if result.returncode != 0:
+        raise RuntimeError(f"Bootloader build failed:\n{result.stderr}")
+
+    vsp = VirtualSerialPorts(2)
+    vsp.open()
+    vsp.start()
+    test_port, exe_port = vsp.ports
+
+    boot = SimBootloader(serial.Serial(test_port, DEFAULT_BAUD, timeout=DEFAULT_TIMEOUT),
+                         tmp_path / "flash.bin",
+                         PROJECT_ROOT / "hardware" / "x86" / "build" / "bootloader" / "boot_x86",
+                         exe_port)
+    boot.start()
+    yield boot
+
+    boot.stop()
+    boot.serial.close()
+    vsp.stop()
+    vsp.close()
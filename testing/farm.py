@@ -0,0 +1,245 @@
+"""
+Hardware-in-the-loop board farm: inventory, leases and health.
+
+The farm is a JSON inventory of benches. A bench is a set of boards of one
+platform whose board UARTs are wired together, so a test that needs a car
+and a fob leases one whole bench:
+
+    {
+        "state_dir": "/var/lock/hil-farm",
+        "benches": [
+            {"name": "tm4c-1", "platform": "tm4c",
+             "ports": ["/dev/serial/by-id/tm4c-1a", "/dev/serial/by-id/tm4c-1b"]},
+            {"name": "stm32-bus", "platform": "stm32", "shared_bus": true,
+             "ports": ["/dev/ttyACM4", "/dev/ttyACM5", "/dev/ttyACM6", "/dev/ttyACM7"]}
+        ]
+    }
+
+Leases are flock()s on <state_dir>/<bench>.lock, so any number of pytest
+processes (pytest-xdist workers, or separate runs) share the farm safely and
+a crashed worker's bench is freed by the kernel. A worker waits for the
+smallest free bench that fits, so with as many workers as benches the suite
+takes about as long as its slowest test.
+
+Benches are health-checked when leased. Infrastructure failures (a port
+that will not open, a flash or start-up that fails) are counted in
+<state_dir>/health.json; QUARANTINE_AFTER in a row quarantine the bench
+until it is released by hand:
+
+    python3 farm.py inventory.json status
+    python3 farm.py inventory.json release tm4c-1
+"""
+
+import argparse
+import fcntl
+import json
+import os
+import sys
+import time
+from contextlib import contextmanager
+from dataclasses import dataclass
+from pathlib import Path
+from typing import Dict, Iterator, List, Optional
+
+QUARANTINE_AFTER = 3
+POLL_INTERVAL = 0.5
+
+
+@dataclass
+class Bench:
+    name: str
+    platform: str
+    ports: List[str]
+    shared_bus: bool = False
+
+
+@dataclass
+class Lease:
+    bench: Bench
+    _fd: int
+    ports_used: int = 0
+
+    @property
+    def platform(self) -> str:
+        return self.bench.platform
+
+    def next_port(self) -> str:
+        if self.ports_used >= len(self.bench.ports):
+            raise RuntimeError(f"Bench {self.bench.name} has only {len(self.bench.ports)} boards")
+        port = self.bench.ports[self.ports_used]
+        self.ports_used += 1
+        return port
+
+
+@dataclass
+class Health:
+    failures: int = 0
+    quarantined: bool = False
+    reason: str = ""
+    runs: int = 0
+    last: float = 0.0
+
+
+def port_ok(port: str) -> Optional[str]:
+    """Reason a board's host port is unusable, or None."""
+    import serial
+    if not os.path.exists(port):
+        return f"{port} missing"
+    try:
+        serial.Serial(port, 115200, timeout=0).close()
+    except (serial.SerialException, OSError) as e:
+        return f"{port}: {e}"
+    return None
+
+
+class Farm:
+    def __init__(self, inventory: Path, platforms: Optional[List[str]] = None):
+        data = json.loads(Path(inventory).read_text())
+        self.benches = [Bench(b["name"], b["platform"], list(b["ports"]), b.get("shared_bus", False))
+                        for b in data["benches"]]
+        if len({b.name for b in self.benches}) != len(self.benches):
+            raise ValueError(f"{inventory}: bench names must be unique")
+        self.platforms = platforms
+        self.state_dir = Path(data.get("state_dir") or Path(inventory).with_suffix(".state"))
+        self.state_dir.mkdir(parents=True, exist_ok=True)
+
+    @contextmanager
+    def _locked(self, name: str) -> Iterator[None]:
+        with open(self.state_dir / name, "a") as f:
+            fcntl.flock(f, fcntl.LOCK_EX)
+            try:
+                yield
+            finally:
+                fcntl.flock(f, fcntl.LOCK_UN)
+
+    def build_lock(self):
+        """Held around builds: concurrent SCons runs would share .sconsign.dblite."""
+        return self._locked("build.lock")
+
+    def health(self) -> Dict[str, Health]:
+        path = self.state_dir / "health.json"
+        data = json.loads(path.read_text()) if path.exists() else {}
+        return {name: Health(**h) for name, h in data.items()}
+
+    def _write_health(self, health: Dict[str, Health]) -> None:
+        # Replaced whole, so readers outside health.lock never see half a file
+        tmp = self.state_dir / f"health.json.{os.getpid()}"
+        tmp.write_text(json.dumps({n: vars(h) for n, h in health.items()}, indent=2))
+        os.replace(tmp, self.state_dir / "health.json")
+
+    def _update_health(self, name: str, ok: bool, reason: str = "") -> Health:
+        with self._locked("health.lock"):
+            health = self.health()
+            h = health.setdefault(name, Health())
+            h.runs += 1
+            h.last = time.time()
+            if ok:
+                h.failures = 0
+            else:
+                h.failures += 1
+                h.reason = reason
+                if h.failures >= QUARANTINE_AFTER:
+                    h.quarantined = True
+            self._write_health(health)
+            return h
+
+    def report(self, lease: Lease, ok: bool, reason: str = "") -> None:
+        h = self._update_health(lease.bench.name, ok, reason)
+        if h.quarantined and not ok:
+            print(f"\nfarm: bench {lease.bench.name} quarantined after {h.failures} "
+                  f"failures ({reason})", file=sys.stderr)
+
+    def unquarantine(self, name: str) -> None:
+        with self._locked("health.lock"):
+            health = self.health()
+            health[name] = Health(runs=health[name].runs if name in health else 0)
+            self._write_health(health)
+
+    def candidates(self, boards: int, shared_bus: bool = False) -> List[Bench]:
+        """Benches that could run the test, smallest first."""
+        fits = [b for b in self.benches
+                if len(b.ports) >= boards and b.shared_bus == shared_bus
+                and (not self.platforms or b.platform in self.platforms)]
+        return sorted(fits, key=lambda b: len(b.ports))
+
+    def lease(self, boards: int, shared_bus: bool = False, timeout: float = 1800.0) -> Lease:
+        """Wait for a free, healthy bench with enough boards and lock it."""
+        benches = self.candidates(boards, shared_bus)
+        if not benches:
+            raise RuntimeError(f"No bench in the farm has {boards} boards"
+                               f"{' on a shared bus' if shared_bus else ''}")
+
+        deadline = time.monotonic() + timeout
+        while True:
+            health = self.health()
+            usable = [b for b in benches if not health.get(b.name, Health()).quarantined]
+            if not usable:
+                raise RuntimeError("Every bench that fits is quarantined; see farm.py status")
+            for bench in usable:
+                fd = os.open(self.state_dir / f"{bench.name}.lock", os.O_RDWR | os.O_CREAT, 0o644)
+                try:
+                    fcntl.flock(fd, fcntl.LOCK_EX | fcntl.LOCK_NB)
+                except BlockingIOError:
+                    os.close(fd)
+                    continue
+                os.ftruncate(fd, 0)
+                os.write(fd, f"{os.getpid()}\n".encode())
+
+                lease = Lease(bench, fd)
+                problem = next(filter(None, (port_ok(p) for p in bench.ports)), None)
+                if problem is None:
+                    return lease
+                self.report(lease, False, problem)
+                self.release(lease)
+            if time.monotonic() > deadline:
+                raise TimeoutError(f"No free bench with {boards} boards after {timeout:.0f}s")
+            time.sleep(POLL_INTERVAL)
+
+    def release(self, lease: Lease) -> None:
+        fcntl.flock(lease._fd, fcntl.LOCK_UN)
+        os.close(lease._fd)
+
+    def status(self) -> List[str]:
+        health = self.health()
+        lines = []
+        for bench in self.benches:
+            h = health.get(bench.name, Health())
+            fd = os.open(self.state_dir / f"{bench.name}.lock", os.O_RDWR | os.O_CREAT, 0o644)
+            try:
+                fcntl.flock(fd, fcntl.LOCK_EX | fcntl.LOCK_NB)
+                fcntl.flock(fd, fcntl.LOCK_UN)
+                state = "free"
+            except BlockingIOError:
+                state = f"leased by pid {os.pread(fd, 32, 0).decode().strip()}"
+            finally:
+                os.close(fd)
+            if h.quarantined:
+                state = f"QUARANTINED ({h.reason})"
+            lines.append(f"{bench.name:16} {bench.platform:6} {len(bench.ports)} boards"
+                         f"{' shared bus' if bench.shared_bus else ''}: {state}, "
+                         f"{h.runs} runs, {h.failures} failures in a row")
+        return lines
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Show or clear the HIL farm's bench state")
+    parser.add_argument("inventory", type=Path)
+    sub = parser.add_subparsers(dest="command", required=True)
+    sub.add_parser("status", help="Leases and health of every bench")
+    release = sub.add_parser("release", help="Return a quarantined bench to service")
+    release.add_argument("bench")
+    args = parser.parse_args()
+
+    farm = Farm(args.inventory)
+    if args.command == "status":
+        print("\n".join(farm.status()))
+    else:
+        if args.bench not in {b.name for b in farm.benches}:
+            parser.error(f"no bench {args.bench}")
+        farm.unquarantine(args.bench)
+        print(f"{args.bench} returned to service")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
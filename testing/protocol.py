@@ -6,28 +6,57 @@ Responses are "OK\n", "OK: {value}\n", or "ERROR: {reason}\n".
 
 Standard Commands (production firmware):
     Fob:
-        enable <hex_feature_pkg>  - Enable a packaged feature
+        enable <hex_feature_pkg>  - Enable a packaged feature (car id, feature
+                                    and Ed25519 signature, see feature_package)
         pair <pin>                - Initiate pairing (paired fob sends this)
+        pairBatch <pin> <count>   - Pair count fobs at once, waiting for each
+                                    one's acknowledgement (OK: n=,tries=,us=,addrs=)
 
 Test Commands (TEST_BUILD only):
     Both:
         restart                   - Software reset (re-run main, state persists)
         reset                     - Factory reset (clear state, restart)
+        getSnapshot               - Get complete runtime state as hex
+        setSnapshot <hex>         - Replace runtime state with a snapshot
     
     Fob:
         btnPress                  - Simulate button press, blocks until unlock completes
         getFlashData              - Get FLASH_DATA as hex
         setFlashData <hex>        - Set FLASH_DATA from hex (persists to flash)
         isPaired                  - Returns OK: 1 or OK: 0
+        verifyStats               - Package signature check times (OK: n=,mean=,
+                                    std=,min=,max= in us, cycles=, budget=)
     
     Car:
         isLocked                  - Returns OK: 1 or OK: 0
         getUnlockCount            - Returns OK: <n> (resets on power cycle)
+        bound [threshold_us]      - Report (or change) the distance bounding
+                                    limit on the slowest round trip but one;
+                                    0 = off (OK: threshold=,rounds=)
+        boundStats                - Distance bounding checks (OK: n=,rejected=,
+                                    and min=,median=,held=,max=,var= of the
+                                    last one in us, wrong= rounds in it)
+        boundStatsReset           - Zero the distance bounding counts
+
+x86 Platform Commands (TEST_BUILD only):
+    Both:
+        impair <settings>         - Impair bytes received on the board link
+                                    (loss, dup, ber, delay, jitter, rate,
+                                    burst, burst_us, relay, preask, seed;
+                                    or "off")
+        impairStats               - Returns OK: key=value,... counters
+        impairReset               - Zero impairment counters
+        hexBench [bytes]          - Benchmark hex codec, OK: key=value,...
+                                    (impl, MB/s scalar vs SIMD)
+        uartStats                 - Host UART transmit queue, OK: queued=,
+                                    peak=,waits=,dropped=,size=
 """
 
 from dataclasses import dataclass
 from typing import Optional
 
+import ed25519
+
 
 # =============================================================================
 # Response Parsing
@@ -66,13 +95,13 @@ def parse_response(line: str) -> Response:
 # From dataFormats.h:
 #   typedef struct {
 #     uint8_t paired;
-#     PAIR_PACKET pair_info;    // car_id[8], password[8], pin[8]
+#     PAIR_PACKET pair_info;    // car_id[8], password[8], pin[8], bound_key[16]
 #     FEATURE_DATA feature_info; // car_id[8], num_active, features[3]
 #   } FLASH_DATA;
 #
-# Total: 1 + 24 + 12 = 37 bytes (but aligned to 4, so likely 40 bytes)
+# Total: 1 + 40 + 12 = 53 bytes, aligned to 4
 
-FLASH_DATA_SIZE = 40  # Adjust based on actual sizeof(FLASH_DATA)
+FLASH_DATA_SIZE = 56
 
 NUM_FEATURES = 3
 
@@ -82,18 +111,21 @@ class PairPacket:
     car_id: bytes      # 8 bytes
     password: bytes    # 8 bytes
     pin: bytes         # 8 bytes
+    bound_key: bytes = b'\x00' * 16  # distance-bounding key
     
     def pack(self) -> bytes:
         return self.car_id.ljust(8, b'\x00')[:8] + \
                self.password.ljust(8, b'\x00')[:8] + \
-               self.pin.ljust(8, b'\x00')[:8]
+               self.pin.ljust(8, b'\x00')[:8] + \
+               self.bound_key.ljust(16, b'\x00')[:16]
     
     @classmethod
     def unpack(cls, data: bytes) -> 'PairPacket':
         return cls(
             car_id=data[0:8],
             password=data[8:16],
-            pin=data[16:24]
+            pin=data[16:24],
+            bound_key=data[24:40]
         )
 
 
@@ -118,6 +150,15 @@ class FeatureData:
         )
 
 
+def feature_package(car_id: bytes, feature: int, seed: bytes) -> bytes:
+    """
+    A feature package as tools/package_tool writes it: car id, feature
+    number and an Ed25519 signature of both by the seed.
+    """
+    message = car_id.ljust(8, b'\x00')[:8] + bytes([feature])
+    return message + ed25519.sign(seed, message)
+
+
 @dataclass
 class FlashData:
     paired: bool
@@ -137,8 +178,8 @@ class FlashData:
         """Unpack from bytes received from getFlashData."""
         return cls(
             paired=data[0] != 0,
-            pair_info=PairPacket.unpack(data[1:25]),
-            feature_info=FeatureData.unpack(data[25:37])
+            pair_info=PairPacket.unpack(data[1:41]),
+            feature_info=FeatureData.unpack(data[41:53])
         )
     
     @classmethod
@@ -192,8 +233,8 @@ def cmd_pair(device, pin: str) -> Response:
     """
     Initiate pairing from a paired fob.
     
-    The paired fob validates the PIN and sends pairing data to the
-    unpaired fob (which is blocking, waiting for PAIR_MAGIC).
+    The paired fob validates the PIN and broadcasts pairing data on the
+    board link, where an unpaired fob is listening for PAIR_MAGIC.
     
     After this succeeds, the unpaired fob will send "OK: paired" on its
     host UART. Use wait_for_paired() to consume that message.
@@ -208,6 +249,33 @@ def cmd_pair(device, pin: str) -> Response:
     return parse_response(device.send_recv(f"pair {pin}"))
 
 
+def cmd_pair_batch(device, pin: str, count: int, timeout: float = 5.0) -> dict:
+    """
+    Pair count unpaired fobs at once from a paired fob.
+    
+    The paired fob broadcasts its pairing data and collects an
+    acknowledgement from each fob that takes it on, repeating the broadcast
+    for any that do not answer. Each new fob also sends "OK: paired".
+    
+    Returns:
+        dict with 'n', 'tries', 'us' (ints) and 'addrs' (list of board
+        link addresses that acknowledged)
+    
+    Raises:
+        RuntimeError: if fewer than count fobs acknowledged
+    """
+    resp = parse_response(device.send_recv(f"pairBatch {pin} {count}", timeout=timeout))
+    if not resp.success:
+        raise RuntimeError(f"pairBatch failed: {resp.error}")
+    fields = dict(item.split("=", 1) for item in resp.value.split(","))
+    return {
+        'n': int(fields['n']),
+        'tries': int(fields['tries']),
+        'us': int(fields['us']),
+        'addrs': [int(a, 16) for a in fields['addrs'].split(":") if a],
+    }
+
+
 def wait_for_paired(device, timeout: float = 2.0) -> Response:
     """
     Wait for an unpaired fob to receive pairing and become paired.
@@ -236,7 +304,8 @@ def cmd_restart(device, timeout: float = 2.0) -> Response:
     Software reset - re-run main, state persists.
     
     On STM32/TM4C: NVIC_SystemReset()
-    On x86: re-exec or longjmp to main
+    On x86: longjmp back to main in the same process (warm restart);
+            run the binary with restart=cold to re-exec instead
     
     The device will reset and send "OK: started" when ready.
     """
@@ -246,6 +315,36 @@ def cmd_restart(device, timeout: float = 2.0) -> Response:
     return parse_response(resp)
 
 
+def cmd_restart_cold(device, timeout: float = 5.0) -> Response:
+    """
+    x86 only: software reset by re-exec'ing the binary, as a restart=cold
+    build does, whatever the binary was started with.
+
+    The device sends "OK: started" when ready, as for cmd_restart.
+    """
+    device.send("restart cold")
+    resp = device.recv(timeout=timeout)
+    return parse_response(resp)
+
+
+def get_restart_stats(device) -> dict:
+    """
+    x86 only: how long the last software reset took, measured in firmware
+    from softwareReset() until the application's hardware is back up.
+
+    Returns:
+        dict with 'us' (int) and 'kind' ("warm" or "cold")
+
+    Raises:
+        RuntimeError: if command fails
+    """
+    resp = parse_response(device.send_recv("restartStats"))
+    if not resp.success:
+        raise RuntimeError(f"restartStats failed: {resp.error}")
+    fields = dict(kv.split('=') for kv in resp.value.split(','))
+    return {'us': int(fields['us']), 'kind': fields['kind']}
+
+
 def cmd_reset(device) -> Response:
     """
     Factory reset - clear all state and restart.
@@ -256,6 +355,50 @@ def cmd_reset(device) -> Response:
     return parse_response(device.send_recv("reset"))
 
 
+def cmd_get_snapshot(device) -> Response:
+    """
+    Capture the device's complete runtime state.
+
+    The snapshot covers RAM state (lock state and unlock count on the car,
+    fob state on the fob) plus, on x86, bytes received on the board UART
+    that the firmware has not read yet.
+
+    Returns:
+        Response with value=hex blob on success
+    """
+    return parse_response(device.send_recv("getSnapshot"))
+
+
+def cmd_set_snapshot(device, snapshot: str) -> Response:
+    """
+    Restore runtime state captured by cmd_get_snapshot.
+
+    Snapshots are role-specific (car or fob) but not tied to one binary, so
+    a paired fob's snapshot can be loaded into an unpaired fob.
+
+    Args:
+        device: DeployedDevice
+        snapshot: hex blob from cmd_get_snapshot
+
+    Returns:
+        Response with success/error
+    """
+    return parse_response(device.send_recv(f"setSnapshot {snapshot}"))
+
+
+def get_snapshot(device) -> str:
+    """
+    Convenience: capture a snapshot as a hex string.
+
+    Raises:
+        RuntimeError: if command fails
+    """
+    resp = cmd_get_snapshot(device)
+    if not resp.success:
+        raise RuntimeError(f"getSnapshot failed: {resp.error}")
+    return resp.value
+
+
 # --- Fob Only ---
 
 def cmd_btn_press(device, timeout: float = 2.0) -> Response:
@@ -369,6 +512,185 @@ def get_unlock_count(device) -> int:
         raise RuntimeError(f"getUnlockCount failed: {resp.error}")
     return int(resp.value)
 
+# --- x86 Only ---
+
+def cmd_impair(device, settings: str) -> Response:
+    """
+    Change impairments on the board link as seen by this device.
+
+    Args:
+        device: DeployedDevice (x86)
+        settings: e.g. "loss=0.01,jitter=500,seed=3", or "off"
+    """
+    return parse_response(device.send_recv(f"impair {settings}"))
+
+
+def get_impair_stats(device) -> dict:
+    """
+    Convenience: read impairment counters as a dict of ints.
+
+    Raises:
+        RuntimeError: if command fails
+    """
+    resp = parse_response(device.send_recv("impairStats"))
+    if not resp.success:
+        raise RuntimeError(f"impairStats failed: {resp.error}")
+    return {k: int(v) for k, v in (kv.split('=') for kv in resp.value.split(','))}
+
+
+def get_unlock_stats(device) -> dict:
+    """
+    Convenience: read the fob's unlock latency statistics since boot.
+
+    Returns:
+        dict with 'n' and, once an unlock has completed, 'mean', 'std', 'min'
+        and 'max' of the UNLOCK-to-ACK round trip in microseconds (ints)
+
+    Raises:
+        RuntimeError: if command fails
+    """
+    resp = parse_response(device.send_recv("unlockStats"))
+    if not resp.success:
+        raise RuntimeError(f"unlockStats failed: {resp.error}")
+    return {k: int(v) for k, v in (kv.split('=') for kv in resp.value.split(','))}
+
+
+def get_verify_stats(device) -> dict:
+    """
+    Convenience: read the fob's feature package signature check times.
+
+    Returns:
+        dict with 'n' and 'budget' and, once a package has been checked,
+        'mean', 'std', 'min' and 'max' in microseconds and 'cycles', the
+        slowest in core cycles (0 on x86) (ints)
+
+    Raises:
+        RuntimeError: if command fails
+    """
+    resp = parse_response(device.send_recv("verifyStats"))
+    if not resp.success:
+        raise RuntimeError(f"verifyStats failed: {resp.error}")
+    return {k: int(v) for k, v in (kv.split('=') for kv in resp.value.split(','))}
+
+
+def reset_unlock_stats(device) -> Response:
+    """
+    Start the fob's unlock latency statistics over.
+
+    Args:
+        device: DeployedDevice (fob)
+    """
+    return parse_response(device.send_recv("unlockStatsReset"))
+
+
+def cmd_bound(device, threshold_us: Optional[int] = None) -> Response:
+    """
+    Report the car's distance bounding limit, or change it first.
+
+    Args:
+        device: DeployedDevice (car)
+        threshold_us: limit on the slowest round trip but one; 0 turns
+            bounding off
+
+    Returns:
+        Response whose value is e.g. "threshold=10000,rounds=16"
+    """
+    return parse_response(device.send_recv("bound" if threshold_us is None else f"bound {threshold_us}"))
+
+
+def get_bound_stats(device) -> dict:
+    """
+    Convenience: read the car's distance bounding results since boot.
+
+    Returns:
+        dict with 'n' checks and 'rejected' and, once a check has run, the
+        'min', 'median', 'held' (the round held to the limit), 'max' and
+        'var' of the last one's round trips in microseconds and the number
+        of its rounds answered 'wrong' or not at all (ints)
+
+    Raises:
+        RuntimeError: if command fails
+    """
+    resp = parse_response(device.send_recv("boundStats"))
+    if not resp.success:
+        raise RuntimeError(f"boundStats failed: {resp.error}")
+    return {k: int(v) for k, v in (kv.split('=') for kv in resp.value.split(','))}
+
+
+def reset_bound_stats(device) -> Response:
+    """
+    Start the car's distance bounding counts over.
+
+    Args:
+        device: DeployedDevice (car)
+    """
+    return parse_response(device.send_recv("boundStatsReset"))
+
+
+CLOCK_PROFILES = ("performance", "balanced", "low_power")
+
+
+def cmd_clock(device, profile: Optional[str] = None) -> Response:
+    """
+    Report the device's clock profile, or switch to another first.
+
+    Args:
+        device: DeployedDevice
+        profile: one of CLOCK_PROFILES, or None to only report
+
+    Returns:
+        Response whose value is e.g. "profile=performance,hz=80000000";
+        hz is 0 on x86, which runs at host speed whatever the profile
+    """
+    return parse_response(device.send_recv(f"clock {profile}" if profile else "clock"))
+
+
+def get_clock(device, profile: Optional[str] = None) -> dict:
+    """
+    Convenience: cmd_clock as a dict with 'profile' (str) and 'hz' (int).
+
+    Raises:
+        RuntimeError: if command fails
+    """
+    resp = cmd_clock(device, profile)
+    if not resp.success:
+        raise RuntimeError(f"clock failed: {resp.error}")
+    fields = dict(kv.split('=') for kv in resp.value.split(','))
+    return {'profile': fields['profile'], 'hz': int(fields['hz'])}
+
+
+def get_uart_stats(device) -> dict:
+    """
+    Convenience: read the host UART's transmit queue counters as a dict of ints.
+
+    Raises:
+        RuntimeError: if command fails
+    """
+    resp = parse_response(device.send_recv("uartStats"))
+    if not resp.success:
+        raise RuntimeError(f"uartStats failed: {resp.error}")
+    return {k: int(v) for k, v in (kv.split('=') for kv in resp.value.split(','))}
+
+
+def get_hex_bench(device, size: int = 4096) -> dict:
+    """
+    Convenience: benchmark the firmware hex codec on `size` random bytes.
+
+    Returns:
+        dict with 'impl' (str), 'bytes' (int) and encode/decode rates in
+        MB/s (float), scalar and dispatched
+
+    Raises:
+        RuntimeError: if command fails (including SIMD/scalar mismatch)
+    """
+    resp = parse_response(device.send_recv(f"hexBench {size}", timeout=2.0))
+    if not resp.success:
+        raise RuntimeError(f"hexBench failed: {resp.error}")
+    result = dict(kv.split('=') for kv in resp.value.split(','))
+    return {k: (v if k == 'impl' else int(v) if k == 'bytes' else float(v))
+            for k, v in result.items()}
+
+
 # =============================================================================
 # Unlock Flag Reading
 # =============================================================================
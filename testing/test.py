@@ -7,10 +7,13 @@ Or via: ./project.py test
 """
 
 import pytest
-from conftest import RoleConfig
+from conftest import RoleConfig, build_role
 import protocol as proto
+import boot_tool
+import ed25519
 
 
+@pytest.mark.boards(1)
 class TestSinglePairedFob:
     """Tests using only a single paired fob."""
 
@@ -176,6 +179,75 @@ class TestStateManagement:
         assert flash_after.paired == flash_before.paired
         assert flash_after.pair_info.car_id == flash_before.pair_info.car_id
 
+    def test_restart_matches_cold_boot_car(self, car_and_paired_fob):
+        """A warm restart should leave the car exactly as a cold boot does."""
+        car, fob = car_and_paired_fob
+        if car.platform != "x86":
+            pytest.skip("warm and cold restarts differ only on x86")
+
+        resp = proto.cmd_btn_press(fob)
+        assert resp.success, f"btnPress failed: {resp.error}"
+        proto.drain_unlock_flags(car)
+        assert not proto.is_locked(car), "Car should be unlocked"
+
+        resp = proto.cmd_restart(car)
+        assert resp.success, f"Restart failed: {resp.error}"
+        assert resp.value == "started", f"Unexpected restart reply: {resp.value}"
+        warm = proto.get_snapshot(car)
+
+        # Dirty the same state again, then re-exec the same binary
+        resp = proto.cmd_btn_press(fob)
+        assert resp.success, f"btnPress failed: {resp.error}"
+        proto.drain_unlock_flags(car)
+        assert not proto.is_locked(car), "Car should be unlocked"
+
+        resp = proto.cmd_restart_cold(car)
+        assert resp.success, f"Cold restart failed: {resp.error}"
+        assert resp.value == "started", f"Unexpected restart reply: {resp.value}"
+        cold = proto.get_snapshot(car)
+
+        assert warm == cold, f"Warm restart state {warm} differs from cold boot {cold}"
+        assert proto.is_locked(car), "Car should be locked after restart"
+        assert proto.get_unlock_count(car) == 0, "Unlock count should be 0"
+
+        # And the board link must still work without being reopened
+        resp = proto.cmd_btn_press(fob)
+        assert resp.success, f"btnPress after restart failed: {resp.error}"
+        proto.drain_unlock_flags(car)
+        assert proto.get_unlock_count(car) == 1, "Unlock count should be 1"
+
+    def test_restart_matches_cold_boot_fob(self, paired_fob):
+        """A warm restart should reload fob state from flash, as a cold boot does."""
+        custom = proto.FlashData.new_paired(
+            car_id=b'TESTCAR1',
+            password=b'TESTPWD1',
+            pin=b'999999\x00\x00'
+        )
+        if paired_fob.platform != "x86":
+            pytest.skip("warm and cold restarts differ only on x86")
+
+        resp = proto.cmd_set_flash_data(paired_fob, custom)
+        assert resp.success, f"setFlashData failed: {resp.error}"
+        before = proto.cmd_get_flash_data(paired_fob)
+
+        for _ in range(3):
+            resp = proto.cmd_restart(paired_fob)
+            assert resp.success, f"Restart failed: {resp.error}"
+            assert resp.value == "started", f"Unexpected restart reply: {resp.value}"
+        warm = proto.get_snapshot(paired_fob)
+        warm_flash = proto.cmd_get_flash_data(paired_fob)
+
+        resp = proto.cmd_restart_cold(paired_fob)
+        assert resp.success, f"Cold restart failed: {resp.error}"
+        assert resp.value == "started", f"Unexpected restart reply: {resp.value}"
+        cold = proto.get_snapshot(paired_fob)
+        cold_flash = proto.cmd_get_flash_data(paired_fob)
+
+        assert warm == cold, f"Warm restart state {warm} differs from cold boot {cold}"
+        assert warm_flash.value == cold_flash.value == before.value, \
+            "Flash data should survive both restarts"
+        assert proto.is_paired(paired_fob), "Should still be paired"
+
     def test_reset_clears_state(self, paired_fob):
         """Factory reset should clear all state."""
         assert proto.is_paired(paired_fob), "Should start paired"
@@ -205,6 +277,874 @@ class TestStateManagement:
         assert flash.pair_info.password == b'TESTPWD1'
 
 
+class TestSnapshots:
+    """Tests for runtime snapshot and restore."""
+
+    def test_car_snapshot_round_trip(self, car_and_paired_fob):
+        """Restoring a snapshot should bring back lock state and unlock count."""
+        car, fob = car_and_paired_fob
+
+        for i in range(2):
+            resp = proto.cmd_btn_press(fob)
+            assert resp.success, f"btnPress {i+1} failed: {resp.error}"
+            proto.drain_unlock_flags(car)
+
+        snapshot = proto.get_snapshot(car)
+
+        resp = proto.cmd_reset(car)
+        assert resp.success, f"Reset failed: {resp.error}"
+        assert proto.is_locked(car), "Car should be locked after reset"
+
+        resp = proto.cmd_set_snapshot(car, snapshot)
+        assert resp.success, f"setSnapshot failed: {resp.error}"
+        assert not proto.is_locked(car), "Car should be unlocked again"
+        assert proto.get_unlock_count(car) == 2, "Unlock count should be restored"
+        assert proto.get_snapshot(car) == snapshot, "Snapshot should be stable"
+
+    def test_car_snapshot_keeps_link_state(self, car_and_paired_fob):
+        """Fob sessions and the distance-bounding state come back too."""
+        car, fob = car_and_paired_fob
+
+        resp = proto.cmd_btn_press(fob)
+        assert resp.success, f"btnPress failed: {resp.error}"
+        proto.drain_unlock_flags(car)
+        assert proto.cmd_bound(car, 12345).success
+        snapshot = proto.get_snapshot(car)
+
+        resp = proto.cmd_restart(car)
+        assert resp.success, f"Restart failed: {resp.error}"
+        assert proto.get_snapshot(car) != snapshot, "Restart should change the state"
+
+        resp = proto.cmd_set_snapshot(car, snapshot)
+        assert resp.success, f"setSnapshot failed: {resp.error}"
+        assert proto.cmd_bound(car).value.startswith("threshold=12345,")
+        assert proto.get_snapshot(car) == snapshot, "Snapshot should be stable"
+
+        # nextSession (byte 15) must index the session table
+        bad = snapshot[:30] + "ff" + snapshot[32:]
+        assert not proto.cmd_set_snapshot(car, bad).success
+
+    def test_fob_snapshot_transfers_pairing(self, paired_and_unpaired_fob):
+        """An unpaired fob restored from a paired fob's snapshot is paired."""
+        paired, unpaired = paired_and_unpaired_fob
+        assert not proto.is_paired(unpaired), "Should start unpaired"
+
+        snapshot = proto.get_snapshot(paired)
+        resp = proto.cmd_set_snapshot(unpaired, snapshot)
+        assert resp.success, f"setSnapshot failed: {resp.error}"
+
+        assert proto.is_paired(unpaired), "Should now be paired"
+        assert proto.cmd_get_flash_data(unpaired).value == \
+            proto.cmd_get_flash_data(paired).value, "Fob state should match"
+
+    def test_snapshot_rejects_wrong_role(self, car_and_paired_fob):
+        """A car snapshot must not load into a fob, and vice versa."""
+        car, fob = car_and_paired_fob
+
+        resp = proto.cmd_set_snapshot(fob, proto.get_snapshot(car))
+        assert not resp.success, "Fob should reject a car snapshot"
+        resp = proto.cmd_set_snapshot(car, proto.get_snapshot(fob))
+        assert not resp.success, "Car should reject a fob snapshot"
+
+
+class TestImpairedLink:
+    """Tests with an impaired board link (x86 only)."""
+
+    @pytest.fixture(autouse=True)
+    def _x86_only(self, request):
+        if request.config.getoption("--using"):
+            pytest.skip("link impairment is x86-only")
+
+    def test_delayed_link_still_unlocks(self, car_and_paired_fob):
+        """Latency, jitter and a bandwidth cap slow the link but lose nothing."""
+        car, fob = car_and_paired_fob
+
+        resp = proto.cmd_impair(car, "delay=2000,jitter=1000,rate=11520,seed=1")
+        assert resp.success, f"impair failed: {resp.error}"
+
+        resp = proto.cmd_btn_press(fob)
+        assert resp.success, f"btnPress failed: {resp.error}"
+        proto.drain_unlock_flags(car)
+        assert not proto.is_locked(car), "Car should be unlocked"
+
+        stats = proto.get_impair_stats(car)
+        assert stats['in'] > 0, "Car should have received bytes"
+        assert stats['delivered'] == stats['in'], f"Nothing should be lost: {stats}"
+
+    def test_dead_link_blocks_unlock(self, car_and_paired_fob):
+        """With every byte lost the car never sees the unlock request."""
+        car, fob = car_and_paired_fob
+
+        resp = proto.cmd_impair(car, "loss=1")
+        assert resp.success, f"impair failed: {resp.error}"
+
+        resp = proto.cmd_btn_press(fob, timeout=0.5)
+        assert not resp.success, "Unlock should not complete"
+        assert proto.is_locked(car), "Car should still be locked"
+
+        stats = proto.get_impair_stats(car)
+        assert stats['in'] > 0, "Car should have been sent bytes"
+        assert stats['dropped'] == stats['in'], f"Every byte should be lost: {stats}"
+
+    def test_truncated_frames_do_not_stall(self, car_and_paired_fob):
+        """Frames cut short by loss are given up, and the next one gets through."""
+        car, fob = car_and_paired_fob
+
+        resp = proto.cmd_impair(car, "loss=0.3,seed=7")
+        assert resp.success, f"impair failed: {resp.error}"
+        for _ in range(3):
+            proto.cmd_btn_press(fob, timeout=3.0)
+        for device in (car, fob):
+            while device.recv(timeout=0.3):
+                pass
+
+        assert proto.cmd_impair(car, "off").success
+        count = proto.get_unlock_count(car)
+        resp = proto.cmd_btn_press(fob)
+        assert resp.success, f"btnPress after loss failed: {resp.error}"
+        proto.drain_unlock_flags(car)
+        assert proto.get_unlock_count(car) == count + 1
+
+    def test_snapshot_keeps_delayed_bytes(self, car_and_paired_fob):
+        """A snapshot copies delayed bytes without delivering them early."""
+        import time
+        car, fob = car_and_paired_fob
+        assert proto.cmd_bound(car, 0).success
+        resp = proto.cmd_impair(car, "delay=500000")
+        assert resp.success, f"impair failed: {resp.error}"
+        idle = proto.get_snapshot(car)
+
+        start = time.monotonic()
+        fob.send("btnPress")
+        time.sleep(0.2)
+        busy = proto.get_snapshot(car)
+        assert len(busy) > len(idle), "The delayed unlock request should be captured"
+        assert proto.get_snapshot(car) == busy, "Taking a snapshot should change nothing"
+
+        resp = proto.parse_response(fob.recv(timeout=3.0))
+        assert resp.success, f"btnPress failed: {resp.error}"
+        assert time.monotonic() - start >= 0.5, "The delay should still apply"
+        assert proto.drain_unlock_flags(car, timeout=2.0)['unlock']
+
+    def test_invalid_settings_rejected(self, paired_fob):
+        """Unknown keys and out-of-range values are errors."""
+        assert not proto.cmd_impair(paired_fob, "loss=2").success
+        assert not proto.cmd_impair(paired_fob, "nonsense=1").success
+        assert proto.cmd_impair(paired_fob, "off").success
+
+
+class TestDistanceBounding:
+    """Relay detection by timed single-byte rounds (relay simulation is x86-only)."""
+
+    @pytest.fixture(autouse=True)
+    def _x86_only(self, request):
+        if request.config.getoption("--using"):
+            pytest.skip("relay simulation is x86-only")
+
+    def unlock(self, car, fob):
+        """Press the button; True if the car unlocked, False if it refused."""
+        resp = proto.cmd_btn_press(fob)
+        if resp.success:
+            proto.drain_unlock_flags(car)
+            return True
+        assert car.recv() == "ERROR: distance bound failed"
+        return False
+
+    def relay(self, car, fob, us):
+        for device in (car, fob):
+            assert proto.cmd_impair(device, f"relay={us}").success
+
+    def test_unlock_is_bounded(self, car_and_paired_fob):
+        car, fob = car_and_paired_fob
+        assert self.unlock(car, fob)
+
+        stats = proto.get_bound_stats(car)
+        assert stats['n'] == 1 and stats['rejected'] == 0, stats
+        threshold = int(proto.cmd_bound(car).value.split(',')[0].split('=')[1])
+        assert 0 < stats['min'] <= stats['median'] <= stats['held'] <= stats['max'], stats
+        assert stats['held'] < threshold, stats
+        assert stats['wrong'] == 0, stats
+
+    def test_relay_detected(self, car_and_paired_fob):
+        """A relay's forwarding delay is caught; the bare link is not."""
+        car, fob = car_and_paired_fob
+        attempts = 10
+
+        # The simulated link's round trips are set by the host's scheduling;
+        # the build's limit leaves a margin over the held round of a few
+        # unlocks, and is under the 40 ms a 20 ms relay adds to every round
+        threshold = int(proto.cmd_bound(car).value.split(',')[0].split('=')[1])
+        baseline = 0
+        for _ in range(5):
+            assert self.unlock(car, fob)
+            baseline = max(baseline, proto.get_bound_stats(car)['held'])
+        assert baseline < threshold, f"Bare link {baseline} us over the {threshold} us limit"
+
+        rates = {}
+        for relay_us in (0, 1000, 5000, 20000):
+            self.relay(car, fob, relay_us)
+            assert proto.reset_bound_stats(car).success
+            unlocked = sum(self.unlock(car, fob) for _ in range(attempts))
+            stats = proto.get_bound_stats(car)
+            assert stats['n'] == attempts, stats
+            assert stats['rejected'] == attempts - unlocked, stats
+            rates[relay_us] = stats['rejected'] / attempts
+
+        print(f"\nthreshold {threshold} us (link {baseline} us); relay detection rate: " +
+              ", ".join(f"{us} us each way {rate:.0%}" for us, rate in rates.items()))
+        assert rates[0] == 0, "The bare link should never look relayed"
+        assert rates[20000] == 1, "A 40 ms round-trip relay should always be caught"
+
+    def test_preasking_relay_refused(self, car_and_paired_fob):
+        """A relay that asks the fob ahead hides its delay but learns only half the keys."""
+        car, fob = car_and_paired_fob
+        attempts = 5
+        limit = dict(kv.split('=') for kv in proto.cmd_bound(car).value.split(','))
+        threshold, rounds = int(limit['threshold']), int(limit['rounds'])
+        for device in (car, fob):
+            assert proto.cmd_impair(device, "relay=20000,preask=1").success
+
+        assert not any(self.unlock(car, fob) for _ in range(attempts))
+        stats = proto.get_bound_stats(car)
+        assert stats['n'] == stats['rejected'] == attempts, stats
+        assert proto.get_impair_stats(fob)['preasked'] == attempts * rounds
+
+        # Only the first round waits on the relay; pre-asking answers the
+        # rest at once, so the rounds are in time while the answers are not
+        print(f"\npre-asking relay: last check held {stats['held']} us, "
+              f"max {stats['max']} us, {stats['wrong']} of {rounds} rounds wrong")
+        assert stats['held'] < threshold, stats
+        assert stats['wrong'] > 0, "Half the key bits should stay hidden from the relay"
+
+    def test_wrong_key_refused(self, car_and_paired_fob):
+        """The password alone, which crosses the link, does not answer the rounds."""
+        car, fob = car_and_paired_fob
+        flash = proto.get_flash_data(fob)
+        flash.paired = True
+        flash.pair_info.bound_key = bytes(b ^ 1 for b in flash.pair_info.bound_key)
+        assert proto.cmd_set_flash_data(fob, flash).success
+
+        assert not self.unlock(car, fob)
+        assert proto.get_bound_stats(car)['rejected'] == 1
+
+    def test_bounding_off(self, car_and_paired_fob):
+        car, fob = car_and_paired_fob
+        default = proto.cmd_bound(car).value
+        assert proto.cmd_bound(car, 0).success
+        self.relay(car, fob, 20000)
+        assert self.unlock(car, fob), "With bounding off even a slow relay unlocks"
+        assert proto.get_bound_stats(car)['n'] == 0
+
+        assert not proto.cmd_bound(car, "x").success
+
+        # A warm restart puts the limit back, as a cold boot does
+        assert proto.cmd_restart(car).success
+        assert proto.cmd_bound(car).value == default
+        assert not self.unlock(car, fob), "A slow relay is caught again after restart"
+
+
+@pytest.mark.boards(1)
+class TestHexCodec:
+    """Tests for host command hex decoding."""
+
+    def test_invalid_hex_rejected(self, paired_fob):
+        """Non-hex characters and odd lengths must be rejected outright."""
+        before = proto.cmd_get_flash_data(paired_fob).value
+
+        for bad in ["0g", "abc", "zz" * 16, "0 "]:
+            resp = proto.parse_response(paired_fob.send_recv(f"enable {bad}"))
+            assert not resp.success and resp.error == "invalid hex", f"{bad!r}: {resp}"
+
+        resp = proto.parse_response(paired_fob.send_recv("setFlashData " + "x" * len(before)))
+        assert not resp.success, "Invalid flash data hex should be rejected"
+        assert proto.cmd_get_flash_data(paired_fob).value == before, "State must be unchanged"
+
+    def test_mixed_case_accepted(self, paired_fob):
+        """Upper- and lower-case hex decode to the same bytes."""
+        before = proto.cmd_get_flash_data(paired_fob).value
+        resp = proto.parse_response(paired_fob.send_recv("setFlashData " + before.upper()))
+        assert resp.success, f"setFlashData failed: {resp.error}"
+        assert proto.cmd_get_flash_data(paired_fob).value == before
+
+    def test_simd_matches_scalar(self, paired_fob):
+        """The x86 SIMD codec agrees with the table codec at every tail length."""
+        if paired_fob.platform != "x86":
+            pytest.skip("hexBench is x86-only")
+
+        for size in [1, 15, 16, 31, 33, 63, 65, 4097]:
+            proto.get_hex_bench(paired_fob, size)
+
+        bench = proto.get_hex_bench(paired_fob, 16384)
+        print(f"\nhex codec ({bench['impl']}, {bench['bytes']} bytes): "
+              f"encode {bench['encode_scalar']:.0f} -> {bench['encode']:.0f} MB/s, "
+              f"decode {bench['decode_scalar']:.0f} -> {bench['decode']:.0f} MB/s")
+
+
+class TestFeaturePackages:
+    """Tests for signed feature packages."""
+
+    def test_signed_package_unlocks_feature(self, car_and_paired_fob, feature_key):
+        """A package signed for the car enables its feature on the next unlock."""
+        car, fob = car_and_paired_fob
+        seed, _ = feature_key
+
+        resp = proto.cmd_enable(fob, proto.feature_package(b"1", 2, seed))
+        assert resp.success, f"enable failed: {resp.error}"
+        assert proto.get_flash_data(fob).feature_info.features[0] == 2
+
+        assert proto.cmd_btn_press(fob).success
+        flags = proto.drain_unlock_flags(car)
+        assert flags['features'].get(2), f"Feature 2 flag missing: {flags}"
+
+    @pytest.mark.boards(1)
+    def test_tampered_packages_rejected(self, paired_fob, feature_key):
+        """Changed, unsigned, foreign-key and other-car packages enable nothing."""
+        seed, _ = feature_key
+        before = proto.cmd_get_flash_data(paired_fob).value
+
+        signed = proto.feature_package(b"1", 1, seed)
+        other_key, _ = ed25519.keygen()
+        cases = {
+            "other feature": signed[:8] + bytes([2]) + signed[9:],
+            "flipped bit": signed[:40] + bytes([signed[40] ^ 1]) + signed[41:],
+            "other key": proto.feature_package(b"1", 1, other_key),
+            "unsigned": signed[:9] + b"\n",
+            "other car": proto.feature_package(b"2", 1, seed),
+        }
+        for name, package in cases.items():
+            resp = proto.cmd_enable(paired_fob, package)
+            assert not resp.success, f"{name} package was accepted"
+            print(f"\n{name}: {resp.error}", end="")
+        assert proto.cmd_get_flash_data(paired_fob).value == before, "State must be unchanged"
+
+    @pytest.mark.boards(1)
+    def test_verify_within_budget(self, paired_fob, feature_key):
+        """Every signature check the fob makes fits in its latency budget."""
+        seed, _ = feature_key
+        for feature in (1, 2, 3):
+            package = proto.feature_package(b"1", feature, seed)
+            assert proto.cmd_enable(paired_fob, package).success
+
+        stats = proto.get_verify_stats(paired_fob)
+        print(f"\nsignature check: mean {stats['mean']} us, max {stats['max']} us "
+              f"({stats['cycles']} cycles), budget {stats['budget']} us")
+        assert stats['n'] == 3
+        assert stats['max'] <= stats['budget']
+
+    def test_host_batch_signing(self, tmp_path, feature_key):
+        """package_tool signs a batch that verifies, and finds a bad package."""
+        import subprocess
+        from conftest import PROJECT_ROOT, FEATURE_KEY
+
+        batch = tmp_path / "batch.csv"
+        batch.write_text("".join(f"pkg{i},{i % 40},{1 + i % 3}\n" for i in range(200)))
+        tool = ["python3", str(PROJECT_ROOT / "tools" / "package_tool"), "--key", str(FEATURE_KEY)]
+        subprocess.run(tool + ["--batch", str(batch)], cwd=tmp_path, check=True)
+
+        packages = sorted((tmp_path / "application" / "packages").iterdir())
+        assert len(packages) == 200
+        assert all(len(p.read_bytes()) == 73 for p in packages)
+        assert subprocess.run(tool + ["--verify"] + [str(p) for p in packages], cwd=tmp_path).returncode == 0
+
+        data = bytearray(packages[7].read_bytes())
+        data[8] ^= 3
+        packages[7].write_bytes(data)
+        result = subprocess.run(tool + ["--verify"] + [str(p) for p in packages],
+                                cwd=tmp_path, capture_output=True, text=True)
+        assert result.returncode == 1 and f"{packages[7]}: bad signature" in result.stdout
+
+
+class TestSharedBus:
+    """Tests with several boards on one multi-drop board link."""
+
+    def test_fobs_unlock_concurrently(self, deploy_shared_bus):
+        """Three fobs pressed at once should all unlock the car, every round."""
+        import time
+        car, *fobs = deploy_shared_bus([RoleConfig("car", id="1")] +
+                                       [RoleConfig("paired_fob", id="1", pin="123456")] * 3)
+        rounds = 5
+
+        start = time.monotonic()
+        for r in range(rounds):
+            for fob in fobs:
+                fob.send("btnPress")
+            for i, fob in enumerate(fobs):
+                resp = proto.parse_response(fob.recv(timeout=2.0))
+                assert resp.success, f"Round {r+1}, fob {i+1} failed: {resp.error}"
+            for _ in fobs:
+                flags = proto.drain_unlock_flags(car)
+                assert flags['unlock'], f"Round {r+1}: missing unlock flag"
+        elapsed = time.monotonic() - start
+
+        assert proto.get_unlock_count(car) == rounds * len(fobs)
+        print(f"\n{rounds * len(fobs)} unlocks by {len(fobs)} fobs in {elapsed:.2f}s "
+              f"({rounds * len(fobs) / elapsed:.1f} unlocks/s)")
+
+    def test_reserved_address_rejected(self, request):
+        """A simulated fob refuses to start on an address it cannot own."""
+        if request.config.getoption("--using"):
+            pytest.skip("addr= is the simulator's setting")
+        import subprocess
+        binary = build_role(RoleConfig("unpaired_fob"), "x86")
+        for addr in ("0", "1", "0xff", "0x110", "x"):
+            result = subprocess.run([str(binary), f"addr={addr}"],
+                                    capture_output=True, text=True, timeout=5)
+            assert result.returncode != 0, f"addr={addr} should be rejected"
+            assert "Invalid board link address" in result.stderr
+
+    def test_pairing_over_shared_bus(self, deploy_shared_bus):
+        """A broadcast pairing message reaches the unpaired fob past the car."""
+        car, paired, unpaired = deploy_shared_bus([
+            RoleConfig("car", id="1"),
+            RoleConfig("paired_fob", id="1", pin="123456"),
+            RoleConfig("unpaired_fob"),
+        ])
+
+        resp = proto.cmd_pair(paired, "123456")
+        assert resp.success, f"Pair failed: {resp.error}"
+        resp = proto.wait_for_paired(unpaired)
+        assert resp.success, f"Unpaired fob did not pair: {resp.error}"
+
+        resp = proto.cmd_btn_press(unpaired)
+        assert resp.success, f"btnPress on new fob failed: {resp.error}"
+        proto.drain_unlock_flags(car)
+        assert not proto.is_locked(car), "Car should be unlocked"
+
+
+    def test_batch_pairing(self, deploy_shared_bus):
+        """One paired fob pairs several unpaired fobs with one command."""
+        import time
+        paired, *fobs = deploy_shared_bus([RoleConfig("paired_fob", id="1", pin="123456")] +
+                                          [RoleConfig("unpaired_fob")] * 4)
+
+        start = time.monotonic()
+        batch = proto.cmd_pair_batch(paired, "123456", len(fobs))
+        elapsed = time.monotonic() - start
+        assert sorted(batch['addrs']) == [0x11, 0x12, 0x13, 0x14], batch
+        for fob in fobs:
+            resp = proto.wait_for_paired(fob)
+            assert resp.success and resp.value == "paired", resp
+            assert proto.is_paired(fob)
+        print(f"\nbatch pairing: {len(fobs)} fobs in {elapsed * 1000:.0f} ms, "
+              f"{batch['tries']} broadcast(s), {len(fobs) * 60 / elapsed:.0f} fobs/min")
+
+        # Fobs already paired acknowledge a repeat, so a lost ACK is retried
+        again = proto.cmd_pair_batch(paired, "123456", len(fobs))
+        assert sorted(again['addrs']) == sorted(batch['addrs']), again
+
+        resp = proto.parse_response(paired.send_recv(f"pairBatch 123456 {len(fobs) + 1}",
+                                                     timeout=5.0))
+        assert not resp.success and f"{len(fobs)} of {len(fobs) + 1}" in resp.error, resp
+        resp = proto.parse_response(paired.send_recv("pairBatch 654321 1"))
+        assert not resp.success and resp.error == "wrong pin", resp
+
+
+class TestClockProfiles:
+    """Clock profiles switched at run time, and what they do to unlock latency."""
+
+    def test_clock_profile_reported(self, car_and_paired_fob):
+        """Both devices boot in the build's profile, performance by default."""
+        for device in car_and_paired_fob:
+            clock = proto.get_clock(device)
+            assert clock['profile'] == "performance", clock
+            assert clock['hz'] >= 0, clock
+
+    def test_invalid_clock_profile_rejected(self, car_and_paired_fob):
+        car, fob = car_and_paired_fob
+        resp = proto.cmd_clock(fob, "turbo")
+        assert not resp.success, "An unknown profile should be rejected"
+        assert proto.get_clock(fob)['profile'] == "performance"
+
+    def test_unlock_latency_per_profile(self, car_and_paired_fob):
+        """Unlocking works in every profile; the latency of each is reported.
+
+        Before these profiles the TM4C ran as low_power (16 MHz PIOSC) and the
+        STM32 as balanced (84 MHz), so those rows are the old latency.
+        """
+        car, fob = car_and_paired_fob
+        rows = []
+        try:
+            for profile in proto.CLOCK_PROFILES:
+                hz = [proto.get_clock(device, profile)['hz'] for device in (car, fob)]
+                assert proto.reset_unlock_stats(fob).success
+                for _ in range(5):
+                    resp = proto.cmd_btn_press(fob)
+                    assert resp.success, f"Unlock failed at {profile}: {resp.error}"
+                    proto.drain_unlock_flags(car)
+                stats = proto.get_unlock_stats(fob)
+                assert stats['n'] == 5, stats
+                rows.append((profile, hz, stats))
+        finally:
+            for device in (car, fob):
+                proto.cmd_clock(device, "performance")
+
+        print("\nunlock latency by clock profile (us):")
+        for profile, hz, stats in rows:
+            print(f"  {profile:12} car {hz[0] / 1e6:5.1f} MHz, fob {hz[1] / 1e6:5.1f} MHz: "
+                  f"mean {stats['mean']}, min {stats['min']}, max {stats['max']}")
+
+
+class TestBootloader:
+    """Delta updates through the resident bootloader, on the x86 emulated flash."""
+
+    APP_BASE = 0x4000
+
+    def image(self, size=0xE000):
+        """Code-like contents over both sector sizes, with an erased tail."""
+        import random
+        rng = random.Random(93)
+        words = [rng.getrandbits(32) for _ in range(64)]
+        out = bytearray()
+        while len(out) < size - 0x800:
+            out += rng.choice(words).to_bytes(4, "little")
+        return bytes(out[:size - 0x800]) + b"\xff" * 0x800
+
+    def flash(self, boot, address, size):
+        return boot.flash.read_bytes()[address:address + size]
+
+    def test_first_update_writes_image(self, sim_bootloader):
+        image = self.image()
+        stats = boot_tool.update(sim_bootloader.serial, self.APP_BASE, image, restart=False)
+
+        # 12 4 KB sectors from 0x4000, then a 16 KB one; the state is already blank
+        assert stats.written == 13, stats
+        assert stats.sectors == 14, stats
+        assert stats.sent < stats.raw, "Blocks should compress"
+        assert self.flash(sim_bootloader, self.APP_BASE, len(image)) == image
+        assert sim_bootloader.wait_exit() == 0, "BOOT should start the application"
+        print(f"\nfirst update: {stats.written} sectors, {stats.sent}/{stats.raw} bytes "
+              f"at {stats.baud} baud in {stats.seconds:.2f}s")
+
+    def test_unchanged_image_sends_nothing(self, sim_bootloader):
+        image = self.image()
+        boot_tool.update(sim_bootloader.serial, self.APP_BASE, image, restart=False, start_app=False)
+        stats = boot_tool.update(sim_bootloader.serial, self.APP_BASE, image, restart=False)
+        assert stats.written == 0 and stats.sent == 0, stats
+
+    def test_one_byte_change_rewrites_one_sector(self, sim_bootloader):
+        image = bytearray(self.image())
+        boot_tool.update(sim_bootloader.serial, self.APP_BASE, bytes(image),
+                         restart=False, start_app=False)
+
+        image[0x5123] ^= 0x5A
+        stats = boot_tool.update(sim_bootloader.serial, self.APP_BASE, bytes(image),
+                                 restart=False, start_app=False)
+        assert stats.changed == [0x9000], stats
+        assert stats.raw == 0x1000, "Only the changed sector should be sent"
+        assert self.flash(sim_bootloader, self.APP_BASE, len(image)) == image
+
+    def test_app_starts_after_reset(self, sim_bootloader):
+        """With a valid application the bootloader only listens briefly."""
+        boot_tool.update(sim_bootloader.serial, self.APP_BASE, self.image(), restart=False)
+        assert sim_bootloader.wait_exit() == 0
+        sim_bootloader.start()
+        assert sim_bootloader.wait_exit(timeout=3.0) == 0, "The application should start on its own"
+
+    def test_software_reset_skips_listening(self, sim_bootloader):
+        """A restart goes straight back to the application; a reset by hand listens."""
+        import time
+        boot_tool.update(sim_bootloader.serial, self.APP_BASE, self.image(), restart=False)
+        assert sim_bootloader.wait_exit() == 0
+
+        began = time.monotonic()
+        sim_bootloader.start(software_reset=True)
+        assert sim_bootloader.wait_exit(timeout=3.0) == 0
+        restart_s = time.monotonic() - began
+
+        began = time.monotonic()
+        sim_bootloader.start()
+        assert sim_bootloader.wait_exit(timeout=3.0) == 0
+        listen_s = time.monotonic() - began
+        assert restart_s < 0.2 <= listen_s, (restart_s, listen_s)
+        print(f"\nsoftware reset {restart_s * 1000:.0f} ms, power-on {listen_s * 1000:.0f} ms")
+
+    def test_state_sector_erased_unless_kept(self, sim_bootloader):
+        image = self.image()
+        sim_bootloader.stop()
+        flash = bytearray(sim_bootloader.flash.read_bytes())
+        flash[0x20000:0x20010] = bytes(16)
+        sim_bootloader.flash.write_bytes(bytes(flash))
+        sim_bootloader.start()
+
+        boot_tool.update(sim_bootloader.serial, self.APP_BASE, image, keep_state=True,
+                         restart=False, start_app=False)
+        assert self.flash(sim_bootloader, 0x20000, 16) == bytes(16), "State should be kept"
+        link = boot_tool.BootLink(sim_bootloader.serial)
+        state = [r for r in link.hello() if r.kind == boot_tool.REGION_STATE]
+        assert link.hashes(state[0], 0, 1) == [bytes(16)], "A saved state's hash should not be given out"
+
+        stats = boot_tool.update(sim_bootloader.serial, self.APP_BASE, image,
+                                 restart=False, start_app=False)
+        assert stats.changed == [0x20000], stats
+        assert self.flash(sim_bootloader, 0x20000, 0x1000) == b"\xff" * 0x1000
+
+    def test_only_signed_image_started(self, sim_bootloader, tmp_path):
+        """Anyone on the host UART can rewrite the application, so only a signed one runs."""
+        image = self.image()
+        foreign = tmp_path / "foreign_key.json"
+        ed25519.load_keypair(foreign, create=True)
+        with pytest.raises(boot_tool.BootError, match="not signed"):
+            boot_tool.update(sim_bootloader.serial, self.APP_BASE, image, restart=False, key=foreign)
+        link = boot_tool.BootLink(sim_bootloader.serial)
+        with pytest.raises(boot_tool.BootError, match="not signed"):
+            link.boot()
+        sim_bootloader.start()
+        assert sim_bootloader.wait_exit(timeout=1.0) is None, "An unsigned image should not start"
+
+        # Signed, then changed through the bootloader: the signature no longer holds
+        boot_tool.update(sim_bootloader.serial, self.APP_BASE, image, restart=False, start_app=False)
+        link.request(boot_tool.CMD_ERASE, bytes([1, 5, 0]))
+        with pytest.raises(boot_tool.BootError, match="not signed"):
+            link.boot()
+
+        # Signing erases whatever was left past the signed image
+        boot_tool.update(sim_bootloader.serial, self.APP_BASE, image[:0x2000], restart=False)
+        assert self.flash(sim_bootloader, self.APP_BASE + 0x2000, 0x1000) == b"\xff" * 0x1000
+        assert sim_bootloader.wait_exit() == 0
+
+    def test_bootloader_protected(self, sim_bootloader):
+        with pytest.raises(boot_tool.BootError, match="overlaps the bootloader"):
+            boot_tool.update(sim_bootloader.serial, 0x3000, self.image(0x2000), restart=False)
+
+        link = boot_tool.BootLink(sim_bootloader.serial)
+        link.hello()
+        with pytest.raises(boot_tool.BootError, match="protected"):
+            link.request(boot_tool.CMD_ERASE, bytes([0, 0, 0]))
+
+
+class TestMeasuredBoot:
+    """Measurement of the application by the bootloader, on the x86 emulated flash."""
+
+    APP_BASE = TestBootloader.APP_BASE
+    SECTORS = 16
+
+    def image(self):
+        return TestBootloader().image()
+
+    def measure_line(self, boot, timeout=3.0):
+        """The fields of the next "boot: measure" line from the bootloader."""
+        import time
+        deadline = time.monotonic() + timeout
+        while time.monotonic() < deadline:
+            line = boot.serial.readline()
+            start = line.find(b"boot: measure ")
+            if start >= 0:
+                fields = line[start + 14:].decode().strip().split(",")
+                return dict(f.split("=") for f in fields)
+        raise AssertionError("no measurement line from the bootloader")
+
+    def tamper(self, boot, address):
+        """Change flash behind the bootloader's back, as a probe would."""
+        boot.stop()
+        flash = bytearray(boot.flash.read_bytes())
+        flash[address] ^= 0xA5
+        boot.flash.write_bytes(bytes(flash))
+        boot.start()
+
+    def test_only_rewritten_sectors_hashed(self, sim_bootloader):
+        image = bytearray(self.image())
+        boot_tool.update(sim_bootloader.serial, self.APP_BASE, bytes(image),
+                         restart=False, start_app=False)
+        link = boot_tool.BootLink(sim_bootloader.serial)
+
+        first = link.measure()
+        assert first.hashed == self.SECTORS and first.tampered == 0, first
+        again = link.measure()
+        assert again.hashed == 0 and again.image == first.image, again
+
+        image[0x5123] ^= 0x5A
+        boot_tool.update(sim_bootloader.serial, self.APP_BASE, bytes(image),
+                         restart=False, start_app=False)
+        changed = link.measure()
+        assert changed.hashed == 1 and changed.image != first.image, changed
+
+        # The digests survive a reset in the record
+        sim_bootloader.start()
+        link.enter(restart=False)
+        after_reset = link.measure()
+        assert after_reset.hashed == 0 and after_reset.image == changed.image, after_reset
+        print(f"\nmeasure: all {self.SECTORS} sectors {first.us} us, "
+              f"one sector {changed.us} us, none {after_reset.us} us")
+
+    def test_boot_reports_measurement(self, sim_bootloader):
+        stats = boot_tool.update(sim_bootloader.serial, self.APP_BASE, self.image(), restart=False)
+        assert stats.measured.hashed == self.SECTORS and stats.measured.tampered == 0, stats
+        assert sim_bootloader.wait_exit() == 0
+
+        sim_bootloader.start()
+        line = self.measure_line(sim_bootloader)
+        assert line["hashed"] == "0" and line["sectors"] == str(self.SECTORS), line
+        assert sim_bootloader.wait_exit(timeout=3.0) == 0, "The application should start on its own"
+
+    def test_tampered_sector_blocks_boot(self, sim_bootloader):
+        image = self.image()
+        boot_tool.update(sim_bootloader.serial, self.APP_BASE, image,
+                         restart=False, start_app=False)
+        link = boot_tool.BootLink(sim_bootloader.serial)
+        link.measure()
+
+        self.tamper(sim_bootloader, 0x5010)
+        link.enter(restart=False)
+        assert link.measure().tampered == 0, "Only a full check hashes unchanged sectors"
+        full = link.measure(full=True)
+        assert full.hashed == self.SECTORS and full.tampered == 1, full
+        with pytest.raises(boot_tool.BootError, match="integrity"):
+            link.boot()
+
+        # The mark is kept, so a reset does not start the application either
+        sim_bootloader.start()
+        assert self.measure_line(sim_bootloader)["tampered"] == "1"
+        assert sim_bootloader.wait_exit(timeout=1.0) is None
+
+        # Rewriting the sector through the bootloader clears it
+        stats = boot_tool.update(sim_bootloader.serial, self.APP_BASE, image, restart=False)
+        assert stats.changed == [0x5000], stats
+        assert sim_bootloader.wait_exit() == 0
+
+    def test_record_protected(self, sim_bootloader):
+        link = boot_tool.BootLink(sim_bootloader.serial)
+        regions = link.hello()
+        record = [r for r in regions if r.kind == boot_tool.REGION_RECORD]
+        assert len(record) == 1, regions
+        with pytest.raises(boot_tool.BootError, match="protected"):
+            link.request(boot_tool.CMD_ERASE, bytes([record[0].index, 0, 0]))
+
+
+class TestFarm:
+    """Bench leasing and quarantine, on virtual ports standing in for boards."""
+
+    @pytest.fixture
+    def inventory(self, tmp_path):
+        import json
+        from virtualserialports import VirtualSerialPorts
+        vsp = VirtualSerialPorts(5)
+        vsp.open()
+        vsp.start()
+        ports = vsp.ports
+        path = tmp_path / "farm.json"
+        path.write_text(json.dumps({"benches": [
+            {"name": "big", "platform": "stm32", "ports": ports[2:5]},
+            {"name": "small", "platform": "tm4c", "ports": ports[0:2]},
+            {"name": "dead", "platform": "tm4c", "ports": ["/dev/missing0", "/dev/missing1"],
+             "shared_bus": True},
+        ]}))
+        yield path
+        vsp.stop()
+        vsp.close()
+
+    def test_leases_are_exclusive(self, inventory):
+        from farm import Farm
+        farm, other = Farm(inventory), Farm(inventory)
+
+        first = farm.lease(2, timeout=1)
+        assert first.bench.name == "small", "The smallest bench that fits goes first"
+        second = other.lease(2, timeout=1)
+        assert second.bench.name == "big"
+        with pytest.raises(TimeoutError):
+            other.lease(2, timeout=1)
+        assert "leased" in farm.status()[0]
+
+        farm.release(first)
+        assert other.lease(2, timeout=1).bench.name == "small"
+        assert Farm(inventory, ["stm32"]).candidates(2)[0].name == "big"
+
+    def test_failing_bench_quarantined(self, inventory):
+        from farm import Farm, QUARANTINE_AFTER
+        farm = Farm(inventory)
+
+        with pytest.raises(RuntimeError, match="quarantined"):
+            farm.lease(2, shared_bus=True, timeout=10)
+        health = farm.health()["dead"]
+        assert health.quarantined and health.failures == QUARANTINE_AFTER, health
+        assert "QUARANTINED" in farm.status()[2]
+
+        farm.unquarantine("dead")
+        assert not farm.health()["dead"].quarantined
+
+
+class TestHostLink:
+    """Many commands in flight through the native host-link library."""
+
+    @pytest.fixture
+    def link(self, car_and_paired_fob):
+        import subprocess
+        from conftest import PROJECT_ROOT
+        from hostlink import HostLink
+        subprocess.run(["scons", "hostlink=1"], cwd=PROJECT_ROOT, check=True, capture_output=True)
+
+        # The library takes over the ports from pyserial
+        car, fob = car_and_paired_fob
+        with HostLink() as link:
+            devs = []
+            for device in (car, fob):
+                device.serial.close()
+                devs.append(link.add(device.serial.port, depth=8))
+            yield link, devs
+
+    def test_pipelined_replies_in_order(self, link):
+        link, (car, fob) = link
+        jobs = [(fob, "isPaired"), (car, "isLocked"), (fob, "pair"), (car, "getUnlockCount")] * 25
+        replies = link.run(jobs)
+
+        for (dev, cmd), reply in zip(jobs, replies):
+            assert reply.dev == dev
+            if cmd == "pair":
+                assert not reply.success and reply.error, reply
+            else:
+                assert reply.success and reply.value in ("0", "1"), f"{cmd}: {reply}"
+
+    def test_unsolicited_lines_kept_apart(self, link):
+        link, (car, fob) = link
+        assert link.command(fob, "btnPress", timeout=5.0).success
+
+        # The car's unlock flags arrive with no command outstanding
+        import time
+        deadline = time.monotonic() + 2.0
+        while "done" not in link.lines[car] and time.monotonic() < deadline:
+            link.poll(0.1)
+        assert link.lines[car][-1] == "OK: done", list(link.lines[car])
+        assert link.command(car, "isLocked").value == "0"
+
+    def test_pipelining_beats_round_trips(self, link):
+        import time
+        link, (car, fob) = link
+        n = 200
+
+        start = time.monotonic()
+        for _ in range(n // 2):
+            link.command(car, "isLocked")
+            link.command(fob, "isPaired")
+        serial_s = time.monotonic() - start
+
+        start = time.monotonic()
+        link.run([(car, "isLocked"), (fob, "isPaired")] * (n // 2))
+        pipelined_s = time.monotonic() - start
+
+        print(f"\n{n} commands: one at a time {serial_s * 1000:.0f} ms, "
+              f"pipelined {pipelined_s * 1000:.0f} ms")
+        assert pipelined_s < serial_s
+
+
+class TestTransmitQueue:
+    """Replies go out through the UART transmit queue."""
+
+    def test_pipelined_replies_intact(self, paired_fob):
+        """Replies to commands sent in one burst come back whole and in order."""
+        if paired_fob.platform != "x86":
+            pytest.skip("uartStats is x86-only")
+
+        expected = proto.cmd_get_flash_data(paired_fob).value
+        n = 10
+        paired_fob.serial.write(b"getFlashData\nisPaired\n" * n)
+        for i in range(n):
+            assert proto.parse_response(paired_fob.recv()).value == expected, f"reply {i}"
+            assert proto.parse_response(paired_fob.recv()).value == "1", f"reply {i}"
+
+        stats = proto.get_uart_stats(paired_fob)
+        assert stats["queued"] == 0 and stats["dropped"] == 0, stats
+        assert stats["peak"] <= stats["size"], stats
+
+
 class TestCustomConfigurations:
     """Tests that deploy custom role configurations."""
 
@@ -240,4 +1180,44 @@ class TestTiming:
         proto.drain_unlock_flags(car)
 
         assert resp.success, f"Unlock failed: {resp.error}"
-        assert elapsed < 1.0, f"Unlock took {elapsed:.2f}s, should be <1s"
\ No newline at end of file
+        assert elapsed < 1.0, f"Unlock took {elapsed:.2f}s, should be <1s"
+
+    def test_unlock_latency_stats(self, car_and_paired_fob):
+        """The fob keeps running statistics of each unlock's round trip."""
+        car, fob = car_and_paired_fob
+        before = proto.get_unlock_stats(fob)['n']
+
+        for _ in range(3):
+            resp = proto.cmd_btn_press(fob)
+            assert resp.success, f"Unlock failed: {resp.error}"
+            proto.drain_unlock_flags(car)
+
+        stats = proto.get_unlock_stats(fob)
+        assert stats['n'] == before + 3, f"Every unlock should be counted: {stats}"
+        assert 0 < stats['min'] <= stats['mean'] <= stats['max'] < 1_000_000, stats
+        assert stats['std'] <= stats['max'] - stats['min'], stats
+
+    def test_restart_completes_within_1ms(self, paired_fob):
+        """A warm restart on x86 should take microseconds, well under a cold one."""
+        if paired_fob.platform != "x86":
+            pytest.skip("warm restart is x86-only")
+
+        # Firmware-measured, so serial round trips and scheduling of the
+        # test process do not count; best of a few rides out a preemption
+        warm_us = []
+        for _ in range(5):
+            resp = proto.cmd_restart(paired_fob)
+            assert resp.success, f"Restart failed: {resp.error}"
+            stats = proto.get_restart_stats(paired_fob)
+            assert stats['kind'] == "warm", stats
+            warm_us.append(stats['us'])
+
+        resp = proto.cmd_restart_cold(paired_fob)
+        assert resp.success, f"Cold restart failed: {resp.error}"
+        stats = proto.get_restart_stats(paired_fob)
+        assert stats['kind'] == "cold", stats
+        cold_us = stats['us']
+
+        print(f"\nwarm restart: {warm_us} us, cold restart: {cold_us} us")
+        assert min(warm_us) < 1000, f"Warm restart took {min(warm_us)}us, should be <1ms"
+        assert min(warm_us) < cold_us, "A warm restart should beat re-exec'ing"
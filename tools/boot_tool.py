@@ -0,0 +1,453 @@
+#!/usr/bin/python3 -u
+
+# @file boot_tool.py
+# @brief Reflash a board through the resident UART bootloader, sending only
+#        the flash sectors that changed
+#
+# The bootloader (hardware/boot) reports its flash layout and a hash of any
+# sector on request. Each sector the new image covers is compared by hash
+# and only those that differ are erased and rewritten, one compressed
+# block at a time of the size HELLO reports, after switching the link to
+# the fastest baud rate both ends accept. The state sector is erased too,
+# as a full reflash would leave it, unless --keep-state is given.
+#
+# A running test build is sent "bootloader" first: it resets asking the
+# bootloader to listen, which it otherwise skips after a software reset
+# (boot_request.h). A board reset by hand always gets the window.
+#
+# The bootloader measures the application before starting it, hashing only
+# the sectors rewritten since the last measurement (see measure.h).
+# --measure asks for a measurement without updating, and --full for one
+# that hashes every sector to find changes made other than through the
+# bootloader.
+#
+# The bootloader only starts an image signed with the bootloader's key
+# (secrets/boot_key.json, or --key), so every update ends with SIGN.
+
+import argparse
+import binascii
+import hashlib
+import struct
+import sys
+import time
+from dataclasses import dataclass, field
+from pathlib import Path
+from typing import Dict, List, Optional, Tuple
+
+import serial
+
+import ed25519
+
+SOF = 0xB7
+REPLY = 0x80
+
+CMD_HELLO = 0x01
+CMD_HASH = 0x02
+CMD_BAUD = 0x03
+CMD_ERASE = 0x04
+CMD_WRITE = 0x05
+CMD_BOOT = 0x06
+CMD_MEASURE = 0x07
+CMD_SIGN = 0x08
+
+STATUS = ["ok", "bad command", "out of range", "protected", "bad data", "flash error",
+          "baud rate not supported", "no application", "integrity check failed", "image not signed"]
+
+REGION_BOOT = 0
+REGION_APP = 1
+REGION_STATE = 2
+REGION_RECORD = 3
+
+BOOT_KEY = Path(__file__).resolve().parent.parent / "secrets" / "boot_key.json"
+
+DEFAULT_BAUD = 115200
+BAUD_RATES = [1000000, 921600, 460800, 230400]
+BAUD_CONFIRM_S = 1.0
+BOOT_VERSIONS = (3,)
+HASH_SIZE = 16
+MAX_HASHES = 64
+WRITE_HEADER = 7              # region (u8), sector (u16), offset (u32)
+
+LITERAL_MAX = 128
+MATCH_MIN = 3
+MATCH_MAX = 130
+
+
+class BootError(Exception):
+    pass
+
+
+@dataclass
+class Region:
+    index: int
+    base: int
+    sector_size: int
+    count: int
+    kind: int
+
+    def sector(self, i):
+        return self.base + i * self.sector_size
+
+
+@dataclass
+class Stats:
+    sectors: int = 0          # compared by hash
+    written: int = 0          # erased and rewritten
+    sent: int = 0             # compressed bytes of WRITE data
+    raw: int = 0              # the blocks they decode to
+    baud: int = DEFAULT_BAUD
+    seconds: float = 0.0
+    changed: List[int] = field(default_factory=list)   # addresses of rewritten sectors
+    measured: Optional["MeasureReport"] = None         # from BOOT, if the application was started
+
+
+@dataclass
+class MeasureReport:
+    us: int                   # time the bootloader took
+    hashed: int               # sectors hashed
+    sectors: int              # application sectors
+    tampered: int             # sectors that differ from their recorded digest
+    full: bool                # every sector was hashed
+    image: bytes              # digest over the sector digests
+
+    @classmethod
+    def unpack(cls, data: bytes) -> "MeasureReport":
+        us, hashed, sectors, tampered, full, image = struct.unpack_from("<IHHHB16s", data)
+        return cls(us, hashed, sectors, tampered, bool(full), image)
+
+
+def compress(data: bytes) -> bytes:
+    """Encode a block as literal runs and back references (see boot.h)"""
+    out = bytearray()
+    literals = bytearray()
+    last: Dict[bytes, int] = {}
+    i = 0
+
+    def flush():
+        for start in range(0, len(literals), LITERAL_MAX):
+            run = literals[start:start + LITERAL_MAX]
+            out.append(len(run) - 1)
+            out.extend(run)
+        literals.clear()
+
+    while i < len(data):
+        best_len = 0
+        best_dist = 0
+        # A run of one byte repeated is a match at distance 1
+        if i > 0 and data[i] == data[i - 1]:
+            n = 0
+            while i + n < len(data) and n < MATCH_MAX and data[i + n] == data[i - 1]:
+                n += 1
+            best_len, best_dist = n, 1
+        key = bytes(data[i:i + MATCH_MIN])
+        j = last.get(key)
+        if j is not None and len(key) == MATCH_MIN:
+            n = 0
+            while i + n < len(data) and n < MATCH_MAX and data[j + n] == data[i + n]:
+                n += 1
+            if n > best_len:
+                best_len, best_dist = n, i - j
+
+        if best_len >= MATCH_MIN:
+            flush()
+            out.append(0x80 | (best_len - MATCH_MIN))
+            out += struct.pack("<H", best_dist)
+            for k in range(i, i + best_len):
+                last[bytes(data[k:k + MATCH_MIN])] = k
+            i += best_len
+        else:
+            last[key] = i
+            literals.append(data[i])
+            i += 1
+    flush()
+    return bytes(out)
+
+
+def load_image(path: Path, base: Optional[int] = None) -> Tuple[int, bytes]:
+    """Flash base address and contents of an ELF's loaded segments, or of a raw binary"""
+    data = path.read_bytes()
+    if data[:4] != b"\x7fELF":
+        if base is None:
+            raise BootError(f"{path} is not an ELF file; give its --base address")
+        return base, data
+
+    if data[4] != 1 or data[5] != 1:
+        raise BootError(f"{path}: only 32-bit little-endian ELF files are supported")
+    phoff, = struct.unpack_from("<I", data, 28)
+    phentsize, phnum = struct.unpack_from("<HH", data, 42)
+    segments = []
+    for n in range(phnum):
+        p_type, p_offset, _, p_paddr, p_filesz = struct.unpack_from("<IIIII", data, phoff + n * phentsize)
+        if p_type == 1 and p_filesz:
+            segments.append((p_paddr, data[p_offset:p_offset + p_filesz]))
+    if not segments:
+        raise BootError(f"{path} has nothing to load")
+
+    start = min(a for a, _ in segments)
+    end = max(a + len(s) for a, s in segments)
+    image = bytearray(b"\xff" * (end - start))
+    for address, contents in segments:
+        image[address - start:address - start + len(contents)] = contents
+    return start, bytes(image)
+
+
+def sector_hash(data: bytes) -> bytes:
+    return hashlib.sha256(data).digest()[:HASH_SIZE]
+
+
+class BootLink:
+    """Request and reply frames with the bootloader over a serial port"""
+
+    def __init__(self, ser: serial.Serial):
+        self.ser = ser
+        self.block_size = 1024    # largest decompressed WRITE, from HELLO
+        self.max_payload = 1088   # largest request payload, from HELLO
+
+    def send(self, cmd: int, payload: bytes = b"") -> None:
+        body = struct.pack("<BH", cmd, len(payload)) + payload
+        crc = binascii.crc_hqx(body, 0xFFFF)
+        self.ser.write(bytes([SOF]) + body + struct.pack("<H", crc))
+        self.ser.flush()
+
+    def receive(self, cmd: int, timeout: float) -> Optional[Tuple[int, bytes]]:
+        deadline = time.monotonic() + timeout
+        buf = bytearray()
+        while time.monotonic() < deadline:
+            self.ser.timeout = max(0.001, deadline - time.monotonic())
+            chunk = self.ser.read(max(1, self.ser.in_waiting))
+            buf += chunk
+            # Skip to a start of frame with the expected reply
+            while buf and (buf[0] != SOF or (len(buf) > 1 and buf[1] != cmd | REPLY)):
+                del buf[0]
+            if len(buf) < 4:
+                continue
+            length, = struct.unpack_from("<H", buf, 2)
+            if len(buf) < 4 + length + 2:
+                continue
+            body = bytes(buf[1:4 + length])
+            crc, = struct.unpack_from("<H", buf, 4 + length)
+            if length >= 1 and binascii.crc_hqx(body, 0xFFFF) == crc:
+                return body[3], body[4:]
+            del buf[0]
+        return None
+
+    def request(self, cmd: int, payload: bytes = b"", timeout: float = 1.0, retries: int = 3) -> bytes:
+        for _ in range(retries + 1):
+            self.send(cmd, payload)
+            reply = self.receive(cmd, timeout)
+            if reply is None:
+                continue
+            status, data = reply
+            if status != 0:
+                name = STATUS[status] if status < len(STATUS) else f"status {status}"
+                raise BootError(f"command {cmd:#04x} failed: {name}")
+            return data
+        raise BootError(f"no reply to command {cmd:#04x}")
+
+    def enter(self, restart: bool = True, timeout: float = 3.0) -> List[Region]:
+        """Catch the bootloader after a reset and read its flash layout"""
+        self.ser.baudrate = DEFAULT_BAUD
+        self.ser.reset_input_buffer()
+        if restart:
+            self.ser.write(b"\nbootloader\n")
+        deadline = time.monotonic() + timeout
+        while time.monotonic() < deadline:
+            try:
+                return self.hello(timeout=0.05, retries=0)
+            except BootError:
+                continue
+        raise BootError("the bootloader did not answer; reset the board and try again")
+
+    def hello(self, timeout: float = 1.0, retries: int = 3) -> List[Region]:
+        data = self.request(CMD_HELLO, timeout=timeout, retries=retries)
+        version, block_size, max_payload, count = struct.unpack_from("<BHHB", data)
+        if version not in BOOT_VERSIONS:
+            raise BootError(f"unsupported bootloader version {version}")
+        if block_size < 4 or max_payload <= WRITE_HEADER:
+            raise BootError(f"bootloader reports block size {block_size}, max payload {max_payload}")
+        self.block_size, self.max_payload = block_size, max_payload
+        return [Region(r, *struct.unpack_from("<IIHB", data, 6 + 11 * r)) for r in range(count)]
+
+    def set_baud(self, rates: List[int]) -> int:
+        """Switch to the first rate both ends can run; DEFAULT_BAUD if none"""
+        for baud in rates:
+            try:
+                self.request(CMD_BAUD, struct.pack("<I", baud))
+            except BootError:
+                continue
+            self.ser.baudrate = baud
+            time.sleep(0.01)
+            try:
+                self.hello(timeout=0.2, retries=1)
+                return baud
+            except BootError:
+                # The bootloader returns to the default rate when it hears nothing
+                self.ser.baudrate = DEFAULT_BAUD
+                time.sleep(BAUD_CONFIRM_S + 0.1)
+                self.ser.reset_input_buffer()
+                self.hello()
+        return DEFAULT_BAUD
+
+    def hashes(self, region: Region, first: int, count: int) -> List[bytes]:
+        out = []
+        for start in range(first, first + count, MAX_HASHES):
+            n = min(MAX_HASHES, first + count - start)
+            data = self.request(CMD_HASH, struct.pack("<BHH", region.index, start, n), timeout=5.0)
+            out += [data[i:i + HASH_SIZE] for i in range(0, len(data), HASH_SIZE)]
+        return out
+
+    def write_sector(self, region: Region, index: int, contents: bytes, stats: Stats) -> None:
+        """Erase a sector and write it back in blocks of the size HELLO reported"""
+        self.request(CMD_ERASE, struct.pack("<BH", region.index, index), timeout=5.0)
+        for offset in range(0, len(contents), self.block_size):
+            self.write_block(region, index, offset, contents[offset:offset + self.block_size], stats)
+
+    def write_block(self, region: Region, index: int, offset: int, block: bytes, stats: Stats) -> None:
+        if block.count(0xFF) == len(block):
+            return
+        packed = compress(block)
+        # A block that does not compress may not fit the payload; send it in
+        # halves, keeping offsets word aligned
+        if WRITE_HEADER + len(packed) > self.max_payload and len(block) > 4:
+            half = (len(block) // 2 + 3) & ~3
+            self.write_block(region, index, offset, block[:half], stats)
+            self.write_block(region, index, offset + half, block[half:], stats)
+            return
+        self.request(CMD_WRITE, struct.pack("<BHI", region.index, index, offset) + packed)
+        stats.sent += len(packed)
+        stats.raw += len(block)
+
+    def measure(self, full: bool = False) -> MeasureReport:
+        """Measure the application: the stale sectors, or all of them"""
+        return MeasureReport.unpack(self.request(CMD_MEASURE, bytes([full]), timeout=10.0))
+
+    def sign(self, length: int, signature: bytes) -> None:
+        """Have the bootloader check the image's signature; it erases the sectors past it"""
+        self.request(CMD_SIGN, struct.pack("<I", length) + signature, timeout=10.0)
+
+    def boot(self) -> MeasureReport:
+        """Start the application; the reply carries the measurement it passed"""
+        return MeasureReport.unpack(self.request(CMD_BOOT, timeout=10.0))
+
+
+def plan(regions: List[Region], base: int, image: bytes, keep_state: bool) -> List[Tuple[Region, int, bytes]]:
+    """Every sector to check, with the contents it should have"""
+    end = base + len(image)
+    sectors = []
+    covered = 0
+    for region in regions:
+        for i in range(region.count):
+            start = region.sector(i)
+            stop = start + region.sector_size
+            if region.kind == REGION_STATE and not keep_state:
+                sectors.append((region, i, b"\xff" * region.sector_size))
+            elif start < end and base < stop:
+                if region.kind != REGION_APP:
+                    raise BootError(f"image overlaps the bootloader at {start:#x}; "
+                                    "was it built with bootloader=1?")
+                contents = bytearray(b"\xff" * region.sector_size)
+                lo, hi = max(start, base), min(stop, end)
+                contents[lo - start:hi - start] = image[lo - base:hi - base]
+                sectors.append((region, i, bytes(contents)))
+                covered += hi - lo
+    if covered != len(image):
+        raise BootError("image does not fit the application's flash")
+    return sectors
+
+
+def update(ser: serial.Serial, base: int, image: bytes, baud: int = BAUD_RATES[0],
+           keep_state: bool = False, restart: bool = True, start_app: bool = True,
+           key: Path = BOOT_KEY) -> Stats:
+    """Bring the board's flash to the image, rewriting only sectors that differ"""
+    began = time.monotonic()
+    link = BootLink(ser)
+    stats = Stats()
+    try:
+        seed, public = ed25519.load_keypair(key)
+    except (OSError, ValueError) as e:
+        raise BootError(f"cannot sign the image: {e}")
+
+    regions = link.enter(restart)
+    rates = [b for b in BAUD_RATES if b <= baud]
+    if baud not in rates and baud != DEFAULT_BAUD:
+        rates.insert(0, baud)
+    stats.baud = link.set_baud(rates)
+
+    sectors = plan(regions, base, image, keep_state)
+    stats.sectors = len(sectors)
+    app = [r for r in regions if r.kind == REGION_APP]
+    if base != app[0].base:
+        raise BootError(f"image starts at {base:#x}, not at the application's {app[0].base:#x}")
+
+    # One HASH request per run of sectors in a region
+    have: Dict[Tuple[int, int], bytes] = {}
+    by_region: Dict[int, List[int]] = {}
+    for region, i, _ in sectors:
+        by_region.setdefault(region.index, []).append(i)
+    for r, indices in by_region.items():
+        first, last = min(indices), max(indices)
+        for i, h in zip(range(first, last + 1), link.hashes(regions[r], first, last - first + 1)):
+            have[(r, i)] = h
+
+    for region, i, contents in sectors:
+        if have[(region.index, i)] == sector_hash(contents):
+            continue
+        link.write_sector(region, i, contents, stats)
+        if link.hashes(region, i, 1)[0] != sector_hash(contents):
+            raise BootError(f"sector at {region.sector(i):#x} does not verify")
+        stats.written += 1
+        stats.changed.append(region.sector(i))
+
+    link.sign(len(image), ed25519.sign(seed, image, public))
+    if start_app:
+        stats.measured = link.boot()
+    ser.baudrate = DEFAULT_BAUD
+    stats.seconds = time.monotonic() - began
+    return stats
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--port", required=True, help="serial port of the board's host UART")
+    parser.add_argument("--bin", type=Path, help="ELF file, or raw binary with --base")
+    parser.add_argument("--base", type=lambda s: int(s, 0), help="flash address of a raw binary")
+    parser.add_argument("--baud", type=int, default=BAUD_RATES[0],
+                        help="fastest baud rate to try for the transfer")
+    parser.add_argument("--keep-state", action="store_true", help="leave the saved device state")
+    parser.add_argument("--key", type=Path, default=BOOT_KEY,
+                        help="image signing key (default: secrets/boot_key.json)")
+    parser.add_argument("--no-restart", action="store_true",
+                        help="do not send \"bootloader\" first; reset the board by hand")
+    parser.add_argument("--no-boot", action="store_true", help="stay in the bootloader afterwards")
+    parser.add_argument("--measure", action="store_true", help="report the measurement instead of updating")
+    parser.add_argument("--full", action="store_true", help="with --measure, hash every sector")
+    args = parser.parse_args()
+    if not args.measure and args.bin is None:
+        parser.error("--bin is required unless --measure is given")
+
+    try:
+        if args.measure:
+            with serial.Serial(args.port, DEFAULT_BAUD) as ser:
+                link = BootLink(ser)
+                link.enter(not args.no_restart)
+                report = link.measure(args.full)
+                if not args.no_boot and report.tampered == 0:
+                    link.boot()
+            print(f"{report.hashed}/{report.sectors} sectors hashed in {report.us} us, "
+                  f"{report.tampered} tampered, image {report.image.hex()}")
+            return 0 if report.tampered == 0 else 2
+        base, image = load_image(args.bin, args.base)
+        with serial.Serial(args.port, DEFAULT_BAUD) as ser:
+            stats = update(ser, base, image, args.baud, args.keep_state,
+                           not args.no_restart, not args.no_boot, args.key)
+    except (BootError, serial.SerialException) as e:
+        print(f"boot_tool: {e}", file=sys.stderr)
+        return 1
+
+    print(f"{stats.written}/{stats.sectors} sectors rewritten, {stats.sent}/{stats.raw} bytes sent "
+          f"at {stats.baud} baud in {stats.seconds:.2f} s")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
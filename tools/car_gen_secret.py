@@ -14,6 +14,7 @@
 
 import json
 import argparse
+import os
 from pathlib import Path
 
 
@@ -35,6 +36,11 @@ def main():
     car_secret = args.car_id + 1
     secrets[str(args.car_id)] = car_secret
 
+    # The distance-bounding key is random, and kept once made: fobs already
+    # paired with this car hold it
+    bound_key = bytes.fromhex(secrets.setdefault("bound_keys", {}).setdefault(
+        str(args.car_id), os.urandom(16).hex()))
+
     # Save the secret file
     with open(args.secret_file, "w") as fp:
         json.dump(secrets, fp, indent=4)
@@ -46,6 +52,7 @@ def main():
         fp.write(f"#define CAR_SECRET {car_secret}\n\n")
         fp.write(f'#define CAR_ID "{args.car_id}"\n\n')
         fp.write('#define PASSWORD "unlock"\n\n')
+        fp.write(f"#define BOUND_KEY {{{', '.join(f'0x{b:02x}' for b in bound_key)}}}\n\n")
         fp.write("#endif\n")
 
 
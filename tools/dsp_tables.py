@@ -0,0 +1,289 @@
+#!/usr/bin/python3 -u
+
+# @file dsp_tables.py
+# @brief Generate the CMSIS-DSP FFT tables a firmware uses, and only those
+#
+# arm_common_tables.c and arm_const_structs.c define the tables and
+# instances of every FFT length. With ARM_DSP_CONFIG_TABLES set, CMSIS-DSP
+# keeps only those whose ARM_TABLE_* macros are defined, but the macros have
+# to be kept in step with the code by hand. This scans the firmware sources
+# for the transforms they use, arm_cfft_sR_<type>_len<N> style instances and
+# init calls with a constant length, and writes one source file with the
+# macros for exactly those, the library sources behind them and
+# arm_dsp_tables_init().
+#
+# With --ram, the floating-point tables are not kept in flash at all:
+# arm_dsp_tables_init() builds them into RAM at boot with the hardware/dsp
+# FFT table functions, and the file defines the instances and
+# arm_cfft_init_f32 / arm_rfft_fast_init_f32 over them. The fixed-point
+# tables stay in flash.
+
+import argparse
+import re
+import sys
+from collections import namedtuple
+from pathlib import Path
+
+# A transform the firmware uses: kind is "cfft", "rfft_fast" or "rfft"
+Use = namedtuple("Use", ["kind", "dtype", "length"])
+
+LENGTHS = {
+    "cfft": [1 << n for n in range(4, 13)],
+    "rfft_fast": [1 << n for n in range(5, 13)],
+    "rfft": [1 << n for n in range(5, 14)],
+}
+
+INSTANCE_RE = re.compile(
+    r"\barm_(cfft|rfft_fast|rfft)_sR_(f32|q31|q15)_len(\d+)\b")
+INIT_RE = re.compile(
+    r"\barm_(cfft|rfft_fast|rfft)_init_(f32|q31|q15)\s*\([^,;]*,\s*(\w+)\s*[,)]")
+DEFINE_RE = re.compile(r"^\s*#\s*define\s+(\w+)\s+\(?\s*(\d+)U?\s*\)?\s*$", re.M)
+COMMENT_RE = re.compile(r"//[^\n]*|/\*.*?\*/", re.S)
+
+# Library sources of each transform, besides its init function
+SOURCES = {
+    ("cfft", "f32"): ["arm_bitreversal2.c", "arm_cfft_radix8_f32.c", "arm_cfft_f32.c"],
+    ("cfft", "q15"): ["arm_bitreversal.c", "arm_bitreversal2.c", "arm_cfft_radix4_q15.c", "arm_cfft_q15.c"],
+    ("cfft", "q31"): ["arm_bitreversal.c", "arm_bitreversal2.c", "arm_cfft_radix4_q31.c", "arm_cfft_q31.c"],
+    ("rfft_fast", "f32"): ["arm_rfft_fast_f32.c"],
+    ("rfft", "q15"): ["arm_rfft_q15.c"],
+    ("rfft", "q31"): ["arm_rfft_q31.c"],
+}
+
+
+def valid(use):
+    if use.kind == "rfft_fast":
+        return use.dtype == "f32" and use.length in LENGTHS["rfft_fast"]
+    if use.kind == "rfft":
+        return use.dtype != "f32" and use.length in LENGTHS["rfft"]
+    return use.length in LENGTHS["cfft"]
+
+
+def scan(paths):
+    """Transforms used by the given sources, as a set of Use"""
+    texts = [COMMENT_RE.sub(" ", Path(p).read_text(errors="replace")) for p in paths]
+    defines = {}
+    for text in texts:
+        defines.update(DEFINE_RE.findall(text))
+
+    uses = set()
+    for text in texts:
+        for kind, dtype, length in INSTANCE_RE.findall(text):
+            uses.add(Use(kind, dtype, int(length)))
+        for kind, dtype, arg in INIT_RE.findall(text):
+            length = arg if arg.isdigit() else defines.get(arg)
+            if length is None:
+                # Length only known at run time: keep every length, as
+                # CMSIS-DSP does without ARM_DSP_CONFIG_TABLES
+                print(f"dsp_tables: length of arm_{kind}_init_{dtype}(..., {arg}) "
+                      f"is not a constant; keeping all {dtype} {kind} tables",
+                      file=sys.stderr)
+                uses.update(Use(kind, dtype, n) for n in LENGTHS[kind])
+            else:
+                uses.add(Use(kind, dtype, int(length)))
+
+    for use in uses:
+        if not valid(use):
+            raise ValueError(f"dsp_tables: no CMSIS-DSP tables for {use.dtype} "
+                             f"{use.kind} of length {use.length}")
+    return uses
+
+
+def complex_part(use):
+    """The complex FFT a transform runs on"""
+    if use.kind == "cfft":
+        return use
+    return Use("cfft", use.dtype, use.length // 2)
+
+
+def table_macros(use):
+    cfft = complex_part(use)
+    dtype = cfft.dtype.upper()
+    bitrev = "FLT" if cfft.dtype == "f32" else "FXT"
+    macros = [f"ARM_TABLE_TWIDDLECOEF_{dtype}_{cfft.length}",
+              f"ARM_TABLE_BITREVIDX_{bitrev}_{cfft.length}"]
+    if use.kind == "rfft_fast":
+        macros.append(f"ARM_TABLE_TWIDDLECOEF_RFFT_F32_{use.length}")
+    elif use.kind == "rfft":
+        macros.append(f"ARM_TABLE_REALCOEF_{dtype}")
+    return macros
+
+
+def cfft_position(k, log2_len):
+    """Mirrors cfft_position() in arm_cfft_bitrev_init_f32.c"""
+    low_bits = log2_len % 3
+    digits = k >> low_bits
+    reversed_digits = 0
+    for _ in range(log2_len // 3):
+        reversed_digits = (reversed_digits << 3) | (digits & 7)
+        digits >>= 3
+    return ((k & ((1 << low_bits) - 1)) << (log2_len - low_bits)) | reversed_digits
+
+
+def bitrev_length(length):
+    """Length of the f32 bit-reversal table, two entries per swap"""
+    log2_len = length.bit_length() - 1
+    seen = set()
+    cycles = 0
+    for k in range(length):
+        if k in seen:
+            continue
+        cycles += 1
+        x = k
+        while x not in seen:
+            seen.add(x)
+            x = cfft_position(x, log2_len)
+    return 2 * (length - cycles)
+
+
+def in_ram(use, ram):
+    return ram and use.dtype == "f32"
+
+
+def generate(uses, ram):
+    """Source of the tables, instances and arm_dsp_tables_init()"""
+    flash = sorted((u for u in uses if not in_ram(u, ram)), key=lambda u: (u.kind, u.dtype, u.length))
+    moved = sorted((u for u in uses if in_ram(u, ram)), key=lambda u: (u.kind, u.length))
+    lines = ["/*",
+             " * Generated by tools/dsp_tables.py; do not edit.",
+             " *"]
+    if uses:
+        lines.append(" * Transforms used:")
+        for use in sorted(uses, key=lambda u: (u.kind, u.dtype, u.length)):
+            where = "RAM" if in_ram(use, ram) else "flash"
+            lines.append(f" *   arm_{use.kind}_{use.dtype} {use.length} ({where})")
+    else:
+        lines.append(" * No FFT is used, so no tables are built.")
+    lines += [" */", ""]
+
+    if flash:
+        macros = sorted({m for u in flash for m in table_macros(u)})
+        lines += ["#define ARM_DSP_CONFIG_TABLES", "#define ARM_FFT_ALLOW_TABLES"]
+        lines += [f"#define {m}" for m in macros]
+        lines += ["", '#include "arm_common_tables.c"', '#include "arm_const_structs.c"', ""]
+
+    sources = []
+    for use in sorted(uses, key=lambda u: (u.kind != "cfft", u.kind, u.dtype)):
+        for part in (complex_part(use), use):
+            for source in SOURCES[(part.kind, part.dtype)]:
+                if source not in sources:
+                    sources.append(source)
+    for use in flash:
+        init = f"arm_{use.kind}_init_{use.dtype}.c"
+        if use.kind != "cfft" and f"arm_cfft_init_{use.dtype}.c" not in sources:
+            sources.append(f"arm_cfft_init_{use.dtype}.c")
+        if init not in sources:
+            sources.append(init)
+    lines += [f'#include "{s}"' for s in sources]
+    if sources:
+        lines.append("")
+
+    lines += ['#include "arm_math.h"', '#include "arm_fft_tables.h"', ""]
+    if moved:
+        lines += generate_ram(moved)
+    else:
+        lines += ["void arm_dsp_tables_init(void)", "{", "}"]
+    return "\n".join(lines) + "\n"
+
+
+def generate_ram(uses):
+    cffts = sorted({complex_part(u).length for u in uses})
+    rffts = sorted(u.length for u in uses if u.kind == "rfft_fast")
+    lines = []
+
+    for n in cffts:
+        lines.append(f"static float32_t cfftTwiddle{n}[{2 * n}];")
+        lines.append(f"static uint16_t cfftBitRev{n}[{bitrev_length(n)}];")
+    for n in rffts:
+        lines.append(f"static float32_t rfftTwiddle{n}[{n}];")
+    lines.append("")
+
+    def cfft_init(n):
+        return f"{n}U, cfftTwiddle{n}, cfftBitRev{n}, {bitrev_length(n)}U"
+
+    for n in cffts:
+        lines += [f"const arm_cfft_instance_f32 arm_cfft_sR_f32_len{n} = {{",
+                  f"  {cfft_init(n)}",
+                  "};", ""]
+    for n in rffts:
+        lines += [f"const arm_rfft_fast_instance_f32 arm_rfft_fast_sR_f32_len{n} = {{",
+                  f"  {{ {cfft_init(n // 2)} }},",
+                  f"  {n}U,",
+                  f"  rfftTwiddle{n}",
+                  "};", ""]
+
+    lines += ["arm_status arm_cfft_init_f32(",
+              "  arm_cfft_instance_f32 * S,",
+              "  uint16_t fftLen)",
+              "{",
+              "  switch (fftLen)",
+              "  {"]
+    for n in cffts:
+        lines += [f"  case {n}U:",
+                  f"    *S = arm_cfft_sR_f32_len{n};",
+                  "    return ARM_MATH_SUCCESS;"]
+    lines += ["  default:",
+              "    S->fftLen = fftLen;",
+              "    S->pTwiddle = NULL;",
+              "    return ARM_MATH_ARGUMENT_ERROR;",
+              "  }",
+              "}",
+              ""]
+
+    if rffts:
+        lines += ["arm_status arm_rfft_fast_init_f32(",
+                  "  arm_rfft_fast_instance_f32 * S,",
+                  "  uint16_t fftLen)",
+                  "{",
+                  "  switch (fftLen)",
+                  "  {"]
+        for n in rffts:
+            lines += [f"  case {n}U:",
+                      f"    *S = arm_rfft_fast_sR_f32_len{n};",
+                      "    return ARM_MATH_SUCCESS;"]
+        lines += ["  default:",
+                  "    return ARM_MATH_ARGUMENT_ERROR;",
+                  "  }",
+                  "}",
+                  ""]
+
+    lines += ["void arm_dsp_tables_init(void)", "{"]
+    for n in cffts:
+        lines.append(f"  arm_cfft_twiddle_init_f32(cfftTwiddle{n}, {n}U);")
+        lines.append(f"  arm_cfft_bitrev_init_f32(cfftBitRev{n}, {n}U);")
+    for n in rffts:
+        lines.append(f"  arm_rfft_fast_twiddle_init_f32(rfftTwiddle{n}, {n}U);")
+    lines.append("}")
+    return lines
+
+
+def summary(uses, ram):
+    if not uses:
+        return "DSP tables: none"
+    parts = []
+    for use in sorted(uses, key=lambda u: (u.kind, u.dtype, u.length)):
+        parts.append(f"{use.kind}_{use.dtype} {use.length}" + (" (RAM)" if in_ram(use, ram) else ""))
+    ram_bytes = sum(8 * n + 2 * bitrev_length(n)
+                    for n in {complex_part(u).length for u in uses if in_ram(u, ram)})
+    ram_bytes += sum(4 * u.length for u in uses if in_ram(u, ram) and u.kind == "rfft_fast")
+    text = "DSP tables: " + ", ".join(parts)
+    if ram_bytes:
+        text += f"; {ram_bytes} bytes built in RAM at boot"
+    return text
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--ram", action="store_true",
+                        help="build the floating-point tables in RAM at boot")
+    parser.add_argument("--output", type=Path, required=True)
+    parser.add_argument("sources", type=Path, nargs="+")
+    args = parser.parse_args()
+
+    uses = scan(args.sources)
+    args.output.write_text(generate(uses, args.ram))
+    print(summary(uses, args.ram))
+
+
+if __name__ == "__main__":
+    main()
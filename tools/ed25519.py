@@ -0,0 +1,346 @@
+#!/usr/bin/python3 -u
+
+# @file ed25519.py
+# @brief Ed25519 signatures (RFC 8032) for signing feature packages
+#
+# Pure Python on hashlib, so the host tools need no crypto package. Signing
+# uses a fixed-base comb table (64 windows of 16 multiples of B), so a
+# signature costs one SHA-512 pass and 64 point additions. verify_batch()
+# checks many signatures under one key with a random linear combination:
+# the doublings are shared, so each further signature costs about 40 point
+# additions instead of 256 doublings.
+#
+# The fob's verifier (application/source/ed25519.c) takes its table of
+# multiples of B from this file:
+#
+#     ed25519.py --c-table
+
+import argparse
+import hashlib
+import json
+import os
+import sys
+from multiprocessing import Pool
+from pathlib import Path
+from typing import Iterable, List, Optional, Sequence, Tuple
+
+P = 2 ** 255 - 19
+L = 2 ** 252 + 27742317777372353535851937790883648493
+D = -121665 * pow(121666, P - 2, P) % P
+D2 = 2 * D % P
+SQRT_M1 = pow(2, (P - 1) // 4, P)
+
+# Points are extended coordinates (X, Y, Z, T) with x = X/Z, y = Y/Z, xy = T/Z
+IDENTITY = (0, 1, 1, 0)
+
+
+def _add(p, q):
+    x1, y1, z1, t1 = p
+    x2, y2, z2, t2 = q
+    a = (y1 - x1) * (y2 - x2) % P
+    b = (y1 + x1) * (y2 + x2) % P
+    c = t1 * D2 * t2 % P
+    d = 2 * z1 * z2 % P
+    e, f, g, h = b - a, d - c, d + c, b + a
+    return (e * f % P, g * h % P, f * g % P, e * h % P)
+
+
+def _double(p):
+    x1, y1, z1, _ = p
+    a = x1 * x1 % P
+    b = y1 * y1 % P
+    c = 2 * z1 * z1 % P
+    h = a + b
+    e = h - (x1 + y1) * (x1 + y1)
+    g = a - b
+    f = c + g
+    return (e * f % P, g * h % P, f * g % P, e * h % P)
+
+
+def _negate(p):
+    x, y, z, t = p
+    return (-x % P, y, z, -t % P)
+
+
+def _mul(s: int, p):
+    q = IDENTITY
+    for bit in reversed(range(s.bit_length())):
+        q = _double(q)
+        if (s >> bit) & 1:
+            q = _add(q, p)
+    return q
+
+
+def _affine(p) -> Tuple[int, int]:
+    x, y, z, _ = p
+    zi = pow(z, P - 2, P)
+    return x * zi % P, y * zi % P
+
+
+def _encode(p) -> bytes:
+    x, y = _affine(p)
+    return (y | (x & 1) << 255).to_bytes(32, "little")
+
+
+def _equal(p, q) -> bool:
+    return (p[0] * q[2] - q[0] * p[2]) % P == 0 and (p[1] * q[2] - q[1] * p[2]) % P == 0
+
+
+def _decode(s: bytes):
+    """The point encoded by s, or None if s is not a valid encoding."""
+    if len(s) != 32:
+        return None
+    y = int.from_bytes(s, "little")
+    sign = y >> 255
+    y &= (1 << 255) - 1
+    if y >= P:
+        return None
+    x2 = (y * y - 1) * pow(D * y * y + 1, P - 2, P) % P
+    if x2 == 0:
+        if sign:
+            return None
+        return (0, y, 1, 0)
+    x = pow(x2, (P + 3) // 8, P)
+    if (x * x - x2) % P:
+        x = x * SQRT_M1 % P
+    if (x * x - x2) % P:
+        return None
+    if (x & 1) != sign:
+        x = P - x
+    return (x, y, 1, x * y % P)
+
+
+GY = 4 * pow(5, P - 2, P) % P
+B = _decode(GY.to_bytes(32, "little"))
+
+# _COMB[i][j] = j * 16^i * B, so k * B is one addition per hex digit of k
+_COMB: List[List[tuple]] = []
+
+
+def _comb():
+    if not _COMB:
+        base = B
+        for _ in range(64):
+            row = [IDENTITY]
+            for _ in range(15):
+                row.append(_add(row[-1], base))
+            _COMB.append(row)
+            base = _double(_double(_double(_double(base))))
+    return _COMB
+
+
+def _mul_base(s: int):
+    comb = _comb()
+    q = IDENTITY
+    for i in range(64):
+        q = _add(q, comb[i][(s >> (4 * i)) & 15])
+    return q
+
+
+def _sha512_int(*parts: bytes) -> int:
+    return int.from_bytes(hashlib.sha512(b"".join(parts)).digest(), "little")
+
+
+def _expand(seed: bytes) -> Tuple[int, bytes]:
+    h = hashlib.sha512(seed).digest()
+    a = int.from_bytes(h[:32], "little")
+    a &= (1 << 254) - 8
+    a |= 1 << 254
+    return a, h[32:]
+
+
+def public_key(seed: bytes) -> bytes:
+    if len(seed) != 32:
+        raise ValueError("Ed25519 seeds are 32 bytes")
+    a, _ = _expand(seed)
+    return _encode(_mul_base(a))
+
+
+def keygen() -> Tuple[bytes, bytes]:
+    """A new (seed, public key) pair."""
+    seed = os.urandom(32)
+    return seed, public_key(seed)
+
+
+def load_keypair(path: Path, create: bool = False) -> Tuple[bytes, bytes]:
+    """The (seed, public key) kept in a JSON key file, made first if asked."""
+    path = Path(path)
+    if not path.exists():
+        if not create:
+            raise FileNotFoundError(f"{path}: no signing key")
+        seed, public = keygen()
+        # Written whole, so a concurrent reader never sees half a key
+        tmp = path.with_name(f"{path.name}.{os.getpid()}")
+        tmp.write_text(json.dumps({"seed": seed.hex(), "public": public.hex()}, indent=4))
+        os.chmod(tmp, 0o600)
+        os.replace(tmp, path)
+    data = json.loads(path.read_text())
+    seed, public = bytes.fromhex(data["seed"]), bytes.fromhex(data["public"])
+    if public_key(seed) != public:
+        raise ValueError(f"{path}: public key does not match the seed")
+    return seed, public
+
+
+def sign(seed: bytes, msg: bytes, public: Optional[bytes] = None) -> bytes:
+    a, prefix = _expand(seed)
+    if public is None:
+        public = _encode(_mul_base(a))
+    r = _sha512_int(prefix, msg) % L
+    rs = _encode(_mul_base(r))
+    k = _sha512_int(rs, public, msg) % L
+    return rs + ((r + k * a) % L).to_bytes(32, "little")
+
+
+def verify(public: bytes, msg: bytes, sig: bytes) -> bool:
+    """Checks [S]B = R + [k]A, as the fob does."""
+    if len(sig) != 64:
+        return False
+    a = _decode(public)
+    s = int.from_bytes(sig[32:], "little")
+    if a is None or s >= L:
+        return False
+    k = _sha512_int(sig[:32], public, msg) % L
+    return _encode(_add(_mul_base(s), _negate(_mul(k, a)))) == sig[:32]
+
+
+def _multi_mul(pairs: Sequence[Tuple[int, tuple]]):
+    """Sum of s * p over the pairs, with 4-bit windows and shared doublings."""
+    tables = []
+    for _, p in pairs:
+        row = [IDENTITY, p]
+        for _ in range(14):
+            row.append(_add(row[-1], p))
+        tables.append(row)
+    bits = max((s.bit_length() for s, _ in pairs), default=0)
+    q = IDENTITY
+    for w in reversed(range(0, bits, 4)):
+        q = _double(_double(_double(_double(q))))
+        for (s, _), row in zip(pairs, tables):
+            digit = (s >> w) & 15
+            if digit:
+                q = _add(q, row[digit])
+    return q
+
+
+def verify_batch(public: bytes, items: Sequence[Tuple[bytes, bytes]]) -> bool:
+    """True if every (msg, sig) verifies under public.
+
+    Checks 8 * ([sum z_i S_i] B - sum z_i R_i - [sum z_i k_i] A) = 0 for
+    random 128-bit z_i. A False answer does not say which signature is bad;
+    verify() each to find out.
+    """
+    a = _decode(public)
+    if a is None:
+        return False
+    s_sum = k_sum = 0
+    pairs = []
+    for msg, sig in items:
+        if len(sig) != 64:
+            return False
+        r = _decode(sig[:32])
+        s = int.from_bytes(sig[32:], "little")
+        if r is None or s >= L:
+            return False
+        z = int.from_bytes(os.urandom(16), "little") | 1
+        k = _sha512_int(sig[:32], public, msg) % L
+        s_sum += z * s
+        k_sum += z * k
+        pairs.append((z, r))
+    pairs.append((k_sum % L, a))
+    total = _add(_mul_base(s_sum % L), _negate(_multi_mul(pairs)))
+    return _equal(_double(_double(_double(total))), IDENTITY)
+
+
+def _sign_job(job):
+    seed, public, msg = job
+    return sign(seed, msg, public)
+
+
+def _verify_job(job):
+    public, chunk = job
+    if verify_batch(public, chunk):
+        return [True] * len(chunk)
+    return [verify(public, msg, sig) for msg, sig in chunk]
+
+
+def _split(items: Sequence, n: int) -> List[Sequence]:
+    size = max(1, -(-len(items) // n))
+    return [items[i:i + size] for i in range(0, len(items), size)]
+
+
+def sign_many(seed: bytes, msgs: Iterable[bytes], processes: Optional[int] = None) -> List[bytes]:
+    """Signatures of msgs, in order, on every core."""
+    public = public_key(seed)
+    jobs = [(seed, public, m) for m in msgs]
+    if len(jobs) < 64 or processes == 1:
+        return [_sign_job(j) for j in jobs]
+    with Pool(processes) as pool:
+        return pool.map(_sign_job, jobs, chunksize=64)
+
+
+def verify_many(public: bytes, items: Sequence[Tuple[bytes, bytes]],
+                processes: Optional[int] = None) -> List[bool]:
+    """Whether each (msg, sig) verifies: batches of them on every core."""
+    items = list(items)
+    workers = 1 if len(items) < 64 or processes == 1 else (processes or os.cpu_count() or 1)
+    chunks = _split(items, workers * 4) if workers > 1 else _split(items, max(1, len(items) // 64))
+    if workers == 1:
+        return [ok for chunk in chunks for ok in _verify_job((public, chunk))]
+    with Pool(workers) as pool:
+        return [ok for res in pool.map(_verify_job, [(public, c) for c in chunks]) for ok in res]
+
+
+def _limbs(x: int) -> str:
+    return "{" + ", ".join(f"0x{(x >> (32 * i)) & 0xffffffff:08x}" for i in range(8)) + "}"
+
+
+def c_table() -> str:
+    """j * B for j = 0..15 as (y+x, y-x, 2dxy), for application/source/ed25519.c."""
+    lines = []
+    p = IDENTITY
+    for j in range(16):
+        x, y = _affine(p)
+        lines.append(f"  {{{_limbs((y + x) % P)},\n   {_limbs((y - x) % P)},\n"
+                     f"   {_limbs(D2 * x * y % P)}}},")
+        p = _add(p, B)
+    return "\n".join(lines)
+
+
+# RFC 8032 section 7.1, tests 1 and 2
+_VECTORS = [
+    ("9d61b19deffd5a60ba844af492ec2cc44449c5697b326919703bac031cae7f60",
+     "d75a980182b10ab7d54bfed3c964073a0ee172f3daa62325af021a68f707511a", "",
+     "e5564300c360ac729086e2cc806e828a84877f1eb8e5d974d873e06522490155"
+     "5fb8821590a33bacc61e39701cf9b46bd25bf5f0595bbe24655141438e7a100b"),
+    ("4ccd089b28ff96da9db6c346ec114e0f5b8a319f35aba624da8cf6ed4fb8a6fb",
+     "3d4017c3e843895a92b70aa74d1b7ebc9c982ccf2ec4968cc0cd55f12af4660c", "72",
+     "92a009a9f0d4cab8720e820b5f642540a2b27b5416503f8fb3762223ebdb69da"
+     "085ac1e43e15996e458f3613d0f11d8c387b2eaeb4302aeeb00d291612bb0c00"),
+]
+
+
+def self_test() -> bool:
+    for seed, public, msg, sig in _VECTORS:
+        seed, public, msg, sig = map(bytes.fromhex, (seed, public, msg, sig))
+        if public_key(seed) != public or sign(seed, msg) != sig or not verify(public, msg, sig):
+            return False
+        if verify(public, msg + b"x", sig):
+            return False
+    return True
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Ed25519 self-test and fob table generation")
+    parser.add_argument("--c-table", action="store_true", help="print the fob's table of multiples of B")
+    args = parser.parse_args()
+
+    if args.c_table:
+        print(c_table())
+        return 0
+    ok = self_test()
+    print("RFC 8032 vectors: " + ("pass" if ok else "FAIL"))
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -14,8 +14,11 @@
 
 import json
 import argparse
+import os
 from pathlib import Path
 
+import ed25519
+
 
 def main():
     parser = argparse.ArgumentParser()
@@ -24,14 +27,31 @@ def main():
     parser.add_argument("--secret-file", type=Path)
     parser.add_argument("--header-file", type=Path)
     parser.add_argument("--paired", action="store_true")
+    parser.add_argument("--feature-key", type=Path,
+                        help="feature package signing key (default: feature_key.json beside the secret file)")
     args = parser.parse_args()
 
+    # Every fob checks feature packages against the same public key; the
+    # signing key is made on the first build and kept for package_tool
+    key_file = args.feature_key or args.secret_file.parent / "feature_key.json"
+    _, public = ed25519.load_keypair(key_file, create=True)
+    pubkey = ", ".join(f"0x{b:02x}" for b in public)
+
     if args.paired:
         # Open the secret file, get the car's secret
         with open(args.secret_file, "r") as fp:
             secrets = json.load(fp)
             car_secret = secrets[str(args.car_id)]
 
+        # The car's distance-bounding key, made here if the car has not been
+        # built since keys were introduced
+        bound_keys = secrets.setdefault("bound_keys", {})
+        if str(args.car_id) not in bound_keys:
+            bound_keys[str(args.car_id)] = os.urandom(16).hex()
+            with open(args.secret_file, "w") as fp:
+                json.dump(secrets, fp, indent=4)
+        bound_key = ", ".join(f"0x{b:02x}" for b in bytes.fromhex(bound_keys[str(args.car_id)]))
+
         # Write to header file
         with open(args.header_file, "w") as fp:
             fp.write("#ifndef __FOB_SECRETS__\n")
@@ -41,6 +61,8 @@ def main():
             fp.write(f'#define CAR_ID "{args.car_id}"\n')
             fp.write(f'#define CAR_SECRET "{car_secret}"\n\n')
             fp.write('#define PASSWORD "unlock"\n\n')
+            fp.write(f"#define BOUND_KEY {{{bound_key}}}\n\n")
+            fp.write(f"#define FEATURE_PUBKEY {{{pubkey}}}\n\n")
             fp.write("#endif\n")
     else:
         # Write to header file
@@ -52,6 +74,7 @@ def main():
             fp.write('#define CAR_ID "000000"\n')
             fp.write('#define CAR_SECRET "000000"\n\n')
             fp.write('#define PASSWORD "unlock"\n\n')
+            fp.write(f"#define FEATURE_PUBKEY {{{pubkey}}}\n\n")
             fp.write("#endif\n")
 
 
@@ -0,0 +1,207 @@
+#!/usr/bin/python3 -u
+
+# @file hostlink.py
+# @brief Python bindings for the host-link client library (libhostlink.so)
+#
+# Drives the host UARTs of many devices from one epoll loop, with several
+# commands in flight on each, instead of one blocking readline at a time:
+#
+#     with HostLink() as link:
+#         devs = [link.add(port) for port in ports]
+#         replies = link.run([(dev, "isPaired") for dev in devs])
+#
+# Replies are matched to commands in order per device (see
+# hardware/x86/hostlink/hostlink.h). Lines nothing was waiting for collect in
+# HostLink.lines[dev]. Build the library first with "scons hostlink=1".
+#
+# As a tool, sends each command to every port and prints the replies:
+#
+#     hostlink.py --port /dev/ttyACM0 --port /dev/ttyACM1 isPaired getFlashData
+
+import argparse
+import ctypes
+import os
+import sys
+import time
+from collections import deque
+from dataclasses import dataclass
+from pathlib import Path
+from typing import Deque, Dict, Iterable, List, Optional, Tuple
+
+LIB_PATH = Path(__file__).resolve().parent.parent / "hardware" / "x86" / "build" / "hostlink" / "libhostlink.so"
+
+HL_OK = 0
+HL_ERROR = 1
+HL_LINE = 2
+HL_CLOSED = 3
+
+EVENT_BATCH = 256
+
+
+class _Event(ctypes.Structure):
+    _fields_ = [("dev", ctypes.c_int32),
+                ("status", ctypes.c_int32),
+                ("tag", ctypes.c_uint64),
+                ("value", ctypes.c_void_p),
+                ("len", ctypes.c_uint32)]
+
+
+@dataclass
+class Reply:
+    """A device's answer to one command, as testing/protocol.py's Response."""
+    success: bool
+    value: Optional[str] = None
+    error: Optional[str] = None
+    dev: int = -1
+    tag: int = 0
+
+    def __bool__(self):
+        return self.success
+
+
+class HostLinkError(Exception):
+    pass
+
+
+def _load(path: Path) -> ctypes.CDLL:
+    if not path.exists():
+        raise HostLinkError(f"{path} not found; build it with: scons hostlink=1")
+    lib = ctypes.CDLL(str(path), use_errno=True)
+    lib.hl_open.restype = ctypes.c_void_p
+    lib.hl_close.argtypes = [ctypes.c_void_p]
+    lib.hl_add.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_uint32, ctypes.c_uint32]
+    lib.hl_add.restype = ctypes.c_int32
+    lib.hl_remove.argtypes = [ctypes.c_void_p, ctypes.c_int32]
+    lib.hl_remove.restype = ctypes.c_int32
+    lib.hl_send.argtypes = [ctypes.c_void_p, ctypes.c_int32, ctypes.c_char_p, ctypes.c_uint32]
+    lib.hl_send.restype = ctypes.c_int64
+    lib.hl_pending.argtypes = [ctypes.c_void_p, ctypes.c_int32]
+    lib.hl_pending.restype = ctypes.c_int32
+    lib.hl_poll.argtypes = [ctypes.c_void_p, ctypes.POINTER(_Event), ctypes.c_int32, ctypes.c_int32]
+    lib.hl_poll.restype = ctypes.c_int32
+    return lib
+
+
+class HostLink:
+    def __init__(self, lib_path: Path = LIB_PATH):
+        self._lib = _load(Path(lib_path))
+        self._loop = self._lib.hl_open()
+        if not self._loop:
+            raise HostLinkError("hl_open failed")
+        self._events = (_Event * EVENT_BATCH)()
+        self.replies: Dict[int, Reply] = {}
+        self.lines: Dict[int, Deque[str]] = {}
+        self.closed: set = set()
+        self._owner: Dict[int, int] = {}
+
+    def close(self) -> None:
+        if self._loop:
+            self._lib.hl_close(self._loop)
+            self._loop = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def _check(self, result: int, what: str) -> int:
+        if result < 0:
+            raise HostLinkError(f"{what}: {os.strerror(-result)}")
+        return result
+
+    def add(self, port: str, baud: int = 115200, depth: int = 1) -> int:
+        """Open a device's host port; up to depth commands go out before a reply.
+
+        The boards buffer only their UART FIFO while a command runs, so
+        deeper pipelines suit short commands, or the x86 builds.
+        """
+        dev = self._check(self._lib.hl_add(self._loop, port.encode(), baud, depth), port)
+        self.lines[dev] = deque()
+        return dev
+
+    def remove(self, dev: int) -> None:
+        self._check(self._lib.hl_remove(self._loop, dev), f"device {dev}")
+
+    def send(self, dev: int, cmd: str) -> int:
+        """Queue a command; returns the tag its reply will carry."""
+        data = cmd.encode("ascii")
+        tag = self._check(self._lib.hl_send(self._loop, dev, data, len(data)), f"device {dev}")
+        self._owner[tag] = dev
+        return tag
+
+    def pending(self, dev: int) -> int:
+        return self._check(self._lib.hl_pending(self._loop, dev), f"device {dev}")
+
+    def poll(self, timeout: Optional[float] = None) -> int:
+        """Move bytes for up to timeout seconds; returns the number of events."""
+        ms = -1 if timeout is None else max(0, int(timeout * 1000))
+        n = self._check(self._lib.hl_poll(self._loop, self._events, EVENT_BATCH, ms), "hl_poll")
+        for ev in self._events[:n]:
+            # The value points into the library's buffer until the next poll
+            text = ctypes.string_at(ev.value, ev.len).decode("ascii", errors="replace") if ev.len else ""
+            if ev.status == HL_OK:
+                self.replies[ev.tag] = Reply(True, text or None, None, ev.dev, ev.tag)
+            elif ev.status == HL_ERROR:
+                self.replies[ev.tag] = Reply(False, None, text, ev.dev, ev.tag)
+            elif ev.status == HL_LINE:
+                self.lines[ev.dev].append(text)
+            else:
+                self.closed.add(ev.dev)
+        return n
+
+    def wait(self, tags: Iterable[int], timeout: float = 5.0) -> List[Reply]:
+        """Replies to the given tags, in the same order."""
+        tags = list(tags)
+        deadline = time.monotonic() + timeout
+        while any(t not in self.replies for t in tags):
+            lost = [t for t in tags if t not in self.replies and self._owner.get(t) in self.closed]
+            if lost:
+                raise HostLinkError(f"device {self._owner[lost[0]]} closed with "
+                                    f"{len(lost)} replies outstanding")
+            remaining = deadline - time.monotonic()
+            if remaining <= 0:
+                missing = sum(t not in self.replies for t in tags)
+                raise TimeoutError(f"{missing} of {len(tags)} replies missing after {timeout}s")
+            self.poll(remaining)
+        for t in tags:
+            self._owner.pop(t, None)
+        return [self.replies.pop(t) for t in tags]
+
+    def run(self, commands: Iterable[Tuple[int, str]], timeout: float = 5.0) -> List[Reply]:
+        """Send every (device, command) at once and return the replies in order."""
+        tags = [self.send(dev, cmd) for dev, cmd in commands]
+        return self.wait(tags, timeout)
+
+    def command(self, dev: int, cmd: str, timeout: float = 5.0) -> Reply:
+        return self.run([(dev, cmd)], timeout)[0]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Send commands to many devices at once")
+    parser.add_argument("--port", action="append", required=True, help="device host port (repeatable)")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--depth", type=int, default=1, help="commands in flight per device")
+    parser.add_argument("--timeout", type=float, default=10.0)
+    parser.add_argument("commands", nargs="+")
+    args = parser.parse_args()
+
+    try:
+        with HostLink() as link:
+            devs = {link.add(port, args.baud, args.depth): port for port in args.port}
+            jobs = [(dev, cmd) for dev in devs for cmd in args.commands]
+            replies = link.run(jobs, args.timeout)
+    except (HostLinkError, TimeoutError) as e:
+        print(f"hostlink: {e}", file=sys.stderr)
+        return 1
+
+    failed = 0
+    for (dev, cmd), reply in zip(jobs, replies):
+        text = f"OK: {reply.value}" if reply.success else f"ERROR: {reply.error}"
+        print(f"{devs[dev]}: {cmd}: {text}")
+        failed += not reply.success
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())